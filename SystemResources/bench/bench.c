@@ -0,0 +1,969 @@
+// Benchmark de los parsers de /proc sobre snapshots fijos (make bench).
+//
+// Cada fixture es un árbol <dir>/proc + <dir>/sys que se monta con
+// procfs_set_root(). Además de los grabados en bench/fixtures/ se generan
+// sintéticos: un /proc/stat de 256 cores, un /proc/cpuinfo enorme (256
+// bloques estilo x86 con la línea de flags completa), un /proc con 5000
+// procesos para el sampler de procesos, /proc/interrupts + /proc/softirqs de
+// 192 columnas, un /proc/net/dev con 300 veth, un /proc/diskstats con 150
+// loop y 40 discos, listas de CPUs de sysfs con rangos enormes y un
+// /proc/self/mountinfo de 400 montajes con cgroup2 en el montaje híbrido.
+//
+// Por función se reporta ns/llamada y reservas de memoria por llamada (se
+// interpone malloc & cía. sobre glibc, así también se cuentan las de fopen).
+// Cada fixture corre en un proceso hijo para que los handles persistentes de
+// memory.c/cpu.c se abran contra su propia raíz.
+//
+// Un fixture es un archivo regular, que pread() entrega entero; los de /proc
+// hechos con seq_file devuelven como mucho una página por llamada. Para que
+// los parsers vean lo mismo que en una máquina real, pread() también se
+// interpone y, sobre los fixtures, corta cada lectura como el kernel. Antes
+// de medir se comprueba que procfile lee completos un archivo así y uno real
+// de /proc de varias páginas.
+#include "memory.h"
+#include "cpu.h"
+#include "procfile.h"
+#include "procs.h"
+#include "irq.h"
+#include "disk.h"
+#include "net.h"
+#include "cgroup.h"
+#include "thermal.h"
+#include <dirent.h>
+#include <dlfcn.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+// ---------- Conteo de reservas ----------
+extern void *__libc_malloc(size_t n);
+extern void *__libc_calloc(size_t n, size_t sz);
+extern void *__libc_realloc(void *p, size_t n);
+extern void *__libc_memalign(size_t align, size_t n);
+extern void  __libc_free(void *p);
+
+static int g_counting = 0;
+static unsigned long long g_allocs = 0, g_alloc_bytes = 0;
+
+static void count(size_t n) {
+    if (g_counting) { g_allocs++; g_alloc_bytes += n; }
+}
+
+void *malloc(size_t n)                { count(n); return __libc_malloc(n); }
+void *calloc(size_t n, size_t sz)     { count(n * sz); return __libc_calloc(n, sz); }
+void *realloc(void *p, size_t n)      { count(n); return __libc_realloc(p, n); }
+void *aligned_alloc(size_t a, size_t n) { count(n); return __libc_memalign(a, n); }
+void  free(void *p)                   { __libc_free(p); }
+
+int posix_memalign(void **out, size_t a, size_t n) {
+    count(n);
+    void *p = __libc_memalign(a, n);
+    if (!p) return ENOMEM;
+    *out = p;
+    return 0;
+}
+
+// ---------- Lecturas cortas al estilo seq_file ----------
+// seq_file llena su buffer de a una página y nunca parte un registro: cada
+// pread() devuelve las líneas completas que caben en SEQ_PAGE bytes.
+#define SEQ_PAGE 4096
+static int g_seq_reads = 0;
+
+ssize_t pread(int fd, void *buf, size_t n, off_t off) {
+    static ssize_t (*real_pread)(int, void *, size_t, off_t);
+    if (!real_pread) *(void **)&real_pread = dlsym(RTLD_NEXT, "pread");
+    if (!g_seq_reads || n <= SEQ_PAGE) return real_pread(fd, buf, n, off);
+    ssize_t r = real_pread(fd, buf, SEQ_PAGE, off);
+    if (r == SEQ_PAGE) {
+        const char *nl = memrchr(buf, '\n', SEQ_PAGE);
+        if (nl) r = nl - (const char *)buf + 1;
+    }
+    return r;
+}
+
+// ---------- Medición ----------
+static double now_s(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+typedef int (*BenchFn)(char *result, size_t len);
+
+static int bench_one(const char *name, BenchFn fn, double min_s) {
+    char result[96] = "";
+    // Calentamiento: abre handles persistentes y estabiliza los buffers
+    for (int i = 0; i < 3; ++i) {
+        if (fn(result, sizeof(result)) != 0) {
+            printf("  %-16s  ERROR (%s)\n", name, result[0] ? result : "la función devolvió error");
+            return 1;
+        }
+    }
+
+    unsigned long long iters = 0;
+    g_allocs = g_alloc_bytes = 0;
+    g_counting = 1;
+    double t0 = now_s(), el = 0.0;
+    do {
+        for (int k = 0; k < 64; ++k) fn(result, sizeof(result));
+        iters += 64;
+        el = now_s() - t0;
+    } while (el < min_s);
+    g_counting = 0;
+
+    printf("  %-16s %10.0f %12.2f %12.1f   %s\n", name, el * 1e9 / (double)iters,
+           (double)g_allocs / (double)iters, (double)g_alloc_bytes / (double)iters, result);
+    return 0;
+}
+
+static int b_mem(char *res, size_t len) {
+    MemStats m;
+    int rc = mem_read_stats(&m);
+    snprintf(res, len, "total=%ld kB disp=%ld kB", m.total_kib, m.avail_kib);
+    return rc;
+}
+
+static CPUUsage g_usage;
+static int b_usage(char *res, size_t len) {
+    int rc = cpu_read_usage(&g_usage);
+    // Con un /proc/stat fijo no hay delta: se mide lectura + parseo completos
+    snprintf(res, len, "cores=%d", g_usage.cores);
+    return rc;
+}
+
+static int b_info(char *res, size_t len) {
+    CPUInfo ci;
+    int rc = cpu_read_info(&ci);
+    snprintf(res, len, "config=%d hw=%s", ci.cores_config, ci.hardware);
+    return rc;
+}
+
+// Con /proc fijo todos los procesos siguen vivos: se mide el caso estable
+// (pread por fd cacheado + parseo + top-N), no el alta de pids nuevos.
+static ProcSampler *g_procs;
+static ProcStats g_proc_stats;
+static int b_procs(char *res, size_t len) {
+    int rc = proc_sampler_sample(g_procs, &g_proc_stats);
+    snprintf(res, len, "procs=%d sin_fd=%d", g_proc_stats.total, g_proc_stats.uncached);
+    return rc;
+}
+
+// Igual: contadores fijos, así que se mide relectura + parseo de ambas tablas
+// (las filas y columnas ya conocidas, sin reservas).
+static IrqSampler *g_irq;
+static IrqStats g_irq_stats;
+static int b_irq(char *res, size_t len) {
+    int rc = irq_sampler_sample(g_irq, &g_irq_stats);
+    snprintf(res, len, "cpus=%d", g_irq_stats.ncpus);
+    return rc;
+}
+
+typedef int (*VerifyFn)(const char *dir);
+
+static int check(int ok, const char *what);
+
+static DiskSampler *g_disk;
+static DiskStats g_disk_stats;
+static int b_disk(char *res, size_t len) {
+    int rc = disk_sampler_sample(g_disk, &g_disk_stats);
+    snprintf(res, len, "discos=%d", g_disk_stats.count + g_disk_stats.omitted);
+    return rc;
+}
+
+static NetSampler *g_net;
+static NetStats g_net_stats;
+static int b_net(char *res, size_t len) {
+    int rc = net_sampler_sample(g_net, &g_net_stats);
+    snprintf(res, len, "interfaces=%d", g_net_stats.count + g_net_stats.omitted);
+    return rc;
+}
+
+static int run_fixture(const char *name, const char *dir, double min_s, VerifyFn verify) {
+    char proc[512], sys[512];
+    snprintf(proc, sizeof(proc), "%s/proc", dir);
+    snprintf(sys, sizeof(sys), "%s/sys", dir);
+    if (procfs_set_root(proc, sys) != 0) return 1;
+    g_seq_reads = 1;
+    cpu_usage_init(&g_usage);
+
+    printf("\n[%s] %s\n", name, dir);
+    int rc = 0;
+    if (verify) rc |= verify(dir);
+    printf("  %-16s %10s %12s %12s   %s\n", "función", "ns/llamada", "allocs/llam.", "bytes/llam.", "resultado");
+    rc |= bench_one("mem_read_stats", b_mem, min_s);
+    rc |= bench_one("cpu_read_usage", b_usage, min_s);
+    rc |= bench_one("cpu_read_info", b_info, min_s);
+    g_procs = proc_sampler_create();
+    if (g_procs) rc |= bench_one("proc_sampler", b_procs, min_s);
+    proc_sampler_destroy(g_procs);
+    g_irq = irq_sampler_create();
+    if (g_irq) rc |= bench_one("irq_sampler", b_irq, min_s);
+    irq_sampler_destroy(g_irq);
+    g_disk = disk_sampler_create();
+    if (g_disk) rc |= bench_one("disk_sampler", b_disk, min_s);
+    disk_sampler_destroy(g_disk);
+    g_net = net_sampler_create();
+    if (g_net) rc |= bench_one("net_sampler", b_net, min_s);
+    net_sampler_destroy(g_net);
+    fflush(stdout);
+    cpu_usage_free(&g_usage);
+    return rc;
+}
+
+// ---------- Fixtures sintéticos ----------
+static int mkdirs(const char *path) {
+    char tmp[512];
+    snprintf(tmp, sizeof(tmp), "%s", path);
+    for (char *p = tmp + 1; *p; ++p) {
+        if (*p != '/') continue;
+        *p = '\0';
+        if (mkdir(tmp, 0755) != 0 && errno != EEXIST) return 1;
+        *p = '/';
+    }
+    return (mkdir(tmp, 0755) != 0 && errno != EEXIST) ? 1 : 0;
+}
+
+static FILE *create(const char *root, const char *rel) {
+    char path[512], dir[512];
+    snprintf(path, sizeof(path), "%s/%s", root, rel);
+    snprintf(dir, sizeof(dir), "%s", path);
+    char *slash = strrchr(dir, '/');
+    if (slash) { *slash = '\0'; if (mkdirs(dir) != 0) return NULL; }
+    return fopen(path, "w");
+}
+
+static int copy_file(const char *from, const char *root, const char *rel) {
+    FILE *in = fopen(from, "r");
+    FILE *out = in ? create(root, rel) : NULL;
+    if (!out) { if (in) fclose(in); return 1; }
+    char buf[4096];
+    size_t n;
+    while ((n = fread(buf, 1, sizeof(buf), in)) > 0) fwrite(buf, 1, n, out);
+    fclose(in);
+    return fclose(out) == 0 ? 0 : 1;
+}
+
+// 256 cores: /proc/stat con una línea por core e "intr" con 1024 fuentes
+static int gen_stat256(const char *root, const char *meminfo) {
+    const int n = 256;
+    const unsigned long long un = (unsigned long long)n;
+    FILE *f = create(root, "proc/stat");
+    if (!f) return 1;
+    unsigned long long seed = 12345;
+    fprintf(f, "cpu  %llu 0 %llu %llu 0 0 0 0 0 0\n", 1000000ULL * un, 300000ULL * un, 9000000ULL * un);
+    for (int c = 0; c < n; ++c) {
+        seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+        unsigned long long u = 900000 + (seed >> 44), s = 280000 + (seed >> 48);
+        fprintf(f, "cpu%d %llu %llu %llu %llu %llu %llu %llu 0 0 0\n",
+                c, u, seed >> 60, s, 9000000ULL - u - s, (seed >> 52) & 0xff, 0ULL, (seed >> 50) & 0xfff);
+    }
+    fprintf(f, "intr 9182736455");
+    for (int i = 0; i < 1024; ++i) fprintf(f, " %d", (i % 7) ? 0 : 1000 + i);
+    fprintf(f, "\nctxt 98172635412\nbtime 1728990211\nprocesses 9182736\n"
+               "procs_running 37\nprocs_blocked 2\nsoftirq 1 2 3 4 5 6 7 8 9 10 11\n");
+    if (fclose(f) != 0) return 1;
+
+    f = create(root, "sys/devices/system/cpu/online");
+    if (!f) return 1;
+    fprintf(f, "0-%d\n", n - 1);
+    fclose(f);
+    f = create(root, "sys/devices/system/cpu/possible");
+    if (!f) return 1;
+    fprintf(f, "0-%d\n", n - 1);
+    fclose(f);
+
+    // cpuinfo corto (el enorme va en su propio fixture)
+    f = create(root, "proc/cpuinfo");
+    if (!f) return 1;
+    fprintf(f, "processor\t: 0\nmodel name\t: Synthetic 256-core\nHardware\t: SYNTH\n");
+    fclose(f);
+    return copy_file(meminfo, root, "proc/meminfo");
+}
+
+// /proc/cpuinfo enorme: 256 bloques x86 con ~1.4 KiB de flags cada uno
+static int gen_cpuinfo_huge(const char *root, const char *meminfo) {
+    static const char *flags =
+        "fpu vme de pse tsc msr pae mce cx8 apic sep mtrr pge mca cmov pat pse36 clflush dts acpi "
+        "mmx fxsr sse sse2 ss ht tm pbe syscall nx pdpe1gb rdtscp lm constant_tsc art arch_perfmon "
+        "pebs bts rep_good nopl xtopology nonstop_tsc cpuid aperfmperf pni pclmulqdq dtes64 monitor "
+        "ds_cpl vmx smx est tm2 ssse3 sdbg fma cx16 xtpr pdcm pcid dca sse4_1 sse4_2 x2apic movbe "
+        "popcnt tsc_deadline_timer aes xsave avx f16c rdrand lahf_lm abm 3dnowprefetch cpuid_fault "
+        "epb cat_l3 cdp_l3 invpcid_single intel_ppin ssbd mba ibrs ibpb stibp ibrs_enhanced "
+        "tpr_shadow vnmi flexpriority ept vpid ept_ad fsgsbase tsc_adjust bmi1 avx2 smep bmi2 erms "
+        "invpcid cqm rdt_a avx512f avx512dq rdseed adx smap avx512ifma clflushopt clwb intel_pt "
+        "avx512cd sha_ni avx512bw avx512vl xsaveopt xsavec xgetbv1 xsaves cqm_llc cqm_occup_llc "
+        "cqm_mbm_total cqm_mbm_local split_lock_detect wbnoinvd dtherm ida arat pln pts hwp hwp_act_window "
+        "hwp_epp hwp_pkg_req avx512vbmi umip pku ospke avx512_vbmi2 gfni vaes vpclmulqdq avx512_vnni "
+        "avx512_bitalg tme avx512_vpopcntdq la57 rdpid fsrm md_clear pconfig flush_l1d arch_capabilities";
+    FILE *f = create(root, "proc/cpuinfo");
+    if (!f) return 1;
+    for (int c = 0; c < 256; ++c) {
+        fprintf(f,
+                "processor\t: %d\nvendor_id\t: GenuineIntel\ncpu family\t: 6\nmodel\t\t: 106\n"
+                "model name\t: Intel(R) Xeon(R) Platinum 8380 CPU @ 2.30GHz\nstepping\t: 6\n"
+                "microcode\t: 0xd0003a5\ncpu MHz\t\t: 2300.000\ncache size\t: 61440 KB\n"
+                "physical id\t: %d\nsiblings\t: 128\ncore id\t\t: %d\ncpu cores\t: 64\napicid\t\t: %d\n"
+                "initial apicid\t: %d\nfpu\t\t: yes\nfpu_exception\t: yes\ncpuid level\t: 27\nwp\t\t: yes\n"
+                "flags\t\t: %s\nvmx flags\t: vnmi preemption_timer posted_intr invvpid ept_x_only ept_ad\n"
+                "bugs\t\t: spectre_v1 spectre_v2 spec_store_bypass swapgs mmio_stale_data\n"
+                "bogomips\t: 4600.00\nclflush size\t: 64\ncache_alignment\t: 64\n"
+                "address sizes\t: 46 bits physical, 57 bits virtual\npower management:\n\n",
+                c, c / 128, c % 64, c, c, flags);
+    }
+    if (fclose(f) != 0) return 1;
+    f = create(root, "sys/devices/system/cpu/online");
+    if (!f) return 1;
+    fprintf(f, "0-255\n");
+    fclose(f);
+    f = create(root, "sys/devices/system/cpu/possible");
+    if (!f) return 1;
+    fprintf(f, "0-255\n");
+    fclose(f);
+    if (copy_file(meminfo, root, "proc/meminfo") != 0) return 1;
+    // /proc/stat mínimo de 1 core para que cpu_read_usage tenga algo que leer
+    f = create(root, "proc/stat");
+    if (!f) return 1;
+    fprintf(f, "cpu  1 0 1 100 0 0 0 0 0 0\ncpu0 1 0 1 100 0 0 0 0 0 0\nctxt 1\nprocesses 1\n"
+               "procs_running 1\nprocs_blocked 0\n");
+    return fclose(f) == 0 ? 0 : 1;
+}
+
+// 5000 procesos: /proc/<pid>/stat con el formato real (comm variados, alguno
+// con espacios y paréntesis) más un /proc/stat y cpuinfo mínimos
+static int gen_procs5000(const char *root, const char *meminfo) {
+    static const char *const comm[] = { "bash", "sshd", "kworker/3:1-events", "python3", "nginx",
+                                        "Web Content", "a) b (c", "postgres", "java", "containerd-shim" };
+    unsigned long long seed = 987654321;
+    for (int i = 0; i < 5000; ++i) {
+        int pid = 1000 + i * 3;
+        char rel[64];
+        snprintf(rel, sizeof(rel), "proc/%d/stat", pid);
+        FILE *f = create(root, rel);
+        if (!f) return 1;
+        seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+        fprintf(f, "%d (%.15s) %c 1 %d %d 0 -1 4194560 %llu 0 12 0 %llu %llu 0 0 20 0 %llu 0 %llu "
+                   "%llu %llu 18446744073709551615 1 1 0 0 0 0 0 4096 0 0 0 0 17 %d 0 0 0 0 0\n",
+                pid, comm[i % 10], (i % 50) ? 'S' : 'R', pid, pid, seed >> 50, seed >> 52, seed >> 54,
+                1 + (seed >> 61), 100000ULL + (unsigned long long)i, (seed >> 30) & 0xffffffffULL,
+                (seed >> 44) & 0xfffffULL, i % 64);
+        if (fclose(f) != 0) return 1;
+    }
+    FILE *f = create(root, "proc/stat");
+    if (!f) return 1;
+    fprintf(f, "cpu  1 0 1 100 0 0 0 0 0 0\ncpu0 1 0 1 100 0 0 0 0 0 0\nctxt 1\nprocesses 1\n"
+               "procs_running 1\nprocs_blocked 0\n");
+    if (fclose(f) != 0) return 1;
+    f = create(root, "proc/cpuinfo");
+    if (!f) return 1;
+    fprintf(f, "processor\t: 0\nmodel name\t: Synthetic 5000-procs\n");
+    fclose(f);
+    return copy_file(meminfo, root, "proc/meminfo");
+}
+
+// Los dormidos se releen una de cada 4 muestras: un proceso que despierta
+// tiene que llegar al top de CPU dentro de ese plazo. Se usa uno de los 5000
+// (mismo starttime, para que no parezca un pid reutilizado).
+#define PROCS_HOT_IDX 1234
+static int verify_procs5000(const char *dir) {
+    ProcSampler *s = proc_sampler_create();
+    ProcStats st;
+    int rc = 0;
+    for (int i = 0; i < 3 && s; ++i) rc |= proc_sampler_sample(s, &st);
+    const int pid = 1000 + PROCS_HOT_IDX * 3;
+    char rel[64];
+    snprintf(rel, sizeof(rel), "proc/%d/stat", pid);
+    FILE *f = create(dir, rel);
+    if (!s || rc != 0 || !f) {
+        if (f) fclose(f);
+        proc_sampler_destroy(s);
+        return check(0, "procs: no se pudo muestrear el /proc sintético");
+    }
+    fprintf(f, "%d (hot) R 1 %d %d 0 -1 4194560 0 0 0 0 900000 100 0 0 20 0 1 0 %llu "
+               "1000000 256 18446744073709551615 1 1 0 0 0 0 0 4096 0 0 0 0 17 0 0 0 0 0 0\n",
+            pid, pid, pid, 100000ULL + PROCS_HOT_IDX);
+    fclose(f);
+    int seen = 0;
+    for (int i = 1; i <= 4 && !seen; ++i)
+        if (proc_sampler_sample(s, &st) == 0 && st.n_cpu > 0 && st.by_cpu[0].pid == pid) seen = i;
+    proc_sampler_destroy(s);
+    char what[96];
+    snprintf(what, sizeof(what), "procs: proceso despierto en el top en %d de 4 muestras", seen);
+    rc |= check(seen > 0 && st.total == 5000, what);
+    return rc;
+}
+
+// 192 núcleos: /proc/interrupts con el formato de x86 (IO-APIC, 180 vectores
+// MSI-X de NIC y NVMe, filas de arquitectura y ERR/MIS de una sola columna) y
+// /proc/softirqs, más un /proc/stat y cpuinfo mínimos
+#define IRQ192_CPUS      192
+#define IRQ192_ROWS      (200 + 14)   // filas por núcleo (sin ERR/MIS)
+#define IRQ192_HOT_CPU   5
+#define IRQ192_HOT_BUMP  1000000ULL   // con 'bump', la última IRQ en IRQ192_HOT_CPU
+
+// Con 'bump' = 1 cada contador por núcleo sube en 1 y la última IRQ
+// numerada (nvme0q-7, a ~400 KiB del principio) suma IRQ192_HOT_BUMP en
+// IRQ192_HOT_CPU.
+static int write_interrupts192(const char *root, int bump) {
+    static const char *const arch[] = { "NMI", "LOC", "SPU", "PMI", "IWI", "RTR", "RES",
+                                        "CAL", "TLB", "TRM", "THR", "DFR", "MCE", "MCP" };
+    const int n = IRQ192_CPUS;
+    const unsigned long long b = (unsigned long long)bump;
+    unsigned long long seed = 55555;
+    FILE *f = create(root, "proc/interrupts");
+    if (!f) return 1;
+    fprintf(f, "%*s", 4, "");
+    for (int c = 0; c < n; ++c) fprintf(f, "CPU%-8d", c);
+    fputc('\n', f);
+    for (int irq = 0; irq < 200; ++irq) {
+        fprintf(f, "%4d: ", irq);
+        for (int c = 0; c < n; ++c) {
+            seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+            // Cada vector se concentra en uno o dos núcleos (afinidad)
+            unsigned long long v = (c % 64 == irq % 64) ? seed >> 36 : (seed >> 62) * (seed >> 56);
+            if (irq == 199 && c == IRQ192_HOT_CPU) v += b * IRQ192_HOT_BUMP;
+            fprintf(f, "%10llu ", v + b);
+        }
+        if (irq < 20) fprintf(f, " IO-APIC   %d-edge      timer\n", irq);
+        else fprintf(f, " PCI-MSIX-0000:%02x:00.0   %d-edge      %s-%d\n",
+                     irq < 140 ? 0x3b : 0x5e, irq, irq < 140 ? "mlx5_comp" : "nvme0q", irq % 64);
+    }
+    for (size_t i = 0; i < sizeof(arch) / sizeof(arch[0]); ++i) {
+        fprintf(f, "%4s: ", arch[i]);
+        for (int c = 0; c < n; ++c) fprintf(f, "%10llu ", 1000000ULL * (i + 1) + (unsigned long long)c + b);
+        fprintf(f, "  Synthetic architecture interrupts\n");
+    }
+    fprintf(f, " ERR:          0\n MIS:          0\n");
+    return fclose(f) == 0 ? 0 : 1;
+}
+
+static int gen_irq192(const char *root, const char *meminfo) {
+    static const char *const soft[] = { "HI", "TIMER", "NET_TX", "NET_RX", "BLOCK",
+                                        "IRQ_POLL", "TASKLET", "SCHED", "HRTIMER", "RCU" };
+    const int n = IRQ192_CPUS;
+    unsigned long long seed = 55555;
+    if (write_interrupts192(root, 0) != 0) return 1;
+
+    FILE *f = create(root, "proc/softirqs");
+    if (!f) return 1;
+    fprintf(f, "%*s", 20, "");
+    for (int c = 0; c < n; ++c) fprintf(f, "CPU%-8d", c);
+    fputc('\n', f);
+    for (size_t i = 0; i < sizeof(soft) / sizeof(soft[0]); ++i) {
+        fprintf(f, "%12s:", soft[i]);
+        for (int c = 0; c < n; ++c) {
+            seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+            fprintf(f, " %10llu", seed >> 34);
+        }
+        fputc('\n', f);
+    }
+    if (fclose(f) != 0) return 1;
+
+    f = create(root, "proc/stat");
+    if (!f) return 1;
+    fprintf(f, "cpu  1 0 1 100 0 0 0 0 0 0\ncpu0 1 0 1 100 0 0 0 0 0 0\nctxt 1\nprocesses 1\n"
+               "procs_running 1\nprocs_blocked 0\n");
+    if (fclose(f) != 0) return 1;
+    f = create(root, "proc/cpuinfo");
+    if (!f) return 1;
+    fprintf(f, "processor\t: 0\nmodel name\t: Synthetic 192-core irq\n");
+    fclose(f);
+    return copy_file(meminfo, root, "proc/meminfo");
+}
+
+// Con las lecturas cortas de seq_file: una muestra, todos los contadores +1
+// y otra. El total tiene que contar todas las filas y el núcleo caliente
+// tiene que venir de la última IRQ, varias páginas después del principio.
+static int verify_irq192(const char *dir) {
+    IrqSampler *s = irq_sampler_create();
+    IrqStats st;
+    int rc = (s && irq_sampler_sample(s, &st) == 0 && write_interrupts192(dir, 1) == 0 &&
+              irq_sampler_sample(s, &st) == 0) ? 0 : 1;
+    irq_sampler_destroy(s);
+    write_interrupts192(dir, 0);
+    if (rc != 0) return check(0, "irq: no se pudo muestrear /proc/interrupts");
+    char what[96];
+    unsigned long long want = (unsigned long long)IRQ192_ROWS * IRQ192_CPUS + IRQ192_HOT_BUMP;
+    unsigned long long got = (unsigned long long)(st.irq_ps * st.interval_s + 0.5);
+    snprintf(what, sizeof(what), "irq: %llu eventos de %d filas x %d núcleos", got, IRQ192_ROWS, IRQ192_CPUS);
+    rc |= check(st.ready && got == want, what);
+    snprintf(what, sizeof(what), "irq: núcleo caliente %d por %s", st.nhot ? st.hot[0].cpu : -1,
+             st.nhot && st.hot[0].nsrc ? st.hot[0].src[0].name : "-");
+    rc |= check(st.nhot && st.hot[0].cpu == IRQ192_HOT_CPU && st.hot[0].nsrc &&
+                strcmp(st.hot[0].src[0].name, "nvme0q-7") == 0, what);
+    return rc;
+}
+
+// /proc mínimo (stat de 1 core, cpuinfo y meminfo) para los fixtures que
+// solo prueban otra tabla
+static int write_min_proc(const char *root, const char *model, const char *meminfo) {
+    FILE *f = create(root, "proc/stat");
+    if (!f) return 1;
+    fprintf(f, "cpu  1 0 1 100 0 0 0 0 0 0\ncpu0 1 0 1 100 0 0 0 0 0 0\nctxt 1\nprocesses 1\n"
+               "procs_running 1\nprocs_blocked 0\n");
+    if (fclose(f) != 0) return 1;
+    f = create(root, "proc/cpuinfo");
+    if (!f) return 1;
+    fprintf(f, "processor\t: 0\nmodel name\t: %s\n", model);
+    fclose(f);
+    return copy_file(meminfo, root, "proc/meminfo");
+}
+
+// Dispositivos de bloque de un host con snaps: 150 loop al principio de
+// /proc/diskstats y después 40 discos NVMe con 4 particiones cada uno
+// (~35 KiB). Con 'bump' cada contador sube en 1, salvo los sectores leídos
+// del último disco (fuera de dev[]), que suben en 1000.
+#define BLK_LOOPS 150
+#define BLK_DISKS 40
+static int write_diskstats(const char *root, int bump) {
+    FILE *f = create(root, "proc/diskstats");
+    if (!f) return 1;
+    const unsigned long long b = (unsigned long long)bump;
+    for (int i = 0; i < BLK_LOOPS; ++i)
+        fprintf(f, "   7 %7d loop%d %llu 0 %llu 12 0 0 0 0 0 16 12 0 0 0 0 0 0\n", i, i, 90 + b, 2000 + b);
+    for (int d = 0; d < BLK_DISKS; ++d) {
+        const unsigned long long bs = (d == BLK_DISKS - 1) ? 1000 * b : b;
+        for (int part = 0; part <= 4; ++part) {
+            char name[32];
+            if (part) snprintf(name, sizeof(name), "nvme%dn1p%d", d, part);
+            else snprintf(name, sizeof(name), "nvme%dn1", d);
+            fprintf(f, " 259 %7d %s %llu 11 %llu 345 %llu 22 %llu 678 0 %llu %llu 0 0 0 0 9 10\n",
+                    d * 5 + part, name, 1000 + b, 80000 + bs, 2000 + b, 160000 + b, 900 + b, 1200 + b);
+        }
+    }
+    return fclose(f) == 0 ? 0 : 1;
+}
+
+static int gen_blockdevs(const char *root, const char *meminfo) {
+    if (write_diskstats(root, 0) != 0) return 1;
+    for (int d = 0; d < BLK_DISKS; ++d) {
+        char rel[64];
+        snprintf(rel, sizeof(rel), "sys/block/nvme%dn1/dev", d);
+        FILE *f = create(root, rel);
+        if (!f) return 1;
+        fprintf(f, "259:%d\n", d * 5);
+        fclose(f);
+    }
+    return write_min_proc(root, "Synthetic block devices", meminfo);
+}
+
+// Con las lecturas cortas de seq_file: dos muestras con los contadores
+// movidos. Tienen que aparecer los 40 discos (ninguno sin seguimiento por
+// los loop) y con delta, y los totales tienen que incluir a los omitidos.
+static int verify_blockdevs(const char *dir) {
+    DiskSampler *s = disk_sampler_create();
+    DiskStats st;
+    memset(&st, 0, sizeof(st));
+    int rc = (s && disk_sampler_sample(s, &st) == 0 && write_diskstats(dir, 1) == 0 &&
+              disk_sampler_sample(s, &st) == 0) ? 0 : 1;
+    disk_sampler_destroy(s);
+    write_diskstats(dir, 0);
+    if (rc != 0) return check(0, "disk: no se pudo muestrear /proc/diskstats");
+    char what[96];
+    snprintf(what, sizeof(what), "disk: %d discos de %d tras %d loop, %d sin seguimiento",
+             st.count + st.omitted, BLK_DISKS, BLK_LOOPS, st.untracked);
+    rc |= check(st.count + st.omitted == BLK_DISKS && st.untracked == 0, what);
+    rc |= check(st.ready && st.count > 0 && st.dev[0].ready && st.dev[0].r_iops > 0.0,
+                "disk: tasas con delta en la segunda muestra");
+    if (st.count > 0 && st.dev[0].r_bps > 0.0) {
+        // Todos leen lo mismo salvo el último, que lee 1000 veces más
+        double iops = st.total_r_iops / (BLK_DISKS * st.dev[0].r_iops);
+        double bps  = st.total_r_bps / ((BLK_DISKS - 1 + 1000) * st.dev[0].r_bps);
+        snprintf(what, sizeof(what), "disk: totales de los %d discos (iops x%.3f, bytes x%.3f)",
+                 BLK_DISKS, iops, bps);
+        rc |= check(iops > 0.999 && iops < 1.001 && bps > 0.999 && bps < 1.001 && st.max_util > 0.0, what);
+    }
+    return rc;
+}
+
+// Un host de contenedores: /proc/net/dev con lo, 300 veth (~40 KiB) y al
+// final el enlace físico. Con 'bump' cada contador sube en 1000 (en eth0,
+// 1000 veces más).
+#define NET_VETHS 300
+static int write_netdev(const char *root, int bump) {
+    FILE *f = create(root, "proc/net/dev");
+    if (!f) return 1;
+    const unsigned long long b = 1000ULL * (unsigned long long)bump;
+    fprintf(f, "Inter-|   Receive                                                |  Transmit\n"
+               " face |bytes    packets errs drop fifo frame compressed multicast|bytes    packets errs drop fifo colls carrier compressed\n"
+               "    lo: 123456 789 0 0 0 0 0 0 123456 789 0 0 0 0 0 0\n");
+    for (int i = 0; i < NET_VETHS; ++i)
+        fprintf(f, "veth%07x: %llu %llu 0 0 0 0 0 0 %llu %llu 0 0 0 0 0 0\n",
+                0x1a2b3c0u + (unsigned)i, 5000000ULL + b, 4000ULL + b, 7000000ULL + b, 5000ULL + b);
+    fprintf(f, "  eth0: %llu %llu 0 0 0 0 0 0 %llu %llu 0 0 0 0 0 0\n",
+            900000000ULL + 1000 * b, 800000ULL + b, 600000000ULL + 1000 * b, 700000ULL + b);
+    return fclose(f) == 0 ? 0 : 1;
+}
+
+static int gen_netdevs(const char *root, const char *meminfo) {
+    if (write_netdev(root, 0) != 0) return 1;
+    return write_min_proc(root, "Synthetic container host", meminfo);
+}
+
+// Con las lecturas cortas de seq_file: todas las interfaces tienen que
+// contarse (en ifs[] o en 'omitted'), con seguimiento y delta, y eth0 (la de
+// más tráfico, la última del archivo) tiene que estar en ifs[].
+static int verify_netdevs(const char *dir) {
+    NetSampler *s = net_sampler_create();
+    NetStats st;
+    memset(&st, 0, sizeof(st));
+    int rc = (s && net_sampler_sample(s, &st) == 0 && write_netdev(dir, 1) == 0 &&
+              net_sampler_sample(s, &st) == 0) ? 0 : 1;
+    net_sampler_destroy(s);
+    write_netdev(dir, 0);
+    if (rc != 0) return check(0, "net: no se pudo muestrear /proc/net/dev");
+    char what[96];
+    snprintf(what, sizeof(what), "net: %d interfaces de %d, %d sin seguimiento",
+             st.count + st.omitted, NET_VETHS + 1, st.untracked);
+    rc |= check(st.count + st.omitted == NET_VETHS + 1 && st.untracked == 0, what);
+    rc |= check(st.ready && st.count > 0 && st.ifs[0].ready && st.ifs[0].rx_bps > 0.0,
+                "net: tasas con delta en la segunda muestra");
+    int up = -1;
+    for (int i = 0; i < st.count; ++i) if (strcmp(st.ifs[i].name, "eth0") == 0) up = i;
+    rc |= check(up >= 0 && st.ifs[up].rx_bps > st.ifs[0].rx_bps, "net: el enlace con más tráfico entra en ifs[]");
+    if (up > 0) {
+        // Todas las veth reciben lo mismo y eth0 1000 veces más
+        double rx = st.total_rx_bps / ((NET_VETHS + 1000) * st.ifs[0].rx_bps);
+        snprintf(what, sizeof(what), "net: totales de las %d interfaces (rx x%.3f)", NET_VETHS + 1, rx);
+        rc |= check(rx > 0.999 && rx < 1.001 && st.total_rx_pps > NET_VETHS * st.ifs[0].rx_pps, what);
+    }
+    return rc;
+}
+
+// Un host con muchos montajes (contenedores, snaps): /proc/self/mountinfo
+// de ~60 KiB con cgroup2 en el montaje híbrido al final. Sin 'cgroup2' la
+// línea no se escribe, como si mountinfo se hubiera leído a medias.
+#define MNT_LINES 400
+static int write_mountinfo(const char *root, int cgroup2) {
+    FILE *f = create(root, "proc/self/mountinfo");
+    if (!f) return 1;
+    for (int i = 0; i < MNT_LINES; ++i)
+        fprintf(f, "%d 28 0:%d / /var/lib/containers/storage/overlay/%064x/merged rw,relatime shared:%d - "
+                   "overlay overlay rw,lowerdir=/l/%d,upperdir=/u/%d,workdir=/w/%d\n",
+                100 + i, 60 + i, (unsigned)i, 200 + i, i, i, i);
+    fprintf(f, "30 24 0:26 / /sys/fs/cgroup ro,nosuid,nodev,noexec shared:9 - tmpfs tmpfs ro,mode=755\n"
+               "31 30 0:27 / /sys/fs/cgroup/memory rw,nosuid,nodev,noexec,relatime shared:10 - cgroup cgroup rw,memory\n");
+    if (cgroup2)
+        fprintf(f, "32 30 0:28 / /sys/fs/cgroup/unified rw,nosuid,nodev,noexec,relatime shared:11 - "
+                   "cgroup2 cgroup2 rw,nsdelegate\n");
+    return fclose(f) == 0 ? 0 : 1;
+}
+
+static int write_text(const char *root, const char *rel, const char *text) {
+    FILE *f = create(root, rel);
+    if (!f) return 1;
+    fputs(text, f);
+    return fclose(f) == 0 ? 0 : 1;
+}
+
+#define MNT_CGROUP "sys/fs/cgroup/unified/test.slice/"
+static int gen_mountinfo(const char *root, const char *meminfo) {
+    if (write_mountinfo(root, 1) != 0 ||
+        write_text(root, "proc/self/cgroup", "4:memory:/test.slice\n0::/test.slice\n") != 0 ||
+        write_text(root, "sys/fs/cgroup/memory/memory.usage_in_bytes", "0\n") != 0 ||
+        write_text(root, "sys/fs/cgroup/unified/cgroup.controllers", "memory pids\n") != 0 ||
+        write_text(root, MNT_CGROUP "cgroup.controllers", "memory pids\n") != 0 ||
+        write_text(root, MNT_CGROUP "memory.current", "4194304\n") != 0 ||
+        write_text(root, MNT_CGROUP "cpu.stat", "usage_usec 1000\nuser_usec 600\nsystem_usec 400\n") != 0)
+        return 1;
+    return write_min_proc(root, "Synthetic hybrid cgroup host", meminfo);
+}
+
+// Elige el cgroup propio y lee memory.current de la jerarquía híbrida.
+static int mountinfo_case(const char *what) {
+    CgroupStats st;
+    int ok = cgroup_set_target("self") == 0;
+    CgroupSampler *s = ok ? cgroup_sampler_create() : NULL;
+    ok = s && cgroup_sampler_sample(s, &st) == 0 && st.mem_current_kib == 4096 &&
+         strcmp(st.path, "/test.slice") == 0;
+    cgroup_sampler_destroy(s);
+    return check(ok, what);
+}
+
+// Con las lecturas cortas de seq_file la línea de cgroup2 queda en la
+// página 15; sin ella, se cae al montaje estándar.
+static int verify_mountinfo(const char *dir) {
+    int rc = mountinfo_case("cgroup: montaje híbrido al final de mountinfo largo");
+    if (write_mountinfo(dir, 0) != 0) return check(0, "cgroup: no se pudo reescribir mountinfo");
+    rc |= mountinfo_case("cgroup: sin cgroup2 en mountinfo, /sys/fs/cgroup/unified");
+    write_mountinfo(dir, 1);
+    return rc;
+}
+
+// Listas de CPUs de sysfs corruptas o con rangos enormes: el parser tiene
+// que acotarlas sin recorrer 2^32 ids ni reservar para ellos.
+static int gen_bad_cpulist(const char *root, const char *meminfo) {
+    if (write_text(root, "sys/devices/system/cpu/possible", "0-4294967295\n") != 0 ||
+        write_text(root, "sys/devices/system/cpu/online", "0-3,7-4294967295\n") != 0)
+        return 1;
+    if (write_min_proc(root, "Synthetic bad cpu lists", meminfo) != 0) return 1;
+    // Un id absurdo en /proc/stat tampoco debe reservar un slot por id
+    return write_text(root, "proc/stat", "cpu  2 0 2 200 0 0 0 0 0 0\ncpu0 1 0 1 100 0 0 0 0 0 0\n"
+                                         "cpu999999 1 0 1 100 0 0 0 0 0 0\nctxt 1\nprocesses 1\n"
+                                         "procs_running 1\nprocs_blocked 0\n");
+}
+
+static int verify_bad_cpulist(const char *dir) {
+    (void)dir;
+    struct timespec t0, t1;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    int possible = cpu_possible_count();
+    CPUUsage u;
+    cpu_usage_init(&u);
+    int rc = cpu_read_usage(&u);
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    double ms = (double)(t1.tv_sec - t0.tv_sec) * 1e3 + (double)(t1.tv_nsec - t0.tv_nsec) / 1e6;
+    char what[96];
+    snprintf(what, sizeof(what), "cpu: listas e ids enormes acotados (%d posibles, %d slots, %.1f ms)",
+             possible, u.cores, ms);
+    int ok = check(rc == 0 && possible > 0 && possible <= 8192 && u.cores <= 8192 && u.cap <= 8192 && ms < 100.0, what);
+    cpu_usage_free(&u);
+    return ok;
+}
+
+// Un servidor x86 con intel_pstate: una policy de cpufreq por núcleo, más
+// de las que caben en la muestra. La policy N va a 1000 + N MHz.
+#define FREQ_POLICIES 300
+static int gen_cpufreq(const char *root, const char *meminfo) {
+    static const char *const names[] = {
+        "scaling_cur_freq", "scaling_min_freq", "scaling_max_freq", "cpuinfo_max_freq", "related_cpus"
+    };
+    for (int i = 0; i < FREQ_POLICIES; ++i) {
+        char val[5][32];
+        snprintf(val[0], sizeof(val[0]), "%d\n", (1000 + i) * 1000);
+        snprintf(val[1], sizeof(val[1]), "800000\n");
+        snprintf(val[2], sizeof(val[2]), "3000000\n");
+        snprintf(val[3], sizeof(val[3]), "3000000\n");
+        snprintf(val[4], sizeof(val[4]), "%d\n", i);
+        for (int k = 0; k < 5; ++k) {
+            char rel[96];
+            snprintf(rel, sizeof(rel), "sys/devices/system/cpu/cpufreq/policy%d/%s", i, names[k]);
+            if (write_text(root, rel, val[k]) != 0) return 1;
+        }
+    }
+    return write_min_proc(root, "Synthetic per-core cpufreq", meminfo);
+}
+
+// Todas las policies que caben se leen (también las de núcleos >= 64) y las
+// demás se cuentan.
+static int verify_cpufreq(const char *dir) {
+    (void)dir;
+    static ThermalStats st;
+    ThermalSampler *s = thermal_sampler_create();
+    int rc = (s && thermal_sampler_sample(s, &st) == 0) ? 0 : 1;
+    thermal_sampler_destroy(s);
+    if (rc != 0) return check(0, "thermal: no se pudieron leer las policies");
+    const FreqPolicy *fp = thermal_core_policy(&st, 200);
+    char what[96];
+    snprintf(what, sizeof(what), "thermal: %d policies de %d, %d omitidas, núcleo 200 a %ld kHz",
+             st.npolicies, FREQ_POLICIES, st.omitted_policies, fp ? fp->cur_khz : 0L);
+    return check(st.npolicies == FREQ_POLICY_MAX && st.npolicies + st.omitted_policies == FREQ_POLICIES &&
+                 fp && fp->cur_khz == 1200000, what);
+}
+
+static void rm_tree(const char *path) {
+    DIR *d = opendir(path);
+    if (!d) { unlink(path); return; }
+    struct dirent *e;
+    while ((e = readdir(d)) != NULL) {
+        if (strcmp(e->d_name, ".") == 0 || strcmp(e->d_name, "..") == 0) continue;
+        char sub[1024];
+        snprintf(sub, sizeof(sub), "%s/%s", path, e->d_name);
+        rm_tree(sub);
+    }
+    closedir(d);
+    rmdir(path);
+}
+
+// ---------- Comprobaciones de procfile ----------
+static int check(int ok, const char *what) {
+    printf("  %-60s %s\n", what, ok ? "OK" : "FALLO");
+    return ok ? 0 : 1;
+}
+
+// Lee 'path' entero con read() hasta 0: la referencia contra la que se
+// compara procfile. Devuelve la longitud o -1.
+static long read_all(const char *path, char *buf, size_t cap) {
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return -1;
+    size_t len = 0;
+    ssize_t n;
+    while (len < cap && (n = read(fd, buf + len, cap - len)) > 0) len += (size_t)n;
+    close(fd);
+    return (long)len;
+}
+
+// Un archivo de 40 KiB leído con cortes de seq_file, dos veces: la segunda
+// con el buffer ya agrandado, que es cuando una lectura corta deja sitio
+// libre y parece el final.
+static int check_seq_file(const char *tmp) {
+    char path[512], what[96];
+    snprintf(path, sizeof(path), "%s/seq-file", tmp);
+    FILE *f = fopen(path, "w");
+    if (!f) return check(0, "procfile: no se pudo crear el archivo de prueba");
+    for (int i = 0; i < 800; ++i) fprintf(f, "%5d: 12345 67890 línea de prueba de seq_file (%04d)\n", i, i);
+    fclose(f);
+
+    static char ref[64 * 1024];
+    long want = read_all(path, ref, sizeof(ref));
+    ProcFile pf = PROCFILE_INIT;
+    int rc = 0;
+    g_seq_reads = 1;
+    if (want <= 0 || procfile_open(&pf, path, 4096) != 0) {
+        rc = check(0, "procfile: no se pudo abrir el archivo de prueba");
+    } else {
+        for (int pass = 1; pass <= 2; ++pass) {
+            snprintf(what, sizeof(what), "procfile: %ld B en lecturas de <= %d B (lectura %d)", want, SEQ_PAGE, pass);
+            rc |= check(procfile_read(&pf) == 0 && (long)pf.len == want && memcmp(pf.buf, ref, (size_t)want) == 0,
+                        what);
+        }
+    }
+    g_seq_reads = 0;
+    procfile_close(&pf);
+    unlink(path);
+    return rc;
+}
+
+static long count_lines(const char *buf, size_t len) {
+    long n = 0;
+    for (size_t i = 0; i < len; ++i) n += buf[i] == '\n';
+    return n;
+}
+
+// Un seq_file real de varias páginas: /proc/<pid>/smaps de un hijo dormido
+// (sus mapeos no cambian mientras se lee; los del propio proceso sí). Los
+// contadores sí pueden moverse (copy-on-write con el padre), pero sus campos
+// tienen ancho fijo: se comparan longitud y número de líneas.
+static int check_real_proc(void) {
+    pid_t pid = fork();
+    if (pid < 0) return check(0, "procfile: fork");
+    if (pid == 0) { for (;;) pause(); }
+    char path[64], what[96];
+    snprintf(path, sizeof(path), "/proc/%ld/smaps", (long)pid);
+    static char ref[1024 * 1024];
+    long want = read_all(path, ref, sizeof(ref));
+    int rc = 0;
+    ProcFile pf = PROCFILE_INIT;
+    if (want <= 2 * SEQ_PAGE || procfile_open(&pf, path, 4096) != 0) {
+        printf("  %-60s omitida\n", "procfile: /proc/<pid>/smaps de varias páginas");
+    } else {
+        for (int pass = 1; pass <= 2; ++pass) {
+            snprintf(what, sizeof(what), "procfile: %s, %ld B (lectura %d)", "/proc/<pid>/smaps", want, pass);
+            rc |= check(procfile_read(&pf) == 0 && (long)pf.len == want &&
+                        count_lines(pf.buf, pf.len) == count_lines(ref, (size_t)want), what);
+        }
+    }
+    procfile_close(&pf);
+    kill(pid, SIGKILL);
+    waitpid(pid, NULL, 0);
+    return rc;
+}
+
+// Una ruta que no cabe traducida bajo la raíz no puede caer a la del
+// anfitrión: "/proc/./././…/meminfo" existe en /proc, no en 'tmp'.
+static int check_root_overflow(const char *tmp) {
+    char path[1200] = "/proc";
+    while (strlen(path) + 16 < sizeof(path)) strcat(path, "/.");
+    strcat(path, "/meminfo");
+    if (procfs_set_root(tmp, NULL) != 0) return check(0, "procfs: no se pudo fijar la raíz");
+    char real[512];
+    ProcFile pf = PROCFILE_INIT;
+    int rc = check(procfs_path(path, real, sizeof(real)) == NULL && errno == ENAMETOOLONG,
+                   "procfs: ruta demasiado larga bajo la raíz → NULL");
+    rc |= check(procfile_open(&pf, path, 4096) != 0, "procfs: procfile_open no cae a la ruta del anfitrión");
+    procfile_close(&pf);
+    procfs_set_root("", NULL);
+    return rc;
+}
+
+static int run_in_child(const char *name, const char *dir, double min_s, VerifyFn verify) {
+    fflush(stdout);
+    pid_t pid = fork();
+    if (pid < 0) return 1;
+    if (pid == 0) _exit(run_fixture(name, dir, min_s, verify));
+    int st = 0;
+    if (waitpid(pid, &st, 0) < 0) return 1;
+    return (WIFEXITED(st) && WEXITSTATUS(st) == 0) ? 0 : 1;
+}
+
+int main(int argc, char **argv) {
+    const char *fixtures = argc > 1 ? argv[1] : "bench/fixtures";
+    double min_s = argc > 2 ? atof(argv[2]) / 1000.0 : 0.2;
+    if (min_s <= 0.0) min_s = 0.2;
+
+    printf("Benchmark de parsers (mínimo %.0f ms por función)\n", min_s * 1000.0);
+    int rc = 0;
+
+    char tmpl[] = "/tmp/rpi-sysinfo-bench.XXXXXX";
+    char *tmp = mkdtemp(tmpl);
+    if (!tmp) { perror("mkdtemp"); return 1; }
+    printf("\n[comprobaciones]\n");
+    rc |= check_seq_file(tmp);
+    rc |= check_real_proc();
+    rc |= check_root_overflow(tmp);
+
+    // Snapshots grabados: un subdirectorio por fixture
+    DIR *d = opendir(fixtures);
+    if (!d) {
+        fprintf(stderr, "No se pudo abrir '%s': %s\n", fixtures, strerror(errno));
+        rm_tree(tmp);
+        return 1;
+    }
+    struct dirent *e;
+    char meminfo[600] = "";
+    while ((e = readdir(d)) != NULL) {
+        if (e->d_name[0] == '.') continue;
+        char dir[512];
+        snprintf(dir, sizeof(dir), "%s/%s", fixtures, e->d_name);
+        struct stat st;
+        if (stat(dir, &st) != 0 || !S_ISDIR(st.st_mode)) continue;
+        if (!meminfo[0]) snprintf(meminfo, sizeof(meminfo), "%s/proc/meminfo", dir);
+        rc |= run_in_child(e->d_name, dir, min_s, NULL);
+    }
+    closedir(d);
+    if (!meminfo[0]) {
+        fprintf(stderr, "No hay fixtures en '%s'.\n", fixtures);
+        rm_tree(tmp);
+        return 1;
+    }
+
+    // Sintéticos
+    char dir[512];
+    snprintf(dir, sizeof(dir), "%s/stat256", tmp);
+    if (gen_stat256(dir, meminfo) == 0) rc |= run_in_child("synthetic-256-cores", dir, min_s, NULL);
+    else rc = 1;
+    snprintf(dir, sizeof(dir), "%s/cpuinfo-huge", tmp);
+    if (gen_cpuinfo_huge(dir, meminfo) == 0) rc |= run_in_child("synthetic-huge-cpuinfo", dir, min_s, NULL);
+    else rc = 1;
+    snprintf(dir, sizeof(dir), "%s/procs5000", tmp);
+    if (gen_procs5000(dir, meminfo) == 0) rc |= run_in_child("synthetic-5000-procs", dir, min_s, verify_procs5000);
+    else rc = 1;
+    snprintf(dir, sizeof(dir), "%s/irq192", tmp);
+    if (gen_irq192(dir, meminfo) == 0) rc |= run_in_child("synthetic-192-irq", dir, min_s, verify_irq192);
+    else rc = 1;
+    snprintf(dir, sizeof(dir), "%s/netdevs", tmp);
+    if (gen_netdevs(dir, meminfo) == 0) rc |= run_in_child("synthetic-300-veth", dir, min_s, verify_netdevs);
+    else rc = 1;
+    snprintf(dir, sizeof(dir), "%s/blockdevs", tmp);
+    if (gen_blockdevs(dir, meminfo) == 0) rc |= run_in_child("synthetic-block-devs", dir, min_s, verify_blockdevs);
+    else rc = 1;
+    snprintf(dir, sizeof(dir), "%s/bad-cpulist", tmp);
+    if (gen_bad_cpulist(dir, meminfo) == 0) rc |= run_in_child("synthetic-bad-cpulist", dir, min_s, verify_bad_cpulist);
+    else rc = 1;
+    snprintf(dir, sizeof(dir), "%s/cpufreq", tmp);
+    if (gen_cpufreq(dir, meminfo) == 0) rc |= run_in_child("synthetic-cpufreq-per-core", dir, min_s, verify_cpufreq);
+    else rc = 1;
+    snprintf(dir, sizeof(dir), "%s/mountinfo", tmp);
+    if (gen_mountinfo(dir, meminfo) == 0) rc |= run_in_child("synthetic-long-mountinfo", dir, min_s, verify_mountinfo);
+    else rc = 1;
+    rm_tree(tmp);
+
+    if (rc) fprintf(stderr, "\nAlguna comprobación falló o alguna función falló sobre un fixture.\n");
+    return rc;
+}
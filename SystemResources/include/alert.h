@@ -0,0 +1,60 @@
+#ifndef ALERT_H
+#define ALERT_H
+
+#include "sampler.h"
+#include <stddef.h>
+
+// Motor de alertas (--alerts FILE): reglas de umbral sobre las métricas de
+// cada Snapshot, con histéresis, tiempo mínimo sostenido y acciones
+// limitadas en frecuencia. Corre como hook del hilo de muestreo, así que
+// evalúa todas las muestras igual con la TUI que con --batch.
+//
+// Archivo de reglas, una por línea ('#' comenta hasta el final):
+//
+//   log /var/log/rpi-alerts.log          # directiva: registro de eventos
+//   cpu.core[*] > 0.95 for 10s clear 0.80 every 5m exec logger -t rpi "$1 $2 $3"
+//   mem.used_ratio > 0.9
+//   temp.max >= 80 for 30s clear 75
+//
+//   regla := MÉTRICA[ [N] | [*] ] OP UMBRAL [for DUR] [clear VALOR] [every DUR] [exec COMANDO…]
+//   OP    := > | >= | < | <=          DUR := N[ms|s|m|h] (sin sufijo: s)
+//
+// 'for': la condición debe sostenerse ese tiempo antes de disparar. 'clear':
+// la alerta se resuelve al cruzar ese valor (por defecto, el umbral); es la
+// banda de histéresis. [*] crea un estado por instancia (core, zona, disco,
+// interfaz), que sigue a su etiqueta aunque cambie su posición. Cada
+// transición (DISPARA / RESUELTA) va al registro de eventos, si lo hay; los
+// disparos además lanzan 'exec' con /bin/sh -c, como mucho uno por regla
+// cada 'every' (por defecto 60 s), con $1 = regla, $2 = instancia,
+// $3 = valor, $4 = disparos suprimidos desde el anterior.
+
+#define ALERT_MAX_RULES     64
+#define ALERT_MAX_CHILDREN  8      // comandos de 'exec' vivos a la vez
+#define ALERT_NAME_MAX      96     // "disk.util[nvme0n1] > 0.9": métrica, etiqueta y condición
+#define ALERT_EVERY_DEFAULT 60.0   // s entre dos 'exec' de la misma regla
+
+typedef struct AlertEngine AlertEngine;
+
+// Lee y compila 'path' para una máquina de 'cores' cores posibles (el
+// estado por instancia se reserva aquí) y abre el registro de eventos.
+// NULL si falla; 'err' (puede ser NULL) recibe "archivo:línea: motivo".
+AlertEngine *alert_load(const char *path, int cores, char *err, size_t errlen);
+
+// Evalúa todas las reglas sobre una muestra. Pensado para el hilo de
+// muestreo: no reserva memoria y 'exec' no espera al comando.
+void alert_eval(AlertEngine *a, const Snapshot *snap);
+
+// Hook listo para sampler_start() (arg = el AlertEngine).
+void alert_hook(const Snapshot *snap, void *arg);
+
+// Instancias disparadas ahora mismo y, si hay, el nombre de la última en
+// disparar ("cpu.core[3] > 0.95"). Seguro desde otro hilo (la UI).
+int  alert_firing(AlertEngine *a, char *last, size_t len);
+
+// Reglas compiladas
+int  alert_rule_count(const AlertEngine *a);
+
+// Cierra el registro y recoge los comandos que aún sigan vivos (sin esperarlos).
+void alert_free(AlertEngine *a);
+
+#endif // ALERT_H
@@ -0,0 +1,56 @@
+#ifndef CANVAS_H
+#define CANVAS_H
+
+#include <ncursesw/ncurses.h>
+#include <wchar.h>
+
+// Renderizador con seguimiento de daños sobre una ventana ncurses.
+// Cada frame se compone en memoria (canvas_clear + canvas_text/fill/put) y
+// canvas_flush() compara contra el frame anterior y emite SOLO los tramos que
+// cambiaron, con una llamada mvwaddnwstr/mvwhline por tramo. Así el coste por
+// frame y los bytes enviados a la terminal no crecen con el nº de cores cuando
+// los valores no cambian.
+
+// Estilo de celda: par de color (0 = por defecto) + negrita.
+#define CV_STYLE(pair, bold) ((unsigned short)(((unsigned)(pair) & 0xFFu) | ((bold) ? 0x100u : 0u)))
+#define CV_PLAIN 0
+
+typedef struct {
+    wchar_t        ch;
+    unsigned short style;
+} CvCell;
+
+typedef struct {
+    WINDOW *win;
+    int     y0, x0;        // primera celda dibujable (coordenadas de la ventana)
+    int     rows, cols;    // tamaño del área dibujable
+    CvCell *cur;           // frame en composición
+    CvCell *prev;          // último frame enviado a ncurses
+    wchar_t *run;          // scratch para armar cada tramo (cols + 1)
+    int     prev_valid;    // 0 = el próximo flush repinta todo
+} Canvas;
+
+// Las coordenadas de todas las funciones son las de la ventana: lo que cae
+// fuera de [y0, y0+rows) x [x0, x0+cols) se recorta (p. ej. el borde de box()).
+int  canvas_init(Canvas *cv, WINDOW *win, int y0, int x0, int rows, int cols);
+void canvas_free(Canvas *cv);
+
+// Fuerza que el próximo flush repinte el área completa.
+void canvas_invalidate(Canvas *cv);
+
+// Empieza un frame nuevo en blanco (solo memoria, no toca la terminal).
+void canvas_clear(Canvas *cv);
+
+// Escribe texto UTF-8; devuelve la columna siguiente al último carácter.
+int  canvas_text(Canvas *cv, int y, int x, unsigned short style, const char *utf8);
+int  canvas_printf(Canvas *cv, int y, int x, unsigned short style, const char *fmt, ...)
+     __attribute__((format(printf, 5, 6)));
+
+void canvas_fill(Canvas *cv, int y, int x, int n, wchar_t ch, unsigned short style);
+void canvas_put(Canvas *cv, int y, int x, wchar_t ch, unsigned short style);
+
+// Emite las diferencias a la ventana (sin wnoutrefresh). Devuelve el nº de
+// celdas reescritas en este frame.
+int  canvas_flush(Canvas *cv);
+
+#endif // CANVAS_H
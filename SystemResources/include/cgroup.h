@@ -0,0 +1,87 @@
+#ifndef CGROUP_H
+#define CGROUP_H
+
+#include "memory.h"
+#include <stddef.h>
+
+// Modo cgroup v2: consumo y límites de un cgroup (el propio, p. ej. dentro de
+// un contenedor o un slice de systemd, o uno elegido) en vez de los de toda la
+// máquina, más sus cgroups hijos directos ordenados por consumo.
+
+#define CGROUP_PATH_MAX   128   // ruta dentro de la jerarquía ("/system.slice/foo.service")
+#define CGROUP_NAME_MAX    48   // nombre de un hijo (se recorta si es más largo)
+#define CGROUP_CHILD_MAX    8   // hijos por muestra (los demás cuentan en 'omitted_children')
+
+typedef struct {
+    char   name[CGROUP_NAME_MAX];
+    int    ready;              // 0 = recién aparecido (aún sin delta de CPU)
+    long   mem_kib;            // memory.current (0 si el controlador no está activo)
+    double cpu;                // núcleos usados en el intervalo (usage_usec)
+} CgroupChild;
+
+// Sin punteros: se copia entera con la Snapshot. Memoria en KiB.
+typedef struct {
+    int    ready;              // 0 = primera muestra (aún sin delta)
+    double interval_s;         // tiempo medido desde la muestra anterior
+    char   path[CGROUP_PATH_MAX];
+
+    long   mem_current_kib;    // memory.current
+    long   mem_max_kib;        // memory.max (0 = sin límite)
+    long   mem_high_kib;       // memory.high: a partir de aquí el kernel frena (0 = sin límite)
+    long   swap_current_kib;   // memory.swap.current
+    long   swap_max_kib;       // memory.swap.max (0 = sin límite)
+    // Desglose de memory.stat
+    long   anon_kib, file_kib, shmem_kib, kernel_kib, slab_kib, sreclaimable_kib;
+    long   kernel_stack_kib, pagetables_kib, inactive_file_kib;
+    long   file_mapped_kib, file_dirty_kib, file_writeback_kib;
+
+    unsigned long long usage_usec;      // cpu.stat (acumulados)
+    unsigned long long throttled_usec;
+    unsigned long long nr_periods, nr_throttled;
+    double cpu;                // núcleos usados en el intervalo
+    double cpu_user, cpu_system;
+    double cpu_quota;          // cpu.max en núcleos (quota / period); 0 = sin límite
+    double throttled_ratio;    // periodos frenados / periodos del intervalo [0..1]
+    double throttled_ms_ps;    // ms frenados por segundo
+
+    int         nchildren;     // hijos válidos en child[] (más consumo primero)
+    int         omitted_children;
+    CgroupChild child[CGROUP_CHILD_MAX];
+} CgroupStats;
+
+// Elige el cgroup a vigilar: "self" (o "auto") para el del propio proceso
+// según /proc/self/cgroup, o una ruta de la jerarquía ("/system.slice/x")
+// o absoluta bajo /sys/fs/cgroup. El montaje de cgroup2 se toma de
+// /proc/self/mountinfo; si ahí no está el cgroup se prueban
+// /sys/fs/cgroup y /sys/fs/cgroup/unified. Llamar antes de arrancar el
+// muestreo y después de procfs_set_root. Devuelve 0 si OK, 1 argumentos inválidos,
+// 2 si no existe o no es un cgroup v2.
+int cgroup_set_target(const char *spec);
+
+// 1 si se eligió un cgroup con cgroup_set_target.
+int cgroup_mode_enabled(void);
+
+// Reescribe 'm' con la vista del cgroup: total = memory.max (si es menor que
+// la RAM), usada = memory.current − inactive_file (el "working set" que usan
+// docker y kubelet) y el desglose de memory.stat. La swap, igual con
+// memory.swap.*. Hugepages y commit quedan los de la máquina.
+void cgroup_apply_mem(const CgroupStats *cg, MemStats *m);
+
+// Sampler con handles persistentes a memory.current/max/high/stat,
+// memory.swap.*, cpu.stat y cpu.max del cgroup y a memory.current y cpu.stat
+// de cada hijo. La lista de hijos se rehace cada pocas muestras; entre medio
+// solo se releen los archivos ya abiertos. Una instancia no debe usarse
+// desde dos hilos a la vez.
+typedef struct CgroupSampler CgroupSampler;
+
+// Devuelve NULL si no hay memoria o no se eligió cgroup.
+CgroupSampler *cgroup_sampler_create(void);
+
+// Toma una muestra; la primera deja out->ready = 0.
+// Devuelve 0 si OK, 1 argumentos inválidos, 2 error de lectura (p. ej. el
+// cgroup desapareció).
+int cgroup_sampler_sample(CgroupSampler *s, CgroupStats *out);
+
+void cgroup_sampler_destroy(CgroupSampler *s);
+
+#endif // CGROUP_H
@@ -3,8 +3,6 @@
 
 #include <stddef.h>
 
-#define CPU_MAX_CORES 64  // suficiente para RPi y de sobra
-
 typedef struct {
     char model[128];      // "ARMv7 Processor rev 4 (v7l)" o similar
     char hardware[64];    // "BCM2835" / "BCM2837" (SoC)
@@ -13,17 +11,81 @@ typedef struct {
     int  cores_online;    // núcleos activos
 } CPUInfo;
 
+// Estado de cada slot de CPU en CPUUsage.state[]
+enum {
+    CPU_CORE_OFFLINE = 0,   // apagado (hotplug) o id sin CPU
+    CPU_CORE_ONLINE  = 1,   // en línea y con delta válido
+    CPU_CORE_PENDING = 2    // en línea pero recién aparecido: aún sin delta
+};
+
+// Fracción [0..1] del intervalo en cada estado de /proc/stat (suman ~1).
+// guest/guest_nice ya vienen incluidos en user/nice.
+typedef struct {
+    double user, nice, system, idle, iowait, irq, softirq, steal;
+} CPUTimes;
+
+// Actividad global del kernel (resto de /proc/stat, misma lectura).
+// Las tasas son por segundo de reloj monotónico entre dos muestras.
+typedef struct {
+    unsigned long long ctxt;    // cambios de contexto acumulados
+    unsigned long long intr;    // interrupciones acumuladas (todas las fuentes)
+    unsigned long long forks;   // procesos/hilos creados desde el arranque ("processes")
+    double ctxt_per_s;
+    double intr_per_s;
+    double forks_per_s;
+    int    procs_running;       // tareas ejecutables (cola de ejecución)
+    int    procs_blocked;       // tareas bloqueadas en E/S
+} CPUKernelStats;
+
+// Arreglos dinámicos indexados por id real de CPU ("cpuN" → per_core[N]),
+// así un core apagado no desplaza a los siguientes. Inicializar con
+// cpu_usage_init() y liberar con cpu_usage_free(); el sampler los agranda
+// solo cuando aparece un id nuevo.
 typedef struct {
-    int    cores;                     // núcleos medidos
-    double per_core[CPU_MAX_CORES];   // uso [0..1] por core
-    double avg;                       // promedio [0..1]
-    int    ready;                     // 0 = primera muestra (aún sin delta), 1 = listo
+    int            cores;         // slots válidos = id de CPU más alto + 1
+    int            cap;           // capacidad reservada
+    double        *per_core;      // uso [0..1] por id de CPU
+    unsigned char *state;         // CPU_CORE_* por id de CPU
+    CPUTimes      *times;         // desglose por estado, por id de CPU
+    CPUTimes       total;         // desglose agregado (línea "cpu " de /proc/stat)
+    CPUKernelStats kstat;         // ctxt, intr, forks, procs_running/blocked
+    double         interval_s;    // tiempo medido desde la muestra anterior (0 en la primera)
+    int            online_count;  // cores con delta válido (los que entran al promedio)
+    double         avg;           // promedio [0..1] de los cores en línea
+    int            ready;         // 0 = primera muestra (aún sin delta), 1 = listo
 } CPUUsage;
 
+void cpu_usage_init(CPUUsage *u);
+// Garantiza capacidad para 'cores' slots. Devuelve 0 si OK, 3 sin memoria.
+int  cpu_usage_reserve(CPUUsage *u, int cores);
+void cpu_usage_free(CPUUsage *u);
+
+// Máximo de CPUs que pueden llegar a estar en línea (/sys/.../cpu/possible o
+// _SC_NPROCESSORS_CONF, el mayor). Sirve para preasignar por core. Nunca < 1.
+int cpu_possible_count(void);
+
 // --- Actividad 3 y 4 ---
 int cpu_read_info(CPUInfo *out);
 
 // --- Actividad 5 (usa deltas de /proc/stat internamente, listo para llamar cada 2 s) ---
+// Sampler reentrante: cada instancia guarda su propio estado de deltas y su
+// handle a /proc/stat, así un proceso puede tener varios a distintos intervalos.
+// Una instancia no debe usarse desde dos hilos a la vez.
+typedef struct CPUSampler CPUSampler;
+
+// Devuelve NULL si no hay memoria o no se puede abrir /proc/stat.
+CPUSampler *cpu_sampler_create(void);
+
+// Toma una muestra; la primera llamada deja out->ready = 0 (aún sin delta).
+// El estado en línea se toma de /sys/devices/system/cpu/online; un core que
+// vuelve tras un hotplug queda CPU_CORE_PENDING hasta la siguiente muestra.
+// 'out' debe estar inicializado con cpu_usage_init().
+// Devuelve 0 si OK, 1 argumentos inválidos, 2 error de lectura, 3 formato inesperado o sin memoria.
+int cpu_sampler_sample(CPUSampler *s, CPUUsage *out);
+
+void cpu_sampler_destroy(CPUSampler *s);
+
+// Envoltorio sobre una instancia por defecto (API original).
 int cpu_read_usage(CPUUsage *out);
 
 #endif // CPU_H
@@ -0,0 +1,59 @@
+#ifndef DISK_H
+#define DISK_H
+
+#include <stddef.h>
+
+// Actividad de E/S por dispositivo de bloque a partir de /proc/diskstats.
+// Solo se reportan discos completos (los que tienen /sys/block/<nombre>):
+// particiones, loop y ram se descartan.
+
+#define DISK_MAX       8    // dispositivos por muestra (los demás cuentan en 'omitted')
+#define DISK_NAME_MAX 32
+
+typedef struct {
+    char     name[DISK_NAME_MAX];
+    int      ready;        // 0 = recién aparecido (aún sin delta)
+    double   r_iops;       // lecturas completadas / s
+    double   w_iops;       // escrituras completadas / s
+    double   r_bps;        // bytes leídos / s
+    double   w_bps;        // bytes escritos / s
+    double   r_await_ms;   // tiempo medio por lectura (cola + servicio)
+    double   w_await_ms;   // tiempo medio por escritura
+    double   svc_ms;       // tiempo de servicio medio: ms ocupado / operación
+    double   util;         // fracción del intervalo con E/S en curso [0..1]
+    double   queue;        // profundidad media de la cola (aqu-sz de iostat)
+    unsigned in_flight;    // operaciones en curso al muestrear
+} DiskDev;
+
+// Sin punteros: se copia entera con la Snapshot.
+typedef struct {
+    int     ready;         // 0 = primera muestra (aún sin delta)
+    double  interval_s;    // tiempo medido desde la muestra anterior
+    int     count;         // dispositivos válidos en dev[] (orden de /proc/diskstats)
+    int     omitted;       // discos que no cupieron en dev[]
+    int     untracked;     // discos sin seguimiento (sin memoria para su entrada)
+    // Agregado de todos los discos con delta, también los que no caben en dev[]
+    double  total_r_iops, total_w_iops;
+    double  total_r_bps, total_w_bps;
+    double  total_queue;
+    double  max_util;      // util del disco más ocupado
+    DiskDev dev[DISK_MAX];
+} DiskStats;
+
+// Sampler con handle persistente a /proc/diskstats y los contadores de la
+// muestra anterior de cada dispositivo visto. Tras las primeras muestras no
+// reserva memoria (salvo que aparezcan dispositivos nuevos).
+// Una instancia no debe usarse desde dos hilos a la vez.
+typedef struct DiskSampler DiskSampler;
+
+// Devuelve NULL si no hay memoria o no existe /proc/diskstats.
+DiskSampler *disk_sampler_create(void);
+
+// Toma una muestra; la primera deja out->ready = 0. Los contadores de 32 bits
+// (kernels de 32 bits) que dan la vuelta se corrigen.
+// Devuelve 0 si OK, 1 argumentos inválidos, 2 error de lectura.
+int disk_sampler_sample(DiskSampler *s, DiskStats *out);
+
+void disk_sampler_destroy(DiskSampler *s);
+
+#endif // DISK_H
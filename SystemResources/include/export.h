@@ -0,0 +1,48 @@
+#ifndef EXPORT_H
+#define EXPORT_H
+
+#include "sampler.h"
+#include <stddef.h>
+
+// Exportación sin TUI (modo --batch): una línea por muestra en JSON Lines o
+// CSV. Cada línea se arma en un buffer preasignado con formateadores propios
+// (sin printf) y se emite con UN write(); en régimen estable no reserva memoria.
+// El mismo buffer sirve para el texto de Prometheus de --listen, que solo
+// se formatea (exporter_format) y lo envía el servidor HTTP.
+
+typedef enum {
+    EXPORT_JSONL = 0,
+    EXPORT_CSV   = 1,
+    EXPORT_PROM  = 2      // formato de exposición de Prometheus (solo exporter_format)
+} ExportFormat;
+
+typedef struct {
+    ExportFormat fmt;
+    int    fd;            // destino (no se cierra en exporter_free)
+    int    cores;         // columnas/elementos por core, fijos para todo el flujo
+    const CPUInfo *info;  // EXPORT_PROM: etiquetas de rpi_cpu_info (NULL = sin ellas)
+    char  *buf;
+    size_t cap;
+    size_t len;
+    int    overflow;      // la línea en curso no cupo (no debería ocurrir)
+} Exporter;
+
+// "jsonl"/"json" o "csv". Devuelve 0 si OK, 1 si no se reconoce.
+int export_parse_format(const char *s, ExportFormat *out);
+
+// Reserva el buffer para 'cores' cores. En CSV escribe la cabecera. Con
+// fd = -1 solo se puede usar exporter_format().
+// Devuelve 0 si OK, 1 argumentos inválidos, 2 error de escritura, 3 sin memoria.
+int  exporter_init(Exporter *e, ExportFormat fmt, int fd, int cores);
+
+// Formatea 'snap' y lo escribe con una sola llamada (reintenta escrituras
+// parciales). Devuelve 0 si OK, 2 error de escritura (p. ej. EPIPE).
+int  exporter_write(Exporter *e, const Snapshot *snap);
+
+// Solo formatea 'snap' en e->buf (e->len bytes), sin escribir nada.
+// Devuelve 0 si OK, 1 argumentos inválidos o si no cupo (no debería ocurrir).
+int  exporter_format(Exporter *e, const Snapshot *snap);
+
+void exporter_free(Exporter *e);
+
+#endif // EXPORT_H
@@ -0,0 +1,76 @@
+#ifndef HISTORY_H
+#define HISTORY_H
+
+#include "sampler.h"
+#include <pthread.h>
+#include <stddef.h>
+
+// Historial en memoria de las últimas N muestras de cada métrica.
+// Struct-of-arrays: cada serie es un arreglo contiguo de 'cap' floats usado
+// como anillo, así dibujar una sparkline recorre memoria secuencial. Todo se
+// reserva de una vez en history_init(); después history_push() no reserva
+// nada, y el consumo total es history_bytes(cap, cores), conocido al arrancar.
+//
+// En vivo lo alimenta el hilo de muestreo (history_hook, así no se pierde
+// ninguna muestra aunque la UI vaya atrasada) y la UI solo lo lee, entre
+// history_lock() y history_unlock().
+
+// Series escalares (una por métrica global)
+typedef enum {
+    HIST_MEM_USED = 0,    // RAM usada [0..1]
+    HIST_SWAP_USED,       // SWAP usada [0..1] (0 si no hay swap)
+    HIST_CPU_AVG,         // promedio de los cores en línea [0..1]
+    HIST_RUNQ,            // procs_running por core en línea
+    HIST_CTXT_PER_S,
+    HIST_INTR_PER_S,
+    HIST_SERIES_COUNT
+} HistSeries;
+
+typedef struct {
+    int    cap;           // muestras por serie (fija desde history_init)
+    int    cores;         // series por core (fija; ids >= cores se ignoran)
+    int    head;          // posición donde irá la próxima muestra
+    int    count;         // muestras válidas (<= cap)
+    unsigned long long last_seq;   // última Snapshot añadida (evita duplicados)
+    float *series;        // [HIST_SERIES_COUNT][cap]
+    float *core;          // [cores][cap] uso por id de CPU
+    pthread_mutex_t lock; // entre history_hook y quien lee (la UI)
+} History;
+
+// Bytes que ocupará un historial de 'cap' muestras y 'cores' cores.
+size_t history_bytes(int cap, int cores);
+
+// Reserva todo el historial (una sola allocación). Devuelve 0 si OK,
+// 1 argumentos inválidos, 3 sin memoria.
+int  history_init(History *h, int cap, int cores);
+void history_free(History *h);
+
+// Vacía el historial sin liberar nada (p. ej. al saltar en una reproducción).
+void history_clear(History *h);
+
+// Añade una muestra; si ya se añadió (mismo seq) no hace nada.
+// Los valores que no existen en la muestra (primer ciclo, core apagado,
+// error de lectura) se guardan como NAN y se dibujan como hueco.
+// Devuelve 1 si se añadió, 0 si no.
+int  history_push(History *h, const Snapshot *snap);
+
+// Hook para sampler_start() (arg = el History): history_push bajo el candado.
+void history_hook(const Snapshot *snap, void *arg);
+
+// Candado para leer el historial mientras el hilo de muestreo lo alimenta.
+void history_lock(History *h);
+void history_unlock(History *h);
+
+// Anillo de una serie (índice físico; usar history_at para recorrerlo)
+const float *history_series(const History *h, HistSeries s);
+// Anillo de un core, o NULL si el id está fuera del historial
+const float *history_core(const History *h, int core);
+
+// Valor 'age' muestras atrás (0 = la más reciente) de un anillo del historial.
+static inline float history_at(const History *h, const float *ring, int age) {
+    int i = h->head - 1 - age;
+    if (i < 0) i += h->cap;
+    return ring[i];
+}
+
+#endif // HISTORY_H
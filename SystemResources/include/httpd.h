@@ -0,0 +1,36 @@
+#ifndef HTTPD_H
+#define HTTPD_H
+
+#include "sampler.h"
+#include "cpu.h"
+#include <stddef.h>
+
+// Servidor HTTP mínimo (--listen) que expone la última muestra en el formato
+// de texto de Prometheus en GET /metrics, para scrapear cada placa sin otro
+// agente que vuelva a leer /proc.
+//
+// Vive en su propio hilo con un bucle epoll no bloqueante, independiente de
+// ncurses. El texto lo formatea el hilo de muestreo (hook) en uno de dos
+// buffers preasignados y cada petición lo copia al buffer de respuesta de su
+// conexión, también preasignado: servir no reserva memoria ni lee /proc.
+//
+// Direcciones: "9101" (127.0.0.1:9101), "HOST:PUERTO" ("[::1]:9101" para
+// IPv6) o "unix:/ruta/al/socket".
+
+#define HTTPD_MAX_CONN     8      // conexiones simultáneas (las demás esperan en el backlog)
+#define HTTPD_REQ_MAX      2048   // cabeceras de una petición
+#define HTTPD_IDLE_MS      5000   // se cierra la conexión que no completa su petición
+
+typedef struct Httpd Httpd;
+
+// Abre el socket y arranca el hilo. 'info' debe seguir vivo hasta
+// httpd_stop(). NULL si falla; 'err' (puede ser NULL) recibe el motivo.
+Httpd *httpd_start(const char *addr, const CPUInfo *info, int cores, char *err, size_t errlen);
+
+// Hook para sampler_start() (arg = el Httpd): formatea la muestra.
+void httpd_hook(const Snapshot *snap, void *arg);
+
+// Detiene el hilo, cierra todo (y borra el socket Unix) y libera.
+void httpd_stop(Httpd *h);
+
+#endif // HTTPD_H
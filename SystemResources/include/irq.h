@@ -0,0 +1,55 @@
+#ifndef IRQ_H
+#define IRQ_H
+
+#include <stddef.h>
+
+// Interrupciones y softirqs por núcleo a partir de /proc/interrupts y
+// /proc/softirqs: qué núcleos atienden más y qué fuentes los cargan (la
+// causa típica de un core al 100 % en una máquina de red es la afinidad de
+// las IRQ de la NIC).
+
+#define IRQ_HOT_MAX    4    // núcleos calientes por muestra
+#define IRQ_SRC_MAX    3    // fuentes por núcleo caliente
+#define IRQ_NAME_MAX  24    // "eth0-rx-0", "LOC", "NET_RX" (se recorta si es más largo)
+
+typedef struct {
+    char   name[IRQ_NAME_MAX];   // dispositivo (IRQ numerada), etiqueta (LOC, IPI0) o softirq
+    int    softirq;              // 1 = fila de /proc/softirqs
+    double rate;                 // eventos / s en este núcleo
+} IrqSource;
+
+typedef struct {
+    int       cpu;               // id del núcleo
+    double    irq_ps;            // interrupciones / s (todas las filas de /proc/interrupts)
+    double    softirq_ps;        // softirqs / s
+    int       nsrc;
+    IrqSource src[IRQ_SRC_MAX];  // más eventos primero
+} IrqHotCore;
+
+// Sin punteros: se copia entera con la Snapshot.
+typedef struct {
+    int        ready;            // 0 = primera muestra (aún sin delta)
+    double     interval_s;       // tiempo medido desde la muestra anterior
+    int        ncpus;            // columnas (núcleos en línea) de las tablas
+    double     irq_ps;           // totales de la máquina
+    double     softirq_ps;
+    int        nhot;             // núcleos válidos en hot[] (más carga primero)
+    IrqHotCore hot[IRQ_HOT_MAX];
+} IrqStats;
+
+// Sampler con handles persistentes a ambas tablas y los contadores de la
+// muestra anterior por fila y núcleo. Tras las primeras muestras no reserva
+// memoria (salvo que aparezcan IRQ o núcleos nuevos). Una instancia no debe
+// usarse desde dos hilos a la vez.
+typedef struct IrqSampler IrqSampler;
+
+// Devuelve NULL si no hay memoria o no existe /proc/interrupts.
+IrqSampler *irq_sampler_create(void);
+
+// Toma una muestra; la primera deja out->ready = 0.
+// Devuelve 0 si OK, 1 argumentos inválidos, 2 error de lectura, 3 sin memoria.
+int irq_sampler_sample(IrqSampler *s, IrqStats *out);
+
+void irq_sampler_destroy(IrqSampler *s);
+
+#endif // IRQ_H
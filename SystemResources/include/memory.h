@@ -15,6 +15,29 @@ typedef struct {
 
     double used_ratio;       // RAM usada / total   (0..1)
     double swap_used_ratio;  // Swap usada / total  (0..1)
+
+    // Desglose de /proc/meminfo (KiB; 0 si el kernel no lo reporta)
+    long free_kib;         // MemFree: sin usar en absoluto
+    long buffers_kib;      // Buffers: metadatos de dispositivos de bloque
+    long cached_kib;       // Cached: page cache (incluye Shmem)
+    long swap_cached_kib;  // SwapCached
+    long dirty_kib;        // Dirty: páginas pendientes de escribir a disco
+    long writeback_kib;    // Writeback: escribiéndose ahora mismo
+    long anon_kib;         // AnonPages: memoria de procesos (heap/stack)
+    long mapped_kib;       // Mapped: archivos mapeados con mmap
+    long shmem_kib;        // Shmem: tmpfs + memoria compartida
+    long slab_kib;         // Slab: cachés del kernel (= SReclaimable + SUnreclaim)
+    long sreclaimable_kib; // SReclaimable: parte del slab que se puede liberar
+    long kernel_stack_kib; // KernelStack
+    long page_tables_kib;  // PageTables
+    long commit_limit_kib; // CommitLimit
+    long committed_kib;    // Committed_AS: memoria prometida a los procesos
+
+    long huge_total;       // HugePages_Total (páginas)
+    long huge_free;        // HugePages_Free
+    long huge_rsvd;        // HugePages_Rsvd
+    long huge_surp;        // HugePages_Surp
+    long huge_page_kib;    // Hugepagesize
 } MemStats;
 
 // Actividad 1 (ya existente): memoria instalada
@@ -23,8 +46,11 @@ int mem_total_kib(long *out_kib);
 // Utilidad: formatear KiB -> "X.Y GiB/MiB/KiB"
 void format_bytes_from_kib(long kib, char *buf, size_t buflen);
 
-// Actividad 2: leer RAM/SWAP usadas y totales.
+// Actividad 2: leer RAM/SWAP usadas y totales, más el desglose de meminfo.
+// Un solo recorrido del archivo; cada clave se resuelve con un hash perfecto.
 // Devuelve 0 si OK. No falla si no hay swap (deja swap_total_kib=0).
+// Usa un handle persistente a /proc/meminfo: llamar siempre desde el mismo hilo
+// (en la app, el hilo de muestreo).
 int mem_read_stats(MemStats *out);
 
 #endif // MEMORY_H
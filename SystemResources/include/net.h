@@ -0,0 +1,58 @@
+#ifndef NET_H
+#define NET_H
+
+#include <stddef.h>
+
+// Tráfico por interfaz de red a partir de /proc/net/dev ("lo" se omite).
+
+#define NET_MAX       8    // interfaces por muestra (las demás cuentan en 'omitted')
+#define NET_NAME_MAX 16    // IFNAMSIZ
+
+typedef struct {
+    char   name[NET_NAME_MAX];
+    int    ready;          // 0 = recién aparecida (aún sin delta)
+    int    speed_mbps;     // velocidad del enlace (sysfs); 0 si no se conoce (wifi, virtual)
+    double rx_bps;         // bytes recibidos / s
+    double tx_bps;         // bytes enviados / s
+    double rx_pps;         // paquetes / s
+    double tx_pps;
+    double rx_errs_ps;     // errores / s
+    double tx_errs_ps;
+    double rx_drop_ps;     // descartes / s
+    double tx_drop_ps;
+    unsigned long long rx_errs, tx_errs;   // acumulados desde el arranque
+    unsigned long long rx_drop, tx_drop;
+} NetIf;
+
+// Sin punteros: se copia entera con la Snapshot.
+typedef struct {
+    int    ready;          // 0 = primera muestra (aún sin delta)
+    double interval_s;     // tiempo medido desde la muestra anterior
+    int    count;          // interfaces válidas en ifs[]: las de más tráfico, en el orden de /proc/net/dev
+    int    omitted;        // interfaces que no cupieron en ifs[]
+    int    untracked;      // interfaces sin seguimiento (sin memoria para su entrada)
+    // Sumas de todas las interfaces con delta, también las que no caben en ifs[]
+    double total_rx_bps, total_tx_bps;
+    double total_rx_pps, total_tx_pps;
+    double total_errs_ps;  // rx + tx
+    double total_drop_ps;
+    NetIf  ifs[NET_MAX];
+} NetStats;
+
+// Sampler con handle persistente a /proc/net/dev y los contadores de la
+// muestra anterior de cada interfaz vista. Tras las primeras muestras no
+// reserva memoria (salvo que aparezcan interfaces nuevas).
+// Una instancia no debe usarse desde dos hilos a la vez.
+typedef struct NetSampler NetSampler;
+
+// Devuelve NULL si no hay memoria o no existe /proc/net/dev.
+NetSampler *net_sampler_create(void);
+
+// Toma una muestra; la primera deja out->ready = 0. Los contadores de 32 bits
+// que dan la vuelta se corrigen.
+// Devuelve 0 si OK, 1 argumentos inválidos, 2 error de lectura.
+int net_sampler_sample(NetSampler *s, NetStats *out);
+
+void net_sampler_destroy(NetSampler *s);
+
+#endif // NET_H
@@ -0,0 +1,83 @@
+#ifndef PROCFILE_H
+#define PROCFILE_H
+
+#include <stddef.h>
+
+// Handle persistente a un archivo de /proc o /sys.
+// Se abre UNA vez y en cada muestra se relee con pread(fd, buf, …, 0) sobre un
+// buffer preasignado: sin fopen/fclose ni buffers de stdio por refresco.
+typedef struct {
+    int    fd;      // -1 = cerrado
+    char  *buf;     // contenido de la última lectura, terminado en '\0'
+    size_t cap;     // capacidad del buffer (incluye el '\0')
+    size_t len;     // bytes válidos de la última lectura
+} ProcFile;
+
+#define PROCFILE_INIT { -1, NULL, 0, 0 }
+
+// ---------- Raíces de procfs / sysfs ----------
+// Por defecto "/proc" y "/sys". Se pueden redirigir (p. ej. a /host/proc en un
+// contenedor, o a los fixtures de `make bench`); todas las rutas que empiezan
+// por "/proc/" o "/sys/" se traducen al abrirlas. Configurar antes de arrancar
+// el hilo de muestreo: no es seguro cambiarlas con lecturas en curso.
+// NULL deja la raíz como está. Devuelve 0 si OK, 1 si una ruta es demasiado larga.
+int procfs_set_root(const char *proc_root, const char *sys_root);
+
+// Traduce 'path' según las raíces configuradas. Devuelve 'buf', o 'path' tal
+// cual si no hay que traducirlo. Si la ruta traducida no cabe en 'buf'
+// devuelve NULL (errno = ENAMETOOLONG): nunca cae a la ruta del anfitrión.
+const char *procfs_path(const char *path, char *buf, size_t buflen);
+
+// Abre 'path' (traducido con procfs_path) y reserva 'initial_cap' bytes.
+// Devuelve 0 si OK, 2 si no se pudo abrir.
+int procfile_open(ProcFile *pf, const char *path, size_t initial_cap);
+
+// Relee el archivo completo desde el offset 0, con pread() hasta que devuelve
+// 0 (un archivo de varias páginas cuesta una llamada por página más la final).
+// Si no cabe, duplica el buffer (solo ocurre las primeras veces; después la
+// lectura no reserva memoria).
+// Devuelve 0 si OK, 1 si no está abierto, 2 si falla la lectura, 3 sin memoria.
+int procfile_read(ProcFile *pf);
+
+// Cierra el fd y libera el buffer. Deja el handle reutilizable.
+void procfile_close(ProcFile *pf);
+
+// ---------- Tokenizador mínimo (reemplaza sscanf en los parsers) ----------
+// Todas avanzan sobre un buffer terminado en '\0' y nunca lo modifican.
+
+static inline const char *pf_skip_spaces(const char *p) {
+    while (*p == ' ' || *p == '\t') p++;
+    return p;
+}
+
+// Avanza hasta el inicio de la siguiente línea (o hasta el '\0' final).
+static inline const char *pf_next_line(const char *p) {
+    while (*p && *p != '\n') p++;
+    return *p ? p + 1 : p;
+}
+
+// Parsea un entero sin signo en base 10 (saltando espacios previos).
+// Devuelve el puntero tras el último dígito; si no hay dígitos, devuelve 'p'
+// sin tocar *out.
+static inline const char *pf_parse_ull(const char *p, unsigned long long *out) {
+    const char *s = pf_skip_spaces(p);
+    if (*s < '0' || *s > '9') return p;
+    unsigned long long v = 0;
+    while (*s >= '0' && *s <= '9') {
+        v = v * 10ULL + (unsigned long long)(*s - '0');
+        s++;
+    }
+    *out = v;
+    return s;
+}
+
+// Diferencia entre dos lecturas de un contador de /proc. Si retrocede y el
+// valor anterior cabía en 32 bits, asume que dio la vuelta (los "unsigned
+// long" de un kernel de 32 bits); si no, fue un reinicio y devuelve 0.
+static inline unsigned long long pf_counter_delta(unsigned long long cur, unsigned long long prev) {
+    if (cur >= prev) return cur - prev;
+    if (prev <= 0xFFFFFFFFULL) return cur + (0x100000000ULL - prev);
+    return 0;
+}
+
+#endif // PROCFILE_H
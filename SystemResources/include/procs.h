@@ -0,0 +1,56 @@
+#ifndef PROCS_H
+#define PROCS_H
+
+// Procesos que más CPU y memoria (RSS) consumen, a partir de /proc/<pid>/stat.
+
+#define PROC_TOP       10   // procesos por ranking
+#define PROC_COMM_MAX  16   // TASK_COMM_LEN
+
+typedef struct {
+    int    pid;
+    char   comm[PROC_COMM_MAX];
+    char   state;          // R, S, D, Z, …
+    int    threads;
+    double cpu;            // fracción de UN core en el intervalo (como top: 2.0 = dos cores llenos)
+    long   rss_kib;
+} ProcInfo;
+
+// Sin punteros: se copia entera con la Snapshot.
+typedef struct {
+    int      ready;        // 0 = primera muestra (cpu aún sin delta)
+    double   interval_s;   // tiempo medido desde la muestra anterior
+    int      total;        // procesos vistos
+    int      running;      // en estado R
+    int      threads;      // suma de hilos
+    int      uncached;     // procesos leídos sin fd persistente (límite de descriptores)
+    int      n_cpu;        // entradas válidas en by_cpu[] / by_rss[]
+    int      n_rss;
+    ProcInfo by_cpu[PROC_TOP];   // de mayor a menor cpu
+    ProcInfo by_rss[PROC_TOP];   // de mayor a menor rss_kib
+} ProcStats;
+
+// Sampler incremental: una tabla indexada por pid guarda un fd abierto a
+// /proc/<pid>/stat por proceso, que se relee con pread. En cada muestra solo
+// se abre el stat de los pids nuevos y se cierra el de los que terminaron
+// (el conjunto se obtiene con getdents64 sobre /proc). Para mantener un fd por
+// proceso sube el límite blando de descriptores hasta el duro; si aun así no
+// alcanza, esos procesos se abren y cierran en cada muestra.
+// El pread del stat (el kernel lo formatea en cada lectura: unos µs) es casi
+// todo el coste, así que un proceso que no gastó CPU desde su última lectura
+// se relee solo una de cada 4 muestras: hasta entonces conserva sus datos,
+// y un proceso que despierta aparece en el top con hasta 3 muestras de
+// retraso (su CPU se reparte entre todo el tiempo sin leerlo).
+// Una instancia no debe usarse desde dos hilos a la vez.
+typedef struct ProcSampler ProcSampler;
+
+// Devuelve NULL si no hay memoria o no se puede abrir /proc.
+ProcSampler *proc_sampler_create(void);
+
+// Toma una muestra; la primera deja out->ready = 0.
+// Devuelve 0 si OK, 1 argumentos inválidos, 2 error leyendo /proc,
+// 3 sin memoria.
+int proc_sampler_sample(ProcSampler *s, ProcStats *out);
+
+void proc_sampler_destroy(ProcSampler *s);
+
+#endif // PROCS_H
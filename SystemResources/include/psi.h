@@ -0,0 +1,50 @@
+#ifndef PSI_H
+#define PSI_H
+
+// Pressure Stall Information: /proc/pressure/{cpu,memory,io} (kernel >= 4.20
+// con CONFIG_PSI). "some" = al menos una tarea detenida esperando el recurso,
+// "full" = todas las tareas no ociosas detenidas a la vez.
+
+enum { PSI_CPU = 0, PSI_MEMORY, PSI_IO, PSI_COUNT };
+
+typedef struct {
+    double avg10;                 // % del tiempo detenido, media móvil del kernel (10 s)
+    double avg60;
+    double avg300;
+    double stall;                 // fracción del último intervalo detenido [0..1] (delta de total)
+    unsigned long long total_us;  // tiempo detenido acumulado desde el arranque
+} PsiLine;
+
+typedef struct {
+    int     available;            // el archivo existe y se pudo leer
+    int     has_full;             // cpu solo tiene línea "full" desde 5.13
+    PsiLine some;
+    PsiLine full;
+} PsiResource;
+
+// Sin punteros: se copia entera con la Snapshot.
+typedef struct {
+    int         ready;            // 0 = primera muestra ('stall' aún sin delta)
+    double      interval_s;       // tiempo medido desde la muestra anterior
+    PsiResource res[PSI_COUNT];
+} PsiStats;
+
+// Sampler con handles persistentes a los tres archivos. Una instancia no debe
+// usarse desde dos hilos a la vez.
+typedef struct PsiSampler PsiSampler;
+
+// Devuelve NULL si no hay memoria o si no existe ninguno de los archivos
+// (kernel sin PSI o arrancado con psi=0).
+PsiSampler *psi_sampler_create(void);
+
+// Toma una muestra; la primera deja out->ready = 0. Un recurso que no se pudo
+// leer queda con available = 0.
+// Devuelve 0 si OK, 1 argumentos inválidos, 2 si no se pudo leer ninguno.
+int psi_sampler_sample(PsiSampler *s, PsiStats *out);
+
+void psi_sampler_destroy(PsiSampler *s);
+
+// Nombre corto del recurso ("cpu", "memory", "io").
+const char *psi_resource_name(int res);
+
+#endif // PSI_H
@@ -0,0 +1,92 @@
+#ifndef RECORD_H
+#define RECORD_H
+
+#include "sampler.h"
+#include "cpu.h"
+#include <stddef.h>
+#include <stdint.h>
+
+// Grabación binaria compacta de muestras (--record) y reproducción (--replay).
+//
+// Formato (todos los enteros son varints LEB128 sin signo):
+//   cabecera : "RSYSREC" 0x01, versión, cores, interval_ms, keyframe_every,
+//              cores_config, nº de campos extendidos (v2+), y
+//              model/hardware/arch como (largo, bytes)
+//   registro : tipo ('K' keyframe | 'D' delta), largo del payload, payload
+// Cada muestra se aplana en un vector fijo de enteros (ratios cuantizados):
+// campos globales, los de cada core y al final los extendidos. Estos últimos
+// solo crecen, así una grabación vieja se reproduce con los nuevos en 0.
+// Un keyframe guarda los valores absolutos; un delta, la diferencia con la
+// muestra anterior. Ambos van en zigzag y las rachas de ceros se colapsan en
+// un solo token, así un core ocioso cuesta ~0 bytes. Cada 'keyframe_every'
+// muestras va un keyframe: es el punto de entrada para buscar (seek) y limita
+// lo que se pierde si el archivo queda truncado.
+
+#define REC_KEYFRAME_EVERY 100
+
+// ---------- Grabación ----------
+typedef struct Recorder Recorder;
+
+// Crea (o trunca) 'path' y escribe la cabecera. 'cores' fija el nº de cores
+// del flujo (usar cpu_possible_count()). NULL si falla (errno indica por qué).
+Recorder *recorder_open(const char *path, const CPUInfo *info, int cores, int interval_ms);
+
+// Codifica y añade una muestra con un único write(). Tras el primer error de
+// escritura el grabador queda deshabilitado. Devuelve 0 si OK, 2 si falló.
+int  recorder_write(Recorder *r, const Snapshot *snap);
+
+// 1 si alguna escritura falló (el archivo quedó incompleto)
+int  recorder_failed(const Recorder *r);
+
+// Bytes escritos hasta ahora (cabecera incluida)
+unsigned long long recorder_bytes(const Recorder *r);
+
+void recorder_close(Recorder *r);
+
+// ---------- Vector de campos sin codificar ----------
+// El mismo aplanado (y la misma cuantización) que usa la grabación, sin varints
+// ni deltas: tamaño fijo por muestra, para copiarlo a memoria compartida.
+
+// Campos por muestra para 'cores' cores (0 si cores <= 0).
+size_t record_fields(int cores);
+
+// Aplana 'snap' en f[record_fields(cores)].
+void record_pack(const Snapshot *snap, int cores, int64_t *f);
+
+// Reconstruye una Snapshot (inicializada con snapshot_init) desde f.
+// Devuelve 0 si OK, 3 sin memoria para los arreglos por core.
+int  record_unpack(const int64_t *f, int cores, Snapshot *snap);
+
+// ---------- Reproducción ----------
+typedef struct Player Player;
+
+// Mapea 'path' con mmap e indexa sus keyframes. Copia la CPUInfo grabada en
+// 'info' (puede ser NULL). NULL si no se puede abrir o no es una grabación.
+Player *player_open(const char *path, CPUInfo *info);
+
+// Cores por muestra y periodo de muestreo con que se grabó
+int  player_cores(const Player *p);
+int  player_interval_ms(const Player *p);
+
+// Muestra actual (válida tras player_open si hay al menos un registro).
+const Snapshot *player_snapshot(const Player *p);
+
+// Avanza a la siguiente muestra. Devuelve 0 si OK, 1 si se llegó al final.
+int  player_next(Player *p);
+
+// Timestamp (ms desde la época) de la muestra actual / siguiente.
+// player_next_ms devuelve -1 si no hay siguiente.
+long long player_time_ms(const Player *p);
+long long player_next_ms(const Player *p);
+
+// Rango de la grabación en ms desde la época.
+long long player_first_ms(const Player *p);
+long long player_last_ms(const Player *p);
+
+// Se posiciona en la última muestra con ts <= 'ms' (o la primera si 'ms' es
+// anterior): salta al keyframe previo y decodifica hacia adelante.
+void player_seek_ms(Player *p, long long ms);
+
+void player_close(Player *p);
+
+#endif // RECORD_H
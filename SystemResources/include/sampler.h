@@ -0,0 +1,79 @@
+#ifndef SAMPLER_H
+#define SAMPLER_H
+
+#include "memory.h"
+#include "cpu.h"
+#include "disk.h"
+#include "net.h"
+#include "psi.h"
+#include "procs.h"
+#include "thermal.h"
+#include "cgroup.h"
+#include "irq.h"
+#include <time.h>
+
+// Una muestra completa e inmutable una vez publicada.
+typedef struct {
+    unsigned long long seq;   // nº de muestra (1 = primera)
+    struct timespec    ts;    // CLOCK_REALTIME al tomarla
+    MemStats mem;
+    int      mem_rc;          // código de mem_read_stats (0 = OK)
+    CPUUsage cpu;
+    int      cpu_rc;          // código de cpu_sampler_sample (0 = OK)
+    DiskStats disk;
+    int      disk_rc;         // código de disk_sampler_sample (2 = sin /proc/diskstats)
+    NetStats net;
+    int      net_rc;          // código de net_sampler_sample (2 = sin /proc/net/dev)
+    PsiStats psi;
+    int      psi_rc;          // código de psi_sampler_sample (2 = kernel sin PSI)
+    ProcStats procs;
+    int      procs_rc;        // código de proc_sampler_sample (2 = /proc ilegible)
+    ThermalStats thermal;
+    int      thermal_rc;      // código de thermal_sampler_sample (2 = sin cpufreq ni zonas)
+    CgroupStats cgroup;       // en modo cgroup, 'mem' ya trae la vista del cgroup
+    int      cgroup_rc;       // código de cgroup_sampler_sample (2 = sin modo cgroup)
+    IrqStats irq;
+    int      irq_rc;          // código de irq_sampler_sample (2 = sin /proc/interrupts)
+} Snapshot;
+
+void snapshot_init(Snapshot *snap);
+void snapshot_free(Snapshot *snap);
+
+// Hilo de muestreo dedicado. Publica cada Snapshot en un triple buffer sin
+// locks (un escritor, un lector): el lector siempre obtiene la muestra completa
+// más reciente y nunca bloquea al escritor, ni al revés.
+typedef struct Sampler Sampler;
+
+// Consumidor que debe ver TODAS las muestras (p. ej. --record), no solo la
+// última. Se invoca en el hilo de muestreo justo después de tomar cada
+// muestra y antes de publicarla, así que debe ser rápido y no tocar ncurses.
+typedef void (*SamplerHookFn)(const Snapshot *snap, void *arg);
+typedef struct {
+    SamplerHookFn fn;
+    void         *arg;
+} SamplerHook;
+
+#define SAMPLER_MAX_HOOKS 6
+
+// Arranca el hilo; la primera muestra se toma de inmediato y las siguientes
+// cada 'interval_ms' sobre deadlines absolutos de un timerfd (sin deriva).
+// 'hooks' (hasta SAMPLER_MAX_HOOKS, puede ser NULL) se copian.
+// NULL si falla.
+Sampler *sampler_start(int interval_ms, const SamplerHook *hooks, int nhooks);
+
+// Devuelve la muestra más reciente, o NULL si aún no hay ninguna. El puntero
+// es válido hasta la próxima llamada a sampler_acquire(); solo debe llamarla
+// un hilo (el lector).
+const Snapshot *sampler_acquire(Sampler *s);
+
+// eventfd que se vuelve legible cada vez que se publica una muestra
+// (para multiplexar con poll() junto a la entrada del usuario).
+int sampler_notify_fd(const Sampler *s);
+
+// Consume la notificación pendiente del eventfd (no bloquea).
+void sampler_clear_notify(Sampler *s);
+
+// Detiene el hilo (no espera al siguiente deadline) y libera todo.
+void sampler_stop(Sampler *s);
+
+#endif // SAMPLER_H
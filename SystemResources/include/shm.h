@@ -0,0 +1,67 @@
+#ifndef SHM_H
+#define SHM_H
+
+#include "sampler.h"
+#include "cpu.h"
+#include <stddef.h>
+
+// Publicación de muestras en memoria compartida POSIX (--publish / --view).
+//
+// Un proceso muestrea y escribe cada Snapshot en un anillo de 'slots'
+// muestras dentro de un segmento shm_open(); cualquier número de visores se
+// adjunta en solo lectura y solo dibuja, de modo que N sesiones cuestan una
+// sola pasada por /proc. Como el anillo ya contiene el historial, un visor
+// arranca con las sparklines llenas.
+//
+// Cada ranura guarda el vector de campos de la grabación (record_pack):
+// tamaño fijo y la misma cuantización que --record. Un seqlock protege el
+// anillo: el publicador lo deja impar mientras escribe una ranura y el
+// visor repite la copia si lo ve impar o cambiado; el publicador nunca
+// espera a los visores.
+//
+// Nombres: "rpi" o "/rpi" (el segmento aparece en /dev/shm/rpi).
+
+#define SHM_NAME_MAX   64
+
+typedef struct ShmPublisher ShmPublisher;
+typedef struct ShmViewer    ShmViewer;
+
+// Crea el segmento 'name' (modo 0644) con un anillo de 'slots' muestras.
+// Si ya existe uno cuyo publicador sigue vivo, falla; si su publicador
+// murió, lo reemplaza. 'info' se copia a la cabecera. NULL si falla; 'err'
+// (puede ser NULL) recibe el motivo.
+ShmPublisher *shm_publisher_open(const char *name, const CPUInfo *info, int cores,
+                                 int interval_ms, int slots, char *err, size_t errlen);
+
+// Hook para sampler_start() (arg = el ShmPublisher): copia la muestra a la
+// siguiente ranura. No reserva memoria ni hace llamadas al sistema.
+void shm_publisher_hook(const Snapshot *snap, void *arg);
+
+// Desmapea y borra el segmento (los visores ya adjuntos conservan su mapeo).
+void shm_publisher_close(ShmPublisher *p);
+
+// Se adjunta en solo lectura al segmento 'name'. NULL si falla; 'err'
+// (puede ser NULL) recibe el motivo.
+ShmViewer *shm_viewer_open(const char *name, char *err, size_t errlen);
+
+// Datos de la cabecera
+const CPUInfo *shm_viewer_info(const ShmViewer *v);
+int  shm_viewer_cores(const ShmViewer *v);
+int  shm_viewer_interval_ms(const ShmViewer *v);
+int  shm_viewer_slots(const ShmViewer *v);
+long shm_viewer_pid(const ShmViewer *v);
+
+// Muestras publicadas hasta ahora (la siguiente irá al índice devuelto).
+unsigned long long shm_viewer_count(const ShmViewer *v);
+
+// 1 si el proceso publicador sigue vivo.
+int  shm_viewer_alive(const ShmViewer *v);
+
+// Copia la muestra nº 'idx' (0 = la primera publicada) a 'snap'
+// (inicializada con snapshot_init). Devuelve 0 si OK, 1 si 'idx' ya no
+// está en el anillo (o aún no existe), 3 sin memoria.
+int  shm_viewer_read(ShmViewer *v, unsigned long long idx, Snapshot *snap);
+
+void shm_viewer_close(ShmViewer *v);
+
+#endif // SHM_H
@@ -0,0 +1,102 @@
+#ifndef STATS_H
+#define STATS_H
+
+#include "sampler.h"
+#include <pthread.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Estadísticas en ventana de cada métrica de uso [0..1] (RAM, SWAP, promedio
+// de CPU y cada core): medias móviles exponenciales, mínimo/máximo y
+// percentiles aproximados. Sirven para distinguir carga sostenida de un pico
+// aislado cuando se muestrea rápido (p. ej. -i 100).
+//
+// Memoria constante: todo se reserva en stats_init() y stats_push() cuesta
+// O(1) por métrica. Los percentiles salen de un histograma de STATS_BUCKETS
+// cubetas (1 %) sobre las últimas 'window' muestras; el mínimo y el máximo,
+// de STATS_BLOCKS sub-bloques de la misma ventana (la más vieja sale de golpe
+// al completarse un bloque nuevo).
+//
+// En vivo las alimenta el hilo de muestreo (stats_hook: cada muestra entra
+// en las ventanas aunque la UI no la dibuje) y la UI solo las lee, entre
+// stats_lock() y stats_unlock().
+
+#define STATS_EWMA_COUNT 3        // medias con constante de tiempo de 1, 5 y 15 s
+#define STATS_BUCKETS    100      // cubetas del histograma sobre [0..1]
+#define STATS_BLOCKS     16       // sub-bloques de la ventana para min/max
+#define STATS_WINDOW_S   60       // duración de la ventana de min/max/percentiles
+#define STATS_WINDOW_MIN 16       // muestras por ventana (cotas, según el periodo)
+#define STATS_WINDOW_MAX 4096
+
+typedef enum {
+    STATS_MEM_USED = 0,   // RAM usada
+    STATS_SWAP_USED,      // SWAP usada (0 si no hay swap)
+    STATS_CPU_AVG,        // promedio de los cores en línea
+    STATS_SERIES_COUNT
+} StatsSeries;
+
+// Estado de una métrica (interno; se expone para poder reservarlo de una vez)
+typedef struct {
+    double   ewma[STATS_EWMA_COUNT];
+    double   last_t;                 // instante de la última muestra (s)
+    float    bmin[STATS_BLOCKS];     // min/max de cada sub-bloque
+    float    bmax[STATS_BLOCKS];
+    int      block;                  // sub-bloque en curso
+    int      block_n;                // muestras en el sub-bloque en curso
+    int      nblocks;                // sub-bloques con datos (<= STATS_BLOCKS)
+    int      head;                   // posición del anillo donde va la próxima
+    int      count;                  // muestras en la ventana (<= window)
+    uint16_t hist[STATS_BUCKETS];
+} StatsMetric;
+
+typedef struct {
+    int          window;             // muestras por ventana (fija desde stats_init)
+    int          block_len;          // muestras por sub-bloque
+    int          cores;              // métricas por core (ids >= cores se ignoran)
+    unsigned long long last_seq;     // última Snapshot añadida (evita duplicados)
+    StatsMetric *metric;             // [STATS_SERIES_COUNT + cores]
+    uint8_t     *ring;               // [STATS_SERIES_COUNT + cores][window]: cubeta de cada muestra
+    pthread_mutex_t lock;            // entre stats_hook y quien lee (la UI)
+} Stats;
+
+// Resumen listo para dibujar. count = 0: sin datos (el resto no vale).
+typedef struct {
+    int    count;                    // muestras en la ventana
+    double ewma[STATS_EWMA_COUNT];   // 1, 5 y 15 s (como las 1/5/15 min del loadavg)
+    double min, max;
+    double p50, p95, p99;
+} StatsSummary;
+
+// Muestras por ventana para un periodo de muestreo dado.
+int    stats_window_for(int interval_ms);
+
+// Bytes que ocupará el estado para 'cores' cores con ventanas de 'window'.
+size_t stats_bytes(int window, int cores);
+
+// Reserva todo (una sola allocación). Devuelve 0 si OK, 1 argumentos
+// inválidos, 3 sin memoria.
+int  stats_init(Stats *st, int window, int cores);
+void stats_free(Stats *st);
+
+// Olvida todas las muestras sin liberar nada (p. ej. al saltar en una reproducción).
+void stats_clear(Stats *st);
+
+// Añade una muestra; si ya se añadió (mismo seq) no hace nada. Las métricas
+// sin dato en esta muestra (primer ciclo, core apagado) no se tocan.
+// Devuelve 1 si se añadió, 0 si no.
+int  stats_push(Stats *st, const Snapshot *snap);
+
+// Hook para sampler_start() (arg = el Stats): stats_push bajo el candado.
+void stats_hook(const Snapshot *snap, void *arg);
+
+// Candado para leer las ventanas mientras el hilo de muestreo las alimenta.
+void stats_lock(Stats *st);
+void stats_unlock(Stats *st);
+
+// Resumen de una métrica global o de un core. Recorre el histograma
+// (STATS_BUCKETS) y los sub-bloques: pensado para lo que se dibuja, no para
+// cada muestra. Devuelve 0 si OK, 1 si no existe la métrica.
+int  stats_summary(const Stats *st, StatsSeries s, StatsSummary *out);
+int  stats_core_summary(const Stats *st, int core, StatsSummary *out);
+
+#endif // STATS_H
@@ -0,0 +1,80 @@
+#ifndef THERMAL_H
+#define THERMAL_H
+
+#include <stddef.h>
+
+// Frecuencia de CPU (cpufreq) y temperaturas (/sys/class/thermal).
+// cpufreq agrupa los núcleos en "policies" (todos los de un mismo reloj):
+// en una Pi hay una sola para los 4 núcleos; en big.LITTLE, una por clúster.
+
+#define FREQ_CORE_MAX    256   // núcleos con policy asociada en core_policy[]
+// Policies por muestra (las demás cuentan en 'omitted_policies'): con
+// intel_pstate o acpi-cpufreq cada núcleo tiene la suya
+#define FREQ_POLICY_MAX  FREQ_CORE_MAX
+#define THERMAL_ZONE_MAX   8   // zonas térmicas (las demás cuentan en 'omitted_zones')
+#define THERMAL_TYPE_MAX  24
+
+#define FREQ_NO_POLICY 0xFFFF  // core_policy[i] para núcleos sin cpufreq
+
+typedef struct {
+    int  first_cpu;        // núcleo más bajo de la policy
+    int  ncpus;            // núcleos que comparten este reloj
+    long cur_khz;          // frecuencia actual (scaling_cur_freq)
+    long min_khz;          // límites del governor (scaling_min/max_freq)
+    long max_khz;
+    long hw_max_khz;       // máximo del hardware (cpuinfo_max_freq)
+} FreqPolicy;
+
+typedef struct {
+    char   type[THERMAL_TYPE_MAX];   // "cpu-thermal", "x86_pkg_temp", …
+    double temp_c;
+    double crit_c;         // punto de disparo "critical" (0 si no hay)
+    double passive_c;      // punto "passive": el kernel empieza a bajar el reloj (0 si no hay)
+} ThermalZone;
+
+// Bits de get_throttled del firmware de la Raspberry Pi (vcgencmd get_throttled)
+enum {
+    THROTTLE_UNDERVOLT     = 1 << 0,    // subtensión ahora
+    THROTTLE_FREQ_CAPPED   = 1 << 1,    // frecuencia limitada ahora
+    THROTTLE_THROTTLED     = 1 << 2,    // throttling ahora
+    THROTTLE_SOFT_TEMP     = 1 << 3,    // límite térmico suave ahora
+    THROTTLE_UNDERVOLT_SEEN = 1 << 16,  // ... y desde el arranque
+    THROTTLE_CAPPED_SEEN    = 1 << 17,
+    THROTTLE_THROTTLED_SEEN = 1 << 18,
+    THROTTLE_SOFT_TEMP_SEEN = 1 << 19,
+};
+
+// Sin punteros: se copia entera con la Snapshot.
+typedef struct {
+    int            npolicies;
+    int            omitted_policies;   // policies que no cupieron en policy[]
+    FreqPolicy     policy[FREQ_POLICY_MAX];
+    unsigned short core_policy[FREQ_CORE_MAX];   // índice en policy[] o FREQ_NO_POLICY
+    int            nzones;
+    int            omitted_zones;
+    ThermalZone    zone[THERMAL_ZONE_MAX];
+    int            throttled;  // bits THROTTLE_*; -1 si no hay firmware de RPi
+} ThermalStats;
+
+// Policy del núcleo 'core' o NULL si no tiene cpufreq.
+const FreqPolicy *thermal_core_policy(const ThermalStats *t, int core);
+
+// Temperatura más alta de todas las zonas; 0 si no hay ninguna.
+double thermal_max_temp(const ThermalStats *t);
+
+// Sampler con handles persistentes a scaling_{cur,min,max}_freq de cada
+// policy (reservados según las que lista sysfs) y al 'temp' de cada zona; los
+// valores fijos (cpuinfo_max_freq, tipos, puntos de disparo) se leen una sola
+// vez al crearlo. Una instancia no debe usarse desde dos hilos a la vez.
+typedef struct ThermalSampler ThermalSampler;
+
+// Devuelve NULL si no hay memoria o el sistema no expone ni cpufreq ni zonas
+// térmicas (contenedores, VMs).
+ThermalSampler *thermal_sampler_create(void);
+
+// Devuelve 0 si OK, 1 argumentos inválidos, 2 error de lectura.
+int thermal_sampler_sample(ThermalSampler *s, ThermalStats *out);
+
+void thermal_sampler_destroy(ThermalSampler *s);
+
+#endif // THERMAL_H
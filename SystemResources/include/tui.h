@@ -3,6 +3,16 @@
 
 #include "memory.h"
 #include "cpu.h"
+#include "history.h"
+#include "stats.h"
+#include "disk.h"
+#include "net.h"
+#include "psi.h"
+#include "procs.h"
+#include "thermal.h"
+#include "cgroup.h"
+#include "irq.h"
+#include <time.h>
 
 // Inicializa la TUI (ncurses). Retorna 0 si OK, !=0 si falla.
 int tui_init(void);
@@ -10,6 +20,10 @@ int tui_init(void);
 // Termina la TUI limpiamente.
 void tui_end(void);
 
+// Descarta el estado de daños y reenvía la pantalla completa en el próximo
+// frame (útil si la terminal quedó corrupta, p. ej. en un enlace serie).
+void tui_force_full_redraw(void);
+
 // Dibuja la pantalla con la memoria instalada (texto centrado).
 // 'installed_str' es una cadena preformateada (ej. "0.98 GiB").
 void tui_draw_memory(const char *installed_str);
@@ -17,11 +31,127 @@ void tui_draw_memory(const char *installed_str);
 // pantalla con barras de uso de RAM y SWAP
 void tui_draw_memory_usage(const MemStats *st);
 
-// dashboard completo (act. 1–5 en la misma pantalla)
+// dashboard completo (act. 1–5 en la misma pantalla). Solo compone los
+// lienzos en memoria (lee el historial y las estadísticas); tui_present()
+// los lleva a la terminal.
 void tui_draw_system_dashboard(const MemStats *mem, const CPUInfo *info, const CPUUsage *usage);
+void tui_present(void);
+
+// Periodo de muestreo mostrado en el pie ("Auto-refresh …").
+void tui_set_refresh_interval_ms(int ms);
+
+// Pie alternativo (p. ej. estado de --replay) en lugar de la ayuda de teclas;
+// NULL vuelve al pie normal. Se copia.
+void tui_set_footer(const char *text);
+
+// Hora mostrada en la cabecera: la de la muestra (p. ej. al reproducir una
+// grabación) o, con 0, la hora actual.
+void tui_set_clock(time_t t);
+
+// Estado del motor de alertas en la cabecera: 'rules' = 0 lo oculta; con
+// 'firing' > 0 se muestra en rojo junto a la última en disparar ('last', se copia).
+void tui_set_alerts(int rules, int firing, const char *last);
+
+// Historial para las sparklines junto a cada barra (NULL = sin sparklines).
+// La TUI solo lo lee; el llamador lo mantiene vivo y le añade las muestras
+// antes de dibujar.
+void tui_set_history(const History *h);
+
+// Estadísticas en ventana (NULL = sin ellas). Mismas reglas que el historial.
+// RAM, SWAP y el promedio de CPU las muestran junto a su valor si cabe; los
+// cores, solo con tui_set_core_stats(1) ('e' alterna).
+void tui_set_stats(const Stats *st);
+// Copia los resúmenes que se van a dibujar. Llamarla con stats_lock() tomado
+// (si hay hilo de muestreo) antes de tui_draw_system_dashboard(), que ya no
+// lee el Stats: el candado no cubre el dibujo.
+void tui_take_stats(void);
+void tui_set_core_stats(int on);
+int  tui_get_core_stats(void);
+
+// Discos de la muestra que se va a dibujar (NULL = sin panel de discos, p. ej.
+// sin /proc/diskstats). Igual que el historial: solo se lee al dibujar.
+// El panel pide una fila por disco (hasta 4); si el nº cambia, se rehace el layout.
+void tui_set_disk_stats(const DiskStats *d);
+
+// Interfaces de red de la muestra que se va a dibujar (NULL = sin panel de
+// red). Mismas reglas que tui_set_disk_stats; con terminal ancha ambos
+// paneles comparten franja.
+void tui_set_net_stats(const NetStats *n);
+
+// Presión de la muestra que se va a dibujar (NULL = kernel sin PSI: sin
+// panel). Una fila por recurso legible; va justo debajo de Memoria.
+void tui_set_psi_stats(const PsiStats *p);
+
+// Procesos de la muestra que se va a dibujar (NULL = sin panel). El panel va
+// sobre el de CPU y usa las filas que sobren (de 3 a PROC_TOP).
+void tui_set_proc_stats(const ProcStats *p);
+
+// Frecuencias y temperaturas de la muestra que se va a dibujar (NULL = sin
+// cpufreq ni zonas). No tiene panel propio: se muestran en el de CPU.
+void tui_set_thermal_stats(const ThermalStats *t);
+
+// Cgroup de la muestra que se va a dibujar (NULL = fuera del modo cgroup:
+// sin panel). El panel va debajo de Memoria, con prioridad sobre los demás.
+void tui_set_cgroup_stats(const CgroupStats *c);
+
+// Interrupciones de la muestra que se va a dibujar (NULL = sin panel).
+void tui_set_irq_stats(const IrqStats *s);
+
+// Ranking que muestra el panel de procesos
+typedef enum {
+    TUI_PROC_SORT_CPU = 0,   // % de CPU (de un core, como top)
+    TUI_PROC_SORT_RSS = 1    // memoria residente
+} TuiProcSort;
+
+void tui_set_proc_sort(TuiProcSort sort);
+TuiProcSort tui_get_proc_sort(void);
+
+// Barras por core: uso total (un color por umbral) o desglose apilado
+// user/nice/system/irq/softirq/steal/iowait.
+typedef enum {
+    TUI_CPU_BARS_TOTAL   = 0,
+    TUI_CPU_BARS_STACKED = 1
+} TuiCpuBarMode;
+
+void tui_set_cpu_bar_mode(TuiCpuBarMode mode);
+TuiCpuBarMode tui_get_cpu_bar_mode(void);
+
+// Vista del panel de CPU: una barra por core, o mapa de calor compacto (una
+// celda de 1–2 columnas por core + top-N) para equipos con cientos de cores.
+typedef enum {
+    TUI_CPU_VIEW_BARS    = 0,
+    TUI_CPU_VIEW_HEATMAP = 1
+} TuiCpuView;
+
+void tui_set_cpu_view(TuiCpuView view);
+TuiCpuView tui_get_cpu_view(void);
+
+// Criterio del top-N del mapa de calor
+typedef enum {
+    TUI_HEAT_SORT_TOTAL = 0,   // uso total
+    TUI_HEAT_SORT_KERNEL,      // system + irq + softirq
+    TUI_HEAT_SORT_SOFTIRQ,
+    TUI_HEAT_SORT_STEAL,
+    TUI_HEAT_SORT_IOWAIT,
+    TUI_HEAT_SORT_COUNT
+} TuiHeatSort;
+
+// Pasa al siguiente criterio de orden (cíclico).
+void tui_cycle_heatmap_sort(void);
+
+// Teclas especiales que tui_getch() traduce (así main no depende de ncurses)
+enum {
+    TUI_KEY_LEFT = 0x10000,
+    TUI_KEY_RIGHT,
+    TUI_KEY_PGUP,
+    TUI_KEY_PGDN,
+    TUI_KEY_HOME,
+    TUI_KEY_END
+};
 
 // Lee una tecla (o timeout) desde la TUI.
-// Devuelve un código de tecla, o un valor especial que puedes preguntar con tui_was_timeout().
+// Devuelve un código de tecla (ASCII o TUI_KEY_*), o un valor especial que
+// puedes preguntar con tui_was_timeout().
 int tui_getch(void);
 
 // Devuelve 1 si 'ch' representa que se cumplió el timeout (no se presionó ninguna tecla).
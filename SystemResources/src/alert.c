@@ -0,0 +1,673 @@
+#include "alert.h"
+#include <ctype.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <spawn.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+extern char **environ;
+
+#define ALERT_LINE_MAX  1024   // largo máximo de una línea del archivo de reglas
+#define ALERT_LABEL_MAX 32     // instancia: id de core, tipo de zona, disco, interfaz
+#define ALERT_METRIC_MAX 32    // "psi.memory.some"
+#define ALERT_COND_MAX  32     // " >= 0.95"
+_Static_assert(ALERT_LABEL_MAX >= DISK_NAME_MAX && ALERT_LABEL_MAX >= NET_NAME_MAX &&
+               ALERT_LABEL_MAX >= THERMAL_TYPE_MAX, "la etiqueta de una instancia no cabe");
+// "métrica[etiqueta]cond" entero
+_Static_assert(ALERT_NAME_MAX >= ALERT_METRIC_MAX + ALERT_LABEL_MAX + ALERT_COND_MAX,
+               "ALERT_NAME_MAX no alcanza para el nombre de un evento");
+
+// ==================== Tabla de métricas ====================
+//
+// Cada métrica es una fila: lectura de la instancia 'i' (1 si hay dato), nº
+// de instancias en esta muestra y su etiqueta (las escalares no tienen ni lo
+// uno ni lo otro). Añadir una métrica = una función y una fila.
+
+typedef struct {
+    const char *name;
+    int  (*get)(const Snapshot *s, int i, double *v);
+    int  (*count)(const Snapshot *s);                      // NULL = escalar
+    void (*label)(const Snapshot *s, int i, char *buf, size_t len);
+    int   max_inst;                                        // instancias posibles (-1 = cores)
+} AlertMetric;
+
+static int ok_mem(const Snapshot *s) { return s->mem_rc == 0; }
+static int ok_cpu(const Snapshot *s) { return s->cpu_rc == 0 && s->cpu.ready; }
+
+static int g_mem_used(const Snapshot *s, int i, double *v)  { (void)i; *v = s->mem.used_ratio; return ok_mem(s); }
+static int g_mem_avail(const Snapshot *s, int i, double *v) { (void)i; *v = (double)s->mem.avail_kib / 1024.0; return ok_mem(s); }
+static int g_mem_dirty(const Snapshot *s, int i, double *v) { (void)i; *v = (double)s->mem.dirty_kib / 1024.0; return ok_mem(s); }
+static int g_swap_used(const Snapshot *s, int i, double *v) {
+    (void)i;
+    *v = s->mem.swap_total_kib > 0 ? s->mem.swap_used_ratio : 0.0;
+    return ok_mem(s);
+}
+static int g_mem_commit(const Snapshot *s, int i, double *v) {
+    (void)i;
+    if (s->mem.commit_limit_kib <= 0) return 0;
+    *v = (double)s->mem.committed_kib / (double)s->mem.commit_limit_kib;
+    return ok_mem(s);
+}
+
+static int g_cpu_avg(const Snapshot *s, int i, double *v)     { (void)i; *v = s->cpu.avg; return ok_cpu(s); }
+static int g_cpu_iowait(const Snapshot *s, int i, double *v)  { (void)i; *v = s->cpu.total.iowait; return ok_cpu(s); }
+static int g_cpu_steal(const Snapshot *s, int i, double *v)   { (void)i; *v = s->cpu.total.steal; return ok_cpu(s); }
+static int g_cpu_running(const Snapshot *s, int i, double *v) { (void)i; *v = s->cpu.kstat.procs_running; return ok_cpu(s); }
+static int g_cpu_blocked(const Snapshot *s, int i, double *v) { (void)i; *v = s->cpu.kstat.procs_blocked; return ok_cpu(s); }
+static int g_cpu_core(const Snapshot *s, int i, double *v) {
+    if (!ok_cpu(s) || i >= s->cpu.cores || s->cpu.state[i] != CPU_CORE_ONLINE) return 0;
+    *v = s->cpu.per_core[i];
+    return 1;
+}
+static int n_cpu_core(const Snapshot *s) { return s->cpu_rc == 0 ? s->cpu.cores : 0; }
+static void l_cpu_core(const Snapshot *s, int i, char *buf, size_t len) { (void)s; snprintf(buf, len, "%d", i); }
+
+// PSI: avg10 del kernel como fracción, igual que los demás ratios
+static int psi_avg10(const Snapshot *s, int res, int full, double *v) {
+    const PsiResource *r = &s->psi.res[res];
+    if (s->psi_rc != 0 || !r->available || (full && !r->has_full)) return 0;
+    *v = (full ? r->full.avg10 : r->some.avg10) / 100.0;
+    return 1;
+}
+static int g_psi_cpu(const Snapshot *s, int i, double *v)      { (void)i; return psi_avg10(s, PSI_CPU, 0, v); }
+static int g_psi_mem_some(const Snapshot *s, int i, double *v) { (void)i; return psi_avg10(s, PSI_MEMORY, 0, v); }
+static int g_psi_mem_full(const Snapshot *s, int i, double *v) { (void)i; return psi_avg10(s, PSI_MEMORY, 1, v); }
+static int g_psi_io_some(const Snapshot *s, int i, double *v)  { (void)i; return psi_avg10(s, PSI_IO, 0, v); }
+static int g_psi_io_full(const Snapshot *s, int i, double *v)  { (void)i; return psi_avg10(s, PSI_IO, 1, v); }
+
+static int g_temp_max(const Snapshot *s, int i, double *v) {
+    (void)i;
+    if (s->thermal_rc != 0 || s->thermal.nzones == 0) return 0;
+    *v = thermal_max_temp(&s->thermal);
+    return 1;
+}
+static int g_temp_zone(const Snapshot *s, int i, double *v) {
+    if (s->thermal_rc != 0 || i >= s->thermal.nzones) return 0;
+    *v = s->thermal.zone[i].temp_c;
+    return 1;
+}
+static int n_temp_zone(const Snapshot *s) { return s->thermal_rc == 0 ? s->thermal.nzones : 0; }
+static void l_temp_zone(const Snapshot *s, int i, char *buf, size_t len) { snprintf(buf, len, "%s", s->thermal.zone[i].type); }
+
+static int ok_disk(const Snapshot *s, int i) { return s->disk_rc == 0 && i < s->disk.count && s->disk.dev[i].ready; }
+static int g_disk_util(const Snapshot *s, int i, double *v) {
+    if (!ok_disk(s, i)) return 0;
+    *v = s->disk.dev[i].util;
+    return 1;
+}
+static int g_disk_await(const Snapshot *s, int i, double *v) {
+    if (!ok_disk(s, i)) return 0;
+    const DiskDev *d = &s->disk.dev[i];
+    *v = d->r_await_ms > d->w_await_ms ? d->r_await_ms : d->w_await_ms;
+    return 1;
+}
+static int n_disk(const Snapshot *s) { return s->disk_rc == 0 ? s->disk.count : 0; }
+static void l_disk(const Snapshot *s, int i, char *buf, size_t len) { snprintf(buf, len, "%s", s->disk.dev[i].name); }
+
+static int g_net_errors(const Snapshot *s, int i, double *v) {
+    if (s->net_rc != 0 || i >= s->net.count || !s->net.ifs[i].ready) return 0;
+    const NetIf *n = &s->net.ifs[i];
+    *v = n->rx_errs_ps + n->tx_errs_ps + n->rx_drop_ps + n->tx_drop_ps;
+    return 1;
+}
+static int n_net(const Snapshot *s) { return s->net_rc == 0 ? s->net.count : 0; }
+static void l_net(const Snapshot *s, int i, char *buf, size_t len) { snprintf(buf, len, "%s", s->net.ifs[i].name); }
+
+static int ok_cg(const Snapshot *s) { return s->cgroup_rc == 0 && s->cgroup.ready; }
+static int g_cg_mem(const Snapshot *s, int i, double *v) {
+    (void)i;
+    long lim = s->cgroup.mem_max_kib;
+    if (s->cgroup.mem_high_kib > 0 && (lim == 0 || s->cgroup.mem_high_kib < lim)) lim = s->cgroup.mem_high_kib;
+    if (s->cgroup_rc != 0 || lim <= 0) return 0;
+    *v = (double)s->cgroup.mem_current_kib / (double)lim;
+    return 1;
+}
+static int g_cg_cpu(const Snapshot *s, int i, double *v)       { (void)i; *v = s->cgroup.cpu; return ok_cg(s); }
+static int g_cg_throttled(const Snapshot *s, int i, double *v) { (void)i; *v = s->cgroup.throttled_ratio; return ok_cg(s); }
+
+static const AlertMetric k_metrics[] = {
+    { "mem.used_ratio",      g_mem_used,      NULL,        NULL,        1 },
+    { "mem.swap_used_ratio", g_swap_used,     NULL,        NULL,        1 },
+    { "mem.avail_mib",       g_mem_avail,     NULL,        NULL,        1 },
+    { "mem.dirty_mib",       g_mem_dirty,     NULL,        NULL,        1 },
+    { "mem.commit_ratio",    g_mem_commit,    NULL,        NULL,        1 },
+    { "cpu.avg",             g_cpu_avg,       NULL,        NULL,        1 },
+    { "cpu.core",            g_cpu_core,      n_cpu_core,  l_cpu_core,  -1 },
+    { "cpu.iowait",          g_cpu_iowait,    NULL,        NULL,        1 },
+    { "cpu.steal",           g_cpu_steal,     NULL,        NULL,        1 },
+    { "cpu.running",         g_cpu_running,   NULL,        NULL,        1 },
+    { "cpu.blocked",         g_cpu_blocked,   NULL,        NULL,        1 },
+    { "psi.cpu.some",        g_psi_cpu,       NULL,        NULL,        1 },
+    { "psi.memory.some",     g_psi_mem_some,  NULL,        NULL,        1 },
+    { "psi.memory.full",     g_psi_mem_full,  NULL,        NULL,        1 },
+    { "psi.io.some",         g_psi_io_some,   NULL,        NULL,        1 },
+    { "psi.io.full",         g_psi_io_full,   NULL,        NULL,        1 },
+    { "temp.max",            g_temp_max,      NULL,        NULL,        1 },
+    { "temp.zone",           g_temp_zone,     n_temp_zone, l_temp_zone, THERMAL_ZONE_MAX },
+    { "disk.util",           g_disk_util,     n_disk,      l_disk,      DISK_MAX },
+    { "disk.await_ms",       g_disk_await,    n_disk,      l_disk,      DISK_MAX },
+    { "net.errors_ps",       g_net_errors,    n_net,       l_net,       NET_MAX },
+    { "cg.mem_ratio",        g_cg_mem,        NULL,        NULL,        1 },
+    { "cg.cpu",              g_cg_cpu,        NULL,        NULL,        1 },
+    { "cg.throttled_ratio",  g_cg_throttled,  NULL,        NULL,        1 },
+};
+#define METRIC_COUNT ((int)(sizeof(k_metrics) / sizeof(k_metrics[0])))
+
+// ==================== Reglas compiladas ====================
+
+typedef enum { OP_GT = 0, OP_GE, OP_LT, OP_LE } AlertOp;
+static const char *const k_op_text[] = { ">", ">=", "<", "<=" };
+
+enum { ST_OK = 0, ST_PENDING, ST_FIRING };
+
+typedef struct {
+    unsigned char state;     // ST_*
+    unsigned char seen;      // [*]: su instancia está en la muestra en curso
+    double        since;     // CLOCK_MONOTONIC (s): inicio de PENDING o del disparo
+    char          key[ALERT_LABEL_MAX];   // [*]: etiqueta de la instancia ("" = libre)
+} AlertInst;
+
+typedef struct {
+    const AlertMetric *m;
+    char     metric[ALERT_METRIC_MAX];   // como se escribió: "cpu.core"
+    char     sel[ALERT_LABEL_MAX];   // "" escalar, "*" todas, "3" / "sda" una
+    int      sel_index;              // sel numérico (-1 si no)
+    char     cond[ALERT_COND_MAX];   // " > 0.95"
+    AlertOp  op;
+    double   thr, clr;
+    double   for_s, every_s;
+    char    *exec;                   // NULL = sin comando
+    double   last_exec;              // CLOCK_MONOTONIC del último 'exec' (< 0: nunca)
+    long     suppressed;             // disparos sin 'exec' desde el último
+    int      ninst;
+    AlertInst *inst;                 // [ninst], dentro del bloque del motor
+} AlertRule;
+
+struct AlertEngine {
+    AlertRule  rule[ALERT_MAX_RULES];
+    int        nrules;
+    AlertInst *inst;                 // un solo bloque para el estado de todas las reglas
+    int        log_fd;               // -1 = sin registro
+    int        log_owned;            // 0 si es stderr
+    posix_spawn_file_actions_t fa;   // stdin/stdout/stderr de 'exec' a /dev/null
+    int        fa_ready;
+    pid_t      child[ALERT_MAX_CHILDREN];
+    int        nchild;
+
+    pthread_mutex_t lock;            // protege lo de abajo (lo lee la UI)
+    int        firing;
+    char       last[ALERT_NAME_MAX];
+};
+
+// ==================== Carga ====================
+
+static void set_err(char *err, size_t len, const char *path, int line, const char *fmt, ...) {
+    if (!err || len == 0) return;
+    int n = line > 0 ? snprintf(err, len, "%s:%d: ", path, line) : snprintf(err, len, "%s: ", path);
+    if (n < 0 || (size_t)n >= len) return;
+    va_list ap;
+    va_start(ap, fmt);
+    vsnprintf(err + n, len - (size_t)n, fmt, ap);
+    va_end(ap);
+}
+
+static const char *skip_ws(const char *p) {
+    while (*p == ' ' || *p == '\t') ++p;
+    return p;
+}
+
+// Copia la siguiente palabra (hasta blanco) en 'out'. Devuelve el resto o NULL si no cabe.
+static const char *next_word(const char *p, char *out, size_t len) {
+    size_t n = 0;
+    while (*p && *p != ' ' && *p != '\t') {
+        if (n + 1 >= len) return NULL;
+        out[n++] = *p++;
+    }
+    out[n] = '\0';
+    return skip_ws(p);
+}
+
+// "10s", "500ms", "5m", "1h" o un número de segundos
+static int parse_duration(const char *s, double *out) {
+    char *end;
+    errno = 0;
+    double v = strtod(s, &end);
+    if (errno || end == s || v < 0.0) return 1;
+    if (*end == '\0' || strcmp(end, "s") == 0) *out = v;
+    else if (strcmp(end, "ms") == 0) *out = v / 1000.0;
+    else if (strcmp(end, "m") == 0) *out = v * 60.0;
+    else if (strcmp(end, "h") == 0) *out = v * 3600.0;
+    else return 1;
+    return 0;
+}
+
+// Número con '%' opcional (90% = 0.9)
+static int parse_value(const char *s, double *out) {
+    char *end;
+    errno = 0;
+    double v = strtod(s, &end);
+    if (errno || end == s) return 1;
+    if (*end == '%') { v /= 100.0; ++end; }
+    if (*end) return 1;
+    *out = v;
+    return 0;
+}
+
+static const AlertMetric *find_metric(const char *name) {
+    for (int i = 0; i < METRIC_COUNT; ++i)
+        if (strcmp(k_metrics[i].name, name) == 0) return &k_metrics[i];
+    return NULL;
+}
+
+// Compila una regla. Devuelve NULL si OK o el motivo del error.
+static const char *parse_rule(const char *p, AlertRule *r) {
+    char word[ALERT_LINE_MAX];
+    memset(r, 0, sizeof(*r));
+    r->sel_index = -1;
+    r->every_s = ALERT_EVERY_DEFAULT;
+    r->last_exec = -1.0;
+
+    // MÉTRICA[SEL] (el operador puede ir pegado: "mem.used_ratio>0.9")
+    size_t n = 0;
+    while (isalnum((unsigned char)*p) || *p == '.' || *p == '_') {
+        if (n + 1 >= sizeof(r->metric)) return "nombre de métrica demasiado largo";
+        r->metric[n++] = *p++;
+    }
+    r->metric[n] = '\0';
+    if (n == 0) return "falta la métrica";
+    r->m = find_metric(r->metric);
+    if (!r->m) return "métrica desconocida";
+    if (*p == '[') {
+        const char *close = strchr(p, ']');
+        size_t sl = close ? (size_t)(close - p - 1) : 0;
+        if (!close || sl == 0 || sl >= sizeof(r->sel)) return "selector [..] inválido";
+        memcpy(r->sel, p + 1, sl);
+        r->sel[sl] = '\0';
+        p = close + 1;
+        if (!r->m->count) return "esta métrica no tiene instancias";
+        if (strspn(r->sel, "0123456789") == sl) r->sel_index = atoi(r->sel);
+    } else if (r->m->count) {
+        return "falta el selector: [*], [N] o [nombre]";
+    }
+
+    // OP UMBRAL
+    p = skip_ws(p);
+    if (p[0] == '>' || p[0] == '<') {
+        int ge = (p[1] == '=');
+        r->op = p[0] == '>' ? (ge ? OP_GE : OP_GT) : (ge ? OP_LE : OP_LT);
+        p = skip_ws(p + 1 + ge);
+    } else {
+        return "falta el operador (>, >=, <, <=)";
+    }
+    char thr_text[24];
+    p = next_word(p, thr_text, sizeof(thr_text));
+    if (!p || parse_value(thr_text, &r->thr) != 0) return "umbral inválido";
+    r->clr = r->thr;
+    snprintf(r->cond, sizeof(r->cond), " %s %s", k_op_text[r->op], thr_text);
+
+    // Modificadores; 'exec' se queda con el resto de la línea
+    while (*p) {
+        p = next_word(p, word, sizeof(word));
+        if (!p) return "línea demasiado larga";
+        if (strcmp(word, "exec") == 0) {
+            if (!*p) return "'exec' sin comando";
+            r->exec = strdup(p);
+            if (!r->exec) return "sin memoria";
+            break;
+        }
+        char arg[32];
+        if (!*p) return "falta el valor del modificador";
+        p = next_word(p, arg, sizeof(arg));
+        if (!p) return "valor del modificador inválido";
+        if (strcmp(word, "for") == 0) {
+            if (parse_duration(arg, &r->for_s) != 0) return "duración de 'for' inválida";
+        } else if (strcmp(word, "every") == 0) {
+            if (parse_duration(arg, &r->every_s) != 0) return "duración de 'every' inválida";
+        } else if (strcmp(word, "clear") == 0) {
+            if (parse_value(arg, &r->clr) != 0) return "valor de 'clear' inválido";
+        } else {
+            return "modificador desconocido (for, clear, every, exec)";
+        }
+    }
+    // La banda de histéresis va del lado en que la alerta se resuelve
+    if ((r->op == OP_GT || r->op == OP_GE) ? r->clr > r->thr : r->clr < r->thr)
+        return "'clear' debe quedar del lado que resuelve la alerta";
+    return NULL;
+}
+
+static void free_rules(AlertEngine *a) {
+    for (int i = 0; i < a->nrules; ++i) free(a->rule[i].exec);
+    a->nrules = 0;
+}
+
+AlertEngine *alert_load(const char *path, int cores, char *err, size_t errlen) {
+    if (!path || cores < 1) {
+        set_err(err, errlen, path ? path : "(null)", 0, "argumentos inválidos");
+        return NULL;
+    }
+    FILE *f = fopen(path, "re");
+    if (!f) {
+        set_err(err, errlen, path, 0, "%s", strerror(errno));
+        return NULL;
+    }
+    AlertEngine *a = calloc(1, sizeof(*a));
+    if (!a) {
+        fclose(f);
+        set_err(err, errlen, path, 0, "sin memoria");
+        return NULL;
+    }
+    a->log_fd = -1;
+
+    char line[ALERT_LINE_MAX];
+    char log_path[ALERT_LINE_MAX] = "";
+    int lineno = 0;
+    const char *why = NULL;
+    while (!why && fgets(line, sizeof(line), f)) {
+        ++lineno;
+        size_t len = strlen(line);
+        if (len == sizeof(line) - 1 && line[len - 1] != '\n') { why = "línea demasiado larga"; break; }
+        // '#' al principio o tras un blanco: así un 'exec' puede llevar "a#b"
+        for (char *c = line; *c; ++c)
+            if (*c == '#' && (c == line || *(c - 1) == ' ' || *(c - 1) == '\t')) { *c = '\0'; break; }
+        len = strlen(line);
+        while (len > 0 && isspace((unsigned char)line[len - 1])) line[--len] = '\0';
+        const char *p = skip_ws(line);
+        if (!*p) continue;
+
+        if (strncmp(p, "log", 3) == 0 && (p[3] == ' ' || p[3] == '\t')) {
+            snprintf(log_path, sizeof(log_path), "%s", skip_ws(p + 3));
+            continue;
+        }
+        if (a->nrules == ALERT_MAX_RULES) { why = "demasiadas reglas"; break; }
+        why = parse_rule(p, &a->rule[a->nrules]);
+        if (why) free(a->rule[a->nrules].exec);
+        else a->nrules++;
+    }
+    fclose(f);
+    if (!why && a->nrules == 0) { why = "no hay reglas"; lineno = 0; }
+    if (why) {
+        set_err(err, errlen, path, lineno, "%s", why);
+        free_rules(a);
+        free(a);
+        return NULL;
+    }
+
+    // Estado por instancia: todo en un bloque, reservado aquí
+    size_t total = 0;
+    for (int i = 0; i < a->nrules; ++i) {
+        AlertRule *r = &a->rule[i];
+        r->ninst = strcmp(r->sel, "*") == 0 ? (r->m->max_inst < 0 ? cores : r->m->max_inst) : 1;
+        total += (size_t)r->ninst;
+    }
+    a->inst = calloc(total, sizeof(AlertInst));
+    if (!a->inst) {
+        set_err(err, errlen, path, 0, "sin memoria");
+        free_rules(a);
+        free(a);
+        return NULL;
+    }
+    for (int i = 0, off = 0; i < a->nrules; ++i) {
+        a->rule[i].inst = a->inst + off;
+        off += a->rule[i].ninst;
+    }
+
+    // Registro de eventos ("-" = stderr)
+    if (strcmp(log_path, "-") == 0) {
+        a->log_fd = STDERR_FILENO;
+    } else if (log_path[0]) {
+        a->log_fd = open(log_path, O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+        if (a->log_fd < 0) {
+            set_err(err, errlen, log_path, 0, "%s", strerror(errno));
+            free_rules(a);
+            free(a->inst);
+            free(a);
+            return NULL;
+        }
+        a->log_owned = 1;
+    }
+
+    // Los comandos no deben escribir sobre la TUI ni leer el teclado
+    if (posix_spawn_file_actions_init(&a->fa) == 0) {
+        a->fa_ready = posix_spawn_file_actions_addopen(&a->fa, STDIN_FILENO, "/dev/null", O_RDONLY, 0) == 0
+                   && posix_spawn_file_actions_addopen(&a->fa, STDOUT_FILENO, "/dev/null", O_WRONLY, 0) == 0
+                   && posix_spawn_file_actions_adddup2(&a->fa, STDOUT_FILENO, STDERR_FILENO) == 0;
+        if (!a->fa_ready) posix_spawn_file_actions_destroy(&a->fa);
+    }
+    pthread_mutex_init(&a->lock, NULL);
+    return a;
+}
+
+// ==================== Evaluación ====================
+
+static double mono_s(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static void reap_children(AlertEngine *a) {
+    for (int i = 0; i < a->nchild; ) {
+        if (waitpid(a->child[i], NULL, WNOHANG) != 0) a->child[i] = a->child[--a->nchild];
+        else ++i;
+    }
+}
+
+// "cpu.core[3] > 0.95": el selector se reemplaza por la instancia
+static void event_name(const AlertRule *r, const char *label, char buf[ALERT_NAME_MAX]) {
+    if (label[0]) snprintf(buf, ALERT_NAME_MAX, "%.*s[%.*s]%.*s", ALERT_METRIC_MAX - 1, r->metric,
+                           ALERT_LABEL_MAX - 1, label, ALERT_COND_MAX - 1, r->cond);
+    else snprintf(buf, ALERT_NAME_MAX, "%.*s%.*s", ALERT_METRIC_MAX - 1, r->metric, ALERT_COND_MAX - 1, r->cond);
+}
+
+static void log_event(AlertEngine *a, const Snapshot *snap, const char *what,
+                      const char *name, double v, double held_s) {
+    if (a->log_fd < 0) return;
+    char ts[32], line[256];
+    struct tm tm;
+    time_t t = snap->ts.tv_sec;
+    strftime(ts, sizeof(ts), "%Y-%m-%dT%H:%M:%S", localtime_r(&t, &tm));
+    int n = held_s >= 0.0
+          ? snprintf(line, sizeof(line), "%s %s %s valor=%g (duró %.0f s)\n", ts, what, name, v, held_s)
+          : snprintf(line, sizeof(line), "%s %s %s valor=%g\n", ts, what, name, v);
+    if (n > 0) {
+        // Una línea por write(): con O_APPEND no se mezcla con otros escritores
+        ssize_t w = write(a->log_fd, line, (size_t)n < sizeof(line) ? (size_t)n : sizeof(line) - 1);
+        (void)w;
+    }
+}
+
+static void run_exec(AlertEngine *a, AlertRule *r, const char *name, const char *label, double v, double now) {
+    if (!r->exec) return;
+    reap_children(a);
+    if ((r->last_exec >= 0.0 && now - r->last_exec < r->every_s) || a->nchild == ALERT_MAX_CHILDREN) {
+        r->suppressed++;
+        return;
+    }
+    char value[32], supp[24];
+    snprintf(value, sizeof(value), "%g", v);
+    snprintf(supp, sizeof(supp), "%ld", r->suppressed);
+    // sh -c CMD sh $1 $2 $3 $4
+    char *argv[] = { "sh", "-c", r->exec, "sh", (char *)name, (char *)label, value, supp, NULL };
+    pid_t pid;
+    if (posix_spawn(&pid, "/bin/sh", a->fa_ready ? &a->fa : NULL, NULL, argv, environ) == 0) {
+        a->child[a->nchild++] = pid;
+        r->last_exec = now;
+        r->suppressed = 0;
+    }
+}
+
+static int cond_hit(AlertOp op, double v, double thr) {
+    switch (op) {
+    case OP_GT: return v > thr;
+    case OP_GE: return v >= thr;
+    case OP_LT: return v < thr;
+    default:    return v <= thr;
+    }
+}
+
+// Resuelta: fuera del umbral y más allá de la banda de histéresis
+static int cond_clear(const AlertRule *r, double v) {
+    if (cond_hit(r->op, v, r->thr)) return 0;
+    return (r->op == OP_GT || r->op == OP_GE) ? v <= r->clr : v >= r->clr;
+}
+
+// Recuento de una pasada: cuántas instancias están disparadas y cuál lo hizo última
+typedef struct {
+    int              firing;
+    double           since;
+    const AlertRule *r;
+    int              i;
+} AlertTally;
+
+static void tally(AlertTally *t, const AlertRule *r, const AlertInst *st, int i) {
+    if (st->state != ST_FIRING) return;
+    t->firing++;
+    if (i >= 0 && (!t->r || st->since > t->since)) {
+        t->since = st->since;
+        t->r = r;
+        t->i = i;
+    }
+}
+
+// Una instancia: OK → PENDING (condición) → FIRING ('for' cumplido) → OK (clear)
+static void eval_inst(AlertEngine *a, AlertRule *r, AlertInst *st, const Snapshot *snap,
+                      int i, double now, AlertTally *t) {
+    double v;
+    if (i < 0 || !r->m->get(snap, i, &v)) {
+        // Sin dato (core apagado, primera muestra): no se decide nada nuevo
+        if (st->state == ST_PENDING) st->state = ST_OK;
+        tally(t, r, st, -1);
+        return;
+    }
+    if (st->state == ST_OK && cond_hit(r->op, v, r->thr)) {
+        st->state = ST_PENDING;
+        st->since = now;
+    }
+    char label[ALERT_LABEL_MAX] = "", name[ALERT_NAME_MAX];
+    if (st->state == ST_PENDING) {
+        if (!cond_hit(r->op, v, r->thr)) {
+            st->state = ST_OK;
+        } else if (now - st->since >= r->for_s) {
+            st->state = ST_FIRING;
+            st->since = now;
+            if (r->m->label) r->m->label(snap, i, label, sizeof(label));
+            event_name(r, label, name);
+            log_event(a, snap, "DISPARA", name, v, -1.0);
+            run_exec(a, r, name, label, v, now);
+        }
+    } else if (st->state == ST_FIRING && cond_clear(r, v)) {
+        st->state = ST_OK;
+        if (r->m->label) r->m->label(snap, i, label, sizeof(label));
+        event_name(r, label, name);
+        log_event(a, snap, "RESUELTA", name, v, now - st->since);
+    }
+    tally(t, r, st, i);
+}
+
+// Instancia que elige un selector fijo: índice directo o por etiqueta
+static int select_inst(const AlertRule *r, const Snapshot *snap) {
+    int n = r->m->count(snap);
+    if (r->sel_index >= 0) return r->sel_index < n ? r->sel_index : -1;
+    char label[ALERT_LABEL_MAX];
+    for (int i = 0; i < n; ++i) {
+        r->m->label(snap, i, label, sizeof(label));
+        if (strcmp(label, r->sel) == 0) return i;
+    }
+    return -1;
+}
+
+// Estado de la instancia 'label' de una regla [*]: el suyo, uno libre o uno
+// en OK cuya instancia no apareció aún en esta muestra. NULL si no queda.
+static AlertInst *inst_for(AlertRule *r, const char *label) {
+    AlertInst *empty = NULL, *idle = NULL;
+    for (int j = 0; j < r->ninst; ++j) {
+        AlertInst *st = &r->inst[j];
+        if (st->seen) continue;   // dos instancias con la misma etiqueta: una cada una
+        if (st->key[0] && strcmp(st->key, label) == 0) return st;
+        if (!st->key[0]) { if (!empty) empty = st; }
+        else if (!idle && st->state == ST_OK) idle = st;
+    }
+    AlertInst *st = empty ? empty : idle;
+    if (st) {
+        memset(st, 0, sizeof(*st));
+        snprintf(st->key, sizeof(st->key), "%s", label);
+    }
+    return st;
+}
+
+// [*]: el estado va con la etiqueta (disco, interfaz, zona), no con la
+// posición en la muestra, que se corre cuando aparece o desaparece otra.
+static void eval_all(AlertEngine *a, AlertRule *r, const Snapshot *snap, double now, AlertTally *t) {
+    for (int j = 0; j < r->ninst; ++j) r->inst[j].seen = 0;
+    int n = r->m->count(snap);
+    for (int i = 0; i < n; ++i) {
+        char label[ALERT_LABEL_MAX];
+        r->m->label(snap, i, label, sizeof(label));
+        if (!label[0]) snprintf(label, sizeof(label), "%d", i);
+        AlertInst *st = inst_for(r, label);
+        if (!st) continue;
+        st->seen = 1;
+        eval_inst(a, r, st, snap, i, now, t);
+    }
+    // Las que no están en esta muestra cuentan como sin dato
+    for (int j = 0; j < r->ninst; ++j)
+        if (r->inst[j].key[0] && !r->inst[j].seen) eval_inst(a, r, &r->inst[j], snap, -1, now, t);
+}
+
+void alert_eval(AlertEngine *a, const Snapshot *snap) {
+    if (!a || !snap) return;
+    double now = mono_s();
+    AlertTally t = { 0, 0.0, NULL, -1 };
+    for (int k = 0; k < a->nrules; ++k) {
+        AlertRule *r = &a->rule[k];
+        if (!r->m->count) {
+            eval_inst(a, r, &r->inst[0], snap, 0, now, &t);
+        } else if (strcmp(r->sel, "*") != 0) {
+            eval_inst(a, r, &r->inst[0], snap, select_inst(r, snap), now, &t);
+        } else {
+            eval_all(a, r, snap, now, &t);
+        }
+    }
+    char last[ALERT_NAME_MAX] = "", label[ALERT_LABEL_MAX] = "";
+    if (t.r) {
+        if (t.r->m->label) t.r->m->label(snap, t.i, label, sizeof(label));
+        event_name(t.r, label, last);
+    }
+    pthread_mutex_lock(&a->lock);
+    a->firing = t.firing;
+    memcpy(a->last, last, sizeof(last));
+    pthread_mutex_unlock(&a->lock);
+}
+
+void alert_hook(const Snapshot *snap, void *arg) {
+    alert_eval((AlertEngine *)arg, snap);
+}
+
+int alert_firing(AlertEngine *a, char *last, size_t len) {
+    if (!a) return 0;
+    pthread_mutex_lock(&a->lock);
+    int n = a->firing;
+    if (last && len > 0) snprintf(last, len, "%s", a->last);
+    pthread_mutex_unlock(&a->lock);
+    return n;
+}
+
+int alert_rule_count(const AlertEngine *a) { return a ? a->nrules : 0; }
+
+void alert_free(AlertEngine *a) {
+    if (!a) return;
+    reap_children(a);   // los que sigan vivos los recoge init al salir
+    if (a->log_owned) close(a->log_fd);
+    if (a->fa_ready) posix_spawn_file_actions_destroy(&a->fa);
+    pthread_mutex_destroy(&a->lock);
+    free_rules(a);
+    free(a->inst);
+    free(a);
+}
@@ -0,0 +1,168 @@
+#include "canvas.h"
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Un tramo cambiado absorbe hasta este nº de celdas iguales intermedias (mismo
+// estilo) para no partir, p. ej., "12.3%" → "12.4%" en dos llamadas.
+#define CV_MAX_GAP 4
+// Tramos de un mismo carácter ASCII a partir de este largo van con mvwhline.
+#define CV_HLINE_MIN 4
+
+int canvas_init(Canvas *cv, WINDOW *win, int y0, int x0, int rows, int cols) {
+    if (!cv) return 1;
+    memset(cv, 0, sizeof(*cv));
+    if (!win || rows <= 0 || cols <= 0) return 1;
+
+    size_t n = (size_t)rows * (size_t)cols;
+    cv->cur  = malloc(n * sizeof(*cv->cur));
+    cv->prev = malloc(n * sizeof(*cv->prev));
+    cv->run  = malloc(((size_t)cols + 1) * sizeof(*cv->run));
+    if (!cv->cur || !cv->prev || !cv->run) {
+        canvas_free(cv);
+        return 3;
+    }
+    cv->win = win;
+    cv->y0 = y0; cv->x0 = x0;
+    cv->rows = rows; cv->cols = cols;
+    canvas_clear(cv);
+    cv->prev_valid = 0;
+    return 0;
+}
+
+void canvas_free(Canvas *cv) {
+    if (!cv) return;
+    free(cv->cur);
+    free(cv->prev);
+    free(cv->run);
+    memset(cv, 0, sizeof(*cv));
+}
+
+void canvas_invalidate(Canvas *cv) {
+    if (cv) cv->prev_valid = 0;
+}
+
+void canvas_clear(Canvas *cv) {
+    if (!cv || !cv->cur) return;
+    size_t n = (size_t)cv->rows * (size_t)cv->cols;
+    for (size_t i = 0; i < n; ++i) {
+        cv->cur[i].ch = L' ';
+        cv->cur[i].style = CV_PLAIN;
+    }
+}
+
+static CvCell *cell_at(Canvas *cv, int y, int x) {
+    int r = y - cv->y0, c = x - cv->x0;
+    if (!cv->cur || r < 0 || r >= cv->rows || c < 0 || c >= cv->cols) return NULL;
+    return &cv->cur[(size_t)r * (size_t)cv->cols + (size_t)c];
+}
+
+void canvas_put(Canvas *cv, int y, int x, wchar_t ch, unsigned short style) {
+    if (!cv) return;
+    CvCell *c = cell_at(cv, y, x);
+    if (c) { c->ch = ch; c->style = style; }
+}
+
+void canvas_fill(Canvas *cv, int y, int x, int n, wchar_t ch, unsigned short style) {
+    if (!cv) return;
+    for (int i = 0; i < n; ++i) canvas_put(cv, y, x + i, ch, style);
+}
+
+int canvas_text(Canvas *cv, int y, int x, unsigned short style, const char *utf8) {
+    if (!cv || !utf8) return x;
+    mbstate_t st;
+    memset(&st, 0, sizeof(st));
+    const char *p = utf8;
+    size_t left = strlen(p);
+    while (left > 0) {
+        wchar_t wc;
+        size_t n = mbrtowc(&wc, p, left, &st);
+        if (n == (size_t)-1 || n == (size_t)-2) {   // byte inválido: lo mostramos como '?'
+            wc = L'?'; n = 1;
+            memset(&st, 0, sizeof(st));
+        } else if (n == 0) {
+            break;
+        }
+        p += n; left -= n;
+
+        int w = wcwidth(wc);
+        if (w == 0) continue;                 // combinantes / controles sin ancho
+        if (w < 0 || w > 1) wc = L'?';        // el grid asume 1 columna por celda
+        canvas_put(cv, y, x++, wc, style);
+    }
+    return x;
+}
+
+int canvas_printf(Canvas *cv, int y, int x, unsigned short style, const char *fmt, ...) {
+    char buf[512];
+    va_list ap;
+    va_start(ap, fmt);
+    vsnprintf(buf, sizeof(buf), fmt, ap);
+    va_end(ap);
+    return canvas_text(cv, y, x, style, buf);
+}
+
+static attr_t style_attr(unsigned short style) {
+    attr_t a = (style & 0x100u) ? A_BOLD : A_NORMAL;
+    short pair = (short)(style & 0xFFu);
+    if (pair && has_colors()) a |= (attr_t)COLOR_PAIR(pair);
+    return a;
+}
+
+static int cell_eq(const CvCell *a, const CvCell *b) {
+    return a->ch == b->ch && a->style == b->style;
+}
+
+// Emite cur[y][x0 .. x0+n) con un solo estilo.
+static void emit_run(Canvas *cv, int y, int x, int n, unsigned short style) {
+    const CvCell *c = &cv->cur[(size_t)y * (size_t)cv->cols + (size_t)x];
+    attr_t attr = style_attr(style);
+
+    int same = (c[0].ch < 0x80 && c[0].ch >= 0x20);
+    for (int i = 1; same && i < n; ++i) same = (c[i].ch == c[0].ch);
+
+    if (same && n >= CV_HLINE_MIN) {
+        mvwhline(cv->win, cv->y0 + y, cv->x0 + x, (chtype)c[0].ch | attr, n);
+        return;
+    }
+    for (int i = 0; i < n; ++i) cv->run[i] = c[i].ch;
+    cv->run[n] = L'\0';
+    wattrset(cv->win, (int)attr);
+    mvwaddnwstr(cv->win, cv->y0 + y, cv->x0 + x, cv->run, n);
+    wattrset(cv->win, A_NORMAL);
+}
+
+int canvas_flush(Canvas *cv) {
+    if (!cv || !cv->cur || !cv->win) return 0;
+    int written = 0;
+    int full = !cv->prev_valid;
+
+    for (int y = 0; y < cv->rows; ++y) {
+        const CvCell *c = &cv->cur [(size_t)y * (size_t)cv->cols];
+        const CvCell *p = &cv->prev[(size_t)y * (size_t)cv->cols];
+        int x = 0;
+        while (x < cv->cols) {
+            if (!full && cell_eq(&c[x], &p[x])) { x++; continue; }
+
+            // Tramo: celdas cambiadas consecutivas con el mismo estilo, tolerando
+            // huecos cortos de celdas iguales.
+            unsigned short st = c[x].style;
+            int start = x, end = x + 1, k = x + 1;
+            while (k < cv->cols && c[k].style == st) {
+                if (full || !cell_eq(&c[k], &p[k])) { end = ++k; continue; }
+                int g = k;
+                while (g < cv->cols && g - k < CV_MAX_GAP && c[g].style == st && cell_eq(&c[g], &p[g])) g++;
+                if (g < cv->cols && g - k < CV_MAX_GAP && c[g].style == st) { k = g; continue; }
+                break;
+            }
+            emit_run(cv, y, start, end - start, st);
+            written += end - start;
+            x = end;
+        }
+    }
+
+    memcpy(cv->prev, cv->cur, (size_t)cv->rows * (size_t)cv->cols * sizeof(*cv->cur));
+    cv->prev_valid = 1;
+    return written;
+}
@@ -0,0 +1,441 @@
+#include "cgroup.h"
+#include "procfile.h"
+#include <dirent.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define CGROUP_DEFAULT_MOUNT "/sys/fs/cgroup"
+#define CGROUP_HYBRID_MOUNT  "/sys/fs/cgroup/unified"
+#define CGROUP_DIR_MAX 256
+// Hijos seguidos con fds abiertos (dos por hijo); los demás se ignoran
+#define CGROUP_TRACK_MAX 128
+// La lista de hijos se relee del directorio cada tantas muestras
+#define CGROUP_RESCAN_EVERY 10
+
+// ---------- Destino ----------
+// Solo se escriben al arrancar (cgroup_set_target), antes del hilo de muestreo.
+static char g_dir[CGROUP_DIR_MAX];          // "/sys/fs/cgroup/system.slice/x" (sin traducir)
+static char g_path[CGROUP_PATH_MAX];        // "/system.slice/x"
+
+// Lectura única de un archivo pequeño. Devuelve los bytes leídos o -1.
+static int read_once(const char *rel, char *buf, size_t len) {
+    char path[1024];
+    const char *p = procfs_path(rel, path, sizeof(path));
+    int fd = p ? open(p, O_RDONLY | O_CLOEXEC) : -1;
+    if (fd < 0) return -1;
+    ssize_t n = read(fd, buf, len - 1);
+    close(fd);
+    if (n < 0) return -1;
+    buf[n] = '\0';
+    return (int)n;
+}
+
+// Punto de montaje de cgroup2 según /proc/self/mountinfo (en sistemas
+// híbridos es /sys/fs/cgroup/unified). Campo 5 = punto de montaje; tras " - "
+// viene el tipo de sistema de archivos. Devuelve 1 si lo encontró.
+static int find_mount(char *out, size_t len) {
+    int found = 0;
+    ProcFile pf = PROCFILE_INIT;
+    if (procfile_open(&pf, "/proc/self/mountinfo", 4096) != 0) return 0;
+    if (procfile_read(&pf) == 0) {
+        for (const char *p = pf.buf; *p; p = pf_next_line(p)) {
+            const char *dash = strstr(p, " - cgroup2 ");
+            const char *eol = strchr(p, '\n');
+            if (!dash || (eol && dash > eol)) continue;
+            const char *f = p;
+            for (int k = 0; k < 4 && f; ++k) { f = strchr(f, ' '); if (f) f++; }
+            if (!f) break;
+            const char *e = strchr(f, ' ');
+            size_t n = e ? (size_t)(e - f) : 0;
+            if (n > 0 && n < len) { memcpy(out, f, n); out[n] = '\0'; found = 1; }
+            break;
+        }
+    }
+    procfile_close(&pf);
+    return found;
+}
+
+// Resuelve 'spec' bajo el montaje 'mount' ('self_rel' = ruta de "self", ya
+// leída). Devuelve 0 y rellena dir/rel, 1 si la ruta no cabe, 2 si ahí no
+// hay un cgroup v2.
+static int resolve_under(const char *mount, const char *spec, const char *self_rel,
+                         char dir[CGROUP_DIR_MAX], char rel[CGROUP_PATH_MAX]) {
+    size_t ml = strlen(mount);
+    if (self_rel) {
+        snprintf(rel, CGROUP_PATH_MAX, "%s", self_rel);
+    } else if (strncmp(spec, mount, ml) == 0 && (spec[ml] == '/' || spec[ml] == '\0')) {
+        if (snprintf(rel, CGROUP_PATH_MAX, "%s", spec + ml) >= CGROUP_PATH_MAX) return 1;
+    } else {
+        if (snprintf(rel, CGROUP_PATH_MAX, "%s%s", spec[0] == '/' ? "" : "/", spec) >= CGROUP_PATH_MAX) return 1;
+    }
+    // Sin barras finales; la raíz queda como "/"
+    size_t n = strlen(rel);
+    while (n > 1 && rel[n - 1] == '/') rel[--n] = '\0';
+    if (n == 0) { rel[0] = '/'; rel[1] = '\0'; }
+
+    char probe[CGROUP_DIR_MAX + 32], real[1024];
+    if (snprintf(dir, CGROUP_DIR_MAX, "%s%s", mount, strcmp(rel, "/") == 0 ? "" : rel) >= CGROUP_DIR_MAX) return 1;
+    snprintf(probe, sizeof(probe), "%s/cgroup.controllers", dir);
+    const char *path = procfs_path(probe, real, sizeof(real));
+    if (!path) return 1;
+    return access(path, F_OK) == 0 ? 0 : 2;   // no existe o es v1
+}
+
+int cgroup_set_target(const char *spec) {
+    if (!spec || !*spec) return 1;
+
+    char self_rel[CGROUP_PATH_MAX];
+    int self = strcmp(spec, "self") == 0 || strcmp(spec, "auto") == 0;
+    if (self) {
+        // Línea "0::/ruta" de la jerarquía unificada
+        char buf[4096];
+        if (read_once("/proc/self/cgroup", buf, sizeof(buf)) <= 0) return 2;
+        const char *p = strstr(buf, "0::");
+        if (!p || (p != buf && p[-1] != '\n')) return 2;
+        p += 3;
+        size_t n = strcspn(p, "\n");
+        if (n >= sizeof(self_rel)) return 1;
+        memcpy(self_rel, p, n);
+        self_rel[n] = '\0';
+    }
+
+    // El montaje de mountinfo primero; si no aparece (o no lleva al cgroup),
+    // los dos sitios estándar: v2 puro e híbrido.
+    char found[CGROUP_DIR_MAX] = "";
+    const char *mounts[3];
+    int nm = 0;
+    if (find_mount(found, sizeof(found))) mounts[nm++] = found;
+    if (strcmp(found, CGROUP_DEFAULT_MOUNT) != 0) mounts[nm++] = CGROUP_DEFAULT_MOUNT;
+    if (strcmp(found, CGROUP_HYBRID_MOUNT) != 0) mounts[nm++] = CGROUP_HYBRID_MOUNT;
+
+    int rc = 2;
+    for (int i = 0; i < nm; ++i) {
+        char dir[CGROUP_DIR_MAX], rel[CGROUP_PATH_MAX];
+        int r = resolve_under(mounts[i], spec, self ? self_rel : NULL, dir, rel);
+        if (r == 0) {
+            memcpy(g_dir, dir, sizeof(g_dir));
+            memcpy(g_path, rel, sizeof(g_path));
+            return 0;
+        }
+        if (r == 1) rc = 1;
+    }
+    return rc;
+}
+
+int cgroup_mode_enabled(void) { return g_dir[0] != '\0'; }
+
+void cgroup_apply_mem(const CgroupStats *cg, MemStats *m) {
+    if (!cg || !m || cg->mem_current_kib <= 0) return;
+    long host = m->total_kib;
+    long total = (cg->mem_max_kib > 0 && (host <= 0 || cg->mem_max_kib < host)) ? cg->mem_max_kib : host;
+    long used = cg->mem_current_kib - cg->inactive_file_kib;
+    if (used < 0) used = 0;
+    if (used > total) used = total;
+    long unused = total - cg->mem_current_kib;
+
+    m->total_kib = total;
+    m->used_kib = used;
+    m->avail_kib = total - used;
+    m->used_ratio = total > 0 ? (double)used / (double)total : 0.0;
+    m->free_kib = unused > 0 ? unused : 0;
+    m->buffers_kib = 0;
+    m->cached_kib = cg->file_kib;
+    m->swap_cached_kib = 0;
+    m->dirty_kib = cg->file_dirty_kib;
+    m->writeback_kib = cg->file_writeback_kib;
+    m->anon_kib = cg->anon_kib;
+    m->mapped_kib = cg->file_mapped_kib;
+    m->shmem_kib = cg->shmem_kib;
+    m->slab_kib = cg->slab_kib;
+    m->sreclaimable_kib = cg->sreclaimable_kib;
+    m->kernel_stack_kib = cg->kernel_stack_kib;
+    m->page_tables_kib = cg->pagetables_kib;
+
+    long swap_total = (cg->swap_max_kib > 0 && cg->swap_max_kib < m->swap_total_kib) ? cg->swap_max_kib : m->swap_total_kib;
+    long swap_used = cg->swap_current_kib < swap_total ? cg->swap_current_kib : swap_total;
+    m->swap_total_kib = swap_total;
+    m->swap_used_kib = swap_used;
+    m->swap_free_kib = swap_total - swap_used;
+    m->swap_used_ratio = swap_total > 0 ? (double)swap_used / (double)swap_total : 0.0;
+}
+
+// ---------- Sampler ----------
+typedef struct {
+    char               name[CGROUP_DIR_MAX];
+    unsigned char      used;
+    unsigned char      seen;        // aparece en el último recorrido del directorio
+    unsigned char      prev_valid;  // prev_usage es de la muestra anterior
+    ProcFile           mem;         // memory.current (fd = -1 sin controlador)
+    ProcFile           cpu;         // cpu.stat
+    unsigned long long prev_usage;
+} ChildTrack;
+
+enum { CG_MEM_CURRENT = 0, CG_MEM_MAX, CG_MEM_HIGH, CG_MEM_STAT, CG_SWAP_CURRENT, CG_SWAP_MAX,
+       CG_CPU_STAT, CG_CPU_MAX, CG_FILE_COUNT };
+static const char *const k_cg_file[CG_FILE_COUNT] = {
+    "memory.current", "memory.max", "memory.high", "memory.stat",
+    "memory.swap.current", "memory.swap.max", "cpu.stat", "cpu.max",
+};
+
+struct CgroupSampler {
+    ProcFile           file[CG_FILE_COUNT];   // fd = -1 si el controlador no está activo
+    ChildTrack         track[CGROUP_TRACK_MAX];
+    int                rescan_age;
+    unsigned long long prev_usage, prev_user, prev_system;
+    unsigned long long prev_periods, prev_throttled, prev_throttled_usec;
+    struct timespec    prev_ts;               // CLOCK_MONOTONIC de la muestra anterior
+    int                initialized;
+};
+
+static void track_release(ChildTrack *t) {
+    procfile_close(&t->mem);
+    procfile_close(&t->cpu);
+    t->used = 0;
+}
+
+CgroupSampler *cgroup_sampler_create(void) {
+    if (!cgroup_mode_enabled()) return NULL;
+    CgroupSampler *s = calloc(1, sizeof(*s));
+    if (!s) return NULL;
+    int opened = 0;
+    for (int i = 0; i < CG_FILE_COUNT; ++i) {
+        char rel[CGROUP_DIR_MAX + 32];
+        snprintf(rel, sizeof(rel), "%s/%s", g_dir, k_cg_file[i]);
+        s->file[i] = (ProcFile)PROCFILE_INIT;
+        if (procfile_open(&s->file[i], rel, i == CG_MEM_STAT ? 2048 : 64) == 0) opened++;
+    }
+    for (int i = 0; i < CGROUP_TRACK_MAX; ++i) s->track[i].mem = s->track[i].cpu = (ProcFile)PROCFILE_INIT;
+    s->rescan_age = CGROUP_RESCAN_EVERY;   // recorrer los hijos en la primera muestra
+    if (!opened) {
+        free(s);
+        return NULL;
+    }
+    return s;
+}
+
+void cgroup_sampler_destroy(CgroupSampler *s) {
+    if (!s) return;
+    for (int i = 0; i < CG_FILE_COUNT; ++i) procfile_close(&s->file[i]);
+    for (int i = 0; i < CGROUP_TRACK_MAX; ++i) if (s->track[i].used) track_release(&s->track[i]);
+    free(s);
+}
+
+// Un número de bytes, o "max" (= 0, sin límite), en KiB. 0 si no se pudo leer.
+static int read_kib(ProcFile *pf, long *out) {
+    *out = 0;
+    if (pf->fd < 0 || procfile_read(pf) != 0) return 2;
+    unsigned long long v;
+    if (pf_parse_ull(pf->buf, &v) == pf->buf) return strncmp(pf->buf, "max", 3) == 0 ? 0 : 2;
+    *out = (long)(v / 1024ULL);
+    return 0;
+}
+
+// Recorre "clave valor" por línea y llama a 'set' con cada par.
+typedef void (*KvFn)(void *ctx, const char *key, size_t klen, unsigned long long v);
+static void parse_kv(const char *p, KvFn set, void *ctx) {
+    while (*p) {
+        const char *k = p;
+        while (*p && *p != ' ' && *p != '\n') p++;
+        size_t klen = (size_t)(p - k);
+        unsigned long long v;
+        const char *e = pf_parse_ull(p, &v);
+        if (e != p && klen > 0) set(ctx, k, klen, v);
+        p = pf_next_line(e);
+    }
+}
+
+#define KEY_IS(lit) (klen == sizeof(lit) - 1 && memcmp(key, lit, klen) == 0)
+
+static void set_mem_stat(void *ctx, const char *key, size_t klen, unsigned long long v) {
+    CgroupStats *o = ctx;
+    long kib = (long)(v / 1024ULL);
+    if (KEY_IS("anon"))                  o->anon_kib = kib;
+    else if (KEY_IS("file"))             o->file_kib = kib;
+    else if (KEY_IS("kernel"))           o->kernel_kib = kib;        // kernel ≥ 5.18
+    else if (KEY_IS("kernel_stack"))     o->kernel_stack_kib = kib;
+    else if (KEY_IS("pagetables"))       o->pagetables_kib = kib;
+    else if (KEY_IS("shmem"))            o->shmem_kib = kib;
+    else if (KEY_IS("file_mapped"))      o->file_mapped_kib = kib;
+    else if (KEY_IS("file_dirty"))       o->file_dirty_kib = kib;
+    else if (KEY_IS("file_writeback"))   o->file_writeback_kib = kib;
+    else if (KEY_IS("inactive_file"))    o->inactive_file_kib = kib;
+    else if (KEY_IS("slab"))             o->slab_kib = kib;
+    else if (KEY_IS("slab_reclaimable")) o->sreclaimable_kib = kib;
+}
+
+typedef struct { unsigned long long usage, user, system, periods, throttled, throttled_usec; } CpuStat;
+
+static void set_cpu_stat(void *ctx, const char *key, size_t klen, unsigned long long v) {
+    CpuStat *c = ctx;
+    if (KEY_IS("usage_usec"))          c->usage = v;
+    else if (KEY_IS("user_usec"))      c->user = v;
+    else if (KEY_IS("system_usec"))    c->system = v;
+    else if (KEY_IS("nr_periods"))     c->periods = v;
+    else if (KEY_IS("nr_throttled"))   c->throttled = v;
+    else if (KEY_IS("throttled_usec")) c->throttled_usec = v;
+}
+
+// "usage_usec 12345" es siempre la primera línea de cpu.stat
+static int read_usage(ProcFile *pf, unsigned long long *out) {
+    if (pf->fd < 0 || procfile_read(pf) != 0) return 2;
+    const char *p = pf->buf;
+    if (strncmp(p, "usage_usec", 10) != 0) return 2;
+    return pf_parse_ull(p + 10, out) == p + 10 ? 2 : 0;
+}
+
+// Relee los hijos del directorio: abre los nuevos y libera los que ya no están.
+static void rescan_children(CgroupSampler *s) {
+    char real[1024];
+    const char *dir = procfs_path(g_dir, real, sizeof(real));
+    DIR *d = dir ? opendir(dir) : NULL;
+    if (!d) return;
+    for (int i = 0; i < CGROUP_TRACK_MAX; ++i) s->track[i].seen = 0;
+    struct dirent *de;
+    while ((de = readdir(d)) != NULL) {
+        if (de->d_type != DT_DIR && de->d_type != DT_UNKNOWN) continue;
+        if (de->d_name[0] == '.') continue;
+        size_t len = strlen(de->d_name);
+        if (len >= CGROUP_DIR_MAX || strlen(g_dir) + len + 16 >= CGROUP_DIR_MAX) continue;
+
+        ChildTrack *t = NULL, *free_slot = NULL;
+        for (int i = 0; i < CGROUP_TRACK_MAX && !t; ++i) {
+            ChildTrack *c = &s->track[i];
+            if (c->used && strcmp(c->name, de->d_name) == 0) t = c;
+            else if (!c->used && !free_slot) free_slot = c;
+        }
+        if (t) { t->seen = 1; continue; }
+        if (!free_slot) continue;   // tabla llena: el hijo se ignora
+
+        char rel[2 * CGROUP_DIR_MAX + 32];
+        t = free_slot;
+        memcpy(t->name, de->d_name, len + 1);
+        snprintf(rel, sizeof(rel), "%s/%s/memory.current", g_dir, t->name);
+        (void)procfile_open(&t->mem, rel, 64);
+        snprintf(rel, sizeof(rel), "%s/%s/cpu.stat", g_dir, t->name);
+        (void)procfile_open(&t->cpu, rel, 256);
+        if (t->mem.fd < 0 && t->cpu.fd < 0) continue;   // no es un cgroup, o sin controladores
+        t->used = 1;
+        t->seen = 1;
+        t->prev_valid = 0;
+    }
+    closedir(d);
+    for (int i = 0; i < CGROUP_TRACK_MAX; ++i)
+        if (s->track[i].used && !s->track[i].seen) track_release(&s->track[i]);
+}
+
+// Inserta 'c' en out->child[] ordenado por CPU y, a igualdad, por memoria.
+static void child_insert(CgroupStats *out, const CgroupChild *c) {
+    int n = out->nchildren;
+    if (n == CGROUP_CHILD_MAX) {
+        const CgroupChild *last = &out->child[n - 1];
+        if (c->cpu < last->cpu || (c->cpu == last->cpu && c->mem_kib <= last->mem_kib)) {
+            out->omitted_children++;
+            return;
+        }
+        out->omitted_children++;   // el último sale del top
+        n--;
+    }
+    int k = n;
+    while (k > 0 && (out->child[k - 1].cpu < c->cpu ||
+                     (out->child[k - 1].cpu == c->cpu && out->child[k - 1].mem_kib < c->mem_kib))) {
+        out->child[k] = out->child[k - 1];
+        k--;
+    }
+    out->child[k] = *c;
+    out->nchildren = n + 1;
+}
+
+static void sample_children(CgroupSampler *s, CgroupStats *out, double dt) {
+    if (++s->rescan_age >= CGROUP_RESCAN_EVERY) {
+        rescan_children(s);
+        s->rescan_age = 0;
+    }
+    for (int i = 0; i < CGROUP_TRACK_MAX; ++i) {
+        ChildTrack *t = &s->track[i];
+        if (!t->used) continue;
+        CgroupChild c;
+        memset(&c, 0, sizeof(c));
+        memcpy(c.name, t->name, strnlen(t->name, sizeof(c.name) - 1));   // recortado
+        int ok = read_kib(&t->mem, &c.mem_kib) == 0;
+        unsigned long long usage;
+        if (read_usage(&t->cpu, &usage) == 0) {
+            ok = 1;
+            if (t->prev_valid && dt > 0.0) {
+                c.ready = 1;
+                c.cpu = (double)pf_counter_delta(usage, t->prev_usage) / (dt * 1e6);
+            }
+            t->prev_usage = usage;
+            t->prev_valid = 1;
+        }
+        // El cgroup se borró entre dos recorridos: sus archivos dan ENODEV
+        if (!ok) { track_release(t); continue; }
+        child_insert(out, &c);
+    }
+}
+
+int cgroup_sampler_sample(CgroupSampler *s, CgroupStats *out) {
+    if (!s || !out) return 1;
+
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    double dt = (double)(now.tv_sec - s->prev_ts.tv_sec) +
+                (double)(now.tv_nsec - s->prev_ts.tv_nsec) / 1e9;
+    if (!s->initialized) dt = 0.0;
+
+    memset(out, 0, sizeof(*out));
+    memcpy(out->path, g_path, sizeof(out->path));
+    out->interval_s = dt;
+
+    ProcFile *f = s->file;
+    int ok = read_kib(&f[CG_MEM_CURRENT], &out->mem_current_kib) == 0;
+    (void)read_kib(&f[CG_MEM_MAX], &out->mem_max_kib);
+    (void)read_kib(&f[CG_MEM_HIGH], &out->mem_high_kib);
+    (void)read_kib(&f[CG_SWAP_CURRENT], &out->swap_current_kib);
+    (void)read_kib(&f[CG_SWAP_MAX], &out->swap_max_kib);
+    if (f[CG_MEM_STAT].fd >= 0 && procfile_read(&f[CG_MEM_STAT]) == 0) {
+        parse_kv(f[CG_MEM_STAT].buf, set_mem_stat, out);
+        if (!out->kernel_kib) out->kernel_kib = out->slab_kib + out->kernel_stack_kib + out->pagetables_kib;
+    }
+
+    // cpu.max: "max 100000" o "50000 100000" (quota y periodo en µs)
+    if (f[CG_CPU_MAX].fd >= 0 && procfile_read(&f[CG_CPU_MAX]) == 0) {
+        unsigned long long quota, period;
+        const char *p = f[CG_CPU_MAX].buf;
+        const char *q = pf_parse_ull(p, &quota);
+        if (q != p && pf_parse_ull(q, &period) != q && period > 0)
+            out->cpu_quota = (double)quota / (double)period;
+    }
+
+    CpuStat c = { 0, 0, 0, 0, 0, 0 };
+    if (f[CG_CPU_STAT].fd >= 0 && procfile_read(&f[CG_CPU_STAT]) == 0) {
+        parse_kv(f[CG_CPU_STAT].buf, set_cpu_stat, &c);
+        out->usage_usec = c.usage;
+        out->throttled_usec = c.throttled_usec;
+        out->nr_periods = c.periods;
+        out->nr_throttled = c.throttled;
+        ok = 1;
+        if (s->initialized && dt > 0.0) {
+            double us = dt * 1e6;
+            out->ready = 1;
+            out->cpu = (double)pf_counter_delta(c.usage, s->prev_usage) / us;
+            out->cpu_user = (double)pf_counter_delta(c.user, s->prev_user) / us;
+            out->cpu_system = (double)pf_counter_delta(c.system, s->prev_system) / us;
+            unsigned long long periods = pf_counter_delta(c.periods, s->prev_periods);
+            if (periods) out->throttled_ratio = (double)pf_counter_delta(c.throttled, s->prev_throttled) / (double)periods;
+            out->throttled_ms_ps = (double)pf_counter_delta(c.throttled_usec, s->prev_throttled_usec) / 1000.0 / dt;
+        }
+        s->prev_usage = c.usage;      s->prev_user = c.user;        s->prev_system = c.system;
+        s->prev_periods = c.periods;  s->prev_throttled = c.throttled;
+        s->prev_throttled_usec = c.throttled_usec;
+    }
+    if (!ok) return 2;   // el cgroup desapareció
+
+    sample_children(s, out, dt);
+    s->prev_ts = now;
+    s->initialized = 1;
+    return 0;
+}
@@ -1,7 +1,10 @@
 #include "cpu.h"
+#include "procfile.h"
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <strings.h>
+#include <time.h>           // clock_gettime
 #include <unistd.h>         // sysconf
 #include <sys/utsname.h>    // uname
 
@@ -25,6 +28,8 @@ static void safe_copy(char *dst, size_t dstsz, const char *src) {
     dst[len] = '\0';
 }
 
+static int read_cpu_list_count(const char *path);
+
 // ---------- Actividad 3 y 4 ----------
 int cpu_read_info(CPUInfo *out) {
     if (!out) return 1;
@@ -38,14 +43,19 @@ int cpu_read_info(CPUInfo *out) {
         safe_copy(out->arch, sizeof(out->arch), "unknown");
     }
 
-    // Núcleos configurados y en línea
-    long conf  = sysconf(_SC_NPROCESSORS_CONF);
-    long onln  = sysconf(_SC_NPROCESSORS_ONLN);
-    out->cores_config = (conf > 0) ? (int)conf : 0;
-    out->cores_online = (onln > 0) ? (int)onln : 0;
+    // Núcleos configurados y en línea: de sysfs (respeta --sys-root) y, si no
+    // está disponible, de sysconf
+    int conf = read_cpu_list_count("/sys/devices/system/cpu/possible");
+    int onln = read_cpu_list_count("/sys/devices/system/cpu/online");
+    if (conf <= 0) conf = (int)sysconf(_SC_NPROCESSORS_CONF);
+    if (onln <= 0) onln = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    out->cores_config = (conf > 0) ? conf : 0;
+    out->cores_online = (onln > 0) ? onln : 0;
 
     // Modelo / Hardware desde /proc/cpuinfo (depende de ARM/64)
-    FILE *f = fopen("/proc/cpuinfo", "r");
+    char path[512];
+    const char *p = procfs_path("/proc/cpuinfo", path, sizeof(path));
+    FILE *f = p ? fopen(p, "r") : NULL;
     if (!f) return 0;  // seguimos con lo que tenemos
 
     char line[256];
@@ -82,74 +92,416 @@ int cpu_read_info(CPUInfo *out) {
     return 0;
 }
 
+// ---------- Topología de CPUs ----------
+// Tope de ids (NR_CPUS máximo del kernel): una lista corrupta o enorme
+// ("0-4294967295") no puede disparar bucles ni reservas sin fin.
+#define CPU_ID_LIMIT 8192
+
+// Siguiente rango "lo" o "lo-hi" de una lista de sysfs, con hi acotado a
+// CPU_ID_LIMIT - 1. Devuelve el resto, o NULL si no hay (o está mal formado).
+static const char *next_cpu_range(const char *p, unsigned long long *lo, unsigned long long *hi) {
+    if (*p < '0' || *p > '9') return NULL;
+    p = pf_parse_ull(p, lo);
+    *hi = *lo;
+    if (*p == '-') {
+        const char *q = pf_parse_ull(p + 1, hi);
+        if (q == p + 1) return NULL;
+        p = q;
+    }
+    if (*hi < *lo || *lo >= CPU_ID_LIMIT) return NULL;
+    if (*hi >= CPU_ID_LIMIT) *hi = CPU_ID_LIMIT - 1;
+    return p;
+}
+
+// Parsea una lista de CPUs de sysfs ("0-3,5,8-191") y marca mask[id] = 1.
+// Devuelve (id más alto encontrado) + 1, aunque ese id no quepa en 'mask'.
+static int parse_cpu_list(const char *p, unsigned char *mask, int n) {
+    int max_id = -1;
+    unsigned long long lo, hi;
+    while ((p = next_cpu_range(p, &lo, &hi)) != NULL) {
+        // Sin máscara solo interesa el id más alto
+        if (mask && n > 0 && lo < (unsigned long long)n) {
+            unsigned long long end = hi < (unsigned long long)n ? hi : (unsigned long long)n - 1;
+            memset(mask + lo, 1, (size_t)(end - lo + 1));
+        }
+        if ((int)hi > max_id) max_id = (int)hi;
+        if (*p != ',') break;
+        p++;
+    }
+    return max_id + 1;
+}
+
+// Cantidad de CPUs en una lista de sysfs ("0-3,5" → 5).
+static int count_cpu_list(const char *p) {
+    int count = 0;
+    unsigned long long lo, hi;
+    while ((p = next_cpu_range(p, &lo, &hi)) != NULL) {
+        count += (int)(hi - lo + 1);
+        if (*p != ',') break;
+        p++;
+    }
+    return count < CPU_ID_LIMIT ? count : CPU_ID_LIMIT;
+}
+
+// CPUs listadas en un archivo de lista de sysfs (0 si no existe).
+static int read_cpu_list_count(const char *path) {
+    ProcFile pf = PROCFILE_INIT;
+    if (procfile_open(&pf, path, 128) != 0) return 0;
+    int n = (procfile_read(&pf) == 0) ? count_cpu_list(pf.buf) : 0;
+    procfile_close(&pf);
+    return n;
+}
+
+// Número de ids posibles según /sys/devices/system/cpu/possible (0 si no existe).
+static int read_possible_cpus(void) {
+    ProcFile pf = PROCFILE_INIT;
+    if (procfile_open(&pf, "/sys/devices/system/cpu/possible", 128) != 0) return 0;
+    int n = (procfile_read(&pf) == 0) ? parse_cpu_list(pf.buf, NULL, 0) : 0;
+    procfile_close(&pf);
+    return n;
+}
+
+int cpu_possible_count(void) {
+    int possible = read_possible_cpus();
+    long conf = sysconf(_SC_NPROCESSORS_CONF);
+    if (conf > possible) possible = (int)conf;
+    return possible > 0 ? possible : 1;
+}
+
+// ---------- CPUUsage dinámico ----------
+void cpu_usage_init(CPUUsage *u) {
+    if (u) memset(u, 0, sizeof(*u));
+}
+
+int cpu_usage_reserve(CPUUsage *u, int cores) {
+    if (!u || cores < 0) return 1;
+    if (cores <= u->cap) return 0;
+    int ncap = u->cap > 0 ? u->cap : 8;
+    while (ncap < cores) ncap *= 2;
+
+    double *pc = realloc(u->per_core, (size_t)ncap * sizeof(*pc));
+    if (!pc) return 3;
+    u->per_core = pc;
+    unsigned char *st = realloc(u->state, (size_t)ncap * sizeof(*st));
+    if (!st) return 3;
+    u->state = st;
+    CPUTimes *tm = realloc(u->times, (size_t)ncap * sizeof(*tm));
+    if (!tm) return 3;
+    u->times = tm;
+
+    memset(u->per_core + u->cap, 0, (size_t)(ncap - u->cap) * sizeof(*pc));
+    memset(u->state + u->cap, CPU_CORE_OFFLINE, (size_t)(ncap - u->cap) * sizeof(*st));
+    memset(u->times + u->cap, 0, (size_t)(ncap - u->cap) * sizeof(*tm));
+    u->cap = ncap;
+    return 0;
+}
+
+void cpu_usage_free(CPUUsage *u) {
+    if (!u) return;
+    free(u->per_core);
+    free(u->state);
+    free(u->times);
+    memset(u, 0, sizeof(*u));
+}
+
 // ---------- Actividad 5 ----------
-// guardamos snapshot previo para deltas
-#define MAX_CPUS_INTERNAL 128
-static unsigned long long prev_total[MAX_CPUS_INTERNAL];
-static unsigned long long prev_idle [MAX_CPUS_INTERNAL];
-static int prev_cores = -1;
-static int initialized = 0;
+// Cada sampler guarda su propio snapshot previo para los deltas y su propio
+// handle a /proc/stat, así varios pueden convivir (p. ej. 250 ms y 10 s) y
+// cada uno puede usarse desde un hilo distinto.
+//
+// Los arreglos se indexan por id real de CPU ("cpuN" → N) y crecen solo cuando
+// aparece un id mayor que los conocidos; al crear el sampler ya se reservan
+// todos los ids de /sys/devices/system/cpu/possible.
+// Columnas de /proc/stat que usamos. guest/guest_nice ya están incluidos en
+// user/nice por el kernel, así que no se suman aparte.
+enum {
+    ST_USER, ST_NICE, ST_SYSTEM, ST_IDLE, ST_IOWAIT, ST_IRQ, ST_SOFTIRQ, ST_STEAL,
+    ST_COUNT
+};
 
-int cpu_read_usage(CPUUsage *out) {
-    if (!out) return 1;
-    memset(out, 0, sizeof(*out));
+struct CPUSampler {
+    ProcFile stat;      // /proc/stat abierto una vez, releído con pread()
+    ProcFile online;    // /sys/devices/system/cpu/online (fd < 0 si no existe)
+    int      cap;       // tamaño de los arreglos por core
+    unsigned long long *prev;        // ST_COUNT contadores por core
+    unsigned long long  prev_all[ST_COUNT];  // línea agregada "cpu "
+    unsigned char      *prev_valid;  // 1 = el core apareció en la muestra anterior
+    unsigned char      *seen;        // scratch: el core aparece en esta muestra
+    unsigned char      *online_mask; // scratch: estado según sysfs
+    // Contadores globales de la muestra anterior (ctxt, intr, processes)
+    unsigned long long prev_ctxt, prev_intr, prev_forks;
+    struct timespec    prev_ts;          // CLOCK_MONOTONIC de la muestra anterior
+    double             clk_tck;          // USER_HZ (ticks por segundo en /proc/stat)
+    int initialized;
+};
+
+static int sampler_reserve(CPUSampler *s, int cores) {
+    if (cores <= s->cap) return 0;
+    int ncap = s->cap > 0 ? s->cap : 8;
+    while (ncap < cores) ncap *= 2;
 
-    FILE *f = fopen("/proc/stat", "r");
-    if (!f) {
-        out->ready = 0;
-        return 2;
+    unsigned long long *pr = realloc(s->prev, (size_t)ncap * ST_COUNT * sizeof(*pr));
+    if (!pr) return 3;
+    s->prev = pr;
+    unsigned char *pv = realloc(s->prev_valid, (size_t)ncap);
+    if (!pv) return 3;
+    s->prev_valid = pv;
+    unsigned char *sn = realloc(s->seen, (size_t)ncap);
+    if (!sn) return 3;
+    s->seen = sn;
+    unsigned char *om = realloc(s->online_mask, (size_t)ncap);
+    if (!om) return 3;
+    s->online_mask = om;
+
+    size_t extra = (size_t)(ncap - s->cap);
+    memset(s->prev + (size_t)s->cap * ST_COUNT, 0, extra * ST_COUNT * sizeof(*pr));
+    memset(s->prev_valid + s->cap, 0, extra);
+    s->cap = ncap;
+    return 0;
+}
+
+CPUSampler *cpu_sampler_create(void) {
+    CPUSampler *s = calloc(1, sizeof(*s));
+    if (!s) return NULL;
+    s->online.fd = -1;
+    // 16 KiB cubren ~150 cores; si no alcanza, procfile_read() lo agranda una vez.
+    if (procfile_open(&s->stat, "/proc/stat", 16384) != 0) {
+        free(s);
+        return NULL;
     }
+    // Opcional: sin sysfs (algunos contenedores) usamos la presencia en /proc/stat.
+    (void)procfile_open(&s->online, "/sys/devices/system/cpu/online", 256);
 
-    // saltamos la línea "cpu " (global)
-    char line[512];
-    if (!fgets(line, sizeof(line), f)) { fclose(f); return 3; }
+    long tck = sysconf(_SC_CLK_TCK);
+    s->clk_tck = tck > 0 ? (double)tck : 100.0;
 
-    int core_idx = 0;
-    while (fgets(line, sizeof(line), f)) {
-        if (strncmp(line, "cpu", 3) != 0) break;
-        if (line[3] < '0' || line[3] > '9') break;   // no es cpuN
+    if (sampler_reserve(s, cpu_possible_count()) != 0) {
+        cpu_sampler_destroy(s);
+        return NULL;
+    }
+    return s;
+}
 
-        // Campos: user nice system idle iowait irq softirq steal guest guest_nice
-        unsigned long long user=0, nice=0, system=0, idle=0, iowait=0, irq=0, softirq=0, steal=0, guest=0, guest_nice=0;
-        int scanned = sscanf(line, "cpu%d %llu %llu %llu %llu %llu %llu %llu %llu %llu %llu",
-                             &core_idx, &user, &nice, &system, &idle, &iowait, &irq, &softirq, &steal, &guest, &guest_nice);
-        if (scanned < 5) break; // al menos hasta idle
-
-        unsigned long long idle_all = idle + iowait;
-        unsigned long long non_idle = user + nice + system + irq + softirq + steal;
-        unsigned long long total = idle_all + non_idle;
-
-        if (!initialized) {
-            if (core_idx < MAX_CPUS_INTERNAL) {
-                prev_total[core_idx] = total;
-                prev_idle [core_idx] = idle_all;
-            }
-        } else {
-            if (core_idx < MAX_CPUS_INTERNAL) {
-                unsigned long long dt = total > prev_total[core_idx] ? (total - prev_total[core_idx]) : 0ULL;
-                unsigned long long di = idle_all > prev_idle[core_idx] ? (idle_all - prev_idle[core_idx]) : 0ULL;
-                double ratio = 0.0;
-                if (dt > 0ULL) ratio = (double)(dt - di) / (double)dt;
-                if (out->cores < CPU_MAX_CORES) {
-                    out->per_core[out->cores] = (ratio < 0.0) ? 0.0 : (ratio > 1.0 ? 1.0 : ratio);
-                    out->avg += out->per_core[out->cores];
-                    out->cores++;
-                }
-                prev_total[core_idx] = total;
-                prev_idle [core_idx] = idle_all;
+void cpu_sampler_destroy(CPUSampler *s) {
+    if (!s) return;
+    procfile_close(&s->stat);
+    procfile_close(&s->online);
+    free(s->prev);
+    free(s->prev_valid);
+    free(s->seen);
+    free(s->online_mask);
+    free(s);
+}
+
+// Lee hasta 10 columnas tras "cpu"/"cpuN"; deja en 'f' las ST_COUNT primeras.
+// Devuelve el puntero tras el último número, o NULL si no llega hasta idle.
+static const char *parse_stat_fields(const char *q, unsigned long long f[ST_COUNT]) {
+    unsigned long long extra;
+    int scanned = 0;
+    for (; scanned < 10; ++scanned) {
+        const char *nq = pf_parse_ull(q, scanned < ST_COUNT ? &f[scanned] : &extra);
+        if (nq == q) break;
+        q = nq;
+    }
+    for (int i = scanned; i < ST_COUNT; ++i) f[i] = 0;
+    return scanned > ST_IDLE ? q : NULL;
+}
+
+// Convierte el delta entre dos lecturas en fracciones por estado.
+// Devuelve 0 si el delta no es utilizable (contadores que retroceden o sin tiempo).
+// iowait puede decrecer en algunos kernels: los deltas negativos cuentan como 0.
+//
+// 'expected' son los ticks que debieron transcurrir según el reloj monotónico
+// (intervalo medido × USER_HZ × nº de CPUs de la línea). A intervalos cortos
+// (100 ms ≈ 10 ticks por core) la suma de columnas oscila ±1 tick; dividir por
+// max(suma, esperado) evita inflar el uso cuando la suma se queda corta.
+static int delta_times(const unsigned long long *cur, const unsigned long long *prev,
+                       double expected, CPUTimes *t) {
+    unsigned long long d[ST_COUNT];
+    unsigned long long cur_total = 0, prev_total = 0, dt = 0;
+    for (int i = 0; i < ST_COUNT; ++i) {
+        cur_total  += cur[i];
+        prev_total += prev[i];
+        d[i] = cur[i] > prev[i] ? cur[i] - prev[i] : 0ULL;
+        dt += d[i];
+    }
+    if (cur_total < prev_total || dt == 0ULL) return 0;
+
+    double denom = (double)dt;
+    if (expected > denom) denom = expected;
+    double inv = 1.0 / denom;
+    t->user    = (double)d[ST_USER]    * inv;
+    t->nice    = (double)d[ST_NICE]    * inv;
+    t->system  = (double)d[ST_SYSTEM]  * inv;
+    t->idle    = (double)d[ST_IDLE]    * inv;
+    t->iowait  = (double)d[ST_IOWAIT]  * inv;
+    t->irq     = (double)d[ST_IRQ]     * inv;
+    t->softirq = (double)d[ST_SOFTIRQ] * inv;
+    t->steal   = (double)d[ST_STEAL]   * inv;
+    return 1;
+}
+
+// Resto de /proc/stat tras las líneas cpuN: contadores del kernel.
+// "intr" y "softirq" traen cientos de columnas; solo usamos el total (la primera).
+static void parse_kernel_counters(const char *p, CPUKernelStats *k,
+                                  unsigned long long *ctxt, unsigned long long *intr,
+                                  unsigned long long *forks) {
+    while (*p) {
+        unsigned long long v = 0;
+        switch (p[0]) {
+        case 'c':
+            if (strncmp(p, "ctxt ", 5) == 0) { pf_parse_ull(p + 5, &v); *ctxt = v; }
+            break;
+        case 'i':
+            if (strncmp(p, "intr ", 5) == 0) { pf_parse_ull(p + 5, &v); *intr = v; }
+            break;
+        case 'p':
+            if (strncmp(p, "processes ", 10) == 0) {
+                pf_parse_ull(p + 10, &v); *forks = v;
+            } else if (strncmp(p, "procs_running ", 14) == 0) {
+                pf_parse_ull(p + 14, &v); k->procs_running = (int)v;
+            } else if (strncmp(p, "procs_blocked ", 14) == 0) {
+                pf_parse_ull(p + 14, &v); k->procs_blocked = (int)v;
             }
+            break;
+        default: break;
         }
+        p = pf_next_line(p);
     }
-    fclose(f);
+}
 
-    if (!initialized) {
-        initialized = 1;
-        prev_cores = core_idx + 1;
-        out->ready = 0; // primera lectura: aún no hay delta
-        return 0;
+static double ts_diff_s(const struct timespec *a, const struct timespec *b) {
+    return (double)(a->tv_sec - b->tv_sec) + (double)(a->tv_nsec - b->tv_nsec) / 1e9;
+}
+
+static double rate(unsigned long long cur, unsigned long long prev, double dt_s) {
+    return (cur >= prev && dt_s > 0.0) ? (double)(cur - prev) / dt_s : 0.0;
+}
+
+int cpu_sampler_sample(CPUSampler *s, CPUUsage *out) {
+    if (!s || !out) return 1;
+    out->cores = 0;
+    out->online_count = 0;
+    out->avg = 0.0;
+    out->ready = 0;
+    out->interval_s = 0.0;
+    memset(&out->total, 0, sizeof(out->total));
+    memset(&out->kstat, 0, sizeof(out->kstat));
+
+    if (procfile_read(&s->stat) != 0) return 2;
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    if (s->initialized) out->interval_s = ts_diff_s(&now, &s->prev_ts);
+    double ticks_per_core = out->interval_s * s->clk_tck;   // 0 en la primera muestra
+
+    // Estado en línea según sysfs (si está disponible).
+    int have_online = 0;
+    int online_n = 0;
+    if (s->online.fd >= 0 && procfile_read(&s->online) == 0) {
+        online_n = parse_cpu_list(s->online.buf, NULL, 0);
+        if (sampler_reserve(s, online_n) != 0) return 3;
+        memset(s->online_mask, 0, (size_t)s->cap);
+        parse_cpu_list(s->online.buf, s->online_mask, s->cap);
+        have_online = 1;
     }
+    memset(s->seen, 0, (size_t)s->cap);
+
+    // Línea "cpu " (agregada): desglose global
+    const char *p = s->stat.buf;
+    if (strncmp(p, "cpu ", 4) != 0) return 3;
+    unsigned long long all[ST_COUNT];
+    const char *q0 = parse_stat_fields(p + 3, all);
+    if (!q0) return 3;
+    p = pf_next_line(q0);
+
+    int n_slots = online_n;
+    while (p[0] == 'c' && p[1] == 'p' && p[2] == 'u') {
+        if (p[3] < '0' || p[3] > '9') break;   // no es cpuN
 
-    if (out->cores > 0) out->avg /= (double)out->cores;
+        unsigned long long id = 0;
+        const char *q = pf_parse_ull(p + 3, &id);
+        if (id >= CPU_ID_LIMIT) break;         // id absurdo: formato inesperado
+        int core_idx = (int)id;
+
+        // Campos: user nice system idle iowait irq softirq steal guest guest_nice
+        unsigned long long f[ST_COUNT];
+        q = parse_stat_fields(q, f);
+        if (!q) break;
+        p = pf_next_line(q);
+
+        if (sampler_reserve(s, core_idx + 1) != 0) return 3;
+        if (cpu_usage_reserve(out, core_idx + 1) != 0) return 3;
+        if (core_idx + 1 > n_slots) n_slots = core_idx + 1;
+
+        // Delta válido solo si el core estaba en la muestra anterior y sus
+        // contadores no retrocedieron (p. ej. tras un hotplug).
+        unsigned long long *prev = s->prev + (size_t)core_idx * ST_COUNT;
+        CPUTimes *t = &out->times[core_idx];
+        memset(t, 0, sizeof(*t));
+        int valid = s->initialized && s->prev_valid[core_idx] &&
+                    delta_times(f, prev, ticks_per_core, t);
+        double ratio = valid ? t->user + t->nice + t->system + t->irq + t->softirq + t->steal : 0.0;
+        out->per_core[core_idx] = (ratio < 0.0) ? 0.0 : (ratio > 1.0 ? 1.0 : ratio);
+        out->state[core_idx] = valid ? CPU_CORE_ONLINE : CPU_CORE_PENDING;
+        if (valid) {
+            out->avg += out->per_core[core_idx];
+            out->online_count++;
+        }
+
+        memcpy(prev, f, sizeof(f));
+        s->seen[core_idx] = 1;
+    }
+
+    // Slots sin línea en /proc/stat: offline (o recién apagados). Sus deltas
+    // previos se descartan para no mezclar contadores de antes y después.
+    if (cpu_usage_reserve(out, n_slots) != 0) return 3;
+    for (int i = 0; i < n_slots; ++i) {
+        if (!s->seen[i]) {
+            out->per_core[i] = 0.0;
+            memset(&out->times[i], 0, sizeof(out->times[i]));
+            out->state[i] = (have_online && i < s->cap && s->online_mask[i])
+                          ? CPU_CORE_PENDING : CPU_CORE_OFFLINE;
+        }
+    }
+    memcpy(s->prev_valid, s->seen, (size_t)s->cap);
+    out->cores = n_slots;
+
+    // Desglose agregado: la línea "cpu " suma todos los cores presentes.
+    int present = 0;
+    for (int i = 0; i < n_slots; ++i) present += s->seen[i];
+    if (s->initialized) delta_times(all, s->prev_all, ticks_per_core * (double)present, &out->total);
+    memcpy(s->prev_all, all, sizeof(all));
+
+    // Mismo buffer, misma pasada: ctxt/intr/processes/procs_* sin syscalls extra.
+    CPUKernelStats *k = &out->kstat;
+    parse_kernel_counters(p, k, &k->ctxt, &k->intr, &k->forks);
+    if (s->initialized) {
+        k->ctxt_per_s  = rate(k->ctxt,  s->prev_ctxt,  out->interval_s);
+        k->intr_per_s  = rate(k->intr,  s->prev_intr,  out->interval_s);
+        k->forks_per_s = rate(k->forks, s->prev_forks, out->interval_s);
+    }
+    s->prev_ctxt = k->ctxt; s->prev_intr = k->intr; s->prev_forks = k->forks;
+    s->prev_ts = now;
+
+    if (!s->initialized) {
+        s->initialized = 1;
+        return 0; // primera lectura: aún no hay delta (ready = 0)
+    }
+
+    if (out->online_count > 0) out->avg /= (double)out->online_count;
     out->ready = 1;
     return 0;
 }
+
+// Compatibilidad: instancia por defecto, creada en la primera llamada.
+// (Como antes, esta variante no es reentrante; usa cpu_sampler_* si necesitas varias.)
+static CPUSampler *g_default_sampler = NULL;
+
+int cpu_read_usage(CPUUsage *out) {
+    if (!out) return 1;
+    if (!g_default_sampler) {
+        g_default_sampler = cpu_sampler_create();
+        if (!g_default_sampler) return 2;
+    }
+    return cpu_sampler_sample(g_default_sampler, out);
+}
@@ -0,0 +1,235 @@
+#include "disk.h"
+#include "procfile.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+// Columnas de /proc/diskstats tras "major minor nombre" (las 11 que existen
+// desde 2.6; los campos de discard/flush de kernels nuevos se ignoran).
+enum {
+    DS_READS = 0,      // lecturas completadas
+    DS_READS_MERGED,
+    DS_SECT_READ,      // sectores de 512 B leídos
+    DS_MS_READ,        // ms gastados en lecturas
+    DS_WRITES,
+    DS_WRITES_MERGED,
+    DS_SECT_WRITTEN,
+    DS_MS_WRITE,
+    DS_IN_FLIGHT,      // E/S en curso (no es contador)
+    DS_MS_IO,          // ms con al menos una E/S en curso
+    DS_MS_WEIGHTED,    // ms ponderados por nº de E/S en curso
+    DS_COUNT
+};
+
+#define SECTOR_BYTES 512.0
+
+// Tabla de nombres vistos: además de los discos guarda las particiones y
+// demás dispositivos descartados, para no consultar sysfs en cada muestra.
+// Crece al aparecer dispositivos nuevos (nunca descarta un disco por falta de
+// sitio); loop y ram se descartan por nombre sin ocupar entrada, que un host
+// con snaps tiene decenas.
+#define DISK_TRACK_INIT 32
+
+enum { TRACK_FREE = 0, TRACK_DISK, TRACK_IGNORED };
+
+typedef struct {
+    char               name[DISK_NAME_MAX];
+    unsigned char      kind;        // TRACK_*
+    unsigned char      seen;        // aparece en la muestra actual
+    unsigned char      prev_valid;  // prev[] es de la muestra anterior
+    unsigned long long prev[DS_COUNT];
+} DiskTrack;
+
+struct DiskSampler {
+    ProcFile        file;            // /proc/diskstats abierto una vez
+    DiskTrack      *track;           // [track_cap]
+    int             track_cap;
+    struct timespec prev_ts;         // CLOCK_MONOTONIC de la muestra anterior
+    int             initialized;
+};
+
+DiskSampler *disk_sampler_create(void) {
+    DiskSampler *s = calloc(1, sizeof(*s));
+    if (!s) return NULL;
+    s->file = (ProcFile)PROCFILE_INIT;
+    s->track = calloc(DISK_TRACK_INIT, sizeof(*s->track));
+    if (!s->track || procfile_open(&s->file, "/proc/diskstats", 4096) != 0) {
+        free(s->track);
+        free(s);
+        return NULL;
+    }
+    s->track_cap = DISK_TRACK_INIT;
+    return s;
+}
+
+void disk_sampler_destroy(DiskSampler *s) {
+    if (!s) return;
+    procfile_close(&s->file);
+    free(s->track);
+    free(s);
+}
+
+// loop y ram nunca son discos que interese mostrar
+static int ignored_by_name(const char *name, size_t len) {
+    return (len >= 4 && strncmp(name, "loop", 4) == 0) || (len >= 3 && strncmp(name, "ram", 3) == 0);
+}
+
+// Un disco completo tiene /sys/block/<nombre> ("/" del nombre se escribe "!").
+static int is_whole_disk(const char *name) {
+    char rel[16 + DISK_NAME_MAX], path[512];
+    snprintf(rel, sizeof(rel), "/sys/block/%s", name);
+    for (char *c = rel + 11; *c; ++c) if (*c == '/') *c = '!';
+    const char *p = procfs_path(rel, path, sizeof(path));
+    return p && access(p, F_OK) == 0;
+}
+
+// Busca 'name' empezando por 'hint' (el orden de /proc/diskstats casi nunca
+// cambia, así que suele acertar a la primera). Si no está, lo registra;
+// NULL solo si no hay memoria para agrandar la tabla.
+static DiskTrack *track_find(DiskSampler *s, const char *name, size_t len, int *hint) {
+    for (int k = 0; k < s->track_cap; ++k) {
+        int i = (*hint + k) % s->track_cap;
+        DiskTrack *t = &s->track[i];
+        if (t->kind != TRACK_FREE && strncmp(t->name, name, len) == 0 && t->name[len] == '\0') {
+            *hint = i + 1;
+            return t;
+        }
+    }
+    int i = 0;
+    while (i < s->track_cap && s->track[i].kind != TRACK_FREE) i++;
+    if (i == s->track_cap) {
+        int cap = s->track_cap * 2;
+        DiskTrack *nt = realloc(s->track, (size_t)cap * sizeof(*nt));
+        if (!nt) return NULL;
+        memset(&nt[s->track_cap], 0, (size_t)(cap - s->track_cap) * sizeof(*nt));
+        s->track = nt;
+        s->track_cap = cap;
+    }
+    {
+        DiskTrack *t = &s->track[i];
+        memcpy(t->name, name, len);
+        t->name[len] = '\0';
+        t->kind = is_whole_disk(t->name) ? TRACK_DISK : TRACK_IGNORED;
+        t->prev_valid = 0;
+        *hint = i + 1;
+        return t;
+    }
+}
+
+static void fill_dev(DiskDev *d, const DiskTrack *t, const unsigned long long *v, double dt) {
+    memset(d, 0, sizeof(*d));
+    memcpy(d->name, t->name, sizeof(d->name));
+    d->in_flight = (unsigned)v[DS_IN_FLIGHT];
+    if (!t->prev_valid || dt <= 0.0) return;
+
+    unsigned long long reads  = pf_counter_delta(v[DS_READS], t->prev[DS_READS]);
+    unsigned long long writes = pf_counter_delta(v[DS_WRITES], t->prev[DS_WRITES]);
+    unsigned long long ms_r   = pf_counter_delta(v[DS_MS_READ], t->prev[DS_MS_READ]);
+    unsigned long long ms_w   = pf_counter_delta(v[DS_MS_WRITE], t->prev[DS_MS_WRITE]);
+    unsigned long long ms_io  = pf_counter_delta(v[DS_MS_IO], t->prev[DS_MS_IO]);
+    unsigned long long ms_q   = pf_counter_delta(v[DS_MS_WEIGHTED], t->prev[DS_MS_WEIGHTED]);
+
+    d->ready  = 1;
+    d->r_iops = (double)reads / dt;
+    d->w_iops = (double)writes / dt;
+    d->r_bps  = (double)pf_counter_delta(v[DS_SECT_READ], t->prev[DS_SECT_READ]) * SECTOR_BYTES / dt;
+    d->w_bps  = (double)pf_counter_delta(v[DS_SECT_WRITTEN], t->prev[DS_SECT_WRITTEN]) * SECTOR_BYTES / dt;
+    d->r_await_ms = reads  ? (double)ms_r / (double)reads  : 0.0;
+    d->w_await_ms = writes ? (double)ms_w / (double)writes : 0.0;
+    d->svc_ms = (reads + writes) ? (double)ms_io / (double)(reads + writes) : 0.0;
+    d->util   = (double)ms_io / (dt * 1000.0);
+    if (d->util > 1.0) d->util = 1.0;
+    d->queue  = (double)ms_q / (dt * 1000.0);
+}
+
+static void add_total(DiskStats *out, const DiskDev *d) {
+    if (!d->ready) return;
+    out->total_r_iops += d->r_iops;
+    out->total_w_iops += d->w_iops;
+    out->total_r_bps  += d->r_bps;
+    out->total_w_bps  += d->w_bps;
+    out->total_queue  += d->queue;
+    if (d->util > out->max_util) out->max_util = d->util;
+}
+
+int disk_sampler_sample(DiskSampler *s, DiskStats *out) {
+    if (!s || !out) return 1;
+    if (procfile_read(&s->file) != 0) return 2;
+
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    double dt = (double)(now.tv_sec - s->prev_ts.tv_sec) +
+                (double)(now.tv_nsec - s->prev_ts.tv_nsec) / 1e9;
+    if (!s->initialized) dt = 0.0;
+
+    out->ready = s->initialized;
+    out->interval_s = dt;
+    out->count = 0;
+    out->omitted = 0;
+    out->untracked = 0;
+    out->total_r_iops = out->total_w_iops = 0.0;
+    out->total_r_bps = out->total_w_bps = 0.0;
+    out->total_queue = out->max_util = 0.0;
+
+    for (int i = 0; i < s->track_cap; ++i) s->track[i].seen = 0;
+
+    // "   8       0 sda 1234 5 678 ..." — una línea por dispositivo
+    int hint = 0;
+    const char *p = s->file.buf;
+    while (*p) {
+        unsigned long long major, minor;
+        const char *q = pf_parse_ull(p, &major);
+        const char *r = (q != p) ? pf_parse_ull(q, &minor) : q;
+        if (q == p || r == q) { p = pf_next_line(p); continue; }
+        const char *name = pf_skip_spaces(r);
+        const char *e = name;
+        while (*e && *e != ' ' && *e != '\n') e++;
+        size_t len = (size_t)(e - name);
+        if (len == 0 || len >= DISK_NAME_MAX) { p = pf_next_line(e); continue; }
+
+        if (ignored_by_name(name, len)) { p = pf_next_line(e); continue; }
+        DiskTrack *t = track_find(s, name, len, &hint);
+        if (!t) {
+            // Sin memoria para seguirlo: si es un disco, que al menos se note
+            char tmp[DISK_NAME_MAX];
+            memcpy(tmp, name, len);
+            tmp[len] = '\0';
+            if (is_whole_disk(tmp)) out->untracked++;
+            p = pf_next_line(e);
+            continue;
+        }
+        if (t->kind != TRACK_DISK) { t->seen = 1; p = pf_next_line(e); continue; }
+
+        unsigned long long v[DS_COUNT];
+        int n = 0;
+        const char *c = e;
+        while (n < DS_COUNT) {
+            const char *nx = pf_parse_ull(c, &v[n]);
+            if (nx == c) break;
+            c = nx;
+            n++;
+        }
+        p = pf_next_line(c);
+        if (n < DS_COUNT) continue;   // línea corta (kernel muy viejo): sin datos
+
+        t->seen = 1;
+        // Los que no caben en dev[] se miden igual: cuentan en el agregado
+        DiskDev spill;
+        DiskDev *d = (out->count < DISK_MAX) ? &out->dev[out->count++] : &spill;
+        if (d == &spill) out->omitted++;
+        fill_dev(d, t, v, dt);
+        add_total(out, d);
+        memcpy(t->prev, v, sizeof(t->prev));
+        t->prev_valid = 1;
+    }
+
+    // Los que desaparecieron (USB desconectado) liberan su entrada
+    for (int i = 0; i < s->track_cap; ++i)
+        if (!s->track[i].seen) s->track[i].kind = TRACK_FREE;
+
+    s->prev_ts = now;
+    s->initialized = 1;
+    return 0;
+}
@@ -0,0 +1,760 @@
+#include "export.h"
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+// Cota por core: "0.1234," (JSON: también "null,"); la parte fija cabe de sobra
+// en 4 KiB, cada disco o interfaz del JSON ocupa menos de 384 B, el objeto
+// "psi" menos de 768 B, cada proceso de los rankings menos de 192 B (comm
+// escapado incluido), cada policy de cpufreq menos de 128 B, cada zona
+// térmica menos de 96 B, el objeto "cgroup" sin hijos menos de 1 KiB, cada
+// hijo menos de 384 B (nombre escapado incluido), el objeto "irq" sin núcleos
+// menos de 256 B y cada núcleo caliente con sus fuentes menos de 512 B.
+// Prometheus: las líneas HELP/TYPE y las métricas fijas caben en 8 KiB y
+// cada core ocupa menos de 64 B
+#define EXPORT_FIXED_BYTES 4096
+#define EXPORT_CORE_BYTES  16
+#define EXPORT_DISK_BYTES  384
+#define EXPORT_NET_BYTES   384
+#define EXPORT_PSI_BYTES   768
+#define EXPORT_PROC_BYTES  192
+#define EXPORT_POLICY_BYTES 128
+#define EXPORT_ZONE_BYTES   96
+#define EXPORT_CGROUP_BYTES 1024
+#define EXPORT_CHILD_BYTES  384
+#define EXPORT_IRQ_BYTES    256
+#define EXPORT_HOT_BYTES    512
+#define EXPORT_PROM_BYTES      8192
+#define EXPORT_PROM_CORE_BYTES 64
+
+// ---------- Formateadores sobre el buffer ----------
+static void ob_mem(Exporter *e, const char *s, size_t n) {
+    if (e->len + n >= e->cap) { e->overflow = 1; return; }
+    memcpy(e->buf + e->len, s, n);
+    e->len += n;
+}
+
+#define OB_LIT(e, lit) ob_mem((e), (lit), sizeof(lit) - 1)
+
+static void ob_u64(Exporter *e, unsigned long long v) {
+    char tmp[24];
+    int n = 0;
+    do { tmp[sizeof(tmp) - 1 - (size_t)n++] = (char)('0' + (int)(v % 10u)); v /= 10u; } while (v);
+    ob_mem(e, tmp + sizeof(tmp) - (size_t)n, (size_t)n);
+}
+
+static void ob_i64(Exporter *e, long long v) {
+    if (v < 0) { OB_LIT(e, "-"); ob_u64(e, (unsigned long long)(-(v + 1)) + 1u); }
+    else ob_u64(e, (unsigned long long)v);
+}
+
+// Punto fijo con 'dec' decimales (0..6). NaN/inf no llegan aquí.
+static void ob_fix(Exporter *e, double v, int dec) {
+    static const unsigned long long pow10[] = { 1, 10, 100, 1000, 10000, 100000, 1000000 };
+    if (v < 0) { OB_LIT(e, "-"); v = -v; }
+    unsigned long long p = pow10[dec];
+    unsigned long long scaled = (unsigned long long)(v * (double)p + 0.5);
+    ob_u64(e, scaled / p);
+    if (dec == 0) return;
+    char frac[8];
+    unsigned long long f = scaled % p;
+    for (int i = dec - 1; i >= 0; --i) { frac[i] = (char)('0' + (int)(f % 10u)); f /= 10u; }
+    OB_LIT(e, ".");
+    ob_mem(e, frac, (size_t)dec);
+}
+
+// Época Unix con milisegundos: "1729170000.123"
+static void ob_ts(Exporter *e, const struct timespec *ts) {
+    long ms = ts->tv_nsec / 1000000L;
+    char d[4] = { '.', (char)('0' + ms / 100), (char)('0' + ms / 10 % 10), (char)('0' + ms % 10) };
+    ob_i64(e, (long long)ts->tv_sec);
+    ob_mem(e, d, 4);
+}
+
+// ---------- JSON Lines ----------
+static void json_key(Exporter *e, const char *k, int first) {
+    if (!first) OB_LIT(e, ",");
+    OB_LIT(e, "\"");
+    ob_mem(e, k, strlen(k));
+    OB_LIT(e, "\":");
+}
+
+// Cadena JSON; los nombres de dispositivo son ASCII, pero por si acaso se
+// escapan comillas y barras y se descartan los caracteres de control.
+static void json_str(Exporter *e, const char *s) {
+    OB_LIT(e, "\"");
+    for (; *s; ++s) {
+        if (*s == '"' || *s == '\\') { OB_LIT(e, "\\"); ob_mem(e, s, 1); }
+        else if ((unsigned char)*s >= 0x20) ob_mem(e, s, 1);
+    }
+    OB_LIT(e, "\"");
+}
+
+static void format_json(Exporter *e, const Snapshot *s) {
+    OB_LIT(e, "{");
+    json_key(e, "seq", 1); ob_u64(e, s->seq);
+    json_key(e, "ts", 0);  ob_ts(e, &s->ts);
+
+    json_key(e, "mem", 0);
+    if (s->mem_rc == 0) {
+        const MemStats *m = &s->mem;
+        OB_LIT(e, "{");
+        json_key(e, "total_kib", 1);       ob_i64(e, m->total_kib);
+        json_key(e, "avail_kib", 0);       ob_i64(e, m->avail_kib);
+        json_key(e, "used_kib", 0);        ob_i64(e, m->used_kib);
+        json_key(e, "used_ratio", 0);      ob_fix(e, m->used_ratio, 4);
+        json_key(e, "swap_total_kib", 0);  ob_i64(e, m->swap_total_kib);
+        json_key(e, "swap_used_kib", 0);   ob_i64(e, m->swap_used_kib);
+        json_key(e, "swap_used_ratio", 0); ob_fix(e, m->swap_total_kib > 0 ? m->swap_used_ratio : 0.0, 4);
+        json_key(e, "free_kib", 0);        ob_i64(e, m->free_kib);
+        json_key(e, "buffers_kib", 0);     ob_i64(e, m->buffers_kib);
+        json_key(e, "cached_kib", 0);      ob_i64(e, m->cached_kib);
+        json_key(e, "anon_kib", 0);        ob_i64(e, m->anon_kib);
+        json_key(e, "shmem_kib", 0);       ob_i64(e, m->shmem_kib);
+        json_key(e, "slab_kib", 0);        ob_i64(e, m->slab_kib);
+        json_key(e, "dirty_kib", 0);       ob_i64(e, m->dirty_kib);
+        json_key(e, "writeback_kib", 0);   ob_i64(e, m->writeback_kib);
+        json_key(e, "committed_kib", 0);   ob_i64(e, m->committed_kib);
+        json_key(e, "commit_limit_kib", 0); ob_i64(e, m->commit_limit_kib);
+        json_key(e, "huge_total", 0);      ob_i64(e, m->huge_total);
+        json_key(e, "huge_free", 0);       ob_i64(e, m->huge_free);
+        OB_LIT(e, "}");
+    } else {
+        OB_LIT(e, "null");
+    }
+
+    const CPUUsage *u = &s->cpu;
+    int ready = (s->cpu_rc == 0 && u->ready);
+    json_key(e, "cpu", 0); OB_LIT(e, "{");
+    json_key(e, "ready", 1); ob_u64(e, (unsigned long long)ready);
+    if (ready) {
+        json_key(e, "interval_s", 0);    ob_fix(e, u->interval_s, 3);
+        json_key(e, "online", 0);        ob_i64(e, u->online_count);
+        json_key(e, "avg", 0);           ob_fix(e, u->avg, 4);
+        json_key(e, "user", 0);          ob_fix(e, u->total.user, 4);
+        json_key(e, "nice", 0);          ob_fix(e, u->total.nice, 4);
+        json_key(e, "system", 0);        ob_fix(e, u->total.system, 4);
+        json_key(e, "idle", 0);          ob_fix(e, u->total.idle, 4);
+        json_key(e, "iowait", 0);        ob_fix(e, u->total.iowait, 4);
+        json_key(e, "irq", 0);           ob_fix(e, u->total.irq, 4);
+        json_key(e, "softirq", 0);       ob_fix(e, u->total.softirq, 4);
+        json_key(e, "steal", 0);         ob_fix(e, u->total.steal, 4);
+        json_key(e, "ctxt_per_s", 0);    ob_fix(e, u->kstat.ctxt_per_s, 1);
+        json_key(e, "intr_per_s", 0);    ob_fix(e, u->kstat.intr_per_s, 1);
+        json_key(e, "forks_per_s", 0);   ob_fix(e, u->kstat.forks_per_s, 1);
+    }
+    json_key(e, "procs_running", 0); ob_i64(e, u->kstat.procs_running);
+    json_key(e, "procs_blocked", 0); ob_i64(e, u->kstat.procs_blocked);
+    if (ready) {
+        // Un elemento por id de CPU; null = apagado o sin delta
+        json_key(e, "cores", 0); OB_LIT(e, "[");
+        for (int c = 0; c < e->cores; ++c) {
+            if (c) OB_LIT(e, ",");
+            if (c < u->cores && u->state[c] == CPU_CORE_ONLINE) ob_fix(e, u->per_core[c], 4);
+            else OB_LIT(e, "null");
+        }
+        OB_LIT(e, "]");
+    }
+    OB_LIT(e, "}");
+
+    // Discos: null sin /proc/diskstats; tasas solo con delta
+    json_key(e, "disks", 0);
+    if (s->disk_rc == 0) {
+        const DiskStats *d = &s->disk;
+        OB_LIT(e, "[");
+        for (int i = 0; i < d->count; ++i) {
+            const DiskDev *v = &d->dev[i];
+            if (i) OB_LIT(e, ",");
+            OB_LIT(e, "{");
+            json_key(e, "name", 1); json_str(e, v->name);
+            json_key(e, "in_flight", 0); ob_u64(e, v->in_flight);
+            if (d->ready && v->ready) {
+                json_key(e, "r_iops", 0);     ob_fix(e, v->r_iops, 1);
+                json_key(e, "w_iops", 0);     ob_fix(e, v->w_iops, 1);
+                json_key(e, "r_bps", 0);      ob_fix(e, v->r_bps, 0);
+                json_key(e, "w_bps", 0);      ob_fix(e, v->w_bps, 0);
+                json_key(e, "r_await_ms", 0); ob_fix(e, v->r_await_ms, 3);
+                json_key(e, "w_await_ms", 0); ob_fix(e, v->w_await_ms, 3);
+                json_key(e, "svc_ms", 0);     ob_fix(e, v->svc_ms, 3);
+                json_key(e, "util", 0);       ob_fix(e, v->util, 4);
+                json_key(e, "queue", 0);      ob_fix(e, v->queue, 3);
+            }
+            OB_LIT(e, "}");
+        }
+        OB_LIT(e, "]");
+    } else {
+        OB_LIT(e, "null");
+    }
+
+    // Interfaces de red: null sin /proc/net/dev; tasas solo con delta
+    json_key(e, "net", 0);
+    if (s->net_rc == 0) {
+        const NetStats *n = &s->net;
+        OB_LIT(e, "[");
+        for (int i = 0; i < n->count; ++i) {
+            const NetIf *v = &n->ifs[i];
+            if (i) OB_LIT(e, ",");
+            OB_LIT(e, "{");
+            json_key(e, "name", 1);       json_str(e, v->name);
+            json_key(e, "speed_mbps", 0); ob_i64(e, v->speed_mbps);
+            json_key(e, "rx_errs", 0);    ob_u64(e, v->rx_errs);
+            json_key(e, "tx_errs", 0);    ob_u64(e, v->tx_errs);
+            json_key(e, "rx_drop", 0);    ob_u64(e, v->rx_drop);
+            json_key(e, "tx_drop", 0);    ob_u64(e, v->tx_drop);
+            if (n->ready && v->ready) {
+                json_key(e, "rx_bps", 0);     ob_fix(e, v->rx_bps, 0);
+                json_key(e, "tx_bps", 0);     ob_fix(e, v->tx_bps, 0);
+                json_key(e, "rx_pps", 0);     ob_fix(e, v->rx_pps, 1);
+                json_key(e, "tx_pps", 0);     ob_fix(e, v->tx_pps, 1);
+                json_key(e, "rx_errs_ps", 0); ob_fix(e, v->rx_errs_ps, 1);
+                json_key(e, "tx_errs_ps", 0); ob_fix(e, v->tx_errs_ps, 1);
+                json_key(e, "rx_drop_ps", 0); ob_fix(e, v->rx_drop_ps, 1);
+                json_key(e, "tx_drop_ps", 0); ob_fix(e, v->tx_drop_ps, 1);
+            }
+            OB_LIT(e, "}");
+        }
+        OB_LIT(e, "]");
+    } else {
+        OB_LIT(e, "null");
+    }
+
+    // PSI: null si el kernel no lo expone; un recurso ilegible también es null
+    json_key(e, "psi", 0);
+    if (s->psi_rc == 0) {
+        const PsiStats *ps = &s->psi;
+        OB_LIT(e, "{");
+        for (int r = 0; r < PSI_COUNT; ++r) {
+            const PsiResource *pr = &ps->res[r];
+            json_key(e, psi_resource_name(r), r == 0);
+            if (!pr->available) { OB_LIT(e, "null"); continue; }
+            for (int k = 0; k < 2; ++k) {
+                const PsiLine *l = k ? &pr->full : &pr->some;
+                if (k && !pr->has_full) break;
+                if (k) OB_LIT(e, ",\"full\":{");
+                else   OB_LIT(e, "{\"some\":{");
+                json_key(e, "avg10", 1);  ob_fix(e, l->avg10, 2);
+                json_key(e, "avg60", 0);  ob_fix(e, l->avg60, 2);
+                json_key(e, "avg300", 0); ob_fix(e, l->avg300, 2);
+                json_key(e, "total_us", 0); ob_u64(e, l->total_us);
+                if (ps->ready) { json_key(e, "stall", 0); ob_fix(e, l->stall, 4); }
+                OB_LIT(e, "}");
+            }
+            OB_LIT(e, "}");
+        }
+        OB_LIT(e, "}");
+    } else {
+        OB_LIT(e, "null");
+    }
+
+    // Procesos: totales y los dos rankings; cpu solo con delta
+    json_key(e, "procs", 0);
+    if (s->procs_rc == 0) {
+        const ProcStats *pr = &s->procs;
+        OB_LIT(e, "{");
+        json_key(e, "total", 1);    ob_i64(e, pr->total);
+        json_key(e, "running", 0);  ob_i64(e, pr->running);
+        json_key(e, "threads", 0);  ob_i64(e, pr->threads);
+        for (int k = 0; k < 2; ++k) {
+            const ProcInfo *list = k ? pr->by_rss : pr->by_cpu;
+            int n = k ? pr->n_rss : pr->n_cpu;
+            json_key(e, k ? "top_rss" : "top_cpu", 0);
+            OB_LIT(e, "[");
+            for (int i = 0; i < n; ++i) {
+                const ProcInfo *v = &list[i];
+                if (i) OB_LIT(e, ",");
+                OB_LIT(e, "{");
+                json_key(e, "pid", 1);     ob_i64(e, v->pid);
+                json_key(e, "comm", 0);    json_str(e, v->comm);
+                json_key(e, "state", 0);   ob_mem(e, "\"", 1); ob_mem(e, &v->state, 1); ob_mem(e, "\"", 1);
+                json_key(e, "threads", 0); ob_i64(e, v->threads);
+                json_key(e, "rss_kib", 0); ob_i64(e, v->rss_kib);
+                if (pr->ready) { json_key(e, "cpu", 0); ob_fix(e, v->cpu, 4); }
+                OB_LIT(e, "}");
+            }
+            OB_LIT(e, "]");
+        }
+        OB_LIT(e, "}");
+    } else {
+        OB_LIT(e, "null");
+    }
+
+    // Frecuencias por policy de cpufreq y temperaturas; throttled solo en RPi
+    json_key(e, "thermal", 0);
+    if (s->thermal_rc == 0) {
+        const ThermalStats *th = &s->thermal;
+        OB_LIT(e, "{\"freq\":[");
+        for (int i = 0; i < th->npolicies; ++i) {
+            const FreqPolicy *fp = &th->policy[i];
+            if (i) OB_LIT(e, ",");
+            OB_LIT(e, "{");
+            json_key(e, "first_cpu", 1);  ob_i64(e, fp->first_cpu);
+            json_key(e, "ncpus", 0);      ob_i64(e, fp->ncpus);
+            json_key(e, "cur_khz", 0);    ob_i64(e, fp->cur_khz);
+            json_key(e, "min_khz", 0);    ob_i64(e, fp->min_khz);
+            json_key(e, "max_khz", 0);    ob_i64(e, fp->max_khz);
+            json_key(e, "hw_max_khz", 0); ob_i64(e, fp->hw_max_khz);
+            OB_LIT(e, "}");
+        }
+        OB_LIT(e, "],\"zones\":[");
+        for (int i = 0; i < th->nzones; ++i) {
+            const ThermalZone *z = &th->zone[i];
+            if (i) OB_LIT(e, ",");
+            OB_LIT(e, "{");
+            json_key(e, "type", 1);   json_str(e, z->type);
+            json_key(e, "temp_c", 0); ob_fix(e, z->temp_c, 1);
+            if (z->passive_c > 0.0) { json_key(e, "passive_c", 0); ob_fix(e, z->passive_c, 1); }
+            if (z->crit_c > 0.0)    { json_key(e, "crit_c", 0);    ob_fix(e, z->crit_c, 1); }
+            OB_LIT(e, "}");
+        }
+        OB_LIT(e, "]");
+        // Policies que no cupieron en la muestra: sin frecuencia ni límites
+        if (th->omitted_policies > 0) { json_key(e, "omitted_policies", 0); ob_i64(e, th->omitted_policies); }
+        json_key(e, "throttled", 0);
+        if (th->throttled >= 0) ob_i64(e, th->throttled);
+        else OB_LIT(e, "null");
+        OB_LIT(e, "}");
+    } else {
+        OB_LIT(e, "null");
+    }
+
+    // Cgroup: null fuera del modo cgroup; límites en 0 = sin límite
+    json_key(e, "cgroup", 0);
+    if (s->cgroup_rc == 0) {
+        const CgroupStats *cg = &s->cgroup;
+        OB_LIT(e, "{");
+        json_key(e, "path", 1);              json_str(e, cg->path);
+        json_key(e, "mem_current_kib", 0);   ob_i64(e, cg->mem_current_kib);
+        json_key(e, "mem_max_kib", 0);       ob_i64(e, cg->mem_max_kib);
+        json_key(e, "mem_high_kib", 0);      ob_i64(e, cg->mem_high_kib);
+        json_key(e, "swap_current_kib", 0);  ob_i64(e, cg->swap_current_kib);
+        json_key(e, "swap_max_kib", 0);      ob_i64(e, cg->swap_max_kib);
+        json_key(e, "anon_kib", 0);          ob_i64(e, cg->anon_kib);
+        json_key(e, "file_kib", 0);          ob_i64(e, cg->file_kib);
+        json_key(e, "kernel_kib", 0);        ob_i64(e, cg->kernel_kib);
+        json_key(e, "usage_usec", 0);        ob_u64(e, cg->usage_usec);
+        json_key(e, "throttled_usec", 0);    ob_u64(e, cg->throttled_usec);
+        json_key(e, "nr_periods", 0);        ob_u64(e, cg->nr_periods);
+        json_key(e, "nr_throttled", 0);      ob_u64(e, cg->nr_throttled);
+        json_key(e, "cpu_quota", 0);         ob_fix(e, cg->cpu_quota, 2);
+        if (cg->ready) {
+            json_key(e, "cpu", 0);             ob_fix(e, cg->cpu, 3);
+            json_key(e, "cpu_user", 0);        ob_fix(e, cg->cpu_user, 3);
+            json_key(e, "cpu_system", 0);      ob_fix(e, cg->cpu_system, 3);
+            json_key(e, "throttled_ratio", 0); ob_fix(e, cg->throttled_ratio, 4);
+            json_key(e, "throttled_ms_ps", 0); ob_fix(e, cg->throttled_ms_ps, 1);
+        }
+        json_key(e, "children", 0);
+        OB_LIT(e, "[");
+        for (int i = 0; i < cg->nchildren; ++i) {
+            const CgroupChild *c = &cg->child[i];
+            if (i) OB_LIT(e, ",");
+            OB_LIT(e, "{");
+            json_key(e, "name", 1);    json_str(e, c->name);
+            json_key(e, "mem_kib", 0); ob_i64(e, c->mem_kib);
+            if (c->ready) { json_key(e, "cpu", 0); ob_fix(e, c->cpu, 3); }
+            OB_LIT(e, "}");
+        }
+        OB_LIT(e, "]");
+        json_key(e, "omitted_children", 0); ob_i64(e, cg->omitted_children);
+        OB_LIT(e, "}");
+    } else {
+        OB_LIT(e, "null");
+    }
+
+    // Interrupciones: tasas solo con delta; hot vacío en la primera muestra
+    json_key(e, "irq", 0);
+    if (s->irq_rc == 0) {
+        const IrqStats *iq = &s->irq;
+        OB_LIT(e, "{");
+        json_key(e, "ncpus", 1); ob_i64(e, iq->ncpus);
+        if (iq->ready) {
+            json_key(e, "irq_ps", 0);     ob_fix(e, iq->irq_ps, 1);
+            json_key(e, "softirq_ps", 0); ob_fix(e, iq->softirq_ps, 1);
+        }
+        OB_LIT(e, ",\"hot\":[");
+        for (int i = 0; i < iq->nhot; ++i) {
+            const IrqHotCore *h = &iq->hot[i];
+            if (i) OB_LIT(e, ",");
+            OB_LIT(e, "{");
+            json_key(e, "cpu", 1);        ob_i64(e, h->cpu);
+            json_key(e, "irq_ps", 0);     ob_fix(e, h->irq_ps, 1);
+            json_key(e, "softirq_ps", 0); ob_fix(e, h->softirq_ps, 1);
+            OB_LIT(e, ",\"sources\":[");
+            for (int k = 0; k < h->nsrc; ++k) {
+                const IrqSource *src = &h->src[k];
+                if (k) OB_LIT(e, ",");
+                OB_LIT(e, "{");
+                json_key(e, "name", 1);   json_str(e, src->name);
+                json_key(e, "softirq", 0);
+                if (src->softirq) OB_LIT(e, "true");
+                else OB_LIT(e, "false");
+                json_key(e, "rate", 0);   ob_fix(e, src->rate, 1);
+                OB_LIT(e, "}");
+            }
+            OB_LIT(e, "]}");
+        }
+        OB_LIT(e, "]}");
+    } else {
+        OB_LIT(e, "null");
+    }
+    OB_LIT(e, "}\n");
+}
+
+// ---------- CSV ----------
+// Columnas fijas para todo el flujo; campo vacío = sin dato.
+static const char k_csv_header[] =
+    "seq,ts,mem_total_kib,mem_avail_kib,mem_used_kib,mem_used_ratio,"
+    "swap_total_kib,swap_used_kib,swap_used_ratio,"
+    "mem_free_kib,mem_buffers_kib,mem_cached_kib,mem_anon_kib,mem_shmem_kib,mem_slab_kib,"
+    "mem_dirty_kib,mem_writeback_kib,mem_committed_kib,mem_commit_limit_kib,huge_total,huge_free,"
+    "cpu_ready,cpu_interval_s,cpu_online,cpu_avg,"
+    "cpu_user,cpu_nice,cpu_system,cpu_idle,cpu_iowait,cpu_irq,cpu_softirq,cpu_steal,"
+    "ctxt_per_s,intr_per_s,forks_per_s,procs_running,procs_blocked,"
+    "disk_r_iops,disk_w_iops,disk_r_bps,disk_w_bps,disk_util_max,disk_queue,"
+    "net_rx_bps,net_tx_bps,net_rx_pps,net_tx_pps,net_errs_ps,net_drops_ps,"
+    "psi_cpu_some_avg10,psi_cpu_some_avg60,psi_cpu_some_stall,"
+    "psi_cpu_full_avg10,psi_cpu_full_avg60,psi_cpu_full_stall,"
+    "psi_mem_some_avg10,psi_mem_some_avg60,psi_mem_some_stall,"
+    "psi_mem_full_avg10,psi_mem_full_avg60,psi_mem_full_stall,"
+    "psi_io_some_avg10,psi_io_some_avg60,psi_io_some_stall,"
+    "psi_io_full_avg10,psi_io_full_avg60,psi_io_full_stall,"
+    "procs_total,threads_total,top_cpu_pid,top_cpu,top_rss_pid,top_rss_kib,"
+    "temp_max_c,freq_avg_mhz,freq_min_ratio,throttled,"
+    "cg_mem_current_kib,cg_mem_max_kib,cg_cpu,cg_cpu_quota,cg_throttled_ratio,"
+    "irq_per_s,softirq_per_s,irq_hot_cpu,irq_hot_per_s";
+
+static void format_csv(Exporter *e, const Snapshot *s) {
+    ob_u64(e, s->seq); OB_LIT(e, ",");
+    ob_ts(e, &s->ts);
+
+    const MemStats *m = &s->mem;
+    if (s->mem_rc == 0) {
+        OB_LIT(e, ","); ob_i64(e, m->total_kib);
+        OB_LIT(e, ","); ob_i64(e, m->avail_kib);
+        OB_LIT(e, ","); ob_i64(e, m->used_kib);
+        OB_LIT(e, ","); ob_fix(e, m->used_ratio, 4);
+        OB_LIT(e, ","); ob_i64(e, m->swap_total_kib);
+        OB_LIT(e, ","); ob_i64(e, m->swap_used_kib);
+        OB_LIT(e, ","); ob_fix(e, m->swap_total_kib > 0 ? m->swap_used_ratio : 0.0, 4);
+        const long k[] = { m->free_kib, m->buffers_kib, m->cached_kib, m->anon_kib, m->shmem_kib,
+                           m->slab_kib, m->dirty_kib, m->writeback_kib, m->committed_kib,
+                           m->commit_limit_kib, m->huge_total, m->huge_free };
+        for (size_t i = 0; i < sizeof(k) / sizeof(k[0]); ++i) { OB_LIT(e, ","); ob_i64(e, k[i]); }
+    } else {
+        OB_LIT(e, ",,,,,,,,,,,,,,,,,,,");
+    }
+
+    const CPUUsage *u = &s->cpu;
+    int ready = (s->cpu_rc == 0 && u->ready);
+    OB_LIT(e, ","); ob_u64(e, (unsigned long long)ready);
+    if (ready) {
+        const double t[] = { u->total.user, u->total.nice, u->total.system, u->total.idle,
+                             u->total.iowait, u->total.irq, u->total.softirq, u->total.steal };
+        OB_LIT(e, ","); ob_fix(e, u->interval_s, 3);
+        OB_LIT(e, ","); ob_i64(e, u->online_count);
+        OB_LIT(e, ","); ob_fix(e, u->avg, 4);
+        for (size_t k = 0; k < sizeof(t) / sizeof(t[0]); ++k) { OB_LIT(e, ","); ob_fix(e, t[k], 4); }
+        OB_LIT(e, ","); ob_fix(e, u->kstat.ctxt_per_s, 1);
+        OB_LIT(e, ","); ob_fix(e, u->kstat.intr_per_s, 1);
+        OB_LIT(e, ","); ob_fix(e, u->kstat.forks_per_s, 1);
+    } else {
+        OB_LIT(e, ",,,,,,,,,,,,,,");
+    }
+    OB_LIT(e, ","); ob_i64(e, u->kstat.procs_running);
+    OB_LIT(e, ","); ob_i64(e, u->kstat.procs_blocked);
+
+    // Discos agregados (el CSV tiene columnas fijas): sumas de todos los
+    // discos, también los que no caben en dev[], y el peor util
+    const DiskStats *d = &s->disk;
+    if (s->disk_rc == 0 && d->ready) {
+        OB_LIT(e, ","); ob_fix(e, d->total_r_iops, 1);
+        OB_LIT(e, ","); ob_fix(e, d->total_w_iops, 1);
+        OB_LIT(e, ","); ob_fix(e, d->total_r_bps, 0);
+        OB_LIT(e, ","); ob_fix(e, d->total_w_bps, 0);
+        OB_LIT(e, ","); ob_fix(e, d->max_util, 4);
+        OB_LIT(e, ","); ob_fix(e, d->total_queue, 3);
+    } else {
+        OB_LIT(e, ",,,,,,");
+    }
+
+    // Red agregada: sumas de todas las interfaces (sin lo), también las que
+    // no caben en ifs[]
+    const NetStats *n = &s->net;
+    if (s->net_rc == 0 && n->ready) {
+        OB_LIT(e, ","); ob_fix(e, n->total_rx_bps, 0);
+        OB_LIT(e, ","); ob_fix(e, n->total_tx_bps, 0);
+        OB_LIT(e, ","); ob_fix(e, n->total_rx_pps, 1);
+        OB_LIT(e, ","); ob_fix(e, n->total_tx_pps, 1);
+        OB_LIT(e, ","); ob_fix(e, n->total_errs_ps, 1);
+        OB_LIT(e, ","); ob_fix(e, n->total_drop_ps, 1);
+    } else {
+        OB_LIT(e, ",,,,,,");
+    }
+
+    // PSI: avg10, avg60 y fracción detenida del intervalo por recurso y línea
+    const PsiStats *ps = &s->psi;
+    for (int r = 0; r < PSI_COUNT; ++r) {
+        const PsiResource *pr = &ps->res[r];
+        for (int k = 0; k < 2; ++k) {
+            const PsiLine *l = k ? &pr->full : &pr->some;
+            if (s->psi_rc != 0 || !pr->available || (k && !pr->has_full)) { OB_LIT(e, ",,,"); continue; }
+            OB_LIT(e, ","); ob_fix(e, l->avg10, 2);
+            OB_LIT(e, ","); ob_fix(e, l->avg60, 2);
+            OB_LIT(e, ",");
+            if (ps->ready) ob_fix(e, l->stall, 4);
+        }
+    }
+
+    // Procesos: totales y el primero de cada ranking
+    const ProcStats *pr = &s->procs;
+    if (s->procs_rc == 0) {
+        OB_LIT(e, ","); ob_i64(e, pr->total);
+        OB_LIT(e, ","); ob_i64(e, pr->threads);
+        OB_LIT(e, ",");
+        if (pr->ready && pr->n_cpu > 0) ob_i64(e, pr->by_cpu[0].pid);
+        OB_LIT(e, ",");
+        if (pr->ready && pr->n_cpu > 0) ob_fix(e, pr->by_cpu[0].cpu, 4);
+        OB_LIT(e, ",");
+        if (pr->n_rss > 0) ob_i64(e, pr->by_rss[0].pid);
+        OB_LIT(e, ",");
+        if (pr->n_rss > 0) ob_i64(e, pr->by_rss[0].rss_kib);
+    } else {
+        OB_LIT(e, ",,,,,,");
+    }
+
+    // Térmica: zona más caliente, frecuencia media por núcleo y la policy más
+    // alejada de su máximo de hardware (1.0 = ninguna limitada)
+    const ThermalStats *th = &s->thermal;
+    if (s->thermal_rc == 0) {
+        OB_LIT(e, ",");
+        if (th->nzones > 0) ob_fix(e, thermal_max_temp(th), 1);
+        double sum = 0.0, min_ratio = 1.0;
+        int ncpus = 0;
+        for (int i = 0; i < th->npolicies; ++i) {
+            const FreqPolicy *fp = &th->policy[i];
+            if (fp->cur_khz <= 0) continue;
+            sum += (double)fp->cur_khz * fp->ncpus;
+            ncpus += fp->ncpus;
+            if (fp->hw_max_khz > 0) {
+                double r = (double)fp->cur_khz / (double)fp->hw_max_khz;
+                if (r < min_ratio) min_ratio = r;
+            }
+        }
+        OB_LIT(e, ",");
+        if (ncpus > 0) ob_fix(e, sum / ncpus / 1000.0, 0);
+        OB_LIT(e, ",");
+        if (ncpus > 0) ob_fix(e, min_ratio, 4);
+        OB_LIT(e, ",");
+        if (th->throttled >= 0) ob_i64(e, th->throttled);
+    } else {
+        OB_LIT(e, ",,,,");
+    }
+
+    // Cgroup: límites vacíos = sin límite; CPU solo con delta
+    const CgroupStats *cg = &s->cgroup;
+    if (s->cgroup_rc == 0) {
+        OB_LIT(e, ","); ob_i64(e, cg->mem_current_kib);
+        OB_LIT(e, ",");
+        if (cg->mem_max_kib > 0) ob_i64(e, cg->mem_max_kib);
+        OB_LIT(e, ",");
+        if (cg->ready) ob_fix(e, cg->cpu, 3);
+        OB_LIT(e, ",");
+        if (cg->cpu_quota > 0.0) ob_fix(e, cg->cpu_quota, 2);
+        OB_LIT(e, ",");
+        if (cg->ready) ob_fix(e, cg->throttled_ratio, 4);
+    } else {
+        OB_LIT(e, ",,,,,");
+    }
+
+    // Interrupciones: totales y el núcleo que más atiende (irq + softirq)
+    const IrqStats *iq = &s->irq;
+    if (s->irq_rc == 0 && iq->ready) {
+        OB_LIT(e, ","); ob_fix(e, iq->irq_ps, 1);
+        OB_LIT(e, ","); ob_fix(e, iq->softirq_ps, 1);
+        OB_LIT(e, ",");
+        if (iq->nhot > 0) ob_i64(e, iq->hot[0].cpu);
+        OB_LIT(e, ",");
+        if (iq->nhot > 0) ob_fix(e, iq->hot[0].irq_ps + iq->hot[0].softirq_ps, 1);
+    } else {
+        OB_LIT(e, ",,,,");
+    }
+    for (int c = 0; c < e->cores; ++c) {
+        OB_LIT(e, ",");
+        if (ready && c < u->cores && u->state[c] == CPU_CORE_ONLINE) ob_fix(e, u->per_core[c], 4);
+    }
+    OB_LIT(e, "\n");
+}
+
+// ---------- Prometheus (formato de texto 0.0.4) ----------
+static void ob_str(Exporter *e, const char *s) { ob_mem(e, s, strlen(s)); }
+
+static void prom_meta(Exporter *e, const char *name, const char *type, const char *help) {
+    OB_LIT(e, "# HELP "); ob_str(e, name); OB_LIT(e, " "); ob_str(e, help);
+    OB_LIT(e, "\n# TYPE "); ob_str(e, name); OB_LIT(e, " "); ob_str(e, type); OB_LIT(e, "\n");
+}
+
+static void prom_int(Exporter *e, const char *name, const char *type, const char *help, long long v) {
+    prom_meta(e, name, type, help);
+    ob_str(e, name); OB_LIT(e, " "); ob_i64(e, v); OB_LIT(e, "\n");
+}
+
+static void prom_fix(Exporter *e, const char *name, const char *help, double v, int dec) {
+    prom_meta(e, name, "gauge", help);
+    ob_str(e, name); OB_LIT(e, " "); ob_fix(e, v, dec); OB_LIT(e, "\n");
+}
+
+static void prom_bytes(Exporter *e, const char *name, const char *help, long kib) {
+    prom_int(e, name, "gauge", help, (long long)kib * 1024);
+}
+
+// Valor de etiqueta: se escapan \, " y el salto de línea
+static void prom_label(Exporter *e, const char *s) {
+    OB_LIT(e, "\"");
+    for (; *s; ++s) {
+        if (*s == '\\' || *s == '"') { OB_LIT(e, "\\"); ob_mem(e, s, 1); }
+        else if (*s == '\n') OB_LIT(e, "\\n");
+        else ob_mem(e, s, 1);
+    }
+    OB_LIT(e, "\"");
+}
+
+static void format_prom(Exporter *e, const Snapshot *s) {
+    prom_int(e, "rpi_samples_total", "counter", "Muestras tomadas desde el arranque.", (long long)s->seq);
+    prom_meta(e, "rpi_sample_timestamp_seconds", "gauge", "Hora (Unix) de la muestra servida.");
+    OB_LIT(e, "rpi_sample_timestamp_seconds "); ob_ts(e, &s->ts); OB_LIT(e, "\n");
+
+    if (s->mem_rc == 0) {
+        const MemStats *m = &s->mem;
+        prom_bytes(e, "rpi_memory_total_bytes", "MemTotal.", m->total_kib);
+        prom_bytes(e, "rpi_memory_available_bytes", "MemAvailable.", m->avail_kib);
+        prom_bytes(e, "rpi_memory_used_bytes", "MemTotal - MemAvailable.", m->used_kib);
+        prom_fix(e, "rpi_memory_used_ratio", "Memoria usada / total.", m->used_ratio, 4);
+        prom_bytes(e, "rpi_memory_free_bytes", "MemFree.", m->free_kib);
+        prom_bytes(e, "rpi_memory_buffers_bytes", "Buffers.", m->buffers_kib);
+        prom_bytes(e, "rpi_memory_cached_bytes", "Cached (incluye Shmem).", m->cached_kib);
+        prom_bytes(e, "rpi_memory_anon_bytes", "AnonPages.", m->anon_kib);
+        prom_bytes(e, "rpi_memory_shmem_bytes", "Shmem.", m->shmem_kib);
+        prom_bytes(e, "rpi_memory_slab_bytes", "Slab.", m->slab_kib);
+        prom_bytes(e, "rpi_memory_dirty_bytes", "Dirty.", m->dirty_kib);
+        prom_bytes(e, "rpi_memory_writeback_bytes", "Writeback.", m->writeback_kib);
+        prom_bytes(e, "rpi_memory_committed_bytes", "Committed_AS.", m->committed_kib);
+        prom_bytes(e, "rpi_memory_commit_limit_bytes", "CommitLimit.", m->commit_limit_kib);
+        prom_bytes(e, "rpi_swap_total_bytes", "SwapTotal.", m->swap_total_kib);
+        prom_bytes(e, "rpi_swap_used_bytes", "SwapTotal - SwapFree.", m->swap_used_kib);
+        prom_fix(e, "rpi_swap_used_ratio", "Swap usada / total (0 sin swap).",
+                 m->swap_total_kib > 0 ? m->swap_used_ratio : 0.0, 4);
+    }
+
+    if (e->info) {
+        prom_meta(e, "rpi_cpu_info", "gauge", "Modelo, SoC y arquitectura (valor siempre 1).");
+        OB_LIT(e, "rpi_cpu_info{model="); prom_label(e, e->info->model);
+        OB_LIT(e, ",hardware=");           prom_label(e, e->info->hardware);
+        OB_LIT(e, ",arch=");               prom_label(e, e->info->arch);
+        OB_LIT(e, "} 1\n");
+        prom_int(e, "rpi_cpu_cores_configured", "gauge", "Núcleos posibles.", e->info->cores_config);
+    }
+
+    const CPUUsage *u = &s->cpu;
+    if (s->cpu_rc != 0) return;
+    const CPUKernelStats *k = &u->kstat;
+    prom_int(e, "rpi_cpu_context_switches_total", "counter", "Cambios de contexto (ctxt).", (long long)k->ctxt);
+    prom_int(e, "rpi_cpu_interrupts_total", "counter", "Interrupciones atendidas (intr).", (long long)k->intr);
+    prom_int(e, "rpi_cpu_forks_total", "counter", "Procesos e hilos creados (processes).", (long long)k->forks);
+    prom_int(e, "rpi_procs_running", "gauge", "Tareas ejecutables.", k->procs_running);
+    prom_int(e, "rpi_procs_blocked", "gauge", "Tareas bloqueadas en E/S.", k->procs_blocked);
+    if (!u->ready) return;
+
+    prom_int(e, "rpi_cpu_cores_online", "gauge", "Núcleos en línea con delta válido.", u->online_count);
+    prom_fix(e, "rpi_cpu_sample_interval_seconds", "Intervalo medido entre las dos últimas muestras.", u->interval_s, 3);
+    prom_fix(e, "rpi_cpu_usage_ratio", "Uso medio de los núcleos en línea en el intervalo.", u->avg, 4);
+
+    static const char *const modes[] = { "user", "nice", "system", "idle", "iowait", "irq", "softirq", "steal" };
+    const double t[] = { u->total.user, u->total.nice, u->total.system, u->total.idle,
+                         u->total.iowait, u->total.irq, u->total.softirq, u->total.steal };
+    prom_meta(e, "rpi_cpu_mode_ratio", "gauge", "Fracción del intervalo en cada estado (todos los núcleos).");
+    for (int i = 0; i < 8; ++i) {
+        OB_LIT(e, "rpi_cpu_mode_ratio{mode=\""); ob_str(e, modes[i]); OB_LIT(e, "\"} ");
+        ob_fix(e, t[i], 4);
+        OB_LIT(e, "\n");
+    }
+
+    prom_meta(e, "rpi_cpu_core_usage_ratio", "gauge", "Uso de cada núcleo en línea en el intervalo.");
+    int n = u->cores < e->cores ? u->cores : e->cores;
+    for (int c = 0; c < n; ++c) {
+        if (u->state[c] != CPU_CORE_ONLINE) continue;
+        OB_LIT(e, "rpi_cpu_core_usage_ratio{core=\""); ob_u64(e, (unsigned long long)c); OB_LIT(e, "\"} ");
+        ob_fix(e, u->per_core[c], 4);
+        OB_LIT(e, "\n");
+    }
+}
+
+// ---------- Salida ----------
+static int write_all(int fd, const char *p, size_t n) {
+    while (n > 0) {
+        ssize_t w = write(fd, p, n);
+        if (w < 0) {
+            if (errno == EINTR) continue;
+            return 2;
+        }
+        p += w;
+        n -= (size_t)w;
+    }
+    return 0;
+}
+
+int export_parse_format(const char *s, ExportFormat *out) {
+    if (!s || !out) return 1;
+    if (strcmp(s, "jsonl") == 0 || strcmp(s, "json") == 0) { *out = EXPORT_JSONL; return 0; }
+    if (strcmp(s, "csv") == 0) { *out = EXPORT_CSV; return 0; }
+    return 1;
+}
+
+int exporter_init(Exporter *e, ExportFormat fmt, int fd, int cores) {
+    if (!e || fd < -1 || cores < 0 || (fd < 0 && fmt != EXPORT_PROM)) return 1;
+    memset(e, 0, sizeof(*e));
+    e->fmt   = fmt;
+    e->fd    = fd;
+    e->cores = cores;
+    e->cap   = EXPORT_FIXED_BYTES + (size_t)cores * EXPORT_CORE_BYTES + DISK_MAX * EXPORT_DISK_BYTES
+             + NET_MAX * EXPORT_NET_BYTES + EXPORT_PSI_BYTES + 2 * PROC_TOP * EXPORT_PROC_BYTES
+             + FREQ_POLICY_MAX * EXPORT_POLICY_BYTES + THERMAL_ZONE_MAX * EXPORT_ZONE_BYTES
+             + EXPORT_CGROUP_BYTES + CGROUP_CHILD_MAX * EXPORT_CHILD_BYTES
+             + EXPORT_IRQ_BYTES + IRQ_HOT_MAX * EXPORT_HOT_BYTES;
+    if (fmt == EXPORT_PROM) e->cap = EXPORT_PROM_BYTES + (size_t)cores * EXPORT_PROM_CORE_BYTES;
+    e->buf   = malloc(e->cap);
+    if (!e->buf) return 3;
+
+    if (fmt == EXPORT_CSV) {
+        OB_LIT(e, k_csv_header);
+        for (int c = 0; c < cores; ++c) { OB_LIT(e, ",core"); ob_u64(e, (unsigned long long)c); }
+        OB_LIT(e, "\n");
+        int rc = write_all(fd, e->buf, e->len);
+        e->len = 0;
+        return rc;
+    }
+    return 0;
+}
+
+int exporter_format(Exporter *e, const Snapshot *snap) {
+    if (!e || !e->buf || !snap) return 1;
+    e->len = 0;
+    e->overflow = 0;
+    if (e->fmt == EXPORT_CSV)       format_csv(e, snap);
+    else if (e->fmt == EXPORT_PROM) format_prom(e, snap);
+    else                            format_json(e, snap);
+    return e->overflow ? 1 : 0;
+}
+
+int exporter_write(Exporter *e, const Snapshot *snap) {
+    if (!e || !e->buf || !snap || e->fd < 0) return 1;
+    if (exporter_format(e, snap) != 0) return 0;   // nunca emitir una línea truncada
+    return write_all(e->fd, e->buf, e->len);
+}
+
+void exporter_free(Exporter *e) {
+    if (!e) return;
+    free(e->buf);
+    memset(e, 0, sizeof(*e));
+    e->fd = -1;
+}
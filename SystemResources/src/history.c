@@ -0,0 +1,93 @@
+#include "history.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+size_t history_bytes(int cap, int cores) {
+    if (cap <= 0 || cores < 0) return 0;
+    return (size_t)cap * (size_t)(HIST_SERIES_COUNT + cores) * sizeof(float);
+}
+
+int history_init(History *h, int cap, int cores) {
+    if (!h || cap <= 0 || cores < 0) return 1;
+    memset(h, 0, sizeof(*h));
+    size_t n = (size_t)cap * (size_t)(HIST_SERIES_COUNT + cores);
+    float *block = malloc(n * sizeof(float));
+    if (!block) return 3;
+    for (size_t i = 0; i < n; ++i) block[i] = NAN;
+
+    h->cap    = cap;
+    h->cores  = cores;
+    h->series = block;
+    h->core   = block + (size_t)HIST_SERIES_COUNT * (size_t)cap;
+    pthread_mutex_init(&h->lock, NULL);
+    return 0;
+}
+
+void history_free(History *h) {
+    if (!h || !h->series) return;
+    pthread_mutex_destroy(&h->lock);
+    free(h->series);   // un solo bloque: 'core' apunta dentro de él
+    memset(h, 0, sizeof(*h));
+}
+
+void history_clear(History *h) {
+    if (!h) return;
+    h->head = 0;
+    h->count = 0;
+    h->last_seq = 0;
+}
+
+void history_hook(const Snapshot *snap, void *arg) {
+    History *h = arg;
+    pthread_mutex_lock(&h->lock);
+    history_push(h, snap);
+    pthread_mutex_unlock(&h->lock);
+}
+
+void history_lock(History *h)   { pthread_mutex_lock(&h->lock); }
+void history_unlock(History *h) { pthread_mutex_unlock(&h->lock); }
+
+const float *history_series(const History *h, HistSeries s) {
+    return h->series + (size_t)s * (size_t)h->cap;
+}
+
+const float *history_core(const History *h, int core) {
+    if (core < 0 || core >= h->cores) return NULL;
+    return h->core + (size_t)core * (size_t)h->cap;
+}
+
+int history_push(History *h, const Snapshot *snap) {
+    if (!h || !h->series || !snap || snap->seq == h->last_seq) return 0;
+    h->last_seq = snap->seq;
+
+    const int at = h->head;
+    float v[HIST_SERIES_COUNT];
+    for (int k = 0; k < HIST_SERIES_COUNT; ++k) v[k] = NAN;
+
+    if (snap->mem_rc == 0) {
+        v[HIST_MEM_USED]  = (float)snap->mem.used_ratio;
+        v[HIST_SWAP_USED] = snap->mem.swap_total_kib > 0 ? (float)snap->mem.swap_used_ratio : 0.0f;
+    }
+    const CPUUsage *u = &snap->cpu;
+    if (snap->cpu_rc == 0 && u->ready) {
+        int online = u->online_count > 0 ? u->online_count : 1;
+        v[HIST_CPU_AVG]    = (float)u->avg;
+        v[HIST_RUNQ]       = (float)u->kstat.procs_running / (float)online;
+        v[HIST_CTXT_PER_S] = (float)u->kstat.ctxt_per_s;
+        v[HIST_INTR_PER_S] = (float)u->kstat.intr_per_s;
+    }
+    for (int k = 0; k < HIST_SERIES_COUNT; ++k)
+        h->series[(size_t)k * (size_t)h->cap + (size_t)at] = v[k];
+
+    int ready = (snap->cpu_rc == 0 && u->ready);
+    for (int c = 0; c < h->cores; ++c) {
+        float x = NAN;
+        if (ready && c < u->cores && u->state[c] == CPU_CORE_ONLINE) x = (float)u->per_core[c];
+        h->core[(size_t)c * (size_t)h->cap + (size_t)at] = x;
+    }
+
+    h->head = (at + 1 == h->cap) ? 0 : at + 1;
+    if (h->count < h->cap) h->count++;
+    return 1;
+}
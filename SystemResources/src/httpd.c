@@ -0,0 +1,386 @@
+#include "httpd.h"
+#include "export.h"
+#include <arpa/inet.h>
+#include <errno.h>
+#include <netinet/in.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <time.h>
+#include <unistd.h>
+
+#define HTTPD_HEAD_MAX 256        // línea de estado + cabeceras de la respuesta
+#define EV_LISTEN      HTTPD_MAX_CONN
+#define EV_STOP        (HTTPD_MAX_CONN + 1)
+
+typedef struct {
+    int       fd;                 // -1 = libre
+    int       writing;            // 0 leyendo la petición, 1 enviando la respuesta
+    long long deadline_ms;        // CLOCK_MONOTONIC: se cierra si no avanza antes
+    size_t    req_len;
+    char      req[HTTPD_REQ_MAX];
+    char     *resp;               // [resp_cap], dentro del bloque del servidor
+    size_t    resp_len;
+    size_t    resp_off;
+} Conn;
+
+struct Httpd {
+    int        listen_fd;
+    int        epoll_fd;
+    int        stop_fd;
+    int        listening;         // el socket de escucha está en el epoll
+    char       unix_path[sizeof(((struct sockaddr_un *)0)->sun_path)];   // "" si es TCP
+    pthread_t  thread;
+
+    // Doble buffer: el hook formatea en body[1 - front] y luego publica.
+    // 'front' lo escribe solo el hilo de muestreo; el del servidor lo lee con 'lock'.
+    pthread_mutex_t lock;
+    Exporter   body[2];
+    int        front;             // -1 = aún sin muestras
+
+    size_t     resp_cap;
+    char      *resp_block;        // HTTPD_MAX_CONN respuestas de resp_cap bytes
+    Conn       conn[HTTPD_MAX_CONN];
+};
+
+static long long monotonic_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000 + ts.tv_nsec / 1000000L;
+}
+
+// ==================== Socket de escucha ====================
+
+static int listen_unix(Httpd *h, const char *path, char *err, size_t errlen) {
+    struct sockaddr_un sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sun_family = AF_UNIX;
+    if (!*path || strlen(path) >= sizeof(sa.sun_path)) {
+        snprintf(err, errlen, "ruta de socket inválida: '%s'", path);
+        return -1;
+    }
+    memcpy(sa.sun_path, path, strlen(path) + 1);
+
+    // Un socket que quedó de una ejecución anterior se reemplaza; otro archivo no
+    struct stat st;
+    if (lstat(path, &st) == 0) {
+        if (!S_ISSOCK(st.st_mode)) {
+            snprintf(err, errlen, "'%s' existe y no es un socket", path);
+            return -1;
+        }
+        unlink(path);
+    }
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0 || bind(fd, (struct sockaddr *)&sa, sizeof(sa)) != 0 || listen(fd, 16) != 0) {
+        snprintf(err, errlen, "%s: %s", path, strerror(errno));
+        if (fd >= 0) close(fd);
+        return -1;
+    }
+    snprintf(h->unix_path, sizeof(h->unix_path), "%s", path);
+    return fd;
+}
+
+// "9101", "127.0.0.1:9101" o "[::1]:9101"
+static int listen_tcp(const char *addr, char *err, size_t errlen) {
+    char host[64] = "127.0.0.1";
+    const char *port_s = addr;
+    if (addr[0] == '[') {
+        const char *close_br = strchr(addr, ']');
+        size_t n = close_br ? (size_t)(close_br - addr - 1) : 0;
+        if (!close_br || close_br[1] != ':' || n == 0 || n >= sizeof(host)) goto bad;
+        memcpy(host, addr + 1, n);
+        host[n] = '\0';
+        port_s = close_br + 2;
+    } else if (strchr(addr, ':')) {
+        const char *colon = strrchr(addr, ':');
+        size_t n = (size_t)(colon - addr);
+        if (n == 0 || n >= sizeof(host)) goto bad;
+        memcpy(host, addr, n);
+        host[n] = '\0';
+        port_s = colon + 1;
+    }
+
+    char *end;
+    long port = strtol(port_s, &end, 10);
+    if (end == port_s || *end || port < 1 || port > 65535) goto bad;
+
+    struct sockaddr_storage ss;
+    socklen_t sl;
+    memset(&ss, 0, sizeof(ss));
+    struct sockaddr_in *v4 = (struct sockaddr_in *)&ss;
+    struct sockaddr_in6 *v6 = (struct sockaddr_in6 *)&ss;
+    if (inet_pton(AF_INET, host, &v4->sin_addr) == 1) {
+        v4->sin_family = AF_INET;
+        v4->sin_port = htons((uint16_t)port);
+        sl = sizeof(*v4);
+    } else if (inet_pton(AF_INET6, host, &v6->sin6_addr) == 1) {
+        v6->sin6_family = AF_INET6;
+        v6->sin6_port = htons((uint16_t)port);
+        sl = sizeof(*v6);
+    } else {
+        goto bad;
+    }
+
+    int fd = socket(ss.ss_family, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    int one = 1;
+    if (fd < 0 || setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one)) != 0 ||
+        bind(fd, (struct sockaddr *)&ss, sl) != 0 || listen(fd, 16) != 0) {
+        snprintf(err, errlen, "%s: %s", addr, strerror(errno));
+        if (fd >= 0) close(fd);
+        return -1;
+    }
+    return fd;
+
+bad:
+    snprintf(err, errlen, "dirección inválida: '%s' (PUERTO, HOST:PUERTO, [IPv6]:PUERTO o unix:RUTA)", addr);
+    return -1;
+}
+
+// ==================== Conexiones ====================
+
+static void set_listening(Httpd *h, int on) {
+    if (on == h->listening) return;
+    struct epoll_event ev = { .events = on ? EPOLLIN : 0, .data.u32 = EV_LISTEN };
+    epoll_ctl(h->epoll_fd, EPOLL_CTL_MOD, h->listen_fd, &ev);
+    h->listening = on;
+}
+
+static void conn_close(Httpd *h, Conn *c) {
+    epoll_ctl(h->epoll_fd, EPOLL_CTL_DEL, c->fd, NULL);
+    close(c->fd);
+    c->fd = -1;
+    set_listening(h, 1);   // hay un hueco: volver a aceptar
+}
+
+static void accept_all(Httpd *h) {
+    for (;;) {
+        int slot = -1;
+        for (int i = 0; i < HTTPD_MAX_CONN; ++i) if (h->conn[i].fd < 0) { slot = i; break; }
+        if (slot < 0) { set_listening(h, 0); return; }   // el resto espera en el backlog
+
+        int fd = accept4(h->listen_fd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) return;   // EAGAIN o error transitorio (ECONNABORTED, EMFILE…)
+        Conn *c = &h->conn[slot];
+        c->fd = fd;
+        c->writing = 0;
+        c->req_len = 0;
+        c->resp_len = c->resp_off = 0;
+        c->deadline_ms = monotonic_ms() + HTTPD_IDLE_MS;
+        struct epoll_event ev = { .events = EPOLLIN, .data.u32 = (uint32_t)slot };
+        if (epoll_ctl(h->epoll_fd, EPOLL_CTL_ADD, fd, &ev) != 0) conn_close(h, c);
+    }
+}
+
+// Arma la respuesta completa en c->resp: cabeceras y, salvo HEAD, el cuerpo
+static void respond(Httpd *h, Conn *c, int status, const char *reason, const char *ctype,
+                    const char *body, size_t body_len, int head_only) {
+    int n = snprintf(c->resp, HTTPD_HEAD_MAX,
+                     "HTTP/1.1 %d %s\r\nContent-Type: %s\r\nContent-Length: %zu\r\nConnection: close\r\n\r\n",
+                     status, reason, ctype, body_len);
+    c->resp_len = (n > 0 && n < HTTPD_HEAD_MAX) ? (size_t)n : 0;
+    if (!head_only && body && c->resp_len + body_len <= h->resp_cap) {
+        memcpy(c->resp + c->resp_len, body, body_len);
+        c->resp_len += body_len;
+    }
+    c->resp_off = 0;
+}
+
+static void respond_text(Httpd *h, Conn *c, int status, const char *reason, const char *text, int head_only) {
+    respond(h, c, status, reason, "text/plain; charset=utf-8", text, strlen(text), head_only);
+}
+
+static void handle_request(Httpd *h, Conn *c) {
+    int head_only = 0;
+    const char *p = c->req;
+    if (strncmp(p, "GET ", 4) == 0) p += 4;
+    else if (strncmp(p, "HEAD ", 5) == 0) { p += 5; head_only = 1; }
+    else { respond_text(h, c, 405, "Method Not Allowed", "Solo GET y HEAD.\n", 0); return; }
+
+    size_t plen = strcspn(p, " ?\r\n");
+    if (plen == 8 && memcmp(p, "/metrics", 8) == 0) {
+        // La copia va bajo el lock: el hook no reescribe este buffer mientras tanto
+        pthread_mutex_lock(&h->lock);
+        if (h->front >= 0) {
+            const Exporter *b = &h->body[h->front];
+            respond(h, c, 200, "OK", "text/plain; version=0.0.4; charset=utf-8", b->buf, b->len, head_only);
+        }
+        int ready = h->front >= 0;
+        pthread_mutex_unlock(&h->lock);
+        if (!ready) respond_text(h, c, 503, "Service Unavailable", "Aún no hay muestras.\n", head_only);
+    } else if (plen == 1 && p[0] == '/') {
+        respond_text(h, c, 200, "OK", "rpi-sysinfo-tui: métricas en /metrics\n", head_only);
+    } else {
+        respond_text(h, c, 404, "Not Found", "No existe; las métricas están en /metrics.\n", head_only);
+    }
+}
+
+// Envía lo que se pueda; 1 si la conexión terminó (respuesta completa o error)
+static int conn_flush(Conn *c) {
+    while (c->resp_off < c->resp_len) {
+        ssize_t w = send(c->fd, c->resp + c->resp_off, c->resp_len - c->resp_off, MSG_NOSIGNAL);
+        if (w < 0) {
+            if (errno == EINTR) continue;
+            return errno != EAGAIN && errno != EWOULDBLOCK;
+        }
+        c->resp_off += (size_t)w;
+    }
+    return 1;
+}
+
+static void conn_event(Httpd *h, Conn *c, uint32_t events) {
+    if (events & (EPOLLERR | EPOLLHUP)) { conn_close(h, c); return; }
+    if (!c->writing) {
+        for (;;) {
+            ssize_t r = recv(c->fd, c->req + c->req_len, sizeof(c->req) - 1 - c->req_len, 0);
+            if (r < 0) {
+                if (errno == EINTR) continue;
+                if (errno == EAGAIN || errno == EWOULDBLOCK) return;   // falta el resto
+                conn_close(h, c);
+                return;
+            }
+            if (r == 0) { conn_close(h, c); return; }   // cerró sin terminar la petición
+            c->req_len += (size_t)r;
+            c->req[c->req_len] = '\0';
+            c->deadline_ms = monotonic_ms() + HTTPD_IDLE_MS;
+            if (strstr(c->req, "\r\n\r\n") || strstr(c->req, "\n\n")) break;
+            if (c->req_len == sizeof(c->req) - 1) {
+                respond_text(h, c, 431, "Request Header Fields Too Large", "Petición demasiado grande.\n", 0);
+                goto send;
+            }
+        }
+        handle_request(h, c);
+send:
+        c->writing = 1;
+    }
+    if (conn_flush(c)) {
+        conn_close(h, c);
+        return;
+    }
+    // Queda respuesta: esperar a que el socket acepte más
+    struct epoll_event ev = { .events = EPOLLOUT, .data.u32 = (uint32_t)(c - h->conn) };
+    epoll_ctl(h->epoll_fd, EPOLL_CTL_MOD, c->fd, &ev);
+    c->deadline_ms = monotonic_ms() + HTTPD_IDLE_MS;
+}
+
+static void *httpd_main(void *arg) {
+    Httpd *h = arg;
+    struct epoll_event evs[HTTPD_MAX_CONN + 2];
+    for (;;) {
+        int n = epoll_wait(h->epoll_fd, evs, HTTPD_MAX_CONN + 2, 1000);
+        if (n < 0 && errno != EINTR) break;
+        for (int i = 0; i < n; ++i) {
+            uint32_t id = evs[i].data.u32;
+            if (id == EV_STOP) return NULL;
+            if (id == EV_LISTEN) accept_all(h);
+            else if (h->conn[id].fd >= 0) conn_event(h, &h->conn[id], evs[i].events);
+        }
+        // Clientes que abren y no piden nada (o no leen) no retienen un hueco
+        long long now = monotonic_ms();
+        for (int i = 0; i < HTTPD_MAX_CONN; ++i)
+            if (h->conn[i].fd >= 0 && now >= h->conn[i].deadline_ms) conn_close(h, &h->conn[i]);
+    }
+    return NULL;
+}
+
+// ==================== API ====================
+
+Httpd *httpd_start(const char *addr, const CPUInfo *info, int cores, char *err, size_t errlen) {
+    char dummy[8];
+    if (!err || errlen == 0) { err = dummy; errlen = sizeof(dummy); }
+    if (!addr || cores < 1) {
+        snprintf(err, errlen, "argumentos inválidos");
+        return NULL;
+    }
+    Httpd *h = calloc(1, sizeof(*h));
+    if (!h) {
+        snprintf(err, errlen, "sin memoria");
+        return NULL;
+    }
+    h->listen_fd = h->epoll_fd = h->stop_fd = -1;
+    h->front = -1;
+    for (int i = 0; i < HTTPD_MAX_CONN; ++i) h->conn[i].fd = -1;
+
+    // Todos los buffers se reservan aquí: dos cuerpos y una respuesta por conexión
+    if (exporter_init(&h->body[0], EXPORT_PROM, -1, cores) != 0 ||
+        exporter_init(&h->body[1], EXPORT_PROM, -1, cores) != 0) {
+        snprintf(err, errlen, "sin memoria");
+        goto fail;
+    }
+    h->body[0].info = h->body[1].info = info;
+    h->resp_cap = HTTPD_HEAD_MAX + h->body[0].cap;
+    h->resp_block = malloc(HTTPD_MAX_CONN * h->resp_cap);
+    if (!h->resp_block) {
+        snprintf(err, errlen, "sin memoria");
+        goto fail;
+    }
+    for (int i = 0; i < HTTPD_MAX_CONN; ++i) h->conn[i].resp = h->resp_block + (size_t)i * h->resp_cap;
+
+    h->listen_fd = strncmp(addr, "unix:", 5) == 0 ? listen_unix(h, addr + 5, err, errlen)
+                                                  : listen_tcp(addr, err, errlen);
+    if (h->listen_fd < 0) goto fail;
+
+    h->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    h->stop_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    struct epoll_event el = { .events = EPOLLIN, .data.u32 = EV_LISTEN };
+    struct epoll_event es = { .events = EPOLLIN, .data.u32 = EV_STOP };
+    if (h->epoll_fd < 0 || h->stop_fd < 0 ||
+        epoll_ctl(h->epoll_fd, EPOLL_CTL_ADD, h->listen_fd, &el) != 0 ||
+        epoll_ctl(h->epoll_fd, EPOLL_CTL_ADD, h->stop_fd, &es) != 0) {
+        snprintf(err, errlen, "epoll: %s", strerror(errno));
+        goto fail;
+    }
+    h->listening = 1;
+    pthread_mutex_init(&h->lock, NULL);
+    if (pthread_create(&h->thread, NULL, httpd_main, h) != 0) {
+        snprintf(err, errlen, "no se pudo crear el hilo");
+        pthread_mutex_destroy(&h->lock);
+        goto fail;
+    }
+    return h;
+
+fail:
+    if (h->epoll_fd >= 0) close(h->epoll_fd);
+    if (h->stop_fd >= 0) close(h->stop_fd);
+    if (h->listen_fd >= 0) close(h->listen_fd);
+    if (h->unix_path[0]) unlink(h->unix_path);
+    exporter_free(&h->body[0]);
+    exporter_free(&h->body[1]);
+    free(h->resp_block);
+    free(h);
+    return NULL;
+}
+
+void httpd_hook(const Snapshot *snap, void *arg) {
+    Httpd *h = arg;
+    int back = h->front == 0 ? 1 : 0;   // 'front' solo lo cambia este hilo
+    if (exporter_format(&h->body[back], snap) != 0) return;
+    pthread_mutex_lock(&h->lock);
+    h->front = back;
+    pthread_mutex_unlock(&h->lock);
+}
+
+void httpd_stop(Httpd *h) {
+    if (!h) return;
+    uint64_t one = 1;
+    ssize_t w = write(h->stop_fd, &one, sizeof(one));
+    (void)w;
+    pthread_join(h->thread, NULL);
+
+    for (int i = 0; i < HTTPD_MAX_CONN; ++i) if (h->conn[i].fd >= 0) close(h->conn[i].fd);
+    close(h->epoll_fd);
+    close(h->stop_fd);
+    close(h->listen_fd);
+    if (h->unix_path[0]) unlink(h->unix_path);
+    pthread_mutex_destroy(&h->lock);
+    exporter_free(&h->body[0]);
+    exporter_free(&h->body[1]);
+    free(h->resp_block);
+    free(h);
+}
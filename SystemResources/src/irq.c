@@ -0,0 +1,389 @@
+#include "irq.h"
+#include "procfile.h"
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define IRQ_LABEL_MAX 16   // "NMI", "IPI0", "12345" (las etiquetas más largas se ignoran)
+
+// En una máquina grande las tablas son anchas: cada contador va alineado a 11
+// caracteres, así que con 192 núcleos una fila tiene ~2 KiB de los que más de
+// la mitad son espacios. El parser recorre cada fila una vez saltando el
+// relleno y leyendo los dígitos de 8 en 8 bytes (SWAR) en vez de byte a byte.
+#if defined(__GNUC__) && defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#define IRQ_SWAR 1
+#else
+#define IRQ_SWAR 0
+#endif
+
+#define SWAR_ONES(b) (0x0101010101010101ULL * (uint64_t)(b))
+
+typedef struct {
+    char          label[IRQ_LABEL_MAX];   // lo que va antes de ':'
+    char          name[IRQ_NAME_MAX];     // lo que se muestra
+    unsigned char prev_valid;             // prev[] de esta fila es de la muestra anterior
+    unsigned char per_cpu;                // tiene una columna por núcleo (ERR/MIS no)
+} IrqRow;
+
+// Una de las dos tablas. prev[] y delta[] son matrices filas × ncols.
+typedef struct {
+    ProcFile            file;
+    int                 softirq;
+    int                 ncols;
+    int                 col_cap;
+    int                *col_cpu;      // columna → id de núcleo (la cabecera solo lista los en línea)
+    int                 nrows;
+    int                 row_cap;
+    IrqRow             *row;
+    unsigned long long *prev;
+    uint32_t           *delta;        // eventos en el intervalo (cabe de sobra a 1 Hz)
+} IrqTable;
+
+struct IrqSampler {
+    IrqTable            tab[2];       // 0 = /proc/interrupts, 1 = /proc/softirqs
+    int                 core_cap;
+    unsigned long long *core_irq;     // por id de núcleo
+    unsigned long long *core_soft;
+    struct timespec     prev_ts;
+    int                 initialized;
+};
+
+// ---------- Parser ----------
+static inline int is_digit(char c) { return c >= '0' && c <= '9'; }
+
+// Salta espacios; con 8 bytes disponibles compara palabras enteras.
+static inline const char *skip_blank(const char *p, const char *end) {
+#if IRQ_SWAR
+    while (end - p >= 8) {
+        uint64_t w;
+        memcpy(&w, p, 8);
+        uint64_t x = w ^ SWAR_ONES(' ');
+        if (x) return p + (__builtin_ctzll(x) >> 3);
+        p += 8;
+    }
+#else
+    (void)end;
+#endif
+    while (*p == ' ') p++;
+    return p;
+}
+
+// Entero sin signo que empieza en 'p' (que debe ser un dígito). Devuelve el
+// puntero tras el último dígito.
+static inline const char *parse_count(const char *p, const char *end, unsigned long long *out) {
+    unsigned long long v = 0;
+#if IRQ_SWAR
+    while (end - p >= 8) {
+        uint64_t w;
+        memcpy(&w, p, 8);
+        // Un byte es dígito si su nibble alto es 3 y sigue siéndolo al sumarle 6
+        uint64_t hi = SWAR_ONES(0xF0);
+        uint64_t bad = ((w & hi) ^ SWAR_ONES(0x30)) |
+                       (((w + SWAR_ONES(0x06)) & hi) ^ SWAR_ONES(0x30));
+        int n = bad ? (__builtin_ctzll(bad) >> 3) : 8;
+        if (n == 0) { *out = v; return p; }
+        // Alinea los n dígitos al final de la palabra (los bytes bajos quedan
+        // como ceros a la izquierda) y los combina por parejas: 8 → 4 → 2 → 1
+        uint64_t x = (w << (8 * (8 - n))) & SWAR_ONES(0x0F);
+        x = (x * 10 + (x >> 8)) & 0x00FF00FF00FF00FFULL;
+        x = (x * 100 + (x >> 16)) & 0x0000FFFF0000FFFFULL;
+        x = (x * 10000 + (x >> 32)) & 0xFFFFFFFFULL;
+        static const unsigned long long pow10[9] = {
+            1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000 };
+        v = v * pow10[n] + x;
+        p += n;
+        if (n < 8) { *out = v; return p; }
+    }
+#else
+    (void)end;
+#endif
+    while (is_digit(*p)) v = v * 10ULL + (unsigned long long)(*p++ - '0');
+    *out = v;
+    return p;
+}
+
+// ---------- Tablas ----------
+static int grow_cols(IrqTable *t, int need) {
+    if (need <= t->col_cap) return 0;
+    int cap = t->col_cap ? t->col_cap : 16;
+    while (cap < need) cap *= 2;
+    int *c = realloc(t->col_cpu, (size_t)cap * sizeof(*c));
+    if (!c) return 3;
+    t->col_cpu = c;
+    t->col_cap = cap;
+    return 0;
+}
+
+// prev[] y delta[] dependen de ncols: si cambia el número de columnas se
+// reservan de nuevo y todas las filas pierden su muestra anterior.
+static int resize_matrix(IrqTable *t, int rows, int cols) {
+    size_t cells = (size_t)rows * (size_t)cols;
+    unsigned long long *p = realloc(t->prev, cells * sizeof(*p) + 1);
+    if (!p) return 3;
+    t->prev = p;
+    uint32_t *d = realloc(t->delta, cells * sizeof(*d) + 1);
+    if (!d) return 3;
+    t->delta = d;
+    return 0;
+}
+
+// "           CPU0       CPU1       CPU5" (los desconectados no salen).
+// Devuelve 0 si OK, 2 si la cabecera no es válida, 3 sin memoria. *changed = 1
+// si las columnas no son las de la muestra anterior.
+static int parse_header(IrqSampler *s, IrqTable *t, const char **pp, const char *end, int *changed) {
+    const char *p = *pp;
+    int col = 0;
+    *changed = 0;
+    for (;;) {
+        p = skip_blank(p, end);
+        if (p[0] != 'C' || p[1] != 'P' || p[2] != 'U' || !is_digit(p[3])) break;
+        unsigned long long id;
+        p = parse_count(p + 3, end, &id);
+        if (id > 0xFFFF) return 2;
+        if (grow_cols(t, col + 1) != 0) return 3;
+        if (col >= t->ncols || t->col_cpu[col] != (int)id) *changed = 1;
+        t->col_cpu[col++] = (int)id;
+        if ((int)id >= s->core_cap) {
+            int cap = s->core_cap ? s->core_cap : 16;
+            while (cap <= (int)id) cap *= 2;
+            unsigned long long *a = realloc(s->core_irq, (size_t)cap * sizeof(*a));
+            if (!a) return 3;
+            s->core_irq = a;
+            unsigned long long *b = realloc(s->core_soft, (size_t)cap * sizeof(*b));
+            if (!b) return 3;
+            s->core_soft = b;
+            s->core_cap = cap;
+        }
+    }
+    if (col == 0) return 2;
+    if (col != t->ncols) *changed = 1;
+    if (*changed) {
+        if (resize_matrix(t, t->row_cap, col) != 0) return 3;
+        t->ncols = col;
+        for (int i = 0; i < t->row_cap; ++i) t->row[i].prev_valid = 0;
+    }
+    *pp = pf_next_line(p);
+    return 0;
+}
+
+// Nombre a mostrar: para las IRQ numeradas, el último campo de la descripción
+// ("... PCI-MSIX-0000:00:03.0 1-edge virtio1-input.0" → "virtio1-input.0",
+// sin el "@pci:…" que añade mlx5); para las demás (LOC, IPI0, NET_RX…), la
+// etiqueta.
+static void row_name(IrqRow *r, size_t label_len, const char *desc, const char *eol) {
+    int numeric = label_len > 0;
+    for (size_t i = 0; i < label_len; ++i) if (!is_digit(r->label[i])) numeric = 0;
+    const char *b = eol, *e = eol;
+    if (numeric) {
+        while (e > desc && (e[-1] == ' ' || e[-1] == '\t')) e--;
+        b = e;
+        while (b > desc && b[-1] != ' ' && b[-1] != '\t') b--;
+        const char *at = memchr(b, '@', (size_t)(e - b));
+        if (at && at > b) e = at;
+    }
+    if (b == e) { b = r->label; e = r->label + label_len; }
+    size_t len = (size_t)(e - b);
+    if (len >= IRQ_NAME_MAX) len = IRQ_NAME_MAX - 1;
+    memcpy(r->name, b, len);
+    r->name[len] = '\0';
+}
+
+// Fila 'idx' con esta etiqueta. El orden de las tablas solo cambia cuando se
+// registra o libera una IRQ (carga de un módulo, hotplug de un dispositivo):
+// entonces las filas desplazadas se rebautizan y pierden un delta.
+static IrqRow *row_at(IrqTable *t, int idx, const char *label, size_t len, int *fresh) {
+    if (idx >= t->row_cap) {
+        int cap = t->row_cap ? t->row_cap * 2 : 64;
+        IrqRow *r = realloc(t->row, (size_t)cap * sizeof(*r));
+        if (!r) return NULL;
+        t->row = r;
+        if (resize_matrix(t, cap, t->ncols) != 0) return NULL;
+        memset(&t->row[t->row_cap], 0, (size_t)(cap - t->row_cap) * sizeof(*r));
+        t->row_cap = cap;
+    }
+    IrqRow *r = &t->row[idx];
+    *fresh = 0;
+    if (strncmp(r->label, label, len) != 0 || r->label[len] != '\0') {
+        memcpy(r->label, label, len);
+        r->label[len] = '\0';
+        r->prev_valid = 0;
+        *fresh = 1;
+    }
+    return r;
+}
+
+// Relee una tabla y deja en delta[] los eventos de cada fila y núcleo.
+// Devuelve 0 si OK, 2 error de lectura, 3 sin memoria.
+static int table_sample(IrqSampler *s, IrqTable *t) {
+    int rc = procfile_read(&t->file);
+    if (rc != 0) return rc == 3 ? 3 : 2;
+    const char *p = t->file.buf;
+    const char *end = t->file.buf + t->file.len;
+    int changed;
+    if ((rc = parse_header(s, t, &p, end, &changed)) != 0) return rc;
+
+    int idx = 0;
+    const int ncols = t->ncols;
+    while (*p) {
+        const char *label = skip_blank(p, end);
+        const char *c = label;
+        while (*c && *c != ':' && *c != '\n') c++;
+        size_t len = (size_t)(c - label);
+        if (*c != ':' || len == 0 || len >= IRQ_LABEL_MAX) { p = pf_next_line(c); continue; }
+
+        int fresh;
+        IrqRow *r = row_at(t, idx, label, len, &fresh);
+        if (!r) return 3;
+        unsigned long long *prev = &t->prev[(size_t)idx * (size_t)ncols];
+        uint32_t *delta = &t->delta[(size_t)idx * (size_t)ncols];
+        idx++;
+
+        int n = 0;
+        c++;
+        while (n < ncols) {
+            c = skip_blank(c, end);
+            if (!is_digit(*c)) break;
+            unsigned long long v;
+            c = parse_count(c, end, &v);
+            unsigned long long d = r->prev_valid ? pf_counter_delta(v, prev[n]) : 0;
+            delta[n] = d > 0xFFFFFFFFULL ? 0xFFFFFFFFU : (uint32_t)d;
+            prev[n++] = v;
+        }
+        // ERR/MIS (y algunas de arm64) son un solo contador global, no por núcleo
+        r->per_cpu = (n == ncols);
+        r->prev_valid = r->per_cpu;
+        if (!r->per_cpu) memset(delta, 0, (size_t)ncols * sizeof(*delta));
+
+        const char *eol = c;
+        while (*eol && *eol != '\n') eol++;
+        if (fresh) row_name(r, len, c, eol);
+        p = *eol ? eol + 1 : eol;
+    }
+    t->nrows = idx;
+    return 0;
+}
+
+static int col_of(const IrqTable *t, int cpu) {
+    for (int i = 0; i < t->ncols; ++i)
+        if (t->col_cpu[i] == cpu) return i;
+    return -1;
+}
+
+// Inserta una fuente en hot->src[] si está entre las IRQ_SRC_MAX con más eventos.
+static void src_insert(IrqHotCore *h, const IrqRow *r, int softirq, double rate) {
+    int pos = h->nsrc;
+    while (pos > 0 && h->src[pos - 1].rate < rate) pos--;
+    if (pos >= IRQ_SRC_MAX) return;
+    int last = h->nsrc < IRQ_SRC_MAX ? h->nsrc : IRQ_SRC_MAX - 1;
+    memmove(&h->src[pos + 1], &h->src[pos], (size_t)(last - pos) * sizeof(h->src[0]));
+    IrqSource *src = &h->src[pos];
+    memcpy(src->name, r->name, sizeof(src->name));
+    src->softirq = softirq;
+    src->rate = rate;
+    if (h->nsrc < IRQ_SRC_MAX) h->nsrc++;
+}
+
+static void fill_hot(const IrqSampler *s, IrqStats *out, double dt) {
+    unsigned long long load[IRQ_HOT_MAX];
+    for (int cpu = 0; cpu < s->core_cap; ++cpu) {
+        unsigned long long v = s->core_irq[cpu] + s->core_soft[cpu];
+        if (v == 0) continue;
+        int pos = out->nhot;
+        while (pos > 0 && load[pos - 1] < v) pos--;
+        if (pos >= IRQ_HOT_MAX) continue;
+        int last = out->nhot < IRQ_HOT_MAX ? out->nhot : IRQ_HOT_MAX - 1;
+        memmove(&load[pos + 1], &load[pos], (size_t)(last - pos) * sizeof(load[0]));
+        memmove(&out->hot[pos + 1], &out->hot[pos], (size_t)(last - pos) * sizeof(out->hot[0]));
+        load[pos] = v;
+        IrqHotCore *h = &out->hot[pos];
+        memset(h, 0, sizeof(*h));
+        h->cpu = cpu;
+        h->irq_ps = (double)s->core_irq[cpu] / dt;
+        h->softirq_ps = (double)s->core_soft[cpu] / dt;
+        if (out->nhot < IRQ_HOT_MAX) out->nhot++;
+    }
+
+    // Solo se recorren las columnas de los núcleos calientes
+    for (int k = 0; k < out->nhot; ++k) {
+        IrqHotCore *h = &out->hot[k];
+        for (int ti = 0; ti < 2; ++ti) {
+            const IrqTable *t = &s->tab[ti];
+            int col = col_of(t, h->cpu);
+            if (col < 0) continue;
+            for (int i = 0; i < t->nrows; ++i) {
+                uint32_t d = t->delta[(size_t)i * (size_t)t->ncols + (size_t)col];
+                if (d) src_insert(h, &t->row[i], t->softirq, (double)d / dt);
+            }
+        }
+    }
+}
+
+// ---------- API ----------
+IrqSampler *irq_sampler_create(void) {
+    IrqSampler *s = calloc(1, sizeof(*s));
+    if (!s) return NULL;
+    s->tab[0].file = s->tab[1].file = (ProcFile)PROCFILE_INIT;
+    s->tab[1].softirq = 1;
+    if (procfile_open(&s->tab[0].file, "/proc/interrupts", 16384) != 0) {
+        free(s);
+        return NULL;
+    }
+    (void)procfile_open(&s->tab[1].file, "/proc/softirqs", 4096);   // opcional
+    return s;
+}
+
+void irq_sampler_destroy(IrqSampler *s) {
+    if (!s) return;
+    for (int i = 0; i < 2; ++i) {
+        IrqTable *t = &s->tab[i];
+        procfile_close(&t->file);
+        free(t->col_cpu);
+        free(t->row);
+        free(t->prev);
+        free(t->delta);
+    }
+    free(s->core_irq);
+    free(s->core_soft);
+    free(s);
+}
+
+int irq_sampler_sample(IrqSampler *s, IrqStats *out) {
+    if (!s || !out) return 1;
+    memset(out, 0, sizeof(*out));
+
+    int rc = table_sample(s, &s->tab[0]);
+    if (rc != 0) return rc;
+    if (s->tab[1].file.fd >= 0 && (rc = table_sample(s, &s->tab[1])) != 0) {
+        if (rc == 3) return 3;
+        s->tab[1].nrows = 0;   // sin softirqs esta vez: la muestra sigue valiendo
+    }
+
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    double dt = (double)(now.tv_sec - s->prev_ts.tv_sec) +
+                (double)(now.tv_nsec - s->prev_ts.tv_nsec) / 1e9;
+    out->ready = s->initialized && dt > 0.0;
+    out->interval_s = s->initialized ? dt : 0.0;
+    out->ncpus = s->tab[0].ncols;
+    s->prev_ts = now;
+    s->initialized = 1;
+    if (!out->ready) return 0;
+
+    // Totales por núcleo: una pasada secuencial por cada matriz
+    memset(s->core_irq, 0, (size_t)s->core_cap * sizeof(*s->core_irq));
+    memset(s->core_soft, 0, (size_t)s->core_cap * sizeof(*s->core_soft));
+    unsigned long long total[2] = { 0, 0 };
+    for (int ti = 0; ti < 2; ++ti) {
+        const IrqTable *t = &s->tab[ti];
+        unsigned long long *core = ti ? s->core_soft : s->core_irq;
+        const uint32_t *d = t->delta;
+        for (int i = 0; i < t->nrows; ++i, d += t->ncols)
+            for (int c = 0; c < t->ncols; ++c) core[t->col_cpu[c]] += d[c];
+        for (int c = 0; c < t->ncols; ++c) total[ti] += core[t->col_cpu[c]];
+    }
+    out->irq_ps = (double)total[0] / dt;
+    out->softirq_ps = (double)total[1] / dt;
+    fill_hot(s, out, dt);
+    return 0;
+}
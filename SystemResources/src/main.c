@@ -1,46 +1,812 @@
 #include "memory.h"
 #include "cpu.h"
+#include "sampler.h"
+#include "history.h"
+#include "stats.h"
+#include "export.h"
+#include "record.h"
+#include "alert.h"
+#include "httpd.h"
+#include "shm.h"
+#include "procfile.h"
 #include "tui.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <getopt.h>
+#include <poll.h>
+#include <signal.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
 
-static CPUInfo g_info;  // cache: no cambia frecuentemente
-
-static void draw_once(void) {
-    MemStats mem;
-    CPUUsage usage;
+#define DEFAULT_INTERVAL_MS 2000
+#define MIN_INTERVAL_MS     50
+#define MAX_INTERVAL_MS     3600000
+#define DEFAULT_HISTORY     300      // 10 min a 2 s
+#define MIN_HISTORY         16
+#define MAX_HISTORY         86400
+#define MIN_SPEED           0.125
+#define MAX_SPEED           1024.0
+#define SEEK_SHORT_MS       10000    // ←/→
+#define SEEK_LONG_MS        60000    // PgUp/PgDn
 
-    int rc1 = mem_read_stats(&mem);
-    int rc2 = cpu_read_usage(&usage);  // primera llamada del programa marcará ready=0
+static CPUInfo g_info;  // cache: no cambia frecuentemente
+static History g_hist;  // últimas N muestras (sparklines), reservado al arrancar; en vivo lo llena history_hook
+static Stats   g_stats; // medias, min/max y percentiles en ventana, ídem (stats_hook)
+static AlertEngine *g_alerts;   // --alerts: evalúa en el hilo de muestreo, aquí solo se lee su estado
+static Httpd       *g_httpd;    // --listen: servidor de /metrics en su propio hilo
+static ShmPublisher *g_shm;     // --publish: anillo de muestras en memoria compartida
 
-    if (rc1 != 0) {
+// Dibuja una muestra ya tomada por el hilo de muestreo (la UI nunca lee /proc)
+static void render(const Snapshot *snap) {
+    if (!snap) return;   // aún no hay primera muestra
+    if (snap->mem_rc != 0) {
         tui_draw_memory("ERROR leyendo /proc/meminfo");
         return;
     }
-    (void)rc2; // si falla /proc/stat, simplemente mostrará "calculando…"
+    // si falla /proc/stat, cpu.ready = 0 y simplemente mostrará "calculando…"
+    tui_set_disk_stats(snap->disk_rc == 0 ? &snap->disk : NULL);
+    tui_set_net_stats(snap->net_rc == 0 ? &snap->net : NULL);
+    tui_set_psi_stats(snap->psi_rc == 0 ? &snap->psi : NULL);
+    tui_set_proc_stats(snap->procs_rc == 0 ? &snap->procs : NULL);
+    tui_set_thermal_stats(snap->thermal_rc == 0 ? &snap->thermal : NULL);
+    tui_set_cgroup_stats(snap->cgroup_rc == 0 ? &snap->cgroup : NULL);
+    tui_set_irq_stats(snap->irq_rc == 0 ? &snap->irq : NULL);
+    if (g_alerts) {
+        char last[ALERT_NAME_MAX];
+        int firing = alert_firing(g_alerts, last, sizeof(last));
+        tui_set_alerts(alert_rule_count(g_alerts), firing, last);
+    }
+    // Sparklines y estadísticas se leen mientras el hilo de muestreo las
+    // alimenta: de las estadísticas solo se copian los resúmenes y el
+    // historial se suelta tras componer, antes de escribir a la terminal
+    // (una terminal lenta no debe frenar el muestreo)
+    stats_lock(&g_stats);
+    tui_take_stats();
+    stats_unlock(&g_stats);
+    history_lock(&g_hist);
+    tui_draw_system_dashboard(&snap->mem, &g_info, &snap->cpu);
+    history_unlock(&g_hist);
+    tui_present();
+}
+
+static void usage(const char *prog) {
+    fprintf(stderr,
+            "Uso: %s [opciones]\n"
+            "  -i, --interval-ms N   periodo de muestreo en ms (%d..%d, por defecto %d)\n"
+            "  -H, --history N       muestras de historial por métrica (%d..%d, por defecto %d)\n"
+            "  -b, --batch           sin TUI: una línea por muestra (JSON Lines o CSV)\n"
+            "  -f, --format F        formato de --batch: jsonl (por defecto) o csv\n"
+            "  -o, --output FILE     destino de --batch (añade al final; por defecto stdout)\n"
+            "  -n, --count N         con --batch, termina tras N muestras (0 = sin límite)\n"
+            "  -r, --record FILE     graba cada muestra en FILE (binario compacto; TUI o --batch)\n"
+            "  -p, --replay FILE     reproduce una grabación en el dashboard\n"
+            "  -x, --speed X         velocidad inicial de --replay (%.2g..%.0f, por defecto 1)\n"
+            "  -P, --proc-root DIR   lee procfs desde DIR en vez de /proc (p. ej. /host/proc)\n"
+            "  -S, --sys-root DIR    lee sysfs desde DIR en vez de /sys (p. ej. /host/sys)\n"
+            "  -c, --cgroup CG       memoria y CPU de un cgroup v2: 'self' (el propio, p. ej.\n"
+            "                        dentro de un contenedor) o su ruta (/system.slice/x.service)\n"
+            "  -a, --alerts FILE     reglas de alerta (p. ej. 'cpu.core[*] > 0.95 for 10s');\n"
+            "                        se evalúan en cada muestra, con la TUI o con --batch\n"
+            "  -l, --listen ADDR     sirve /metrics (Prometheus) en PUERTO (127.0.0.1),\n"
+            "                        HOST:PUERTO o unix:RUTA; con la TUI o con --batch\n"
+            "  -W, --publish NAME    publica cada muestra (y el historial) en la memoria\n"
+            "                        compartida NAME (/dev/shm/NAME); con la TUI o con --batch\n"
+            "  -V, --view NAME       solo dibuja lo que publica otro proceso con --publish NAME\n"
+            "                        (no lee /proc; el historial es el del publicador)\n"
+            "  -h, --help            muestra esta ayuda\n",
+            prog, MIN_INTERVAL_MS, MAX_INTERVAL_MS, DEFAULT_INTERVAL_MS,
+            MIN_HISTORY, MAX_HISTORY, DEFAULT_HISTORY, MIN_SPEED, MAX_SPEED);
+}
+
+// Parsea un entero decimal en [lo, hi]. Devuelve 0 si OK.
+static int parse_int_arg(const char *s, int lo, int hi, int *out) {
+    char *end = NULL;
+    errno = 0;
+    long v = strtol(s, &end, 10);
+    if (errno != 0 || end == s || *end != '\0' || v < lo || v > hi) return 1;
+    *out = (int)v;
+    return 0;
+}
+
+// Parsea un real en [lo, hi]. Devuelve 0 si OK.
+static int parse_double_arg(const char *s, double lo, double hi, double *out) {
+    char *end = NULL;
+    errno = 0;
+    double v = strtod(s, &end);
+    if (errno != 0 || end == s || *end != '\0' || !(v >= lo && v <= hi)) return 1;
+    *out = v;
+    return 0;
+}
+
+// Teclas de vista comunes a la TUI en vivo y a --replay. Devuelve 1 si la
+// tecla era una de ellas.
+static int handle_view_key(int ch) {
+    switch (ch) {
+    case 'r':
+        tui_force_full_redraw();
+        return 1;
+    case 'b':
+        tui_set_cpu_bar_mode(tui_get_cpu_bar_mode() == TUI_CPU_BARS_TOTAL
+                             ? TUI_CPU_BARS_STACKED : TUI_CPU_BARS_TOTAL);
+        return 1;
+    case 'h':
+        tui_set_cpu_view(tui_get_cpu_view() == TUI_CPU_VIEW_BARS
+                         ? TUI_CPU_VIEW_HEATMAP : TUI_CPU_VIEW_BARS);
+        return 1;
+    case 's':
+        tui_cycle_heatmap_sort();
+        return 1;
+    case 'm':
+        tui_set_proc_sort(tui_get_proc_sort() == TUI_PROC_SORT_CPU
+                          ? TUI_PROC_SORT_RSS : TUI_PROC_SORT_CPU);
+        return 1;
+    case 'e':
+        tui_set_core_stats(!tui_get_core_stats());
+        return 1;
+    default:
+        return 0;
+    }
+}
+
+// Hook del hilo de muestreo para --record: ve todas las muestras, no solo
+// las que la UI alcanza a dibujar.
+static void record_hook(const Snapshot *snap, void *arg) {
+    recorder_write((Recorder *)arg, snap);
+}
+
+// ==================== Modo --batch (sin ncurses) ====================
+
+static volatile sig_atomic_t g_stop = 0;
+static void on_stop_signal(int sig) { (void)sig; g_stop = 1; }
+
+// Emite cada muestra publicada por el hilo de muestreo hasta SIGINT/SIGTERM,
+// 'count' muestras o un error de escritura (p. ej. el lector cerró el pipe).
+static int run_batch(int interval_ms, ExportFormat fmt, const char *path, long count,
+                     const SamplerHook *hooks, int nhooks) {
+    // Sin SA_RESTART: poll() vuelve con EINTR y el bucle termina limpio
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = on_stop_signal;
+    sigaction(SIGINT, &sa, NULL);
+    sigaction(SIGTERM, &sa, NULL);
+    signal(SIGPIPE, SIG_IGN);   // EPIPE en write() en vez de matar el proceso
+
+    int fd = STDOUT_FILENO;
+    if (path) {
+        fd = open(path, O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+        if (fd < 0) {
+            fprintf(stderr, "No se pudo abrir '%s': %s\n", path, strerror(errno));
+            return 1;
+        }
+    }
+
+    Exporter ex;
+    int rc = exporter_init(&ex, fmt, fd, cpu_possible_count());
+    Sampler *sampler = (rc == 0) ? sampler_start(interval_ms, hooks, nhooks) : NULL;
+    if (!sampler) {
+        fprintf(stderr, rc == 0 ? "No se pudo iniciar el hilo de muestreo.\n"
+                                : "No se pudo preparar la salida de --batch.\n");
+        exporter_free(&ex);
+        if (path) close(fd);
+        return 1;
+    }
+
+    struct pollfd pfd = { .fd = sampler_notify_fd(sampler), .events = POLLIN, .revents = 0 };
+    unsigned long long last_seq = 0;
+    long emitted = 0;
+    rc = 0;
+    while (!g_stop && (count == 0 || emitted < count)) {
+        if (poll(&pfd, 1, -1) < 0) {
+            if (errno == EINTR) continue;
+            rc = 1;
+            break;
+        }
+        sampler_clear_notify(sampler);
+        const Snapshot *snap = sampler_acquire(sampler);
+        if (!snap || snap->seq == last_seq) continue;
+        last_seq = snap->seq;
+        if (exporter_write(&ex, snap) != 0) {
+            if (errno != EPIPE) fprintf(stderr, "Error escribiendo la salida: %s\n", strerror(errno));
+            rc = (errno == EPIPE) ? 0 : 1;
+            break;
+        }
+        emitted++;
+    }
+
+    sampler_stop(sampler);
+    exporter_free(&ex);
+    if (path) close(fd);
+    return rc;
+}
+
+// ==================== Modo --replay ====================
+
+static long long monotonic_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000 + ts.tv_nsec / 1000000L;
+}
+
+// Salta a 'ms' y rellena el historial con las muestras previas, para que las
+// sparklines muestren el contexto del punto de destino y no arranquen vacías.
+static void replay_seek(Player *p, long long ms) {
+    long long span = (long long)g_hist.cap * (player_interval_ms(p) > 0 ? player_interval_ms(p) : 1000);
+    long long from = ms - span;
+    if (from < player_first_ms(p)) from = player_first_ms(p);
+    history_clear(&g_hist);
+    stats_clear(&g_stats);
+    player_seek_ms(p, from);
+    history_push(&g_hist, player_snapshot(p));
+    stats_push(&g_stats, player_snapshot(p));
+    while (player_next_ms(p) >= 0 && player_next_ms(p) <= ms) {
+        player_next(p);
+        history_push(&g_hist, player_snapshot(p));
+        stats_push(&g_stats, player_snapshot(p));
+    }
+}
 
-    tui_draw_system_dashboard(&mem, &g_info, &usage);
+static void replay_footer(const Player *p, double speed, int paused) {
+    char cur[16], end[16], text[160];
+    time_t t = (time_t)(player_time_ms(p) / 1000), e = (time_t)(player_last_ms(p) / 1000);
+    strftime(cur, sizeof(cur), "%H:%M:%S", localtime(&t));
+    strftime(end, sizeof(end), "%H:%M:%S", localtime(&e));
+    long long span = player_last_ms(p) - player_first_ms(p);
+    double pct = span > 0 ? 100.0 * (double)(player_time_ms(p) - player_first_ms(p)) / (double)span : 100.0;
+    snprintf(text, sizeof(text), "%s x%g %s/%s (%.0f%%) — espacio pausa, +/- velocidad, ←/→ ±10 s, PgUp/PgDn ±60 s, q salir",
+             paused ? (player_next_ms(p) < 0 ? "FIN" : "PAUSA") : "REPR.", speed, cur, end, pct);
+    tui_set_footer(text);
+    tui_set_clock(t);
 }
 
-int main(void) {
+// Reproduce una grabación con un reloj virtual que avanza 'speed' veces el
+// reloj real; en cada vuelta se aplican todas las muestras ya vencidas y se
+// dibuja una sola vez.
+static int run_replay(const char *path, double speed, int history_len) {
+    Player *p = player_open(path, &g_info);
+    if (!p) {
+        fprintf(stderr, "No se pudo abrir la grabación '%s': %s\n", path, strerror(errno));
+        return 1;
+    }
+    if (history_init(&g_hist, history_len, player_cores(p)) != 0) {
+        fprintf(stderr, "Sin memoria para el historial (%zu bytes).\n",
+                history_bytes(history_len, player_cores(p)));
+        player_close(p);
+        return 1;
+    }
+    if (stats_init(&g_stats, stats_window_for(player_interval_ms(p)), player_cores(p)) != 0) {
+        fprintf(stderr, "Sin memoria para las estadísticas (%zu bytes).\n",
+                stats_bytes(stats_window_for(player_interval_ms(p)), player_cores(p)));
+        history_free(&g_hist);
+        player_close(p);
+        return 1;
+    }
     if (tui_init() != 0) {
         fprintf(stderr, "No se pudo inicializar la TUI (ncurses).\n");
+        history_free(&g_hist);
+        stats_free(&g_stats);
+        player_close(p);
         return 1;
     }
+    if (player_interval_ms(p) > 0) tui_set_refresh_interval_ms(player_interval_ms(p));
+    tui_set_history(&g_hist);
+    tui_set_stats(&g_stats);
 
-    // CPU info una sola vez
-    cpu_read_info(&g_info);
+    int paused = 0;
+    long long vt = player_time_ms(p);        // reloj virtual (ms de la grabación)
+    long long last = monotonic_ms();
+    history_push(&g_hist, player_snapshot(p));
+    stats_push(&g_stats, player_snapshot(p));
+    int redraw = 1;
 
-    draw_once();
+    struct pollfd pfd = { .fd = STDIN_FILENO, .events = POLLIN, .revents = 0 };
+    int running = 1;
+    while (running) {
+        if (redraw) {
+            replay_footer(p, speed, paused);
+            render(player_snapshot(p));
+            redraw = 0;
+        }
 
-    for (;;) {
-        int ch = tui_getch();     // timeout 2 s ya activo
-        if (ch == 'q') break;
-        if (ch == 'r' || tui_was_timeout(ch)) {
-            draw_once();
+        int timeout = -1;
+        if (!paused) {
+            double wait = (double)(player_next_ms(p) - vt) / speed;
+            timeout = wait < 0.0 ? 0 : (wait > 1000.0 ? 1000 : (int)wait + 1);
         }
+        if (poll(&pfd, 1, timeout) < 0 && errno != EINTR) break;
+
+        long long now = monotonic_ms();
+        if (!paused) vt += (long long)((double)(now - last) * speed);
+        last = now;
+
+        for (;;) {
+            int ch = tui_getch();
+            if (tui_was_timeout(ch)) break;
+            long long seek = 0;
+            switch (ch) {
+            case 'q': running = 0; break;
+            case ' ':
+                paused = !paused;
+                if (!paused && player_next_ms(p) < 0) replay_seek(p, player_first_ms(p));   // al final: reinicia
+                vt = player_time_ms(p);
+                break;
+            case '+': if (speed * 2.0 <= MAX_SPEED) speed *= 2.0; break;
+            case '-': if (speed / 2.0 >= MIN_SPEED) speed /= 2.0; break;
+            case TUI_KEY_LEFT:  seek = -SEEK_SHORT_MS; break;
+            case TUI_KEY_RIGHT: seek =  SEEK_SHORT_MS; break;
+            case TUI_KEY_PGUP:  seek = -SEEK_LONG_MS;  break;
+            case TUI_KEY_PGDN:  seek =  SEEK_LONG_MS;  break;
+            case TUI_KEY_HOME:  seek = player_first_ms(p) - player_time_ms(p); break;
+            case TUI_KEY_END:   seek = player_last_ms(p) - player_time_ms(p);  break;
+            default: handle_view_key(ch); break;   // incluye KEY_RESIZE
+            }
+            if (!running) break;
+            if (seek) {
+                replay_seek(p, player_time_ms(p) + seek);
+                vt = player_time_ms(p);
+            }
+            redraw = 1;
+        }
+
+        // Aplica las muestras vencidas según el reloj virtual
+        while (!paused && player_next_ms(p) >= 0 && player_next_ms(p) <= vt) {
+            player_next(p);
+            history_push(&g_hist, player_snapshot(p));
+            stats_push(&g_stats, player_snapshot(p));
+            redraw = 1;
+        }
+        if (!paused && player_next_ms(p) < 0) { paused = 1; redraw = 1; }
     }
 
     tui_end();
+    history_free(&g_hist);
+    stats_free(&g_stats);
+    player_close(p);
     return 0;
 }
 
+// ==================== Modo --view ====================
+
+#define VIEW_STALE_INTERVALS 3      // sin muestra nueva en N periodos: se avisa en el pie
+#define VIEW_REATTACH_MS     1000   // con el publicador muerto, reintento de adjuntarse
+
+// Pasa al historial las muestras del anillo desde '*next' hasta la última
+// publicada y deja la más reciente en 'snap'. Devuelve cuántas añadió.
+static int view_catch_up(ShmViewer *v, unsigned long long *next, Snapshot *snap) {
+    unsigned long long n = shm_viewer_count(v);
+    unsigned long long slots = (unsigned long long)shm_viewer_slots(v);
+    if (n > slots && *next < n - slots) *next = n - slots;   // lo anterior ya se sobrescribió
+    int added = 0;
+    for (; *next < n; ++*next) {
+        if (shm_viewer_read(v, *next, snap) != 0) continue;
+        history_push(&g_hist, snap);
+        stats_push(&g_stats, snap);
+        added++;
+    }
+    return added;
+}
+
+static void view_footer(const char *name, const ShmViewer *v, const Snapshot *snap, long long idle_ms) {
+    char text[160];
+    long long stale_ms = (long long)VIEW_STALE_INTERVALS * shm_viewer_interval_ms(v);
+    if (!shm_viewer_alive(v))
+        snprintf(text, sizeof(text), "VISOR %s — el publicador (PID %ld) terminó; esperando otro… q salir",
+                 name, shm_viewer_pid(v));
+    else if (snap->seq == 0)
+        snprintf(text, sizeof(text), "VISOR %s — PID %ld, esperando la primera muestra… q salir",
+                 name, shm_viewer_pid(v));
+    else if (idle_ms > stale_ms)
+        snprintf(text, sizeof(text), "VISOR %s — PID %ld sin muestras nuevas desde hace %lld s — q salir",
+                 name, shm_viewer_pid(v), idle_ms / 1000);
+    else
+        snprintf(text, sizeof(text), "VISOR %s — PID %ld, cada %d ms — q salir",
+                 name, shm_viewer_pid(v), shm_viewer_interval_ms(v));
+    tui_set_footer(text);
+    if (snap->seq != 0) tui_set_clock(snap->ts.tv_sec);
+}
+
+// Dibuja lo que publica otro proceso con --publish: ni hilo de muestreo ni
+// lecturas de /proc. El historial y las estadísticas se rellenan con todo el
+// anillo antes del primer frame; después se consulta el contador cada
+// fracción de periodo. Si el publicador muere, se vuelve a adjuntar al
+// segmento que cree su sucesor (mismo nombre y mismos cores).
+static int run_view(const char *name) {
+    char err[256];
+    ShmViewer *v = shm_viewer_open(name, err, sizeof(err));
+    if (!v) {
+        fprintf(stderr, "--view: %s\n", err);
+        return 1;
+    }
+    g_info = *shm_viewer_info(v);
+    int cores = shm_viewer_cores(v), interval_ms = shm_viewer_interval_ms(v);
+    if (history_init(&g_hist, shm_viewer_slots(v), cores) != 0) {
+        fprintf(stderr, "Sin memoria para el historial (%zu bytes).\n",
+                history_bytes(shm_viewer_slots(v), cores));
+        shm_viewer_close(v);
+        return 1;
+    }
+    if (stats_init(&g_stats, stats_window_for(interval_ms), cores) != 0) {
+        fprintf(stderr, "Sin memoria para las estadísticas (%zu bytes).\n",
+                stats_bytes(stats_window_for(interval_ms), cores));
+        history_free(&g_hist);
+        shm_viewer_close(v);
+        return 1;
+    }
+    Snapshot snap;
+    snapshot_init(&snap);
+    unsigned long long next = 0;
+    view_catch_up(v, &next, &snap);
+
+    if (tui_init() != 0) {
+        fprintf(stderr, "No se pudo inicializar la TUI (ncurses).\n");
+        snapshot_free(&snap);
+        history_free(&g_hist);
+        stats_free(&g_stats);
+        shm_viewer_close(v);
+        return 1;
+    }
+    tui_set_refresh_interval_ms(interval_ms);
+    tui_set_history(&g_hist);
+    tui_set_stats(&g_stats);
+
+    // Sin notificación entre procesos: se sondea el contador (una lectura
+    // atómica) a 1/4 del periodo, entre 10 y 250 ms
+    int timeout = interval_ms / 4;
+    if (timeout < 10) timeout = 10;
+    if (timeout > 250) timeout = 250;
+
+    long long now = monotonic_ms(), last_new = now, last_attach = now;
+    long long shown_idle_s = 0;
+    int redraw = 1;
+    struct pollfd pfd = { .fd = STDIN_FILENO, .events = POLLIN, .revents = 0 };
+    int running = 1;
+    while (running) {
+        if (redraw) {
+            view_footer(name, v, &snap, now - last_new);
+            render(snap.seq != 0 ? &snap : NULL);
+            redraw = 0;
+        }
+        if (poll(&pfd, 1, timeout) < 0 && errno != EINTR) break;
+        now = monotonic_ms();
+
+        for (;;) {
+            int ch = tui_getch();
+            if (tui_was_timeout(ch)) break;
+            if (ch == 'q') { running = 0; break; }
+            handle_view_key(ch);
+            redraw = 1;
+        }
+        if (!running) break;
+
+        if (view_catch_up(v, &next, &snap) > 0) {
+            last_new = now;
+            redraw = 1;
+        } else if (!shm_viewer_alive(v) && now - last_attach >= VIEW_REATTACH_MS) {
+            last_attach = now;
+            ShmViewer *nv = shm_viewer_open(name, NULL, 0);
+            if (nv && shm_viewer_pid(nv) != shm_viewer_pid(v) && shm_viewer_cores(nv) == cores &&
+                shm_viewer_slots(nv) <= g_hist.cap) {
+                shm_viewer_close(v);
+                v = nv;
+                nv = NULL;
+                g_info = *shm_viewer_info(v);
+                history_clear(&g_hist);
+                stats_clear(&g_stats);
+                next = 0;
+                view_catch_up(v, &next, &snap);
+                last_new = now;
+                redraw = 1;
+            }
+            shm_viewer_close(nv);
+        }
+        // El pie cuenta los segundos sin datos
+        if ((now - last_new) / 1000 != shown_idle_s) {
+            shown_idle_s = (now - last_new) / 1000;
+            redraw = 1;
+        }
+    }
+
+    tui_end();
+    snapshot_free(&snap);
+    history_free(&g_hist);
+    stats_free(&g_stats);
+    shm_viewer_close(v);
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    int interval_ms = DEFAULT_INTERVAL_MS;
+    int history_len = DEFAULT_HISTORY;
+    int batch = 0;
+    ExportFormat batch_fmt = EXPORT_JSONL;
+    const char *batch_out = NULL;
+    int batch_count = 0;
+    const char *record_path = NULL;
+    const char *replay_path = NULL;
+    double speed = 1.0;
+    const char *cgroup_spec = NULL;
+    const char *alerts_path = NULL;
+    const char *listen_addr = NULL;
+    const char *publish_name = NULL;
+    const char *view_name = NULL;
+
+    static const struct option long_opts[] = {
+        { "interval-ms", required_argument, NULL, 'i' },
+        { "history",     required_argument, NULL, 'H' },
+        { "batch",       no_argument,       NULL, 'b' },
+        { "format",      required_argument, NULL, 'f' },
+        { "output",      required_argument, NULL, 'o' },
+        { "count",       required_argument, NULL, 'n' },
+        { "record",      required_argument, NULL, 'r' },
+        { "replay",      required_argument, NULL, 'p' },
+        { "speed",       required_argument, NULL, 'x' },
+        { "proc-root",   required_argument, NULL, 'P' },
+        { "sys-root",    required_argument, NULL, 'S' },
+        { "cgroup",      required_argument, NULL, 'c' },
+        { "alerts",      required_argument, NULL, 'a' },
+        { "listen",      required_argument, NULL, 'l' },
+        { "publish",     required_argument, NULL, 'W' },
+        { "view",        required_argument, NULL, 'V' },
+        { "help",        no_argument,       NULL, 'h' },
+        { NULL, 0, NULL, 0 }
+    };
+    int opt;
+    while ((opt = getopt_long(argc, argv, "i:H:bf:o:n:r:p:x:P:S:c:a:l:W:V:h", long_opts, NULL)) != -1) {
+        switch (opt) {
+        case 'i':
+            if (parse_int_arg(optarg, MIN_INTERVAL_MS, MAX_INTERVAL_MS, &interval_ms) != 0) {
+                fprintf(stderr, "--interval-ms inválido: '%s'\n", optarg);
+                usage(argv[0]);
+                return 2;
+            }
+            break;
+        case 'H':
+            if (parse_int_arg(optarg, MIN_HISTORY, MAX_HISTORY, &history_len) != 0) {
+                fprintf(stderr, "--history inválido: '%s'\n", optarg);
+                usage(argv[0]);
+                return 2;
+            }
+            break;
+        case 'b':
+            batch = 1;
+            break;
+        case 'f':
+            if (export_parse_format(optarg, &batch_fmt) != 0) {
+                fprintf(stderr, "--format inválido: '%s' (jsonl o csv)\n", optarg);
+                usage(argv[0]);
+                return 2;
+            }
+            break;
+        case 'o':
+            batch_out = optarg;
+            break;
+        case 'n':
+            if (parse_int_arg(optarg, 0, 1000000000, &batch_count) != 0) {
+                fprintf(stderr, "--count inválido: '%s'\n", optarg);
+                usage(argv[0]);
+                return 2;
+            }
+            break;
+        case 'r':
+            record_path = optarg;
+            break;
+        case 'p':
+            replay_path = optarg;
+            break;
+        case 'x':
+            if (parse_double_arg(optarg, MIN_SPEED, MAX_SPEED, &speed) != 0) {
+                fprintf(stderr, "--speed inválido: '%s'\n", optarg);
+                usage(argv[0]);
+                return 2;
+            }
+            break;
+        case 'P':
+        case 'S':
+            if (procfs_set_root(opt == 'P' ? optarg : NULL, opt == 'S' ? optarg : NULL) != 0) {
+                fprintf(stderr, "Ruta demasiado larga: '%s'\n", optarg);
+                return 2;
+            }
+            break;
+        case 'c':
+            cgroup_spec = optarg;
+            break;
+        case 'a':
+            alerts_path = optarg;
+            break;
+        case 'l':
+            listen_addr = optarg;
+            break;
+        case 'W':
+            publish_name = optarg;
+            break;
+        case 'V':
+            view_name = optarg;
+            break;
+        case 'h':
+            usage(argv[0]);
+            return 0;
+        default:
+            usage(argv[0]);
+            return 2;
+        }
+    }
+
+    if (view_name) {
+        if (batch || record_path || replay_path || cgroup_spec || alerts_path || listen_addr || publish_name) {
+            fprintf(stderr, "--view no se combina con --batch, --record, --replay, --cgroup, --alerts, --listen ni --publish.\n");
+            return 2;
+        }
+        return run_view(view_name);
+    }
+    if (replay_path) {
+        if (batch || record_path || cgroup_spec || alerts_path || listen_addr || publish_name) {
+            fprintf(stderr, "--replay no se combina con --batch, --record, --cgroup, --alerts, --listen ni --publish.\n");
+            return 2;
+        }
+        return run_replay(replay_path, speed, history_len);
+    }
+
+    // Después de -P/-S: la ruta del cgroup se resuelve bajo esas raíces
+    if (cgroup_spec && cgroup_set_target(cgroup_spec) != 0) {
+        fprintf(stderr, "--cgroup: '%s' no existe o no es un cgroup v2.\n", cgroup_spec);
+        return 1;
+    }
+
+    // CPU info una sola vez (también va en la cabecera de --record)
+    cpu_read_info(&g_info);
+
+    SamplerHook hooks[SAMPLER_MAX_HOOKS];
+    int nhooks = 0;
+    Recorder *rec = NULL;
+    if (record_path) {
+        rec = recorder_open(record_path, &g_info, cpu_possible_count(), interval_ms);
+        if (!rec) {
+            fprintf(stderr, "No se pudo crear '%s': %s\n", record_path, strerror(errno));
+            return 1;
+        }
+        hooks[nhooks++] = (SamplerHook){ record_hook, rec };
+    }
+    // Las reglas se compilan antes de arrancar: un error se ve al instante
+    if (alerts_path) {
+        char err[256];
+        g_alerts = alert_load(alerts_path, cpu_possible_count(), err, sizeof(err));
+        if (!g_alerts) {
+            fprintf(stderr, "--alerts: %s\n", err);
+            recorder_close(rec);
+            return 1;
+        }
+        hooks[nhooks++] = (SamplerHook){ alert_hook, g_alerts };
+    }
+    if (listen_addr) {
+        char err[256];
+        g_httpd = httpd_start(listen_addr, &g_info, cpu_possible_count(), err, sizeof(err));
+        if (!g_httpd) {
+            fprintf(stderr, "--listen: %s\n", err);
+            recorder_close(rec);
+            alert_free(g_alerts);
+            return 1;
+        }
+        hooks[nhooks++] = (SamplerHook){ httpd_hook, g_httpd };
+    }
+    // El anillo tiene tantas ranuras como el historial: un visor arranca con
+    // las mismas sparklines que tendría esta TUI
+    if (publish_name) {
+        char err[256];
+        g_shm = shm_publisher_open(publish_name, &g_info, cpu_possible_count(), interval_ms,
+                                   history_len, err, sizeof(err));
+        if (!g_shm) {
+            fprintf(stderr, "--publish: %s\n", err);
+            recorder_close(rec);
+            alert_free(g_alerts);
+            httpd_stop(g_httpd);
+            return 1;
+        }
+        hooks[nhooks++] = (SamplerHook){ shm_publisher_hook, g_shm };
+    }
+
+    // Headless: ni ncurses ni historial
+    if (batch) {
+        int rc = run_batch(interval_ms, batch_fmt, batch_out, batch_count, hooks, nhooks);
+        if (rec && recorder_failed(rec)) fprintf(stderr, "Aviso: la grabación en '%s' quedó incompleta.\n", record_path);
+        recorder_close(rec);
+        alert_free(g_alerts);
+        httpd_stop(g_httpd);
+        shm_publisher_close(g_shm);
+        return rc;
+    }
+
+    // Historial y estadísticas: toda la memoria se reserva aquí, antes de empezar a muestrear
+    if (history_init(&g_hist, history_len, cpu_possible_count()) != 0) {
+        fprintf(stderr, "Sin memoria para el historial (%zu bytes).\n",
+                history_bytes(history_len, cpu_possible_count()));
+        recorder_close(rec);
+        alert_free(g_alerts);
+        httpd_stop(g_httpd);
+        shm_publisher_close(g_shm);
+        return 1;
+    }
+    if (stats_init(&g_stats, stats_window_for(interval_ms), cpu_possible_count()) != 0) {
+        fprintf(stderr, "Sin memoria para las estadísticas (%zu bytes).\n",
+                stats_bytes(stats_window_for(interval_ms), cpu_possible_count()));
+        history_free(&g_hist);
+        recorder_close(rec);
+        alert_free(g_alerts);
+        httpd_stop(g_httpd);
+        shm_publisher_close(g_shm);
+        return 1;
+    }
+
+    if (tui_init() != 0) {
+        fprintf(stderr, "No se pudo inicializar la TUI (ncurses).\n");
+        history_free(&g_hist);
+        stats_free(&g_stats);
+        recorder_close(rec);
+        alert_free(g_alerts);
+        httpd_stop(g_httpd);
+        shm_publisher_close(g_shm);
+        return 1;
+    }
+
+    // El muestreo vive en su propio hilo con cadencia fija; este hilo solo
+    // atiende teclado y dibuja la última muestra publicada. El historial y
+    // las estadísticas los llena el propio hilo de muestreo: ve todas las
+    // muestras, no solo las que la UI alcanza a dibujar.
+    hooks[nhooks++] = (SamplerHook){ history_hook, &g_hist };
+    hooks[nhooks++] = (SamplerHook){ stats_hook, &g_stats };
+    Sampler *sampler = sampler_start(interval_ms, hooks, nhooks);
+    if (!sampler) {
+        tui_end();
+        fprintf(stderr, "No se pudo iniciar el hilo de muestreo.\n");
+        history_free(&g_hist);
+        stats_free(&g_stats);
+        recorder_close(rec);
+        alert_free(g_alerts);
+        httpd_stop(g_httpd);
+        shm_publisher_close(g_shm);
+        return 1;
+    }
+    tui_set_refresh_interval_ms(interval_ms);
+    tui_set_history(&g_hist);
+    tui_set_stats(&g_stats);
+
+    struct pollfd fds[2] = {
+        { .fd = STDIN_FILENO,                .events = POLLIN, .revents = 0 },
+        { .fd = sampler_notify_fd(sampler),  .events = POLLIN, .revents = 0 },
+    };
+
+    int running = 1;
+    while (running) {
+        if (poll(fds, 2, -1) < 0 && errno != EINTR) break;
+
+        int redraw = 0;
+        if (fds[1].revents & POLLIN) {
+            sampler_clear_notify(sampler);
+            redraw = 1;
+        }
+
+        // Vacía todas las teclas pendientes (incluye KEY_RESIZE tras SIGWINCH)
+        for (;;) {
+            int ch = tui_getch();
+            if (tui_was_timeout(ch)) break;
+            if (ch == 'q') { running = 0; break; }
+            handle_view_key(ch);
+            // 'r', 'b', 'h', 's', 'm', 'e' o cambio de tamaño: redibujar sin tocar la cadencia de muestreo
+            redraw = 1;
+        }
+
+        if (running && redraw) render(sampler_acquire(sampler));
+    }
+
+    sampler_stop(sampler);   // tras esto el hook ya no escribe
+    tui_end();
+    history_free(&g_hist);
+    stats_free(&g_stats);
+    if (rec && recorder_failed(rec)) fprintf(stderr, "Aviso: la grabación en '%s' quedó incompleta.\n", record_path);
+    recorder_close(rec);
+    alert_free(g_alerts);
+    httpd_stop(g_httpd);
+    shm_publisher_close(g_shm);
+    return 0;
+}
@@ -1,10 +1,13 @@
 #include "memory.h"
+#include "procfile.h"
 #include <stdio.h>
 #include <string.h>
 
 int mem_total_kib(long *out_kib) {
     if (!out_kib) return 1;
-    FILE *f = fopen("/proc/meminfo", "r");
+    char path[512];
+    const char *p = procfs_path("/proc/meminfo", path, sizeof(path));
+    FILE *f = p ? fopen(p, "r") : NULL;
     if (!f) return 2;
 
     char line[256];
@@ -40,49 +43,118 @@ void format_bytes_from_kib(long kib, char *buf, size_t buflen) {
 }
 
 // --- NUEVO: Actividad 2 ---
-int mem_read_stats(MemStats *out) {
-    if (!out) return 1;
+// Handle persistente: /proc/meminfo se abre una vez y se relee con pread().
+static ProcFile g_meminfo = PROCFILE_INIT;
 
-    // Inicializa en "no disponible"
-    long mem_total = -1, mem_avail = -1;
-    long mem_free = -1, buffers = -1, cached = -1, sreclaimable = -1, shmem = -1;
-    long swap_total = -1, swap_free = -1;
+static int meminfo_refresh(void) {
+    if (g_meminfo.fd < 0) {
+        int rc = procfile_open(&g_meminfo, "/proc/meminfo", 4096);
+        if (rc != 0) return 2;
+    }
+    return procfile_read(&g_meminfo) == 0 ? 0 : 2;
+}
 
-    FILE *f = fopen("/proc/meminfo", "r");
-    if (!f) return 2;
+// ---- Claves de /proc/meminfo que nos interesan ----
+enum {
+    MI_MEM_TOTAL = 0, MI_MEM_FREE, MI_MEM_AVAIL, MI_BUFFERS, MI_CACHED, MI_SWAP_CACHED,
+    MI_DIRTY, MI_WRITEBACK, MI_ANON, MI_MAPPED, MI_SHMEM, MI_SLAB, MI_SRECLAIM,
+    MI_SUNRECLAIM, MI_KSTACK, MI_PAGETABLES, MI_SWAP_TOTAL, MI_SWAP_FREE,
+    MI_COMMIT_LIMIT, MI_COMMITTED_AS,
+    MI_HUGE_TOTAL, MI_HUGE_FREE, MI_HUGE_RSVD, MI_HUGE_SURP, MI_HUGE_SIZE,
+    MI_COUNT
+};
+
+typedef struct {
+    const char   *key;
+    unsigned char len;
+    unsigned char id;
+} MemKey;
+
+// Hash perfecto sobre las 25 claves de arriba: largo, primera, última y
+// central letra. Las ~25 claves restantes de meminfo caen en algún hueco (o
+// en una ranura ocupada) y se descartan con una sola comparación de largo +
+// memcmp, sin parsear su valor. Si se agrega una clave hay que recalcular
+// MI_HASH para que siga sin colisiones y reubicar la tabla.
+#define MI_SLOTS 64
+#define MI_HASH(k, n) \
+    (((n) * 5u + (unsigned char)(k)[0] + (unsigned char)(k)[(n) - 1] * 15u + \
+      (unsigned char)(k)[(n) / 2]) & (MI_SLOTS - 1))
+
+#define MK(lit, id) { lit, sizeof(lit) - 1, id }
+static const MemKey k_mi_slots[MI_SLOTS] = {
+    [ 2] = MK("SwapCached",      MI_SWAP_CACHED),
+    [ 3] = MK("HugePages_Surp",  MI_HUGE_SURP),
+    [ 6] = MK("Slab",            MI_SLAB),
+    [ 8] = MK("Buffers",         MI_BUFFERS),
+    [11] = MK("SUnreclaim",      MI_SUNRECLAIM),
+    [12] = MK("HugePages_Total", MI_HUGE_TOTAL),
+    [15] = MK("HugePages_Rsvd",  MI_HUGE_RSVD),
+    [16] = MK("Committed_AS",    MI_COMMITTED_AS),
+    [22] = MK("Hugepagesize",    MI_HUGE_SIZE),
+    [29] = MK("MemAvailable",    MI_MEM_AVAIL),
+    [30] = MK("HugePages_Free",  MI_HUGE_FREE),
+    [32] = MK("PageTables",      MI_PAGETABLES),
+    [33] = MK("MemFree",         MI_MEM_FREE),
+    [35] = MK("SReclaimable",    MI_SRECLAIM),
+    [37] = MK("Cached",          MI_CACHED),
+    [38] = MK("Dirty",           MI_DIRTY),
+    [40] = MK("SwapTotal",       MI_SWAP_TOTAL),
+    [44] = MK("SwapFree",        MI_SWAP_FREE),
+    [46] = MK("Writeback",       MI_WRITEBACK),
+    [51] = MK("KernelStack",     MI_KSTACK),
+    [55] = MK("Mapped",          MI_MAPPED),
+    [56] = MK("MemTotal",        MI_MEM_TOTAL),
+    [58] = MK("CommitLimit",     MI_COMMIT_LIMIT),
+    [59] = MK("AnonPages",       MI_ANON),
+    [60] = MK("Shmem",           MI_SHMEM),
+};
+#undef MK
+
+// Id de la clave [key, key+klen), o -1 si no es una de las que leemos.
+static int mi_lookup(const char *key, size_t klen) {
+    if (klen == 0) return -1;
+    const MemKey *k = &k_mi_slots[MI_HASH(key, klen)];
+    if (k->len != klen || memcmp(key, k->key, klen) != 0) return -1;
+    return k->id;
+}
 
-    char key[64];
-    long value_kb;
-    char unit[16];
+// Valor >= 0 o 0 si el kernel no lo reportó
+static long mi_or_zero(const long *v, int id) {
+    return v[id] > 0 ? v[id] : 0;
+}
 
-    // Leemos claves importantes. El archivo tiene muchas líneas; iteramos todas.
-    char line[256];
-    while (fgets(line, sizeof(line), f)) {
-        if (sscanf(line, "%63[^:]: %ld %15s", key, &value_kb, unit) == 3) {
-            if (strcmp(key, "MemTotal") == 0)        mem_total = value_kb;
-            else if (strcmp(key, "MemAvailable") == 0) mem_avail = value_kb;
-            else if (strcmp(key, "MemFree") == 0)      mem_free = value_kb;
-            else if (strcmp(key, "Buffers") == 0)      buffers = value_kb;
-            else if (strcmp(key, "Cached") == 0)       cached = value_kb;
-            else if (strcmp(key, "SReclaimable") == 0) sreclaimable = value_kb;
-            else if (strcmp(key, "Shmem") == 0)        shmem = value_kb;
-            else if (strcmp(key, "SwapTotal") == 0)    swap_total = value_kb;
-            else if (strcmp(key, "SwapFree") == 0)     swap_free = value_kb;
-        }
+int mem_read_stats(MemStats *out) {
+    if (!out) return 1;
+
+    // Inicializa en "no disponible"
+    long v[MI_COUNT];
+    for (int i = 0; i < MI_COUNT; ++i) v[i] = -1;
+
+    if (meminfo_refresh() != 0) return 2;
+
+    // Formato de cada línea: "Clave:   valor kB". Recorremos el buffer una vez.
+    const char *p = g_meminfo.buf;
+    while (*p) {
+        const char *key = p;
+        while (*p && *p != ':' && *p != '\n') p++;
+        if (*p != ':') { p = pf_next_line(p); continue; }
+        int id = mi_lookup(key, (size_t)(p - key));
+        if (id < 0) { p = pf_next_line(p); continue; }
+
+        unsigned long long val = 0;
+        const char *after = pf_parse_ull(p + 1, &val);
+        if (after != p + 1) v[id] = (long)val;   // con valor numérico
+        p = pf_next_line(after);
     }
-    fclose(f);
 
+    long mem_total = v[MI_MEM_TOTAL], mem_avail = v[MI_MEM_AVAIL];
     if (mem_total < 0) return 3; // sin MemTotal no podemos continuar
 
     // Calcular MemAvailable si no está (fallback clásico):
     // available ≈ MemFree + Buffers + Cached + SReclaimable - Shmem
     if (mem_avail < 0) {
-        long sum = 0;
-        if (mem_free > 0)       sum += mem_free;
-        if (buffers > 0)        sum += buffers;
-        if (cached > 0)         sum += cached;
-        if (sreclaimable > 0)   sum += sreclaimable;
-        if (shmem > 0)          sum -= shmem;
+        long sum = mi_or_zero(v, MI_MEM_FREE) + mi_or_zero(v, MI_BUFFERS) + mi_or_zero(v, MI_CACHED)
+                 + mi_or_zero(v, MI_SRECLAIM) - mi_or_zero(v, MI_SHMEM);
         if (sum < 0) sum = 0;
         mem_avail = sum;
     }
@@ -90,8 +162,8 @@ int mem_read_stats(MemStats *out) {
     long used = mem_total - mem_avail;
     if (used < 0) used = 0;
 
-    long s_total = (swap_total > 0) ? swap_total : 0;
-    long s_free  = (swap_free  > 0) ? swap_free  : 0;
+    long s_total = mi_or_zero(v, MI_SWAP_TOTAL);
+    long s_free  = mi_or_zero(v, MI_SWAP_FREE);
     long s_used  = (s_total > s_free) ? (s_total - s_free) : 0;
 
     out->total_kib = mem_total;
@@ -105,6 +177,28 @@ int mem_read_stats(MemStats *out) {
     out->used_ratio = (mem_total > 0) ? ((double)used / (double)mem_total) : 0.0;
     out->swap_used_ratio = (s_total > 0) ? ((double)s_used / (double)s_total) : 0.0;
 
+    out->free_kib         = mi_or_zero(v, MI_MEM_FREE);
+    out->buffers_kib      = mi_or_zero(v, MI_BUFFERS);
+    out->cached_kib       = mi_or_zero(v, MI_CACHED);
+    out->swap_cached_kib  = mi_or_zero(v, MI_SWAP_CACHED);
+    out->dirty_kib        = mi_or_zero(v, MI_DIRTY);
+    out->writeback_kib    = mi_or_zero(v, MI_WRITEBACK);
+    out->anon_kib         = mi_or_zero(v, MI_ANON);
+    out->mapped_kib       = mi_or_zero(v, MI_MAPPED);
+    out->shmem_kib        = mi_or_zero(v, MI_SHMEM);
+    out->sreclaimable_kib = mi_or_zero(v, MI_SRECLAIM);
+    // Kernels muy viejos no traen "Slab"; se reconstruye con sus dos partes
+    out->slab_kib         = v[MI_SLAB] >= 0 ? v[MI_SLAB]
+                          : out->sreclaimable_kib + mi_or_zero(v, MI_SUNRECLAIM);
+    out->kernel_stack_kib = mi_or_zero(v, MI_KSTACK);
+    out->page_tables_kib  = mi_or_zero(v, MI_PAGETABLES);
+    out->commit_limit_kib = mi_or_zero(v, MI_COMMIT_LIMIT);
+    out->committed_kib    = mi_or_zero(v, MI_COMMITTED_AS);
+    out->huge_total       = mi_or_zero(v, MI_HUGE_TOTAL);
+    out->huge_free        = mi_or_zero(v, MI_HUGE_FREE);
+    out->huge_rsvd        = mi_or_zero(v, MI_HUGE_RSVD);
+    out->huge_surp        = mi_or_zero(v, MI_HUGE_SURP);
+    out->huge_page_kib    = mi_or_zero(v, MI_HUGE_SIZE);
+
     return 0;
 }
-
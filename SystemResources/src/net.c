@@ -0,0 +1,245 @@
+#include "net.h"
+#include "procfile.h"
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+// Columnas de /proc/net/dev tras "nombre:"
+enum {
+    ND_RX_BYTES = 0, ND_RX_PACKETS, ND_RX_ERRS, ND_RX_DROP,
+    ND_RX_FIFO, ND_RX_FRAME, ND_RX_COMPRESSED, ND_RX_MULTICAST,
+    ND_TX_BYTES, ND_TX_PACKETS, ND_TX_ERRS, ND_TX_DROP,
+    ND_TX_FIFO, ND_TX_COLLS, ND_TX_CARRIER, ND_TX_COMPRESSED,
+    ND_COUNT
+};
+
+// Tabla de interfaces vistas: crece al aparecer interfaces nuevas (un host de
+// contenedores tiene cientos de veth), así que todas se miden.
+#define NET_TRACK_INIT 32
+// La velocidad del enlace se relee cada tantas muestras (renegociación, cable)
+#define NET_SPEED_EVERY 30
+
+typedef struct {
+    char               name[NET_NAME_MAX];
+    unsigned char      used;
+    unsigned char      seen;        // aparece en la muestra actual
+    unsigned char      prev_valid;  // prev[] es de la muestra anterior
+    int                speed_mbps;
+    int                speed_age;   // muestras desde la última lectura de speed (tope NET_SPEED_EVERY)
+    unsigned long long prev[ND_COUNT];
+} NetTrack;
+
+struct NetSampler {
+    ProcFile        file;            // /proc/net/dev abierto una vez
+    NetTrack       *track;           // [track_cap]
+    int             track_cap;
+    struct timespec prev_ts;         // CLOCK_MONOTONIC de la muestra anterior
+    int             initialized;
+};
+
+NetSampler *net_sampler_create(void) {
+    NetSampler *s = calloc(1, sizeof(*s));
+    if (!s) return NULL;
+    s->file = (ProcFile)PROCFILE_INIT;
+    s->track = calloc(NET_TRACK_INIT, sizeof(*s->track));
+    if (!s->track || procfile_open(&s->file, "/proc/net/dev", 4096) != 0) {
+        free(s->track);
+        free(s);
+        return NULL;
+    }
+    s->track_cap = NET_TRACK_INIT;
+    return s;
+}
+
+void net_sampler_destroy(NetSampler *s) {
+    if (!s) return;
+    procfile_close(&s->file);
+    free(s->track);
+    free(s);
+}
+
+// /sys/class/net/<if>/speed en Mb/s; 0 si no existe o el driver no lo sabe
+// (devuelve -1 o EINVAL en interfaces virtuales, wifi o con el enlace caído).
+static int read_speed_mbps(const char *name) {
+    char rel[32 + NET_NAME_MAX], path[512], buf[32];
+    snprintf(rel, sizeof(rel), "/sys/class/net/%s/speed", name);
+    const char *p = procfs_path(rel, path, sizeof(path));
+    int fd = p ? open(p, O_RDONLY | O_CLOEXEC) : -1;
+    if (fd < 0) return 0;
+    ssize_t n = read(fd, buf, sizeof(buf) - 1);
+    close(fd);
+    if (n <= 0) return 0;
+    buf[n] = '\0';
+    unsigned long long v = 0;
+    if (pf_parse_ull(buf, &v) == buf || v > 10000000ULL) return 0;
+    return (int)v;
+}
+
+// Igual que en disk.c: el orden de /proc/net/dev casi nunca cambia, así que
+// buscar desde 'hint' suele acertar a la primera. Si no está, la registra;
+// NULL solo si no hay memoria para agrandar la tabla.
+static NetTrack *track_find(NetSampler *s, const char *name, size_t len, int *hint) {
+    for (int k = 0; k < s->track_cap; ++k) {
+        int i = (*hint + k) % s->track_cap;
+        NetTrack *t = &s->track[i];
+        if (t->used && strncmp(t->name, name, len) == 0 && t->name[len] == '\0') {
+            *hint = i + 1;
+            return t;
+        }
+    }
+    int i = 0;
+    while (i < s->track_cap && s->track[i].used) i++;
+    if (i == s->track_cap) {
+        int cap = s->track_cap * 2;
+        NetTrack *nt = realloc(s->track, (size_t)cap * sizeof(*nt));
+        if (!nt) return NULL;
+        memset(&nt[s->track_cap], 0, (size_t)(cap - s->track_cap) * sizeof(*nt));
+        s->track = nt;
+        s->track_cap = cap;
+    }
+    NetTrack *t = &s->track[i];
+    memset(t, 0, sizeof(*t));
+    memcpy(t->name, name, len);
+    t->name[len] = '\0';
+    t->used = 1;
+    t->speed_age = NET_SPEED_EVERY;   // leerla en cuanto se muestre
+    *hint = i + 1;
+    return t;
+}
+
+static void fill_if(NetIf *o, const NetTrack *t, const unsigned long long *v, double dt) {
+    memset(o, 0, sizeof(*o));
+    memcpy(o->name, t->name, sizeof(o->name));
+    o->speed_mbps = t->speed_mbps;
+    o->rx_errs = v[ND_RX_ERRS];
+    o->tx_errs = v[ND_TX_ERRS];
+    o->rx_drop = v[ND_RX_DROP];
+    o->tx_drop = v[ND_TX_DROP];
+    if (!t->prev_valid || dt <= 0.0) return;
+
+    const unsigned long long *p = t->prev;
+    o->ready      = 1;
+    o->rx_bps     = (double)pf_counter_delta(v[ND_RX_BYTES],   p[ND_RX_BYTES])   / dt;
+    o->tx_bps     = (double)pf_counter_delta(v[ND_TX_BYTES],   p[ND_TX_BYTES])   / dt;
+    o->rx_pps     = (double)pf_counter_delta(v[ND_RX_PACKETS], p[ND_RX_PACKETS]) / dt;
+    o->tx_pps     = (double)pf_counter_delta(v[ND_TX_PACKETS], p[ND_TX_PACKETS]) / dt;
+    o->rx_errs_ps = (double)pf_counter_delta(v[ND_RX_ERRS],    p[ND_RX_ERRS])    / dt;
+    o->tx_errs_ps = (double)pf_counter_delta(v[ND_TX_ERRS],    p[ND_TX_ERRS])    / dt;
+    o->rx_drop_ps = (double)pf_counter_delta(v[ND_RX_DROP],    p[ND_RX_DROP])    / dt;
+    o->tx_drop_ps = (double)pf_counter_delta(v[ND_TX_DROP],    p[ND_TX_DROP])    / dt;
+}
+
+static void add_total(NetStats *out, const NetIf *v) {
+    if (!v->ready) return;
+    out->total_rx_bps  += v->rx_bps;
+    out->total_tx_bps  += v->tx_bps;
+    out->total_rx_pps  += v->rx_pps;
+    out->total_tx_pps  += v->tx_pps;
+    out->total_errs_ps += v->rx_errs_ps + v->tx_errs_ps;
+    out->total_drop_ps += v->rx_drop_ps + v->tx_drop_ps;
+}
+
+static double if_traffic(const NetIf *v) {
+    return v->rx_bps + v->tx_bps;
+}
+
+// ifs[] guarda las NET_MAX interfaces de más tráfico en el orden de
+// /proc/net/dev: llena, una nueva entra si supera a la más floja (a igualdad
+// se queda la que ya estaba), que sale; 'sel' lleva la entrada de la tabla de
+// cada una.
+static void keep_busiest(NetStats *out, int *sel, const NetIf *v, int ti) {
+    if (out->count < NET_MAX) {
+        sel[out->count] = ti;
+        out->ifs[out->count++] = *v;
+        return;
+    }
+    out->omitted++;
+    int low = NET_MAX - 1;
+    for (int i = NET_MAX - 2; i >= 0; --i)
+        if (if_traffic(&out->ifs[i]) < if_traffic(&out->ifs[low])) low = i;
+    if (if_traffic(v) <= if_traffic(&out->ifs[low])) return;
+    memmove(&out->ifs[low], &out->ifs[low + 1], (size_t)(NET_MAX - 1 - low) * sizeof(*out->ifs));
+    memmove(&sel[low], &sel[low + 1], (size_t)(NET_MAX - 1 - low) * sizeof(*sel));
+    sel[NET_MAX - 1] = ti;
+    out->ifs[NET_MAX - 1] = *v;
+}
+
+int net_sampler_sample(NetSampler *s, NetStats *out) {
+    if (!s || !out) return 1;
+    if (procfile_read(&s->file) != 0) return 2;
+
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    double dt = (double)(now.tv_sec - s->prev_ts.tv_sec) +
+                (double)(now.tv_nsec - s->prev_ts.tv_nsec) / 1e9;
+    if (!s->initialized) dt = 0.0;
+
+    out->ready = s->initialized;
+    out->interval_s = dt;
+    out->count = 0;
+    out->omitted = 0;
+    out->untracked = 0;
+    out->total_rx_bps = out->total_tx_bps = 0.0;
+    out->total_rx_pps = out->total_tx_pps = 0.0;
+    out->total_errs_ps = out->total_drop_ps = 0.0;
+
+    for (int i = 0; i < s->track_cap; ++i) s->track[i].seen = 0;
+
+    // Dos líneas de cabecera y luego "  eth0: 1234 56 0 0 ..." (en kernels
+    // viejos el primer número va pegado a los dos puntos)
+    int hint = 0;
+    int sel[NET_MAX];
+    const char *p = pf_next_line(pf_next_line(s->file.buf));
+    while (*p) {
+        const char *name = pf_skip_spaces(p);
+        const char *e = name;
+        while (*e && *e != ':' && *e != '\n') e++;
+        size_t len = (size_t)(e - name);
+        if (*e != ':' || len == 0 || len >= NET_NAME_MAX ||
+            (len == 2 && memcmp(name, "lo", 2) == 0)) { p = pf_next_line(e); continue; }
+
+        unsigned long long v[ND_COUNT];
+        int n = 0;
+        const char *c = e + 1;
+        while (n < ND_COUNT) {
+            const char *nx = pf_parse_ull(c, &v[n]);
+            if (nx == c) break;
+            c = nx;
+            n++;
+        }
+        p = pf_next_line(c);
+        if (n < ND_COUNT) continue;
+
+        NetTrack *t = track_find(s, name, len, &hint);
+        if (!t) { out->untracked++; continue; }   // sin memoria para seguirla
+        t->seen = 1;
+        if (t->speed_age < NET_SPEED_EVERY) t->speed_age++;
+        NetIf cur;
+        fill_if(&cur, t, v, dt);
+        add_total(out, &cur);
+        keep_busiest(out, sel, &cur, (int)(t - s->track));
+        memcpy(t->prev, v, sizeof(t->prev));
+        t->prev_valid = 1;
+    }
+
+    // La velocidad del enlace solo se lee para las que se muestran
+    for (int k = 0; k < out->count; ++k) {
+        NetTrack *t = &s->track[sel[k]];
+        if (t->speed_age >= NET_SPEED_EVERY) {
+            t->speed_mbps = read_speed_mbps(t->name);
+            t->speed_age = 0;
+        }
+        out->ifs[k].speed_mbps = t->speed_mbps;
+    }
+
+    // Las interfaces que desaparecieron (USB, VPN) liberan su entrada
+    for (int i = 0; i < s->track_cap; ++i)
+        if (!s->track[i].seen) s->track[i].used = 0;
+
+    s->prev_ts = now;
+    s->initialized = 1;
+    return 0;
+}
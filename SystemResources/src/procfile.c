@@ -0,0 +1,105 @@
+#include "procfile.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+// ---------- Raíces ----------
+// Vacías = rutas originales. Solo se escriben al arrancar (procfs_set_root).
+#define PROCFS_ROOT_MAX 256
+static char g_proc_root[PROCFS_ROOT_MAX];
+static char g_sys_root[PROCFS_ROOT_MAX];
+
+static int set_root(char *dst, const char *root) {
+    if (!root) return 0;
+    size_t n = strlen(root);
+    while (n > 1 && root[n - 1] == '/') n--;        // "/host/proc/" → "/host/proc"
+    if (n >= PROCFS_ROOT_MAX) return 1;
+    memcpy(dst, root, n);
+    dst[n] = '\0';
+    return 0;
+}
+
+int procfs_set_root(const char *proc_root, const char *sys_root) {
+    if (set_root(g_proc_root, proc_root) != 0) return 1;
+    return set_root(g_sys_root, sys_root);
+}
+
+// Si 'path' empieza por 'prefix' + '/', devuelve el resto (con la '/').
+static const char *strip_prefix(const char *path, const char *prefix, size_t plen) {
+    return (strncmp(path, prefix, plen) == 0 && path[plen] == '/') ? path + plen : NULL;
+}
+
+const char *procfs_path(const char *path, char *buf, size_t buflen) {
+    const char *rest;
+    const char *root = NULL;
+    if (g_proc_root[0] && (rest = strip_prefix(path, "/proc", 5)) != NULL) root = g_proc_root;
+    else if (g_sys_root[0] && (rest = strip_prefix(path, "/sys", 4)) != NULL) root = g_sys_root;
+    if (!root) return path;
+    int n = snprintf(buf, buflen, "%s%s", root, rest);
+    if (n > 0 && (size_t)n < buflen) return buf;
+    // Nunca la ruta sin traducir: sería la del anfitrión, no la de la raíz
+    errno = ENAMETOOLONG;
+    return NULL;
+}
+
+// ---------- ProcFile ----------
+int procfile_open(ProcFile *pf, const char *path, size_t initial_cap) {
+    if (!pf || !path) return 1;
+    pf->fd = -1; pf->buf = NULL; pf->cap = 0; pf->len = 0;
+
+    if (initial_cap < 64) initial_cap = 64;
+    // Raíz + ruta; las de cgroup pueden ser largas
+    char real[PROCFS_ROOT_MAX + 512];
+    const char *p = procfs_path(path, real, sizeof(real));
+    int fd = p ? open(p, O_RDONLY | O_CLOEXEC) : -1;
+    if (fd < 0) return 2;
+
+    char *buf = malloc(initial_cap);
+    if (!buf) { close(fd); return 3; }
+    buf[0] = '\0';
+
+    pf->fd  = fd;
+    pf->buf = buf;
+    pf->cap = initial_cap;
+    return 0;
+}
+
+int procfile_read(ProcFile *pf) {
+    if (!pf || pf->fd < 0 || !pf->buf) return 1;
+
+    size_t len = 0;
+    for (;;) {
+        if (len + 1 >= pf->cap) {
+            size_t ncap = pf->cap * 2;
+            char *nbuf = realloc(pf->buf, ncap);
+            if (!nbuf) return 3;
+            pf->buf = nbuf;
+            pf->cap = ncap;
+        }
+        size_t want = pf->cap - 1 - len;
+        ssize_t n = pread(pf->fd, pf->buf + len, want, (off_t)len);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            pf->len = 0; pf->buf[0] = '\0';
+            return 2;
+        }
+        // Solo 0 es fin de archivo: los seq_file de /proc (interrupts,
+        // diskstats, net/dev, mountinfo…) entregan como mucho ~una página por
+        // llamada, así que una lectura corta no dice nada
+        if (n == 0) break;
+        len += (size_t)n;
+    }
+    pf->buf[len] = '\0';
+    pf->len = len;
+    return 0;
+}
+
+void procfile_close(ProcFile *pf) {
+    if (!pf) return;
+    if (pf->fd >= 0) close(pf->fd);
+    free(pf->buf);
+    pf->fd = -1; pf->buf = NULL; pf->cap = 0; pf->len = 0;
+}
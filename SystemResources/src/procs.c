@@ -0,0 +1,348 @@
+#include "procs.h"
+#include "procfile.h"
+#include <dirent.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+// Tamaño del buffer de getdents64: ~24 B por entrada, unas 1300 por llamada
+#define DENTS_BUF   32768
+// /proc/<pid>/stat ronda los 300 B; con un comm raro sigue lejos de esto
+#define STAT_BUF    1024
+#define TABLE_MIN   1024
+// Descriptores que se dejan libres para el resto del programa
+#define FD_RESERVE  256
+// Un proceso que no gastó CPU desde su última lectura se relee solo en una
+// de cada tantas muestras (repartidos por pid): el pread de /proc/<pid>/stat
+// es casi todo el coste y la mayoría de los procesos duerme.
+#define IDLE_EVERY  4
+
+// Entrada de la tabla de pids (direccionamiento abierto, sondeo lineal;
+// pid 0 = hueco).
+typedef struct {
+    int                pid;
+    int                fd;          // -1 = sin fd persistente
+    unsigned           gen;         // última muestra en la que apareció
+    unsigned char      prev_valid;
+    unsigned char      idle;        // sin ticks de CPU en la última lectura
+    double             read_s;      // CLOCK_MONOTONIC de la última lectura
+    unsigned long long starttime;   // detecta reutilización del pid
+    unsigned long long prev_ticks;  // utime + stime de la muestra anterior
+    ProcInfo           info;        // datos de la muestra actual
+} ProcEntry;
+
+struct ProcSampler {
+    int             dir_fd;         // /proc abierto una vez
+    char           *dents;          // buffer de getdents64
+    ProcEntry      *tab;
+    size_t          cap;            // potencia de 2
+    size_t          used;
+    unsigned        gen;
+    size_t          cached;         // entradas con fd persistente
+    size_t          fd_budget;      // cuántas pueden tenerlo
+    long            page_kib;
+    double          hz;             // ticks de reloj por segundo (USER_HZ)
+    struct timespec prev_ts;        // CLOCK_MONOTONIC de la muestra anterior
+    int             initialized;
+};
+
+// Formato que devuelve el kernel (no hay definición pública en glibc < 2.30)
+struct linux_dirent64 {
+    uint64_t       d_ino;
+    int64_t        d_off;
+    unsigned short d_reclen;
+    unsigned char  d_type;
+    char           d_name[];
+};
+
+static size_t slot_of(const ProcSampler *s, int pid) {
+    return ((size_t)(unsigned)pid * 2654435761u) & (s->cap - 1);
+}
+
+// Devuelve la entrada de 'pid' o el hueco donde insertarla
+static ProcEntry *tab_find(ProcSampler *s, int pid) {
+    size_t i = slot_of(s, pid);
+    while (s->tab[i].pid != 0 && s->tab[i].pid != pid) i = (i + 1) & (s->cap - 1);
+    return &s->tab[i];
+}
+
+static int tab_grow(ProcSampler *s) {
+    size_t ncap = s->cap ? s->cap * 2 : TABLE_MIN;
+    ProcEntry *old = s->tab;
+    size_t ocap = s->cap;
+    ProcEntry *tab = calloc(ncap, sizeof(*tab));
+    if (!tab) return 3;
+    s->tab = tab;
+    s->cap = ncap;
+    for (size_t i = 0; i < ocap; ++i)
+        if (old[i].pid != 0) *tab_find(s, old[i].pid) = old[i];
+    free(old);
+    return 0;
+}
+
+// Borrado con desplazamiento hacia atrás (sin lápidas): las entradas que
+// siguen en la racha y podrían ocupar el hueco se corren.
+static void tab_remove(ProcSampler *s, size_t i) {
+    ProcEntry *e = &s->tab[i];
+    if (e->fd >= 0) { close(e->fd); s->cached--; }
+    e->pid = 0;
+    s->used--;
+    size_t mask = s->cap - 1, hole = i, j = i;
+    for (;;) {
+        j = (j + 1) & mask;
+        if (s->tab[j].pid == 0) return;
+        size_t home = slot_of(s, s->tab[j].pid);
+        // ¿'home' está cíclicamente en (hole, j]? entonces no puede moverse
+        if (hole <= j ? (home > hole && home <= j) : (home > hole || home <= j)) continue;
+        s->tab[hole] = s->tab[j];
+        s->tab[j].pid = 0;
+        hole = j;
+    }
+}
+
+// Descriptores ya abiertos al crear el sampler (p. ej. los de cpufreq, que
+// con una policy por núcleo son cientos): no entran en el presupuesto.
+static size_t open_fds(void) {
+    DIR *d = opendir("/proc/self/fd");   // los del propio proceso: sin --proc-root
+    if (!d) return 0;
+    size_t n = 0;
+    struct dirent *de;
+    while ((de = readdir(d)) != NULL)
+        if (de->d_name[0] != '.') n++;
+    closedir(d);
+    return n;
+}
+
+ProcSampler *proc_sampler_create(void) {
+    ProcSampler *s = calloc(1, sizeof(*s));
+    if (!s) return NULL;
+    char path[512];
+    // Con la barra final para que procfs_path la traduzca (--proc-root)
+    const char *proc = procfs_path("/proc/", path, sizeof(path));
+    s->dir_fd = proc ? open(proc, O_RDONLY | O_DIRECTORY | O_CLOEXEC) : -1;
+    s->dents = malloc(DENTS_BUF);
+    if (s->dir_fd < 0 || !s->dents || tab_grow(s) != 0) {
+        if (s->dir_fd >= 0) close(s->dir_fd);
+        free(s->dents);
+        free(s);
+        return NULL;
+    }
+    long pg = sysconf(_SC_PAGESIZE), hz = sysconf(_SC_CLK_TCK);
+    s->page_kib = pg > 0 ? pg / 1024 : 4;
+    s->hz = hz > 0 ? (double)hz : 100.0;
+
+    // Un fd por proceso: el límite blando típico (1024) no alcanza
+    struct rlimit rl;
+    if (getrlimit(RLIMIT_NOFILE, &rl) == 0) {
+        if (rl.rlim_cur < rl.rlim_max) {
+            rl.rlim_cur = rl.rlim_max;
+            if (setrlimit(RLIMIT_NOFILE, &rl) != 0) getrlimit(RLIMIT_NOFILE, &rl);
+        }
+        size_t used = open_fds();
+        if (rl.rlim_cur == RLIM_INFINITY) s->fd_budget = (size_t)1 << 20;
+        else if (rl.rlim_cur > FD_RESERVE + used) s->fd_budget = (size_t)rl.rlim_cur - FD_RESERVE - used;
+    }
+    return s;
+}
+
+void proc_sampler_destroy(ProcSampler *s) {
+    if (!s) return;
+    for (size_t i = 0; i < s->cap; ++i)
+        if (s->tab[i].pid != 0 && s->tab[i].fd >= 0) close(s->tab[i].fd);
+    free(s->tab);
+    free(s->dents);
+    if (s->dir_fd >= 0) close(s->dir_fd);
+    free(s);
+}
+
+// Salta un campo separado por espacios (los hay negativos: no sirve pf_parse_ull)
+static const char *skip_field(const char *p) {
+    p = pf_skip_spaces(p);
+    while (*p && *p != ' ' && *p != '\n') p++;
+    return p;
+}
+
+// "pid (comm) S ppid …": comm puede traer espacios y ')' así que se corta en
+// el último ')'. Devuelve 0 si la línea está completa.
+static int parse_stat(char *buf, ProcEntry *e, unsigned long long *ticks, unsigned long long *start) {
+    char *open = strchr(buf, '(');
+    char *close = strrchr(buf, ')');
+    if (!open || !close || close < open || close[1] != ' ') return 1;
+    size_t len = (size_t)(close - open - 1);
+    if (len >= PROC_COMM_MAX) len = PROC_COMM_MAX - 1;
+    memcpy(e->info.comm, open + 1, len);
+    e->info.comm[len] = '\0';
+
+    const char *p = close + 2;
+    e->info.state = *p;
+    p = skip_field(p);                                       // 3 state
+    for (int k = 4; k <= 13; ++k) p = skip_field(p);         // ppid … cmajflt
+    unsigned long long ut = 0, st = 0, nth = 0, rss = 0;
+    const char *q = pf_parse_ull(p, &ut);                    // 14 utime
+    if (q == p) return 1;
+    p = pf_parse_ull(q, &st);                                // 15 stime
+    for (int k = 16; k <= 19; ++k) p = skip_field(p);        // cutime … nice
+    p = pf_parse_ull(p, &nth);                               // 20 num_threads
+    p = skip_field(p);                                       // 21 itrealvalue
+    q = pf_parse_ull(p, start);                              // 22 starttime
+    if (q == p) return 1;
+    p = skip_field(q);                                       // 23 vsize
+    q = pf_parse_ull(p, &rss);                               // 24 rss (páginas)
+    if (q == p) return 1;
+
+    *ticks = ut + st;
+    e->info.threads = (int)nth;
+    e->info.rss_kib = (long)rss;
+    return 0;
+}
+
+// Lee el stat de 'e' (abriéndolo si hace falta). 'now_s' es el instante de
+// la muestra: la CPU se reparte entre él y la lectura anterior de 'e', que
+// puede ser de unas muestras atrás. Devuelve 0 si OK, 2 si el proceso ya no
+// existe o no se pudo leer.
+static int read_entry(ProcSampler *s, ProcEntry *e, const char *name, double now_s, int *uncached) {
+    char buf[STAT_BUF];
+    char rel[32];
+    int fd = e->fd;
+    if (fd < 0) {
+        snprintf(rel, sizeof(rel), "%s/stat", name);
+        fd = openat(s->dir_fd, rel, O_RDONLY | O_CLOEXEC);
+        if (fd < 0) return 2;
+    }
+    ssize_t n = pread(fd, buf, sizeof(buf) - 1, 0);
+    if (e->fd < 0) {
+        // Sin presupuesto de descriptores se abre y cierra en cada muestra
+        if (n > 0 && s->cached < s->fd_budget) { e->fd = fd; s->cached++; }
+        else { close(fd); if (n > 0) (*uncached)++; }
+    }
+    if (n <= 0) return 2;
+    buf[n] = '\0';
+
+    unsigned long long ticks = 0, start = 0;
+    if (parse_stat(buf, e, &ticks, &start) != 0) return 2;
+    if (e->prev_valid && start != e->starttime) e->prev_valid = 0;   // pid reutilizado
+    e->info.pid = e->pid;
+    e->info.rss_kib *= s->page_kib;
+    double dt = now_s - e->read_s;
+    e->info.cpu = (e->prev_valid && dt > 0.0) ? (double)pf_counter_delta(ticks, e->prev_ticks) / (dt * s->hz) : 0.0;
+    e->idle = e->prev_valid && ticks == e->prev_ticks;
+    e->read_s = now_s;
+    e->starttime = start;
+    e->prev_ticks = ticks;
+    return 0;
+}
+
+// ---------- Top-N: montículo de mínimos de PROC_TOP entradas ----------
+typedef int (*ProcLess)(const ProcInfo *a, const ProcInfo *b);
+
+static int less_cpu(const ProcInfo *a, const ProcInfo *b) {
+    if (a->cpu != b->cpu) return a->cpu < b->cpu;
+    return a->pid > b->pid;   // a igualdad, primero el pid más bajo
+}
+
+static int less_rss(const ProcInfo *a, const ProcInfo *b) {
+    if (a->rss_kib != b->rss_kib) return a->rss_kib < b->rss_kib;
+    return a->pid > b->pid;
+}
+
+static void heap_sift_down(ProcInfo *h, int n, int i, ProcLess less) {
+    for (;;) {
+        int l = 2 * i + 1, r = l + 1, m = i;
+        if (l < n && less(&h[l], &h[m])) m = l;
+        if (r < n && less(&h[r], &h[m])) m = r;
+        if (m == i) return;
+        ProcInfo t = h[i]; h[i] = h[m]; h[m] = t;
+        i = m;
+    }
+}
+
+static void heap_offer(ProcInfo *h, int *n, const ProcInfo *v, ProcLess less) {
+    if (*n < PROC_TOP) {
+        int i = (*n)++;
+        h[i] = *v;
+        while (i > 0 && less(&h[i], &h[(i - 1) / 2])) {
+            int p = (i - 1) / 2;
+            ProcInfo t = h[i]; h[i] = h[p]; h[p] = t;
+            i = p;
+        }
+    } else if (less(&h[0], v)) {
+        h[0] = *v;
+        heap_sift_down(h, *n, 0, less);
+    }
+}
+
+// Deja el montículo ordenado de mayor a menor (heapsort in situ)
+static void heap_finish(ProcInfo *h, int n, ProcLess less) {
+    for (int end = n - 1; end > 0; --end) {
+        ProcInfo t = h[0]; h[0] = h[end]; h[end] = t;
+        heap_sift_down(h, end, 0, less);
+    }
+}
+
+int proc_sampler_sample(ProcSampler *s, ProcStats *out) {
+    if (!s || !out) return 1;
+
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    double dt = (double)(now.tv_sec - s->prev_ts.tv_sec) +
+                (double)(now.tv_nsec - s->prev_ts.tv_nsec) / 1e9;
+    if (!s->initialized) dt = 0.0;
+
+    memset(out, 0, sizeof(*out));
+    out->ready = s->initialized;
+    out->interval_s = dt;
+    double now_s = (double)now.tv_sec + (double)now.tv_nsec / 1e9;
+
+    unsigned gen = ++s->gen;
+    if (lseek(s->dir_fd, 0, SEEK_SET) < 0) return 2;
+    for (;;) {
+        long nread = syscall(SYS_getdents64, s->dir_fd, s->dents, DENTS_BUF);
+        if (nread < 0) return 2;
+        if (nread == 0) break;
+        for (long off = 0; off < nread;) {
+            const struct linux_dirent64 *d = (const struct linux_dirent64 *)(s->dents + off);
+            off += d->d_reclen;
+            const char *nm = d->d_name;
+            if (*nm < '1' || *nm > '9') continue;   // solo directorios numéricos
+            unsigned long long pid = 0;
+            const char *end = pf_parse_ull(nm, &pid);
+            if (*end != '\0' || pid > 0x7fffffffULL) continue;
+
+            if ((s->used + 1) * 2 > s->cap && tab_grow(s) != 0) return 3;
+            ProcEntry *e = tab_find(s, (int)pid);
+            if (e->pid == 0) {
+                memset(e, 0, sizeof(*e));
+                e->pid = (int)pid;
+                e->fd = -1;
+                s->used++;
+            }
+            // Los dormidos conservan la lectura anterior (cpu = 0) hasta su turno
+            int skip = e->idle && ((unsigned)e->pid + gen) % IDLE_EVERY != 0;
+            if (!skip && read_entry(s, e, nm, now_s, &out->uncached) != 0) continue;   // terminó entre medias
+            e->gen = gen;
+            e->prev_valid = 1;
+
+            out->total++;
+            out->threads += e->info.threads;
+            if (e->info.state == 'R') out->running++;
+            heap_offer(out->by_cpu, &out->n_cpu, &e->info, less_cpu);
+            heap_offer(out->by_rss, &out->n_rss, &e->info, less_rss);
+        }
+    }
+
+    // Los pids que no aparecieron (o no se pudieron leer) cierran su fd
+    for (size_t i = 0; i < s->cap; ++i)
+        while (s->tab[i].pid != 0 && s->tab[i].gen != gen) tab_remove(s, i);
+
+    heap_finish(out->by_cpu, out->n_cpu, less_cpu);
+    heap_finish(out->by_rss, out->n_rss, less_rss);
+    s->prev_ts = now;
+    s->initialized = 1;
+    return 0;
+}
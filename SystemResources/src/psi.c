@@ -0,0 +1,132 @@
+#include "psi.h"
+#include "procfile.h"
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static const char *const k_psi_path[PSI_COUNT] = {
+    "/proc/pressure/cpu", "/proc/pressure/memory", "/proc/pressure/io",
+};
+static const char *const k_psi_name[PSI_COUNT] = { "cpu", "memory", "io" };
+
+struct PsiSampler {
+    ProcFile           file[PSI_COUNT];   // fd = -1 si ese recurso no existe
+    unsigned long long prev_some[PSI_COUNT];
+    unsigned long long prev_full[PSI_COUNT];
+    int                prev_valid[PSI_COUNT];
+    struct timespec    prev_ts;            // CLOCK_MONOTONIC de la muestra anterior
+    int                initialized;
+};
+
+const char *psi_resource_name(int res) {
+    return (res >= 0 && res < PSI_COUNT) ? k_psi_name[res] : "?";
+}
+
+PsiSampler *psi_sampler_create(void) {
+    PsiSampler *s = calloc(1, sizeof(*s));
+    if (!s) return NULL;
+    int opened = 0;
+    for (int r = 0; r < PSI_COUNT; ++r) {
+        s->file[r] = (ProcFile)PROCFILE_INIT;
+        if (procfile_open(&s->file[r], k_psi_path[r], 256) == 0) opened++;
+    }
+    if (!opened) {
+        free(s);
+        return NULL;
+    }
+    return s;
+}
+
+void psi_sampler_destroy(PsiSampler *s) {
+    if (!s) return;
+    for (int r = 0; r < PSI_COUNT; ++r) procfile_close(&s->file[r]);
+    free(s);
+}
+
+// "4.14" -> 4.14. El kernel siempre escribe dos decimales.
+static const char *parse_percent(const char *p, double *out) {
+    unsigned long long ip = 0, fp = 0;
+    const char *q = pf_parse_ull(p, &ip);
+    if (q == p) return p;
+    double v = (double)ip;
+    if (*q == '.') {
+        const char *f = q + 1;
+        const char *e = pf_parse_ull(f, &fp);
+        double div = 1.0;
+        for (const char *c = f; c < e; ++c) div *= 10.0;
+        v += (double)fp / div;
+        q = e;
+    }
+    *out = v;
+    return q;
+}
+
+// "some avg10=4.14 avg60=5.24 avg300=4.26 total=79240553"
+// Devuelve 1 si la línea trae los cuatro campos.
+static int parse_line(const char *p, PsiLine *o) {
+    int got = 0;
+    while (*p && *p != '\n') {
+        p = pf_skip_spaces(p);
+        const char *k = p;
+        while (*p && *p != '=' && *p != ' ' && *p != '\n') p++;
+        size_t len = (size_t)(p - k);
+        if (*p != '=') continue;
+        p++;
+        if (len == 5 && memcmp(k, "avg10", 5) == 0)       { p = parse_percent(p, &o->avg10);  got |= 1; }
+        else if (len == 5 && memcmp(k, "avg60", 5) == 0)  { p = parse_percent(p, &o->avg60);  got |= 2; }
+        else if (len == 6 && memcmp(k, "avg300", 6) == 0) { p = parse_percent(p, &o->avg300); got |= 4; }
+        else if (len == 5 && memcmp(k, "total", 5) == 0) {
+            const char *q = pf_parse_ull(p, &o->total_us);
+            if (q != p) got |= 8;
+            p = q;
+        }
+        while (*p && *p != ' ' && *p != '\n') p++;
+    }
+    return got == 15;
+}
+
+static double stall_ratio(unsigned long long cur, unsigned long long prev, double dt) {
+    double r = (double)pf_counter_delta(cur, prev) / (dt * 1e6);
+    return r > 1.0 ? 1.0 : r;
+}
+
+int psi_sampler_sample(PsiSampler *s, PsiStats *out) {
+    if (!s || !out) return 1;
+
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    double dt = (double)(now.tv_sec - s->prev_ts.tv_sec) +
+                (double)(now.tv_nsec - s->prev_ts.tv_nsec) / 1e9;
+    if (!s->initialized) dt = 0.0;
+
+    memset(out, 0, sizeof(*out));
+    out->ready = s->initialized;
+    out->interval_s = dt;
+
+    int ok = 0;
+    for (int r = 0; r < PSI_COUNT; ++r) {
+        PsiResource *o = &out->res[r];
+        if (s->file[r].fd < 0 || procfile_read(&s->file[r]) != 0) { s->prev_valid[r] = 0; continue; }
+
+        const char *p = s->file[r].buf;
+        while (*p) {
+            if (strncmp(p, "some ", 5) == 0)      o->available = parse_line(p + 5, &o->some);
+            else if (strncmp(p, "full ", 5) == 0) o->has_full = parse_line(p + 5, &o->full);
+            p = pf_next_line(p);
+        }
+        if (!o->available) { s->prev_valid[r] = 0; continue; }
+        ok++;
+
+        if (s->prev_valid[r] && dt > 0.0) {
+            o->some.stall = stall_ratio(o->some.total_us, s->prev_some[r], dt);
+            if (o->has_full) o->full.stall = stall_ratio(o->full.total_us, s->prev_full[r], dt);
+        }
+        s->prev_some[r] = o->some.total_us;
+        s->prev_full[r] = o->full.total_us;
+        s->prev_valid[r] = 1;
+    }
+
+    s->prev_ts = now;
+    s->initialized = 1;
+    return ok ? 0 : 2;
+}
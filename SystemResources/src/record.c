@@ -0,0 +1,1142 @@
+#include "record.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static const unsigned char k_magic[8] = { 'R', 'S', 'Y', 'S', 'R', 'E', 'C', 0x01 };
+#define REC_VERSION 2
+
+#define REC_TAG_KEY   'K'
+#define REC_TAG_DELTA 'D'
+
+// Cuantización: ratios globales a 1e-4, por core a 1e-3 (0.1% en pantalla),
+// tasas a 0.1/s. Con menos resolución por core los deltas suelen ser 0.
+#define Q_RATIO 10000.0
+#define Q_CORE  1000.0
+#define Q_RATE  10.0
+
+// ---------- Vector de campos por muestra ----------
+enum {
+    F_SEQ = 0, F_TS_MS, F_MEM_RC, F_CPU_RC, F_READY,
+    F_MEM_TOTAL, F_MEM_AVAIL, F_MEM_USED, F_SWAP_TOTAL, F_SWAP_FREE, F_SWAP_USED,
+    F_MEM_RATIO, F_SWAP_RATIO,
+    F_INTERVAL_US, F_ONLINE, F_AVG, F_CORES,
+    F_T_USER, F_T_NICE, F_T_SYSTEM, F_T_IDLE, F_T_IOWAIT, F_T_IRQ, F_T_SOFTIRQ, F_T_STEAL,
+    F_CTXT, F_INTR, F_FORKS, F_CTXT_RATE, F_INTR_RATE, F_FORKS_RATE,
+    F_RUNNING, F_BLOCKED,
+    F_FIXED_COUNT
+};
+// Por core (idle se deduce: 1 - resto)
+enum {
+    PC_STATE = 0, PC_USAGE,
+    PC_T_USER, PC_T_NICE, PC_T_SYSTEM, PC_T_IOWAIT, PC_T_IRQ, PC_T_SOFTIRQ, PC_T_STEAL,
+    PC_COUNT
+};
+
+// Por disco: el nombre va empaquetado en 4 enteros (8 bytes c/u); como casi
+// nunca cambia, en los deltas es una racha de ceros.
+enum {
+    XD_NAME = 0, XD_READY = 4, XD_IN_FLIGHT, XD_R_IOPS, XD_W_IOPS, XD_R_BPS, XD_W_BPS,
+    XD_R_AWAIT_US, XD_W_AWAIT_US, XD_SVC_US, XD_UTIL, XD_QUEUE,
+    XD_COUNT
+};
+_Static_assert(DISK_NAME_MAX == 4 * sizeof(int64_t), "el nombre se empaqueta en 4 campos");
+// Por interfaz de red (nombre en 2 enteros)
+enum {
+    XN_NAME = 0, XN_READY = 2, XN_SPEED, XN_RX_BPS, XN_TX_BPS, XN_RX_PPS, XN_TX_PPS,
+    XN_RX_ERRS_PS, XN_TX_ERRS_PS, XN_RX_DROP_PS, XN_TX_DROP_PS,
+    XN_RX_ERRS, XN_TX_ERRS, XN_RX_DROP, XN_TX_DROP,
+    XN_COUNT
+};
+_Static_assert(NET_NAME_MAX == 2 * sizeof(int64_t), "el nombre se empaqueta en 2 campos");
+// Por recurso PSI: las medias en centésimas de %, como las escribe el kernel,
+// y luego las líneas "some" y "full" de XL_COUNT campos cada una
+enum { XL_AVG10 = 0, XL_AVG60, XL_AVG300, XL_STALL, XL_TOTAL_US, XL_COUNT };
+// Por proceso de los rankings (comm en 2 enteros)
+enum { XR_PID = 0, XR_COMM, XR_STATE = 3, XR_THREADS, XR_CPU, XR_RSS_KIB, XR_COUNT };
+_Static_assert(PROC_COMM_MAX == 2 * sizeof(int64_t), "el comm se empaqueta en 2 campos");
+// Por policy de cpufreq (frecuencias en kHz) y por zona térmica (tipo en 3
+// enteros, temperaturas en m°C como las da sysfs). Las primeras
+// REC_TH_POLICIES van en su bloque de siempre y el resto, al final.
+enum { XF_FIRST_CPU = 0, XF_NCPUS, XF_CUR_KHZ, XF_MIN_KHZ, XF_MAX_KHZ, XF_HW_MAX_KHZ, XF_COUNT };
+#define REC_TH_POLICIES 64
+_Static_assert(FREQ_POLICY_MAX >= REC_TH_POLICIES, "el bloque original de policies no puede encoger");
+enum { XZ_TYPE = 0, XZ_TEMP_MC = 3, XZ_CRIT_MC, XZ_PASSIVE_MC, XZ_COUNT };
+_Static_assert(THERMAL_TYPE_MAX == 3 * sizeof(int64_t), "el tipo se empaqueta en 3 campos");
+// Por cgroup hijo (nombre en 6 enteros)
+enum { XC_NAME = 0, XC_READY = 6, XC_MEM_KIB, XC_CPU, XC_COUNT };
+_Static_assert(CGROUP_NAME_MAX == 6 * sizeof(int64_t), "el nombre se empaqueta en 6 campos");
+_Static_assert(CGROUP_PATH_MAX == 16 * sizeof(int64_t), "la ruta se empaqueta en 16 campos");
+// Por fuente de interrupciones (nombre en 3 enteros) y por núcleo caliente,
+// con sus IRQ_SRC_MAX fuentes detrás
+enum { XS_NAME = 0, XS_SOFTIRQ = 3, XS_RATE, XS_COUNT };
+enum { XH_CPU = 0, XH_IRQ_PS, XH_SOFTIRQ_PS, XH_NSRC, XH_SRC, XH_COUNT = XH_SRC + IRQ_SRC_MAX * XS_COUNT };
+_Static_assert(IRQ_NAME_MAX == 3 * sizeof(int64_t), "el nombre se empaqueta en 3 campos");
+enum {
+    XP_AVAILABLE = 0, XP_HAS_FULL, XP_SOME, XP_FULL = XP_SOME + XL_COUNT,
+    XP_COUNT = XP_FULL + XL_COUNT
+};
+
+// Campos extendidos: van después de los de cada core, así agregar uno nuevo
+// al final no mueve nada. La cabecera (v2+) guarda cuántos trae el archivo;
+// los que falten al leer una grabación más vieja quedan en 0.
+enum {
+    X_MEM_FREE = 0, X_BUFFERS, X_CACHED, X_SWAP_CACHED, X_DIRTY, X_WRITEBACK,
+    X_ANON, X_MAPPED, X_SHMEM, X_SLAB, X_SRECLAIM, X_KSTACK, X_PAGETABLES,
+    X_COMMIT_LIMIT, X_COMMITTED, X_HUGE_TOTAL, X_HUGE_FREE, X_HUGE_RSVD, X_HUGE_SURP, X_HUGE_SIZE,
+    X_DISK_RC, X_DISK_READY, X_DISK_INTERVAL_US, X_DISK_COUNT, X_DISK_OMITTED,
+    X_DISK_DEV,                                   // DISK_MAX bloques de XD_COUNT
+    X_DISK_END = X_DISK_DEV + DISK_MAX * XD_COUNT,
+    X_NET_RC = X_DISK_END, X_NET_READY, X_NET_INTERVAL_US, X_NET_COUNT, X_NET_OMITTED,
+    X_NET_IF,                                     // NET_MAX bloques de XN_COUNT
+    X_NET_END = X_NET_IF + NET_MAX * XN_COUNT,
+    X_PSI_RC = X_NET_END, X_PSI_READY, X_PSI_INTERVAL_US,
+    X_PSI_RES,                                    // PSI_COUNT bloques de XP_COUNT
+    X_PSI_END = X_PSI_RES + PSI_COUNT * XP_COUNT,
+    X_PROC_RC = X_PSI_END, X_PROC_READY, X_PROC_INTERVAL_US, X_PROC_TOTAL, X_PROC_RUNNING,
+    X_PROC_THREADS, X_PROC_UNCACHED, X_PROC_N_CPU, X_PROC_N_RSS,
+    X_PROC_BY_CPU,                                // PROC_TOP bloques de XR_COUNT
+    X_PROC_BY_RSS = X_PROC_BY_CPU + PROC_TOP * XR_COUNT,
+    X_PROC_END = X_PROC_BY_RSS + PROC_TOP * XR_COUNT,
+    X_TH_RC = X_PROC_END, X_TH_NPOLICIES, X_TH_NZONES, X_TH_OMITTED_ZONES, X_TH_THROTTLED,
+    X_TH_POLICY,                                  // REC_TH_POLICIES bloques de XF_COUNT
+    X_TH_ZONE = X_TH_POLICY + REC_TH_POLICIES * XF_COUNT,   // THERMAL_ZONE_MAX de XZ_COUNT
+    X_TH_END = X_TH_ZONE + THERMAL_ZONE_MAX * XZ_COUNT,
+    X_CG_RC = X_TH_END, X_CG_READY, X_CG_INTERVAL_US,
+    X_CG_PATH,                                    // 16 campos
+    X_CG_MEM_CURRENT = X_CG_PATH + 16, X_CG_MEM_MAX, X_CG_MEM_HIGH, X_CG_SWAP_CURRENT, X_CG_SWAP_MAX,
+    X_CG_ANON, X_CG_FILE, X_CG_SHMEM, X_CG_KERNEL, X_CG_SLAB, X_CG_SRECLAIM, X_CG_KSTACK,
+    X_CG_PAGETABLES, X_CG_INACTIVE_FILE, X_CG_FILE_MAPPED, X_CG_FILE_DIRTY, X_CG_FILE_WRITEBACK,
+    X_CG_USAGE_USEC, X_CG_THROTTLED_USEC, X_CG_NR_PERIODS, X_CG_NR_THROTTLED,
+    X_CG_CPU, X_CG_CPU_USER, X_CG_CPU_SYSTEM, X_CG_CPU_QUOTA, X_CG_THROTTLED_RATIO, X_CG_THROTTLED_MS_PS,
+    X_CG_NCHILDREN, X_CG_OMITTED_CHILDREN,
+    X_CG_CHILD,                                   // CGROUP_CHILD_MAX bloques de XC_COUNT
+    X_CG_END = X_CG_CHILD + CGROUP_CHILD_MAX * XC_COUNT,
+    X_IRQ_RC = X_CG_END, X_IRQ_READY, X_IRQ_INTERVAL_US, X_IRQ_NCPUS, X_IRQ_PS, X_SOFTIRQ_PS,
+    X_IRQ_NHOT,
+    X_IRQ_HOT,                                    // IRQ_HOT_MAX bloques de XH_COUNT
+    X_IRQ_END = X_IRQ_HOT + IRQ_HOT_MAX * XH_COUNT,
+    X_DISK_UNTRACKED = X_IRQ_END,
+    X_DISK_TOTAL_R_IOPS, X_DISK_TOTAL_W_IOPS, X_DISK_TOTAL_R_BPS, X_DISK_TOTAL_W_BPS,
+    X_DISK_TOTAL_QUEUE, X_DISK_MAX_UTIL,
+    X_NET_UNTRACKED,
+    X_NET_TOTAL_RX_BPS, X_NET_TOTAL_TX_BPS, X_NET_TOTAL_RX_PPS, X_NET_TOTAL_TX_PPS,
+    X_NET_TOTAL_ERRS_PS, X_NET_TOTAL_DROP_PS,
+    X_TH_OMITTED_POLICIES,
+    X_TH_POLICY_MORE,                             // policies desde REC_TH_POLICIES
+    X_TH_POLICY_MORE_END = X_TH_POLICY_MORE + (FREQ_POLICY_MAX - REC_TH_POLICIES) * XF_COUNT,
+    X_COUNT = X_TH_POLICY_MORE_END
+};
+
+static size_t rec_ext_off(int cores) {
+    return (size_t)F_FIXED_COUNT + (size_t)cores * PC_COUNT;
+}
+
+static size_t rec_nfields(int cores, size_t ext) {
+    return rec_ext_off(cores) + ext;
+}
+
+// Campos de la policy i (las que no caben en el bloque original van al final)
+static size_t th_policy_off(int i) {
+    return i < REC_TH_POLICIES ? X_TH_POLICY + (size_t)i * XF_COUNT
+                               : X_TH_POLICY_MORE + (size_t)(i - REC_TH_POLICIES) * XF_COUNT;
+}
+
+static int64_t q(double v, double scale) {
+    double x = v * scale;
+    return (int64_t)(x < 0 ? x - 0.5 : x + 0.5);
+}
+
+static void times_to_fields(const CPUTimes *t, int64_t *f, double scale, int with_idle) {
+    *f++ = q(t->user, scale);   *f++ = q(t->nice, scale);   *f++ = q(t->system, scale);
+    if (with_idle) *f++ = q(t->idle, scale);
+    *f++ = q(t->iowait, scale); *f++ = q(t->irq, scale);    *f++ = q(t->softirq, scale);
+    *f   = q(t->steal, scale);
+}
+
+static void fields_to_times(const int64_t *f, CPUTimes *t, double scale, int with_idle) {
+    t->user = (double)*f++ / scale; t->nice = (double)*f++ / scale; t->system = (double)*f++ / scale;
+    if (with_idle) t->idle = (double)*f++ / scale;
+    t->iowait = (double)*f++ / scale; t->irq = (double)*f++ / scale; t->softirq = (double)*f++ / scale;
+    t->steal = (double)*f / scale;
+    if (!with_idle) {
+        double busy = t->user + t->nice + t->system + t->iowait + t->irq + t->softirq + t->steal;
+        t->idle = busy < 1.0 ? 1.0 - busy : 0.0;
+    }
+}
+
+// Nombre de 'size' bytes (múltiplo de 8, hasta CGROUP_PATH_MAX) empaquetado
+// en size/8 campos
+static void pack_name(const char *name, int64_t *f, size_t size) {
+    size_t n = strnlen(name, size - 1);
+    memcpy(f, name, n);
+    memset((char *)f + n, 0, size - n);
+}
+
+static void unpack_name(const int64_t *f, char *name, size_t size) {
+    memcpy(name, f, size);
+    name[size - 1] = '\0';
+}
+
+static void snap_to_fields(const Snapshot *s, int cores, int64_t *f) {
+    const MemStats *m = &s->mem;
+    const CPUUsage *u = &s->cpu;
+    memset(f, 0, rec_nfields(cores, X_COUNT) * sizeof(*f));
+
+    f[F_SEQ]   = (int64_t)s->seq;
+    f[F_TS_MS] = (int64_t)s->ts.tv_sec * 1000 + s->ts.tv_nsec / 1000000L;
+    f[F_MEM_RC] = s->mem_rc;
+    f[F_CPU_RC] = s->cpu_rc;
+    f[F_READY]  = u->ready;
+    f[F_MEM_TOTAL] = m->total_kib;      f[F_MEM_AVAIL] = m->avail_kib;   f[F_MEM_USED] = m->used_kib;
+    f[F_SWAP_TOTAL] = m->swap_total_kib; f[F_SWAP_FREE] = m->swap_free_kib; f[F_SWAP_USED] = m->swap_used_kib;
+    f[F_MEM_RATIO]  = q(m->used_ratio, Q_RATIO);
+    f[F_SWAP_RATIO] = q(m->swap_used_ratio, Q_RATIO);
+    f[F_INTERVAL_US] = q(u->interval_s, 1e6);
+    f[F_ONLINE] = u->online_count;
+    f[F_AVG]    = q(u->avg, Q_RATIO);
+    f[F_CORES]  = u->cores < cores ? u->cores : cores;
+    times_to_fields(&u->total, &f[F_T_USER], Q_RATIO, 1);
+    f[F_CTXT]  = (int64_t)u->kstat.ctxt;
+    f[F_INTR]  = (int64_t)u->kstat.intr;
+    f[F_FORKS] = (int64_t)u->kstat.forks;
+    f[F_CTXT_RATE]  = q(u->kstat.ctxt_per_s, Q_RATE);
+    f[F_INTR_RATE]  = q(u->kstat.intr_per_s, Q_RATE);
+    f[F_FORKS_RATE] = q(u->kstat.forks_per_s, Q_RATE);
+    f[F_RUNNING] = u->kstat.procs_running;
+    f[F_BLOCKED] = u->kstat.procs_blocked;
+
+    for (int c = 0; c < f[F_CORES]; ++c) {
+        int64_t *pc = f + F_FIXED_COUNT + (size_t)c * PC_COUNT;
+        pc[PC_STATE] = u->state[c];
+        if (u->state[c] != CPU_CORE_ONLINE) continue;   // sin dato: todo 0
+        pc[PC_USAGE] = q(u->per_core[c], Q_CORE);
+        times_to_fields(&u->times[c], &pc[PC_T_USER], Q_CORE, 0);
+    }
+
+    int64_t *x = f + rec_ext_off(cores);
+    x[X_MEM_FREE] = m->free_kib;          x[X_BUFFERS] = m->buffers_kib;
+    x[X_CACHED] = m->cached_kib;          x[X_SWAP_CACHED] = m->swap_cached_kib;
+    x[X_DIRTY] = m->dirty_kib;            x[X_WRITEBACK] = m->writeback_kib;
+    x[X_ANON] = m->anon_kib;              x[X_MAPPED] = m->mapped_kib;
+    x[X_SHMEM] = m->shmem_kib;            x[X_SLAB] = m->slab_kib;
+    x[X_SRECLAIM] = m->sreclaimable_kib;  x[X_KSTACK] = m->kernel_stack_kib;
+    x[X_PAGETABLES] = m->page_tables_kib; x[X_COMMIT_LIMIT] = m->commit_limit_kib;
+    x[X_COMMITTED] = m->committed_kib;    x[X_HUGE_TOTAL] = m->huge_total;
+    x[X_HUGE_FREE] = m->huge_free;        x[X_HUGE_RSVD] = m->huge_rsvd;
+    x[X_HUGE_SURP] = m->huge_surp;        x[X_HUGE_SIZE] = m->huge_page_kib;
+
+    const DiskStats *d = &s->disk;
+    x[X_DISK_RC] = s->disk_rc;
+    x[X_DISK_READY] = d->ready;
+    x[X_DISK_INTERVAL_US] = q(d->interval_s, 1e6);
+    x[X_DISK_COUNT] = d->count;
+    x[X_DISK_OMITTED] = d->omitted;
+    x[X_DISK_UNTRACKED] = d->untracked;
+    x[X_DISK_TOTAL_R_IOPS] = q(d->total_r_iops, Q_RATE);  x[X_DISK_TOTAL_W_IOPS] = q(d->total_w_iops, Q_RATE);
+    x[X_DISK_TOTAL_R_BPS] = q(d->total_r_bps, 1.0);       x[X_DISK_TOTAL_W_BPS] = q(d->total_w_bps, 1.0);
+    x[X_DISK_TOTAL_QUEUE] = q(d->total_queue, 1e3);       x[X_DISK_MAX_UTIL] = q(d->max_util, Q_RATIO);
+    for (int i = 0; i < d->count && i < DISK_MAX; ++i) {
+        const DiskDev *v = &d->dev[i];
+        int64_t *xd = x + X_DISK_DEV + (size_t)i * XD_COUNT;
+        pack_name(v->name, xd + XD_NAME, DISK_NAME_MAX);
+        xd[XD_READY] = v->ready;
+        xd[XD_IN_FLIGHT] = v->in_flight;
+        xd[XD_R_IOPS] = q(v->r_iops, Q_RATE);          xd[XD_W_IOPS] = q(v->w_iops, Q_RATE);
+        xd[XD_R_BPS] = q(v->r_bps, 1.0);               xd[XD_W_BPS] = q(v->w_bps, 1.0);
+        xd[XD_R_AWAIT_US] = q(v->r_await_ms, 1e3);     xd[XD_W_AWAIT_US] = q(v->w_await_ms, 1e3);
+        xd[XD_SVC_US] = q(v->svc_ms, 1e3);
+        xd[XD_UTIL] = q(v->util, Q_RATIO);             xd[XD_QUEUE] = q(v->queue, 1e3);
+    }
+
+    const NetStats *ns = &s->net;
+    x[X_NET_RC] = s->net_rc;
+    x[X_NET_READY] = ns->ready;
+    x[X_NET_INTERVAL_US] = q(ns->interval_s, 1e6);
+    x[X_NET_COUNT] = ns->count;
+    x[X_NET_OMITTED] = ns->omitted;
+    x[X_NET_UNTRACKED] = ns->untracked;
+    x[X_NET_TOTAL_RX_BPS] = q(ns->total_rx_bps, 1.0);      x[X_NET_TOTAL_TX_BPS] = q(ns->total_tx_bps, 1.0);
+    x[X_NET_TOTAL_RX_PPS] = q(ns->total_rx_pps, Q_RATE);   x[X_NET_TOTAL_TX_PPS] = q(ns->total_tx_pps, Q_RATE);
+    x[X_NET_TOTAL_ERRS_PS] = q(ns->total_errs_ps, Q_RATE); x[X_NET_TOTAL_DROP_PS] = q(ns->total_drop_ps, Q_RATE);
+    for (int i = 0; i < ns->count && i < NET_MAX; ++i) {
+        const NetIf *v = &ns->ifs[i];
+        int64_t *xn = x + X_NET_IF + (size_t)i * XN_COUNT;
+        pack_name(v->name, xn + XN_NAME, NET_NAME_MAX);
+        xn[XN_READY] = v->ready;                       xn[XN_SPEED] = v->speed_mbps;
+        xn[XN_RX_BPS] = q(v->rx_bps, 1.0);             xn[XN_TX_BPS] = q(v->tx_bps, 1.0);
+        xn[XN_RX_PPS] = q(v->rx_pps, Q_RATE);          xn[XN_TX_PPS] = q(v->tx_pps, Q_RATE);
+        xn[XN_RX_ERRS_PS] = q(v->rx_errs_ps, Q_RATE);  xn[XN_TX_ERRS_PS] = q(v->tx_errs_ps, Q_RATE);
+        xn[XN_RX_DROP_PS] = q(v->rx_drop_ps, Q_RATE);  xn[XN_TX_DROP_PS] = q(v->tx_drop_ps, Q_RATE);
+        xn[XN_RX_ERRS] = (int64_t)v->rx_errs;          xn[XN_TX_ERRS] = (int64_t)v->tx_errs;
+        xn[XN_RX_DROP] = (int64_t)v->rx_drop;          xn[XN_TX_DROP] = (int64_t)v->tx_drop;
+    }
+
+    const PsiStats *ps = &s->psi;
+    x[X_PSI_RC] = s->psi_rc;
+    x[X_PSI_READY] = ps->ready;
+    x[X_PSI_INTERVAL_US] = q(ps->interval_s, 1e6);
+    for (int r = 0; r < PSI_COUNT; ++r) {
+        const PsiResource *pr = &ps->res[r];
+        int64_t *xp = x + X_PSI_RES + (size_t)r * XP_COUNT;
+        xp[XP_AVAILABLE] = pr->available;
+        xp[XP_HAS_FULL] = pr->has_full;
+        for (int k = 0; k < 2; ++k) {
+            const PsiLine *l = k ? &pr->full : &pr->some;
+            int64_t *xl = xp + (k ? XP_FULL : XP_SOME);
+            xl[XL_AVG10] = q(l->avg10, 100.0);         xl[XL_AVG60] = q(l->avg60, 100.0);
+            xl[XL_AVG300] = q(l->avg300, 100.0);       xl[XL_STALL] = q(l->stall, Q_RATIO);
+            xl[XL_TOTAL_US] = (int64_t)l->total_us;
+        }
+    }
+
+    const ProcStats *pr = &s->procs;
+    x[X_PROC_RC] = s->procs_rc;
+    x[X_PROC_READY] = pr->ready;
+    x[X_PROC_INTERVAL_US] = q(pr->interval_s, 1e6);
+    x[X_PROC_TOTAL] = pr->total;        x[X_PROC_RUNNING] = pr->running;
+    x[X_PROC_THREADS] = pr->threads;    x[X_PROC_UNCACHED] = pr->uncached;
+    x[X_PROC_N_CPU] = pr->n_cpu;        x[X_PROC_N_RSS] = pr->n_rss;
+    for (int k = 0; k < 2; ++k) {
+        const ProcInfo *list = k ? pr->by_rss : pr->by_cpu;
+        int n = k ? pr->n_rss : pr->n_cpu;
+        for (int i = 0; i < n && i < PROC_TOP; ++i) {
+            const ProcInfo *v = &list[i];
+            int64_t *xr = x + (k ? X_PROC_BY_RSS : X_PROC_BY_CPU) + (size_t)i * XR_COUNT;
+            xr[XR_PID] = v->pid;
+            pack_name(v->comm, xr + XR_COMM, PROC_COMM_MAX);
+            xr[XR_STATE] = v->state;        xr[XR_THREADS] = v->threads;
+            xr[XR_CPU] = q(v->cpu, Q_CORE); xr[XR_RSS_KIB] = v->rss_kib;
+        }
+    }
+
+    const ThermalStats *th = &s->thermal;
+    x[X_TH_RC] = s->thermal_rc;
+    x[X_TH_NPOLICIES] = th->npolicies;  x[X_TH_NZONES] = th->nzones;
+    x[X_TH_OMITTED_ZONES] = th->omitted_zones;
+    x[X_TH_OMITTED_POLICIES] = th->omitted_policies;
+    x[X_TH_THROTTLED] = th->throttled;
+    for (int i = 0; i < th->npolicies && i < FREQ_POLICY_MAX; ++i) {
+        const FreqPolicy *fp = &th->policy[i];
+        int64_t *xf = x + th_policy_off(i);
+        xf[XF_FIRST_CPU] = fp->first_cpu;   xf[XF_NCPUS] = fp->ncpus;
+        xf[XF_CUR_KHZ] = fp->cur_khz;       xf[XF_MIN_KHZ] = fp->min_khz;
+        xf[XF_MAX_KHZ] = fp->max_khz;       xf[XF_HW_MAX_KHZ] = fp->hw_max_khz;
+    }
+    for (int i = 0; i < th->nzones && i < THERMAL_ZONE_MAX; ++i) {
+        const ThermalZone *z = &th->zone[i];
+        int64_t *xz = x + X_TH_ZONE + (size_t)i * XZ_COUNT;
+        pack_name(z->type, xz + XZ_TYPE, THERMAL_TYPE_MAX);
+        xz[XZ_TEMP_MC] = q(z->temp_c, 1000.0);
+        xz[XZ_CRIT_MC] = q(z->crit_c, 1000.0);
+        xz[XZ_PASSIVE_MC] = q(z->passive_c, 1000.0);
+    }
+
+    const CgroupStats *cg = &s->cgroup;
+    x[X_CG_RC] = s->cgroup_rc;
+    x[X_CG_READY] = cg->ready;
+    x[X_CG_INTERVAL_US] = q(cg->interval_s, 1e6);
+    pack_name(cg->path, x + X_CG_PATH, CGROUP_PATH_MAX);
+    x[X_CG_MEM_CURRENT] = cg->mem_current_kib;     x[X_CG_MEM_MAX] = cg->mem_max_kib;
+    x[X_CG_MEM_HIGH] = cg->mem_high_kib;           x[X_CG_SWAP_CURRENT] = cg->swap_current_kib;
+    x[X_CG_SWAP_MAX] = cg->swap_max_kib;           x[X_CG_ANON] = cg->anon_kib;
+    x[X_CG_FILE] = cg->file_kib;                   x[X_CG_SHMEM] = cg->shmem_kib;
+    x[X_CG_KERNEL] = cg->kernel_kib;               x[X_CG_SLAB] = cg->slab_kib;
+    x[X_CG_SRECLAIM] = cg->sreclaimable_kib;       x[X_CG_KSTACK] = cg->kernel_stack_kib;
+    x[X_CG_PAGETABLES] = cg->pagetables_kib;       x[X_CG_INACTIVE_FILE] = cg->inactive_file_kib;
+    x[X_CG_FILE_MAPPED] = cg->file_mapped_kib;     x[X_CG_FILE_DIRTY] = cg->file_dirty_kib;
+    x[X_CG_FILE_WRITEBACK] = cg->file_writeback_kib;
+    x[X_CG_USAGE_USEC] = (int64_t)cg->usage_usec;  x[X_CG_THROTTLED_USEC] = (int64_t)cg->throttled_usec;
+    x[X_CG_NR_PERIODS] = (int64_t)cg->nr_periods;  x[X_CG_NR_THROTTLED] = (int64_t)cg->nr_throttled;
+    x[X_CG_CPU] = q(cg->cpu, Q_CORE);              x[X_CG_CPU_USER] = q(cg->cpu_user, Q_CORE);
+    x[X_CG_CPU_SYSTEM] = q(cg->cpu_system, Q_CORE);
+    x[X_CG_CPU_QUOTA] = q(cg->cpu_quota, Q_CORE);
+    x[X_CG_THROTTLED_RATIO] = q(cg->throttled_ratio, Q_RATIO);
+    x[X_CG_THROTTLED_MS_PS] = q(cg->throttled_ms_ps, Q_RATE);
+    x[X_CG_NCHILDREN] = cg->nchildren;             x[X_CG_OMITTED_CHILDREN] = cg->omitted_children;
+    for (int i = 0; i < cg->nchildren && i < CGROUP_CHILD_MAX; ++i) {
+        const CgroupChild *c = &cg->child[i];
+        int64_t *xc = x + X_CG_CHILD + (size_t)i * XC_COUNT;
+        pack_name(c->name, xc + XC_NAME, CGROUP_NAME_MAX);
+        xc[XC_READY] = c->ready;
+        xc[XC_MEM_KIB] = c->mem_kib;
+        xc[XC_CPU] = q(c->cpu, Q_CORE);
+    }
+
+    const IrqStats *iq = &s->irq;
+    x[X_IRQ_RC] = s->irq_rc;
+    x[X_IRQ_READY] = iq->ready;
+    x[X_IRQ_INTERVAL_US] = q(iq->interval_s, 1e6);
+    x[X_IRQ_NCPUS] = iq->ncpus;
+    x[X_IRQ_PS] = q(iq->irq_ps, Q_RATE);          x[X_SOFTIRQ_PS] = q(iq->softirq_ps, Q_RATE);
+    x[X_IRQ_NHOT] = iq->nhot;
+    for (int i = 0; i < iq->nhot && i < IRQ_HOT_MAX; ++i) {
+        const IrqHotCore *h = &iq->hot[i];
+        int64_t *xh = x + X_IRQ_HOT + (size_t)i * XH_COUNT;
+        xh[XH_CPU] = h->cpu;
+        xh[XH_IRQ_PS] = q(h->irq_ps, Q_RATE);      xh[XH_SOFTIRQ_PS] = q(h->softirq_ps, Q_RATE);
+        xh[XH_NSRC] = h->nsrc;
+        for (int k = 0; k < h->nsrc && k < IRQ_SRC_MAX; ++k) {
+            int64_t *xs = xh + XH_SRC + (size_t)k * XS_COUNT;
+            pack_name(h->src[k].name, xs + XS_NAME, IRQ_NAME_MAX);
+            xs[XS_SOFTIRQ] = h->src[k].softirq;
+            xs[XS_RATE] = q(h->src[k].rate, Q_RATE);
+        }
+    }
+}
+
+// 'ext' = campos extendidos que trae la grabación; lo que no trae queda "no disponible"
+static int fields_to_snap(const int64_t *f, int cores, size_t ext, Snapshot *s) {
+    MemStats *m = &s->mem;
+    CPUUsage *u = &s->cpu;
+    if (cpu_usage_reserve(u, cores) != 0) return 3;
+
+    s->seq = (unsigned long long)f[F_SEQ];
+    s->ts.tv_sec  = (time_t)(f[F_TS_MS] / 1000);
+    s->ts.tv_nsec = (long)(f[F_TS_MS] % 1000) * 1000000L;
+    s->mem_rc = (int)f[F_MEM_RC];
+    s->cpu_rc = (int)f[F_CPU_RC];
+    m->total_kib = (long)f[F_MEM_TOTAL];       m->avail_kib = (long)f[F_MEM_AVAIL];
+    m->used_kib  = (long)f[F_MEM_USED];        m->swap_total_kib = (long)f[F_SWAP_TOTAL];
+    m->swap_free_kib = (long)f[F_SWAP_FREE];   m->swap_used_kib  = (long)f[F_SWAP_USED];
+    m->used_ratio      = (double)f[F_MEM_RATIO] / Q_RATIO;
+    m->swap_used_ratio = (double)f[F_SWAP_RATIO] / Q_RATIO;
+
+    u->ready        = (int)f[F_READY];
+    u->interval_s   = (double)f[F_INTERVAL_US] / 1e6;
+    u->online_count = (int)f[F_ONLINE];
+    u->avg          = (double)f[F_AVG] / Q_RATIO;
+    int n = (int)f[F_CORES];
+    u->cores = (n >= 0 && n <= cores) ? n : 0;
+    fields_to_times(&f[F_T_USER], &u->total, Q_RATIO, 1);
+    u->kstat.ctxt  = (unsigned long long)f[F_CTXT];
+    u->kstat.intr  = (unsigned long long)f[F_INTR];
+    u->kstat.forks = (unsigned long long)f[F_FORKS];
+    u->kstat.ctxt_per_s  = (double)f[F_CTXT_RATE] / Q_RATE;
+    u->kstat.intr_per_s  = (double)f[F_INTR_RATE] / Q_RATE;
+    u->kstat.forks_per_s = (double)f[F_FORKS_RATE] / Q_RATE;
+    u->kstat.procs_running = (int)f[F_RUNNING];
+    u->kstat.procs_blocked = (int)f[F_BLOCKED];
+
+    for (int c = 0; c < u->cores; ++c) {
+        const int64_t *pc = f + F_FIXED_COUNT + (size_t)c * PC_COUNT;
+        u->state[c]    = (unsigned char)pc[PC_STATE];
+        u->per_core[c] = (double)pc[PC_USAGE] / Q_CORE;
+        if (u->state[c] == CPU_CORE_ONLINE) fields_to_times(&pc[PC_T_USER], &u->times[c], Q_CORE, 0);
+        else memset(&u->times[c], 0, sizeof(u->times[c]));
+    }
+
+    const int64_t *x = f + rec_ext_off(cores);
+    m->free_kib = (long)x[X_MEM_FREE];          m->buffers_kib = (long)x[X_BUFFERS];
+    m->cached_kib = (long)x[X_CACHED];          m->swap_cached_kib = (long)x[X_SWAP_CACHED];
+    m->dirty_kib = (long)x[X_DIRTY];            m->writeback_kib = (long)x[X_WRITEBACK];
+    m->anon_kib = (long)x[X_ANON];              m->mapped_kib = (long)x[X_MAPPED];
+    m->shmem_kib = (long)x[X_SHMEM];            m->slab_kib = (long)x[X_SLAB];
+    m->sreclaimable_kib = (long)x[X_SRECLAIM];  m->kernel_stack_kib = (long)x[X_KSTACK];
+    m->page_tables_kib = (long)x[X_PAGETABLES]; m->commit_limit_kib = (long)x[X_COMMIT_LIMIT];
+    m->committed_kib = (long)x[X_COMMITTED];    m->huge_total = (long)x[X_HUGE_TOTAL];
+    m->huge_free = (long)x[X_HUGE_FREE];        m->huge_rsvd = (long)x[X_HUGE_RSVD];
+    m->huge_surp = (long)x[X_HUGE_SURP];        m->huge_page_kib = (long)x[X_HUGE_SIZE];
+
+    DiskStats *d = &s->disk;
+    memset(d, 0, sizeof(*d));
+    s->disk_rc = ext > X_DISK_RC ? (int)x[X_DISK_RC] : 2;
+    d->ready = (int)x[X_DISK_READY];
+    d->interval_s = (double)x[X_DISK_INTERVAL_US] / 1e6;
+    int nd = (int)x[X_DISK_COUNT];
+    d->count = (nd >= 0 && nd <= DISK_MAX) ? nd : 0;
+    d->omitted = (int)x[X_DISK_OMITTED];
+    d->untracked = ext > X_DISK_UNTRACKED ? (int)x[X_DISK_UNTRACKED] : 0;
+    for (int i = 0; i < d->count; ++i) {
+        DiskDev *v = &d->dev[i];
+        const int64_t *xd = x + X_DISK_DEV + (size_t)i * XD_COUNT;
+        unpack_name(xd + XD_NAME, v->name, DISK_NAME_MAX);
+        v->ready = (int)xd[XD_READY];
+        v->in_flight = (unsigned)xd[XD_IN_FLIGHT];
+        v->r_iops = (double)xd[XD_R_IOPS] / Q_RATE;       v->w_iops = (double)xd[XD_W_IOPS] / Q_RATE;
+        v->r_bps = (double)xd[XD_R_BPS];                  v->w_bps = (double)xd[XD_W_BPS];
+        v->r_await_ms = (double)xd[XD_R_AWAIT_US] / 1e3;  v->w_await_ms = (double)xd[XD_W_AWAIT_US] / 1e3;
+        v->svc_ms = (double)xd[XD_SVC_US] / 1e3;
+        v->util = (double)xd[XD_UTIL] / Q_RATIO;          v->queue = (double)xd[XD_QUEUE] / 1e3;
+    }
+    if (ext > X_DISK_MAX_UTIL) {
+        d->total_r_iops = (double)x[X_DISK_TOTAL_R_IOPS] / Q_RATE;
+        d->total_w_iops = (double)x[X_DISK_TOTAL_W_IOPS] / Q_RATE;
+        d->total_r_bps = (double)x[X_DISK_TOTAL_R_BPS];
+        d->total_w_bps = (double)x[X_DISK_TOTAL_W_BPS];
+        d->total_queue = (double)x[X_DISK_TOTAL_QUEUE] / 1e3;
+        d->max_util = (double)x[X_DISK_MAX_UTIL] / Q_RATIO;
+    } else {
+        // Grabación anterior a los totales: lo mejor que hay son los de dev[]
+        for (int i = 0; i < d->count; ++i) {
+            const DiskDev *v = &d->dev[i];
+            if (!v->ready) continue;
+            d->total_r_iops += v->r_iops; d->total_w_iops += v->w_iops;
+            d->total_r_bps += v->r_bps;   d->total_w_bps += v->w_bps;
+            d->total_queue += v->queue;
+            if (v->util > d->max_util) d->max_util = v->util;
+        }
+    }
+
+    NetStats *ns = &s->net;
+    memset(ns, 0, sizeof(*ns));
+    s->net_rc = ext > X_NET_RC ? (int)x[X_NET_RC] : 2;
+    ns->ready = (int)x[X_NET_READY];
+    ns->interval_s = (double)x[X_NET_INTERVAL_US] / 1e6;
+    int nn = (int)x[X_NET_COUNT];
+    ns->count = (nn >= 0 && nn <= NET_MAX) ? nn : 0;
+    ns->omitted = (int)x[X_NET_OMITTED];
+    ns->untracked = ext > X_NET_UNTRACKED ? (int)x[X_NET_UNTRACKED] : 0;
+    for (int i = 0; i < ns->count; ++i) {
+        NetIf *v = &ns->ifs[i];
+        const int64_t *xn = x + X_NET_IF + (size_t)i * XN_COUNT;
+        unpack_name(xn + XN_NAME, v->name, NET_NAME_MAX);
+        v->ready = (int)xn[XN_READY];                     v->speed_mbps = (int)xn[XN_SPEED];
+        v->rx_bps = (double)xn[XN_RX_BPS];                v->tx_bps = (double)xn[XN_TX_BPS];
+        v->rx_pps = (double)xn[XN_RX_PPS] / Q_RATE;       v->tx_pps = (double)xn[XN_TX_PPS] / Q_RATE;
+        v->rx_errs_ps = (double)xn[XN_RX_ERRS_PS] / Q_RATE;
+        v->tx_errs_ps = (double)xn[XN_TX_ERRS_PS] / Q_RATE;
+        v->rx_drop_ps = (double)xn[XN_RX_DROP_PS] / Q_RATE;
+        v->tx_drop_ps = (double)xn[XN_TX_DROP_PS] / Q_RATE;
+        v->rx_errs = (unsigned long long)xn[XN_RX_ERRS]; v->tx_errs = (unsigned long long)xn[XN_TX_ERRS];
+        v->rx_drop = (unsigned long long)xn[XN_RX_DROP]; v->tx_drop = (unsigned long long)xn[XN_TX_DROP];
+    }
+    if (ext > X_NET_TOTAL_DROP_PS) {
+        ns->total_rx_bps = (double)x[X_NET_TOTAL_RX_BPS];
+        ns->total_tx_bps = (double)x[X_NET_TOTAL_TX_BPS];
+        ns->total_rx_pps = (double)x[X_NET_TOTAL_RX_PPS] / Q_RATE;
+        ns->total_tx_pps = (double)x[X_NET_TOTAL_TX_PPS] / Q_RATE;
+        ns->total_errs_ps = (double)x[X_NET_TOTAL_ERRS_PS] / Q_RATE;
+        ns->total_drop_ps = (double)x[X_NET_TOTAL_DROP_PS] / Q_RATE;
+    } else {
+        // Grabación anterior a los totales: lo mejor que hay son los de ifs[]
+        for (int i = 0; i < ns->count; ++i) {
+            const NetIf *v = &ns->ifs[i];
+            if (!v->ready) continue;
+            ns->total_rx_bps += v->rx_bps;   ns->total_tx_bps += v->tx_bps;
+            ns->total_rx_pps += v->rx_pps;   ns->total_tx_pps += v->tx_pps;
+            ns->total_errs_ps += v->rx_errs_ps + v->tx_errs_ps;
+            ns->total_drop_ps += v->rx_drop_ps + v->tx_drop_ps;
+        }
+    }
+
+    PsiStats *ps = &s->psi;
+    memset(ps, 0, sizeof(*ps));
+    s->psi_rc = ext > X_PSI_RC ? (int)x[X_PSI_RC] : 2;
+    ps->ready = (int)x[X_PSI_READY];
+    ps->interval_s = (double)x[X_PSI_INTERVAL_US] / 1e6;
+    for (int r = 0; r < PSI_COUNT; ++r) {
+        PsiResource *pr = &ps->res[r];
+        const int64_t *xp = x + X_PSI_RES + (size_t)r * XP_COUNT;
+        pr->available = (int)xp[XP_AVAILABLE];
+        pr->has_full = (int)xp[XP_HAS_FULL];
+        for (int k = 0; k < 2; ++k) {
+            PsiLine *l = k ? &pr->full : &pr->some;
+            const int64_t *xl = xp + (k ? XP_FULL : XP_SOME);
+            l->avg10 = (double)xl[XL_AVG10] / 100.0;      l->avg60 = (double)xl[XL_AVG60] / 100.0;
+            l->avg300 = (double)xl[XL_AVG300] / 100.0;    l->stall = (double)xl[XL_STALL] / Q_RATIO;
+            l->total_us = (unsigned long long)xl[XL_TOTAL_US];
+        }
+    }
+
+    ProcStats *pr = &s->procs;
+    memset(pr, 0, sizeof(*pr));
+    s->procs_rc = ext > X_PROC_RC ? (int)x[X_PROC_RC] : 2;
+    pr->ready = (int)x[X_PROC_READY];
+    pr->interval_s = (double)x[X_PROC_INTERVAL_US] / 1e6;
+    pr->total = (int)x[X_PROC_TOTAL];          pr->running = (int)x[X_PROC_RUNNING];
+    pr->threads = (int)x[X_PROC_THREADS];      pr->uncached = (int)x[X_PROC_UNCACHED];
+    for (int k = 0; k < 2; ++k) {
+        ProcInfo *list = k ? pr->by_rss : pr->by_cpu;
+        int np = (int)x[k ? X_PROC_N_RSS : X_PROC_N_CPU];
+        if (np < 0 || np > PROC_TOP) np = 0;
+        if (k) pr->n_rss = np; else pr->n_cpu = np;
+        for (int i = 0; i < np; ++i) {
+            ProcInfo *v = &list[i];
+            const int64_t *xr = x + (k ? X_PROC_BY_RSS : X_PROC_BY_CPU) + (size_t)i * XR_COUNT;
+            v->pid = (int)xr[XR_PID];
+            unpack_name(xr + XR_COMM, v->comm, PROC_COMM_MAX);
+            v->state = (char)xr[XR_STATE];          v->threads = (int)xr[XR_THREADS];
+            v->cpu = (double)xr[XR_CPU] / Q_CORE;   v->rss_kib = (long)xr[XR_RSS_KIB];
+        }
+    }
+
+    ThermalStats *th = &s->thermal;
+    memset(th, 0, sizeof(*th));
+    for (int c = 0; c < FREQ_CORE_MAX; ++c) th->core_policy[c] = FREQ_NO_POLICY;
+    s->thermal_rc = ext > X_TH_RC ? (int)x[X_TH_RC] : 2;
+    th->throttled = ext > X_TH_RC ? (int)x[X_TH_THROTTLED] : -1;
+    th->omitted_zones = (int)x[X_TH_OMITTED_ZONES];
+    th->omitted_policies = ext > X_TH_OMITTED_POLICIES ? (int)x[X_TH_OMITTED_POLICIES] : 0;
+    // Una grabación anterior al bloque del final solo trae las del original
+    int npol = (int)x[X_TH_NPOLICIES], nz = (int)x[X_TH_NZONES];
+    int pol_max = ext >= X_TH_POLICY_MORE_END ? FREQ_POLICY_MAX : REC_TH_POLICIES;
+    th->npolicies = (npol >= 0 && npol <= pol_max) ? npol : 0;
+    th->nzones = (nz >= 0 && nz <= THERMAL_ZONE_MAX) ? nz : 0;
+    for (int i = 0; i < th->npolicies; ++i) {
+        FreqPolicy *fp = &th->policy[i];
+        const int64_t *xf = x + th_policy_off(i);
+        fp->first_cpu = (int)xf[XF_FIRST_CPU];  fp->ncpus = (int)xf[XF_NCPUS];
+        fp->cur_khz = (long)xf[XF_CUR_KHZ];     fp->min_khz = (long)xf[XF_MIN_KHZ];
+        fp->max_khz = (long)xf[XF_MAX_KHZ];     fp->hw_max_khz = (long)xf[XF_HW_MAX_KHZ];
+        // Solo se graba el rango: se asume que los núcleos de una policy son
+        // contiguos (así es en todos los SoC big.LITTLE conocidos)
+        for (int c = fp->first_cpu; c >= 0 && c < fp->first_cpu + fp->ncpus && c < FREQ_CORE_MAX; ++c)
+            th->core_policy[c] = (unsigned short)i;
+    }
+    for (int i = 0; i < th->nzones; ++i) {
+        ThermalZone *z = &th->zone[i];
+        const int64_t *xz = x + X_TH_ZONE + (size_t)i * XZ_COUNT;
+        unpack_name(xz + XZ_TYPE, z->type, THERMAL_TYPE_MAX);
+        z->temp_c = (double)xz[XZ_TEMP_MC] / 1000.0;
+        z->crit_c = (double)xz[XZ_CRIT_MC] / 1000.0;
+        z->passive_c = (double)xz[XZ_PASSIVE_MC] / 1000.0;
+    }
+
+    CgroupStats *cg = &s->cgroup;
+    memset(cg, 0, sizeof(*cg));
+    s->cgroup_rc = ext > X_CG_RC ? (int)x[X_CG_RC] : 2;
+    cg->ready = (int)x[X_CG_READY];
+    cg->interval_s = (double)x[X_CG_INTERVAL_US] / 1e6;
+    unpack_name(x + X_CG_PATH, cg->path, CGROUP_PATH_MAX);
+    cg->mem_current_kib = (long)x[X_CG_MEM_CURRENT];   cg->mem_max_kib = (long)x[X_CG_MEM_MAX];
+    cg->mem_high_kib = (long)x[X_CG_MEM_HIGH];         cg->swap_current_kib = (long)x[X_CG_SWAP_CURRENT];
+    cg->swap_max_kib = (long)x[X_CG_SWAP_MAX];         cg->anon_kib = (long)x[X_CG_ANON];
+    cg->file_kib = (long)x[X_CG_FILE];                 cg->shmem_kib = (long)x[X_CG_SHMEM];
+    cg->kernel_kib = (long)x[X_CG_KERNEL];             cg->slab_kib = (long)x[X_CG_SLAB];
+    cg->sreclaimable_kib = (long)x[X_CG_SRECLAIM];     cg->kernel_stack_kib = (long)x[X_CG_KSTACK];
+    cg->pagetables_kib = (long)x[X_CG_PAGETABLES];     cg->inactive_file_kib = (long)x[X_CG_INACTIVE_FILE];
+    cg->file_mapped_kib = (long)x[X_CG_FILE_MAPPED];   cg->file_dirty_kib = (long)x[X_CG_FILE_DIRTY];
+    cg->file_writeback_kib = (long)x[X_CG_FILE_WRITEBACK];
+    cg->usage_usec = (unsigned long long)x[X_CG_USAGE_USEC];
+    cg->throttled_usec = (unsigned long long)x[X_CG_THROTTLED_USEC];
+    cg->nr_periods = (unsigned long long)x[X_CG_NR_PERIODS];
+    cg->nr_throttled = (unsigned long long)x[X_CG_NR_THROTTLED];
+    cg->cpu = (double)x[X_CG_CPU] / Q_CORE;                  cg->cpu_user = (double)x[X_CG_CPU_USER] / Q_CORE;
+    cg->cpu_system = (double)x[X_CG_CPU_SYSTEM] / Q_CORE;    cg->cpu_quota = (double)x[X_CG_CPU_QUOTA] / Q_CORE;
+    cg->throttled_ratio = (double)x[X_CG_THROTTLED_RATIO] / Q_RATIO;
+    cg->throttled_ms_ps = (double)x[X_CG_THROTTLED_MS_PS] / Q_RATE;
+    int nch = (int)x[X_CG_NCHILDREN];
+    cg->nchildren = (nch >= 0 && nch <= CGROUP_CHILD_MAX) ? nch : 0;
+    cg->omitted_children = (int)x[X_CG_OMITTED_CHILDREN];
+    for (int i = 0; i < cg->nchildren; ++i) {
+        CgroupChild *c = &cg->child[i];
+        const int64_t *xc = x + X_CG_CHILD + (size_t)i * XC_COUNT;
+        unpack_name(xc + XC_NAME, c->name, CGROUP_NAME_MAX);
+        c->ready = (int)xc[XC_READY];
+        c->mem_kib = (long)xc[XC_MEM_KIB];
+        c->cpu = (double)xc[XC_CPU] / Q_CORE;
+    }
+
+    IrqStats *iq = &s->irq;
+    s->irq_rc = ext > X_IRQ_RC ? (int)x[X_IRQ_RC] : 2;
+    iq->ready = (int)x[X_IRQ_READY];
+    iq->interval_s = (double)x[X_IRQ_INTERVAL_US] / 1e6;
+    iq->ncpus = (int)x[X_IRQ_NCPUS];
+    iq->irq_ps = (double)x[X_IRQ_PS] / Q_RATE;
+    iq->softirq_ps = (double)x[X_SOFTIRQ_PS] / Q_RATE;
+    int nhot = (int)x[X_IRQ_NHOT];
+    iq->nhot = (nhot >= 0 && nhot <= IRQ_HOT_MAX) ? nhot : 0;
+    for (int i = 0; i < iq->nhot; ++i) {
+        IrqHotCore *h = &iq->hot[i];
+        const int64_t *xh = x + X_IRQ_HOT + (size_t)i * XH_COUNT;
+        h->cpu = (int)xh[XH_CPU];
+        h->irq_ps = (double)xh[XH_IRQ_PS] / Q_RATE;
+        h->softirq_ps = (double)xh[XH_SOFTIRQ_PS] / Q_RATE;
+        int nsrc = (int)xh[XH_NSRC];
+        h->nsrc = (nsrc >= 0 && nsrc <= IRQ_SRC_MAX) ? nsrc : 0;
+        for (int k = 0; k < h->nsrc; ++k) {
+            const int64_t *xs = xh + XH_SRC + (size_t)k * XS_COUNT;
+            unpack_name(xs + XS_NAME, h->src[k].name, IRQ_NAME_MAX);
+            h->src[k].softirq = (int)xs[XS_SOFTIRQ];
+            h->src[k].rate = (double)xs[XS_RATE] / Q_RATE;
+        }
+    }
+    return 0;
+}
+
+// ---------- Vector de campos sin codificar ----------
+size_t record_fields(int cores) {
+    return cores > 0 ? rec_nfields(cores, X_COUNT) : 0;
+}
+
+void record_pack(const Snapshot *snap, int cores, int64_t *f) {
+    snap_to_fields(snap, cores, f);
+}
+
+int record_unpack(const int64_t *f, int cores, Snapshot *snap) {
+    return fields_to_snap(f, cores, X_COUNT, snap);
+}
+
+// ---------- Varints ----------
+// Peor caso de un varint de 64 bits: 10 bytes
+#define VARINT_MAX 10
+
+static size_t put_uvarint(unsigned char *p, uint64_t v) {
+    size_t n = 0;
+    while (v >= 0x80) { p[n++] = (unsigned char)(v | 0x80); v >>= 7; }
+    p[n++] = (unsigned char)v;
+    return n;
+}
+
+// Devuelve 0 si OK, 1 si el buffer se acaba o el varint es inválido
+static int get_uvarint(const unsigned char **pp, const unsigned char *end, uint64_t *out) {
+    const unsigned char *p = *pp;
+    uint64_t v = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        if (p >= end) return 1;
+        unsigned char b = *p++;
+        v |= (uint64_t)(b & 0x7F) << shift;
+        if (!(b & 0x80)) { *pp = p; *out = v; return 0; }
+    }
+    return 1;
+}
+
+static uint64_t zigzag(int64_t v)   { return ((uint64_t)v << 1) ^ (uint64_t)(v >> 63); }
+static int64_t  unzigzag(uint64_t u) { return (int64_t)(u >> 1) ^ -(int64_t)(u & 1); }
+
+// Token = (zigzag(v) << 1) para un valor, (racha << 1) | 1 para 'racha' ceros.
+// Con el bit de marca, zigzag(v) << 1 ocupa hasta 65 bits (p. ej. un nombre
+// empaquetado con 8 caracteres): el varint lleva ese bit extra en su décimo
+// byte, así los tokens de menos de 64 bits se codifican igual que antes.
+static size_t put_token(unsigned char *p, uint64_t payload, unsigned mark) {
+    uint64_t lo = (payload << 1) | mark;
+    unsigned hi = (unsigned)(payload >> 63);
+    size_t n = 0;
+    while (hi || lo >= 0x80) {
+        p[n++] = (unsigned char)(lo | 0x80);
+        lo = (lo >> 7) | ((uint64_t)hi << 57);
+        hi = 0;
+    }
+    p[n++] = (unsigned char)lo;
+    return n;
+}
+
+// Devuelve 0 si OK, 1 si el buffer se acaba o el token es inválido
+static int get_token(const unsigned char **pp, const unsigned char *end, uint64_t *payload, unsigned *mark) {
+    const unsigned char *p = *pp;
+    uint64_t lo = 0;
+    unsigned hi = 0;
+    for (int shift = 0; shift < 70; shift += 7) {
+        if (p >= end) return 1;
+        unsigned char b = *p++;
+        lo |= (uint64_t)(b & 0x7F) << shift;
+        if (shift == 63) hi = (b >> 1) & 1u;
+        if (!(b & 0x80)) {
+            *pp = p;
+            *mark = (unsigned)(lo & 1u);
+            *payload = (lo >> 1) | ((uint64_t)hi << 63);
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static size_t encode_tokens(const int64_t *v, size_t n, unsigned char *out) {
+    size_t len = 0;
+    for (size_t i = 0; i < n;) {
+        if (v[i] == 0) {
+            size_t run = 1;
+            while (i + run < n && v[i + run] == 0) run++;
+            len += put_token(out + len, (uint64_t)run, 1u);
+            i += run;
+        } else {
+            len += put_token(out + len, zigzag(v[i]), 0u);
+            i++;
+        }
+    }
+    return len;
+}
+
+// 'delta' = 1 suma sobre 'v'; 0 lo sobrescribe. Devuelve 0 si OK.
+static int decode_tokens(const unsigned char *p, const unsigned char *end, int64_t *v, size_t n, int delta) {
+    size_t i = 0;
+    while (i < n) {
+        uint64_t t;
+        unsigned mark;
+        if (get_token(&p, end, &t, &mark) != 0) return 1;
+        if (mark) {
+            uint64_t run = t;
+            if (run == 0 || run > n - i) return 1;
+            if (!delta) memset(v + i, 0, (size_t)run * sizeof(*v));
+            i += (size_t)run;
+        } else {
+            int64_t x = unzigzag(t);
+            v[i] = delta ? (int64_t)((uint64_t)v[i] + (uint64_t)x) : x;
+            i++;
+        }
+    }
+    return p == end ? 0 : 1;
+}
+
+// ==================== Grabación ====================
+
+struct Recorder {
+    int      fd;
+    int      cores;
+    size_t   nfields;
+    int64_t *prev;        // última muestra escrita
+    int64_t *cur;         // muestra en curso / diferencias
+    unsigned char *buf;   // registro completo (peor caso)
+    unsigned long long samples;
+    unsigned long long bytes;
+    int      failed;
+};
+
+static int write_all(int fd, const unsigned char *p, size_t n) {
+    while (n > 0) {
+        ssize_t w = write(fd, p, n);
+        if (w < 0) {
+            if (errno == EINTR) continue;
+            return 2;
+        }
+        p += w;
+        n -= (size_t)w;
+    }
+    return 0;
+}
+
+static size_t put_string(unsigned char *p, const char *s) {
+    size_t n = strnlen(s, 255);
+    size_t len = put_uvarint(p, n);
+    memcpy(p + len, s, n);
+    return len + n;
+}
+
+Recorder *recorder_open(const char *path, const CPUInfo *info, int cores, int interval_ms) {
+    if (!path || !info || cores <= 0) { errno = EINVAL; return NULL; }
+    Recorder *r = calloc(1, sizeof(*r));
+    if (!r) return NULL;
+    r->cores   = cores;
+    r->nfields = rec_nfields(cores, X_COUNT);
+    r->prev = calloc(r->nfields, sizeof(int64_t));
+    r->cur  = calloc(r->nfields, sizeof(int64_t));
+    // tipo + largo + nº de campos + un token por campo
+    r->buf  = malloc(1 + 3 * VARINT_MAX + r->nfields * VARINT_MAX);
+    r->fd   = open(path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (!r->prev || !r->cur || !r->buf || r->fd < 0) {
+        int err = errno;
+        recorder_close(r);
+        errno = err;
+        return NULL;
+    }
+
+    unsigned char hdr[8 + 7 * VARINT_MAX + 3 * (VARINT_MAX + 255)];
+    size_t len = sizeof(k_magic);
+    memcpy(hdr, k_magic, sizeof(k_magic));
+    len += put_uvarint(hdr + len, REC_VERSION);
+    len += put_uvarint(hdr + len, (uint64_t)cores);
+    len += put_uvarint(hdr + len, (uint64_t)(interval_ms > 0 ? interval_ms : 0));
+    len += put_uvarint(hdr + len, REC_KEYFRAME_EVERY);
+    len += put_uvarint(hdr + len, (uint64_t)(info->cores_config > 0 ? info->cores_config : 0));
+    len += put_uvarint(hdr + len, X_COUNT);
+    len += put_string(hdr + len, info->model);
+    len += put_string(hdr + len, info->hardware);
+    len += put_string(hdr + len, info->arch);
+    if (write_all(r->fd, hdr, len) != 0) {
+        int err = errno;
+        recorder_close(r);
+        errno = err;
+        return NULL;
+    }
+    r->bytes = len;
+    return r;
+}
+
+int recorder_write(Recorder *r, const Snapshot *snap) {
+    if (!r || !snap) return 1;
+    if (r->failed) return 2;
+
+    int key = (r->samples % REC_KEYFRAME_EVERY) == 0;
+    snap_to_fields(snap, r->cores, r->cur);
+
+    // Payload a partir de buf + 1 + VARINT_MAX; después se antepone tipo + largo
+    unsigned char *payload = r->buf + 1 + VARINT_MAX;
+    size_t plen = 0;
+    if (key) {
+        plen += put_uvarint(payload, r->nfields);
+        plen += encode_tokens(r->cur, r->nfields, payload + plen);
+    } else {
+        // prev pasa a contener la diferencia y luego se restaura con cur
+        // (en aritmética sin signo: los nombres empaquetados pueden desbordar)
+        for (size_t i = 0; i < r->nfields; ++i)
+            r->prev[i] = (int64_t)((uint64_t)r->cur[i] - (uint64_t)r->prev[i]);
+        plen += encode_tokens(r->prev, r->nfields, payload);
+    }
+    memcpy(r->prev, r->cur, r->nfields * sizeof(int64_t));
+
+    unsigned char head[1 + VARINT_MAX];
+    head[0] = key ? REC_TAG_KEY : REC_TAG_DELTA;
+    size_t hlen = 1 + put_uvarint(head + 1, plen);
+    unsigned char *rec = payload - hlen;
+    memcpy(rec, head, hlen);
+
+    if (write_all(r->fd, rec, hlen + plen) != 0) {
+        r->failed = 1;
+        return 2;
+    }
+    r->samples++;
+    r->bytes += hlen + plen;
+    return 0;
+}
+
+int recorder_failed(const Recorder *r) {
+    return r ? r->failed : 1;
+}
+
+unsigned long long recorder_bytes(const Recorder *r) {
+    return r ? r->bytes : 0;
+}
+
+void recorder_close(Recorder *r) {
+    if (!r) return;
+    if (r->fd >= 0) close(r->fd);
+    free(r->prev);
+    free(r->cur);
+    free(r->buf);
+    free(r);
+}
+
+// ==================== Reproducción ====================
+
+typedef struct {
+    size_t    off;        // offset del registro 'K'
+    long long ts_ms;
+} KeyIndex;
+
+struct Player {
+    const unsigned char *map;
+    size_t    size;
+    size_t    data_off;   // primer registro
+    int       cores;
+    int       interval_ms;
+    size_t    nfields;    // campos por muestra en el archivo
+    size_t    ext;        // de ellos, campos extendidos
+
+    KeyIndex *keys;
+    size_t    nkeys;
+
+    int64_t  *cur;        // campos de la muestra actual
+    size_t    pos;        // offset del registro actual
+    size_t    next;       // offset del siguiente registro (== size si no hay)
+    long long next_ts;    // ts del siguiente (-1 si no hay); se decodifica por adelantado
+    int64_t  *peek;       // campos del siguiente (cur + delta)
+    size_t    after;      // offset del registro posterior al siguiente
+    Snapshot  snap;
+    long long last_ms;
+};
+
+// Lee la cabecera de un registro en 'off'. Devuelve 0 si el registro está completo.
+static int rec_header(const Player *p, size_t off, int *tag, const unsigned char **pay, size_t *plen) {
+    if (off >= p->size) return 1;
+    const unsigned char *q = p->map + off;
+    const unsigned char *end = p->map + p->size;
+    *tag = *q++;
+    if (*tag != REC_TAG_KEY && *tag != REC_TAG_DELTA) return 1;
+    uint64_t len;
+    if (get_uvarint(&q, end, &len) != 0 || len > (uint64_t)(end - q)) return 1;
+    *pay = q;
+    *plen = (size_t)len;
+    return 0;
+}
+
+// Decodifica el registro en 'off' sobre 'v' (delta se aplica sobre lo que haya).
+// Devuelve el offset del siguiente registro, o 0 si está corrupto/truncado.
+static size_t rec_decode(const Player *p, size_t off, int64_t *v) {
+    int tag;
+    const unsigned char *pay;
+    size_t plen;
+    if (rec_header(p, off, &tag, &pay, &plen) != 0) return 0;
+    const unsigned char *end = pay + plen;
+    if (tag == REC_TAG_KEY) {
+        uint64_t n;
+        if (get_uvarint(&pay, end, &n) != 0 || n != p->nfields) return 0;
+        if (decode_tokens(pay, end, v, p->nfields, 0) != 0) return 0;
+    } else {
+        if (decode_tokens(pay, end, v, p->nfields, 1) != 0) return 0;
+    }
+    return (size_t)(end - p->map);
+}
+
+// Prepara 'peek' con la muestra siguiente a la actual
+static void player_prefetch(Player *p) {
+    p->next_ts = -1;
+    if (p->next >= p->size) return;
+    memcpy(p->peek, p->cur, p->nfields * sizeof(int64_t));
+    p->after = rec_decode(p, p->next, p->peek);
+    if (p->after == 0) { p->next = p->size; return; }
+    p->next_ts = p->peek[F_TS_MS];
+}
+
+static int get_string(const unsigned char **q, const unsigned char *end, char *out, size_t cap) {
+    uint64_t n;
+    if (get_uvarint(q, end, &n) != 0 || n > (uint64_t)(end - *q)) return 1;
+    size_t k = (size_t)n < cap - 1 ? (size_t)n : cap - 1;
+    memcpy(out, *q, k);
+    out[k] = '\0';
+    *q += n;
+    return 0;
+}
+
+Player *player_open(const char *path, CPUInfo *info) {
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return NULL;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < (off_t)sizeof(k_magic)) { close(fd); errno = EINVAL; return NULL; }
+    void *map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) return NULL;
+    madvise(map, (size_t)st.st_size, MADV_SEQUENTIAL);
+
+    Player *p = calloc(1, sizeof(*p));
+    if (!p) { munmap(map, (size_t)st.st_size); return NULL; }
+    p->map  = map;
+    p->size = (size_t)st.st_size;
+    snapshot_init(&p->snap);
+
+    // Cabecera
+    const unsigned char *q = p->map, *end = p->map + p->size;
+    uint64_t ver, cores, interval, kevery, cfg, ext = 0;
+    CPUInfo ci;
+    memset(&ci, 0, sizeof(ci));
+    if (memcmp(q, k_magic, sizeof(k_magic)) != 0) goto bad;
+    q += sizeof(k_magic);
+    if (get_uvarint(&q, end, &ver) || ver == 0 || ver > REC_VERSION ||
+        get_uvarint(&q, end, &cores) || cores == 0 || cores > 65536 ||
+        get_uvarint(&q, end, &interval) || get_uvarint(&q, end, &kevery) ||
+        get_uvarint(&q, end, &cfg) ||
+        (ver >= 2 && (get_uvarint(&q, end, &ext) || ext > 4096)) ||
+        get_string(&q, end, ci.model, sizeof(ci.model)) ||
+        get_string(&q, end, ci.hardware, sizeof(ci.hardware)) ||
+        get_string(&q, end, ci.arch, sizeof(ci.arch))) goto bad;
+    ci.cores_config = (int)cfg;
+    ci.cores_online = (int)cfg;
+    if (info) *info = ci;
+
+    p->cores    = (int)cores;
+    p->interval_ms = interval <= 3600000u ? (int)interval : 0;
+    p->ext      = (size_t)ext;
+    p->nfields  = rec_nfields(p->cores, p->ext);
+    p->data_off = (size_t)(q - p->map);
+    // Al menos todos los campos que conocemos: los que el archivo no trae
+    // (grabación más vieja) se quedan en 0 porque nunca se decodifican.
+    size_t alloc = rec_nfields(p->cores, ext > X_COUNT ? (size_t)ext : X_COUNT);
+    p->cur  = calloc(alloc, sizeof(int64_t));
+    p->peek = calloc(alloc, sizeof(int64_t));
+    if (!p->cur || !p->peek) goto bad;
+
+    // Índice de keyframes: se salta de registro en registro sin decodificar
+    // los deltas; de cada keyframe solo se leen seq y ts (los dos primeros campos).
+    size_t capk = 64;
+    p->keys = malloc(capk * sizeof(*p->keys));
+    if (!p->keys) goto bad;
+    size_t off = p->data_off, last_key = 0;
+    for (;;) {
+        int tag;
+        const unsigned char *pay;
+        size_t plen;
+        if (rec_header(p, off, &tag, &pay, &plen) != 0) break;
+        if (tag == REC_TAG_KEY) {
+            int64_t head[2];
+            uint64_t n, t0, t1;
+            const unsigned char *r = pay, *rend = pay + plen;
+            if (get_uvarint(&r, rend, &n) || n != p->nfields ||
+                get_uvarint(&r, rend, &t0) || (t0 & 1u) ||
+                get_uvarint(&r, rend, &t1) || (t1 & 1u)) break;
+            head[0] = unzigzag(t0 >> 1);
+            head[1] = unzigzag(t1 >> 1);
+            if (p->nkeys == capk) {
+                KeyIndex *nk = realloc(p->keys, 2 * capk * sizeof(*nk));
+                if (!nk) break;
+                p->keys = nk;
+                capk *= 2;
+            }
+            p->keys[p->nkeys].off   = off;
+            p->keys[p->nkeys].ts_ms = head[1];
+            p->nkeys++;
+            last_key = off;
+        } else if (p->nkeys == 0) {
+            break;   // un delta sin keyframe previo: archivo inválido
+        }
+        off = (size_t)(pay + plen - p->map);
+    }
+    if (p->nkeys == 0) goto bad;
+
+    // Último ts: se decodifica desde el último keyframe hasta el final
+    p->pos = last_key;
+    p->next = rec_decode(p, last_key, p->cur);
+    if (p->next == 0) goto bad;
+    p->last_ms = p->cur[F_TS_MS];
+    for (;;) {
+        size_t n = rec_decode(p, p->next, p->cur);
+        if (n == 0) break;
+        p->next = n;
+        p->last_ms = p->cur[F_TS_MS];
+    }
+
+    player_seek_ms(p, p->keys[0].ts_ms);
+    return p;
+
+bad:
+    player_close(p);
+    errno = EINVAL;
+    return NULL;
+}
+
+// Posiciona en el registro 'off' ya decodificado en cur
+static void player_settle(Player *p, size_t off, size_t next) {
+    p->pos = off;
+    p->next = next;
+    fields_to_snap(p->cur, p->cores, p->ext, &p->snap);
+    player_prefetch(p);
+}
+
+void player_seek_ms(Player *p, long long ms) {
+    if (!p || p->nkeys == 0) return;
+    // Último keyframe con ts <= ms (búsqueda binaria)
+    size_t lo = 0, hi = p->nkeys;
+    while (hi - lo > 1) {
+        size_t mid = (lo + hi) / 2;
+        if (p->keys[mid].ts_ms <= ms) lo = mid; else hi = mid;
+    }
+    size_t off = p->keys[lo].off;
+    size_t next = rec_decode(p, off, p->cur);
+    if (next == 0) return;
+    player_settle(p, off, next);
+    while (p->next_ts >= 0 && p->next_ts <= ms) player_next(p);
+}
+
+int player_next(Player *p) {
+    if (!p || p->next_ts < 0) return 1;
+    // La siguiente ya está decodificada en 'peek': basta intercambiar
+    int64_t *t = p->cur; p->cur = p->peek; p->peek = t;
+    player_settle(p, p->next, p->after);
+    return 0;
+}
+
+int player_cores(const Player *p)       { return p ? p->cores : 0; }
+int player_interval_ms(const Player *p) { return p ? p->interval_ms : 0; }
+
+const Snapshot *player_snapshot(const Player *p) {
+    return p ? &p->snap : NULL;
+}
+
+long long player_time_ms(const Player *p)  { return p ? (long long)p->cur[F_TS_MS] : 0; }
+long long player_next_ms(const Player *p)  { return p ? p->next_ts : -1; }
+long long player_first_ms(const Player *p) { return (p && p->nkeys) ? p->keys[0].ts_ms : 0; }
+long long player_last_ms(const Player *p)  { return p ? p->last_ms : 0; }
+
+void player_close(Player *p) {
+    if (!p) return;
+    if (p->map) munmap((void *)p->map, p->size);
+    free(p->keys);
+    free(p->cur);
+    free(p->peek);
+    snapshot_free(&p->snap);
+    free(p);
+}
@@ -0,0 +1,229 @@
+#include "sampler.h"
+#include <errno.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+// ---------- Snapshot ----------
+void snapshot_init(Snapshot *snap) {
+    if (!snap) return;
+    memset(snap, 0, sizeof(*snap));
+    snap->mem_rc = 1;
+    snap->cpu_rc = 1;
+    snap->disk_rc = 1;
+    snap->net_rc = 1;
+    snap->psi_rc = 1;
+    snap->procs_rc = 1;
+    snap->thermal_rc = 1;
+    snap->cgroup_rc = 1;
+    snap->irq_rc = 1;
+    cpu_usage_init(&snap->cpu);
+}
+
+void snapshot_free(Snapshot *snap) {
+    if (!snap) return;
+    cpu_usage_free(&snap->cpu);
+    memset(snap, 0, sizeof(*snap));
+}
+
+// ---------- Triple buffer ----------
+// slots[back]  : solo lo toca el escritor (hilo de muestreo)
+// slots[front] : solo lo toca el lector (UI)
+// mid          : el tercer slot, intercambiado atómicamente. TB_FRESH indica que
+//                contiene una muestra que el lector aún no ha tomado.
+// Cada slot conserva sus propios arreglos por core, así que en régimen
+// estable publicar no copia ni reserva memoria.
+#define TB_INDEX 0x3u
+#define TB_FRESH 0x4u
+
+struct Sampler {
+    Snapshot      slots[3];
+    unsigned      back;          // propiedad del escritor
+    unsigned      front;         // propiedad del lector
+    int           have_front;    // el lector ya tomó al menos una muestra
+    atomic_uint   mid;
+
+    CPUSampler   *cpu;
+    DiskSampler  *disk;          // NULL si no hay /proc/diskstats (no es fatal)
+    NetSampler   *net;           // NULL si no hay /proc/net/dev (no es fatal)
+    PsiSampler   *psi;           // NULL si el kernel no expone PSI (no es fatal)
+    ProcSampler  *procs;         // NULL si no se pudo abrir /proc (no es fatal)
+    ThermalSampler *thermal;     // NULL sin cpufreq ni zonas térmicas (no es fatal)
+    CgroupSampler *cgroup;       // NULL fuera del modo cgroup
+    IrqSampler   *irq;           // NULL sin /proc/interrupts (no es fatal)
+    int           interval_ms;
+    SamplerHook   hooks[SAMPLER_MAX_HOOKS];
+    int           nhooks;
+    unsigned long long seq;
+
+    int           notify_fd;     // eventfd: "hay muestra nueva"
+    int           stop_fd;       // eventfd: "termina"
+    int           timer_fd;      // timerfd periódico (CLOCK_MONOTONIC, absoluto)
+    unsigned long long overruns; // periodos perdidos por retraso
+    pthread_t     thread;
+};
+
+static void take_sample(Sampler *s) {
+    Snapshot *snap = &s->slots[s->back];
+    snap->mem_rc = mem_read_stats(&snap->mem);
+    snap->cgroup_rc = s->cgroup ? cgroup_sampler_sample(s->cgroup, &snap->cgroup) : 2;
+    if (snap->mem_rc == 0 && snap->cgroup_rc == 0) cgroup_apply_mem(&snap->cgroup, &snap->mem);
+    snap->cpu_rc = cpu_sampler_sample(s->cpu, &snap->cpu);
+    snap->disk_rc = s->disk ? disk_sampler_sample(s->disk, &snap->disk) : 2;
+    snap->net_rc  = s->net ? net_sampler_sample(s->net, &snap->net) : 2;
+    snap->psi_rc  = s->psi ? psi_sampler_sample(s->psi, &snap->psi) : 2;
+    snap->procs_rc = s->procs ? proc_sampler_sample(s->procs, &snap->procs) : 2;
+    snap->thermal_rc = s->thermal ? thermal_sampler_sample(s->thermal, &snap->thermal) : 2;
+    snap->irq_rc = s->irq ? irq_sampler_sample(s->irq, &snap->irq) : 2;
+    clock_gettime(CLOCK_REALTIME, &snap->ts);
+    snap->seq = ++s->seq;
+    for (int i = 0; i < s->nhooks; ++i) s->hooks[i].fn(snap, s->hooks[i].arg);
+
+    // Publica: el slot recién escrito pasa a 'mid' y recuperamos el anterior.
+    unsigned old = atomic_exchange_explicit(&s->mid, s->back | TB_FRESH, memory_order_acq_rel);
+    s->back = old & TB_INDEX;
+
+    uint64_t one = 1;
+    ssize_t w = write(s->notify_fd, &one, sizeof(one));
+    (void)w; // si el contador satura, el lector igual verá la muestra
+}
+
+static void *sampler_main(void *arg) {
+    Sampler *s = arg;
+    struct pollfd pfds[2] = {
+        { .fd = s->timer_fd, .events = POLLIN, .revents = 0 },
+        { .fd = s->stop_fd,  .events = POLLIN, .revents = 0 },
+    };
+
+    take_sample(s);
+    for (;;) {
+        if (poll(pfds, 2, -1) < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        if (pfds[1].revents & POLLIN) break;   // stop solicitado
+        if (pfds[0].revents & POLLIN) {
+            // Nº de periodos vencidos desde la última lectura. Si es > 1 nos
+            // atrasamos (p. ej. suspensión): se toma UNA muestra y se sigue en
+            // la rejilla original, sin ráfagas.
+            uint64_t expirations = 0;
+            if (read(s->timer_fd, &expirations, sizeof(expirations)) == (ssize_t)sizeof(expirations)) {
+                if (expirations > 1) s->overruns += expirations - 1;
+                take_sample(s);
+            }
+        }
+    }
+    return NULL;
+}
+
+// Arma el timerfd periódico sobre deadlines absolutos: el kernel mantiene la
+// rejilla inicio + k·periodo, así el coste de cada muestra no acumula deriva.
+static int arm_timer(int fd, int interval_ms) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    struct itimerspec its;
+    its.it_interval.tv_sec  = interval_ms / 1000;
+    its.it_interval.tv_nsec = (long)(interval_ms % 1000) * 1000000L;
+    its.it_value.tv_sec  = now.tv_sec + its.it_interval.tv_sec;
+    its.it_value.tv_nsec = now.tv_nsec + its.it_interval.tv_nsec;
+    if (its.it_value.tv_nsec >= 1000000000L) { its.it_value.tv_sec++; its.it_value.tv_nsec -= 1000000000L; }
+    return timerfd_settime(fd, TFD_TIMER_ABSTIME, &its, NULL);
+}
+
+Sampler *sampler_start(int interval_ms, const SamplerHook *hooks, int nhooks) {
+    if (interval_ms <= 0 || nhooks < 0 || nhooks > SAMPLER_MAX_HOOKS || (nhooks > 0 && !hooks)) return NULL;
+    Sampler *s = calloc(1, sizeof(*s));
+    if (!s) return NULL;
+    for (int i = 0; i < nhooks; ++i) {
+        if (hooks[i].fn) s->hooks[s->nhooks++] = hooks[i];
+    }
+    for (int i = 0; i < 3; ++i) snapshot_init(&s->slots[i]);
+    s->back = 0;
+    s->front = 1;
+    atomic_init(&s->mid, 2u);
+    s->interval_ms = interval_ms;
+    s->notify_fd = -1;
+    s->stop_fd = -1;
+    s->timer_fd = -1;
+
+    s->cpu = cpu_sampler_create();
+    s->disk = disk_sampler_create();
+    s->net  = net_sampler_create();
+    s->psi  = psi_sampler_create();
+    // thermal antes que procs: sus descriptores se descuentan del presupuesto de procs
+    s->thermal = thermal_sampler_create();
+    s->procs = proc_sampler_create();
+    s->cgroup = cgroup_sampler_create();
+    s->irq = irq_sampler_create();
+    s->notify_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    s->stop_fd   = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    s->timer_fd  = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC | TFD_NONBLOCK);
+    if (!s->cpu || s->notify_fd < 0 || s->stop_fd < 0 || s->timer_fd < 0 ||
+        arm_timer(s->timer_fd, interval_ms) != 0 ||
+        pthread_create(&s->thread, NULL, sampler_main, s) != 0) {
+        if (s->notify_fd >= 0) close(s->notify_fd);
+        if (s->stop_fd >= 0) close(s->stop_fd);
+        if (s->timer_fd >= 0) close(s->timer_fd);
+        cpu_sampler_destroy(s->cpu);
+        disk_sampler_destroy(s->disk);
+        net_sampler_destroy(s->net);
+        psi_sampler_destroy(s->psi);
+        proc_sampler_destroy(s->procs);
+        thermal_sampler_destroy(s->thermal);
+        cgroup_sampler_destroy(s->cgroup);
+        irq_sampler_destroy(s->irq);
+        for (int i = 0; i < 3; ++i) snapshot_free(&s->slots[i]);
+        free(s);
+        return NULL;
+    }
+    return s;
+}
+
+const Snapshot *sampler_acquire(Sampler *s) {
+    if (!s) return NULL;
+    if (atomic_load_explicit(&s->mid, memory_order_relaxed) & TB_FRESH) {
+        unsigned old = atomic_exchange_explicit(&s->mid, s->front, memory_order_acq_rel);
+        s->front = old & TB_INDEX;
+        s->have_front = 1;
+    }
+    return s->have_front ? &s->slots[s->front] : NULL;
+}
+
+int sampler_notify_fd(const Sampler *s) {
+    return s ? s->notify_fd : -1;
+}
+
+void sampler_clear_notify(Sampler *s) {
+    if (!s) return;
+    uint64_t v;
+    ssize_t r = read(s->notify_fd, &v, sizeof(v));
+    (void)r; // EAGAIN = no había nada pendiente
+}
+
+void sampler_stop(Sampler *s) {
+    if (!s) return;
+    uint64_t one = 1;
+    ssize_t w = write(s->stop_fd, &one, sizeof(one));
+    (void)w;
+    pthread_join(s->thread, NULL);
+
+    close(s->notify_fd);
+    close(s->stop_fd);
+    close(s->timer_fd);
+    cpu_sampler_destroy(s->cpu);
+    disk_sampler_destroy(s->disk);
+    net_sampler_destroy(s->net);
+    psi_sampler_destroy(s->psi);
+    proc_sampler_destroy(s->procs);
+    thermal_sampler_destroy(s->thermal);
+    cgroup_sampler_destroy(s->cgroup);
+    irq_sampler_destroy(s->irq);
+    for (int i = 0; i < 3; ++i) snapshot_free(&s->slots[i]);
+    free(s);
+}
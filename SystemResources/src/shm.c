@@ -0,0 +1,318 @@
+#include "shm.h"
+#include "record.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <sched.h>
+#include <signal.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static const unsigned char k_magic[8] = { 'R', 'S', 'Y', 'S', 'S', 'H', 'M', 0x01 };
+
+#define SHM_MAX_CORES   4096
+#define SHM_READ_TRIES  1000     // copias repetidas antes de rendirse (publicador muerto a media escritura)
+
+// El seqlock se comparte entre procesos: tiene que ser atómico sin candados
+_Static_assert(ATOMIC_INT_LOCK_FREE == 2, "el seqlock necesita atómicos de 32 bits sin candados");
+
+// Cabecera al inicio del segmento; el anillo empieza en ring_offset().
+// 'magic' se escribe la última: un visor que llegue antes la ve a cero.
+typedef struct {
+    unsigned char    magic[8];
+    uint32_t         header_size;   // sizeof(ShmHeader): detecta binarios incompatibles
+    uint32_t         nfields;       // campos por ranura (record_fields(cores))
+    int32_t          cores;
+    int32_t          interval_ms;
+    int32_t          slots;
+    int32_t          pid;           // publicador
+    CPUInfo          info;
+    _Atomic uint32_t seq;           // seqlock: impar mientras se escribe una ranura
+    uint32_t         pad;
+    uint64_t         count;         // muestras publicadas (protegido por seq)
+} ShmHeader;
+
+struct ShmPublisher {
+    char       name[SHM_NAME_MAX + 2];
+    ShmHeader *hdr;
+    int64_t   *ring;                // [slots][nfields]
+    size_t     map_len;
+};
+
+struct ShmViewer {
+    const ShmHeader *hdr;
+    const int64_t   *ring;
+    size_t           map_len;
+    int64_t         *buf;           // copia validada de una ranura
+};
+
+static size_t ring_offset(void) {
+    return (sizeof(ShmHeader) + 63) & ~(size_t)63;
+}
+
+static size_t segment_bytes(size_t nfields, int slots) {
+    return ring_offset() + (size_t)slots * nfields * sizeof(int64_t);
+}
+
+// "rpi" -> "/rpi". Un solo componente, sin '/' internas. 0 si OK.
+static int make_name(const char *name, char *out, size_t len) {
+    if (!name) return 1;
+    if (*name == '/') name++;
+    size_t n = strlen(name);
+    if (n == 0 || n > SHM_NAME_MAX || strchr(name, '/')) return 1;
+    snprintf(out, len, "/%s", name);
+    return 0;
+}
+
+static int pid_alive(pid_t pid) {
+    return pid > 0 && (kill(pid, 0) == 0 || errno == EPERM);
+}
+
+// Si 'path' existe y lo publica otro proceso vivo, devuelve su PID; si no, 0.
+static pid_t live_owner(const char *path) {
+    int fd = shm_open(path, O_RDONLY, 0);
+    if (fd < 0) return 0;
+    pid_t owner = 0;
+    struct stat st;
+    if (fstat(fd, &st) == 0 && (size_t)st.st_size >= sizeof(ShmHeader)) {
+        const ShmHeader *h = mmap(NULL, sizeof(ShmHeader), PROT_READ, MAP_SHARED, fd, 0);
+        if (h != MAP_FAILED) {
+            if (memcmp(h->magic, k_magic, sizeof(k_magic)) == 0 && h->pid != getpid() && pid_alive(h->pid))
+                owner = h->pid;
+            munmap((void *)h, sizeof(ShmHeader));
+        }
+    }
+    close(fd);
+    return owner;
+}
+
+// ==================== Publicador ====================
+
+ShmPublisher *shm_publisher_open(const char *name, const CPUInfo *info, int cores,
+                                 int interval_ms, int slots, char *err, size_t errlen) {
+    char dummy[8];
+    if (!err || errlen == 0) { err = dummy; errlen = sizeof(dummy); }
+    if (!info || cores < 1 || cores > SHM_MAX_CORES || slots < 1) {
+        snprintf(err, errlen, "argumentos inválidos");
+        return NULL;
+    }
+    ShmPublisher *p = calloc(1, sizeof(*p));
+    if (!p) {
+        snprintf(err, errlen, "sin memoria");
+        return NULL;
+    }
+    if (make_name(name, p->name, sizeof(p->name)) != 0) {
+        snprintf(err, errlen, "nombre inválido: '%s' (sin '/', hasta %d caracteres)", name ? name : "", SHM_NAME_MAX);
+        free(p);
+        return NULL;
+    }
+
+    // Un segmento huérfano (publicador muerto sin limpiar) se reemplaza
+    pid_t owner = live_owner(p->name);
+    if (owner) {
+        snprintf(err, errlen, "'%s' ya lo publica el PID %ld", p->name, (long)owner);
+        free(p);
+        return NULL;
+    }
+    if (shm_unlink(p->name) != 0 && errno != ENOENT) {
+        snprintf(err, errlen, "%s: %s", p->name, strerror(errno));
+        free(p);
+        return NULL;
+    }
+
+    size_t nfields = record_fields(cores);
+    p->map_len = segment_bytes(nfields, slots);
+    int fd = shm_open(p->name, O_RDWR | O_CREAT | O_EXCL, 0644);
+    if (fd < 0) {
+        snprintf(err, errlen, "%s: %s", p->name, strerror(errno));
+        free(p);
+        return NULL;
+    }
+    // fchmod: que la umask no impida adjuntarse a los visores de otros
+    // usuarios. posix_fallocate reserva ya las páginas de tmpfs: sin
+    // espacio se falla aquí y no con SIGBUS al escribir una ranura.
+    int rc = fchmod(fd, 0644);
+    if (rc == 0) rc = posix_fallocate(fd, 0, (off_t)p->map_len);
+    else rc = errno;
+    void *map = MAP_FAILED;
+    if (rc == 0) {
+        map = mmap(NULL, p->map_len, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (map == MAP_FAILED) rc = errno;
+    }
+    close(fd);
+    if (rc != 0) {
+        snprintf(err, errlen, "%s (%zu bytes): %s", p->name, p->map_len, strerror(rc));
+        shm_unlink(p->name);
+        free(p);
+        return NULL;
+    }
+
+    p->hdr  = map;
+    p->ring = (int64_t *)((char *)map + ring_offset());
+    p->hdr->header_size = (uint32_t)sizeof(ShmHeader);
+    p->hdr->nfields     = (uint32_t)nfields;
+    p->hdr->cores       = cores;
+    p->hdr->interval_ms = interval_ms;
+    p->hdr->slots       = slots;
+    p->hdr->pid         = (int32_t)getpid();
+    p->hdr->info        = *info;
+    p->hdr->count       = 0;
+    atomic_store_explicit(&p->hdr->seq, 0, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    memcpy(p->hdr->magic, k_magic, sizeof(k_magic));
+    return p;
+}
+
+void shm_publisher_hook(const Snapshot *snap, void *arg) {
+    ShmPublisher *p = arg;
+    if (!p || !snap) return;
+    ShmHeader *h = p->hdr;
+    uint64_t n = h->count;
+    int64_t *slot = p->ring + (size_t)(n % (uint64_t)h->slots) * h->nfields;
+
+    // Seqlock: impar antes de tocar la ranura, par (+2) cuando está completa
+    uint32_t s = atomic_load_explicit(&h->seq, memory_order_relaxed);
+    atomic_store_explicit(&h->seq, s + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    record_pack(snap, h->cores, slot);
+    h->count = n + 1;
+    atomic_store_explicit(&h->seq, s + 2, memory_order_release);
+}
+
+void shm_publisher_close(ShmPublisher *p) {
+    if (!p) return;
+    munmap(p->hdr, p->map_len);
+    shm_unlink(p->name);
+    free(p);
+}
+
+// ==================== Visor ====================
+
+ShmViewer *shm_viewer_open(const char *name, char *err, size_t errlen) {
+    char dummy[8];
+    if (!err || errlen == 0) { err = dummy; errlen = sizeof(dummy); }
+    char path[SHM_NAME_MAX + 2];
+    if (make_name(name, path, sizeof(path)) != 0) {
+        snprintf(err, errlen, "nombre inválido: '%s' (sin '/', hasta %d caracteres)", name ? name : "", SHM_NAME_MAX);
+        return NULL;
+    }
+    int fd = shm_open(path, O_RDONLY, 0);
+    if (fd < 0) {
+        snprintf(err, errlen, errno == ENOENT ? "%s: no existe (¿hay un --publish en marcha?)" : "%s: %s",
+                 path, strerror(errno));
+        return NULL;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < ring_offset()) {
+        snprintf(err, errlen, "%s: segmento vacío o inaccesible", path);
+        close(fd);
+        return NULL;
+    }
+    size_t len = (size_t)st.st_size;
+    const void *map = mmap(NULL, len, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        snprintf(err, errlen, "%s: %s", path, strerror(errno));
+        return NULL;
+    }
+
+    const ShmHeader *h = map;
+    const char *why = NULL;
+    if (memcmp(h->magic, k_magic, sizeof(k_magic)) != 0)
+        why = "no es un segmento de rpi-sysinfo-tui (o el publicador aún arranca)";
+    else if (h->header_size != sizeof(ShmHeader) || h->cores < 1 || h->cores > SHM_MAX_CORES ||
+             h->nfields != record_fields(h->cores) || h->slots < 1)
+        why = "formato incompatible (¿otra versión del publicador?)";
+    else if (segment_bytes(h->nfields, h->slots) > len)
+        why = "segmento truncado";
+    if (why) {
+        snprintf(err, errlen, "%s: %s", path, why);
+        munmap((void *)map, len);
+        return NULL;
+    }
+
+    ShmViewer *v = calloc(1, sizeof(*v));
+    int64_t *buf = malloc(h->nfields * sizeof(int64_t));
+    if (!v || !buf) {
+        snprintf(err, errlen, "sin memoria");
+        free(v);
+        free(buf);
+        munmap((void *)map, len);
+        return NULL;
+    }
+    v->hdr     = h;
+    v->ring    = (const int64_t *)((const char *)map + ring_offset());
+    v->map_len = len;
+    v->buf     = buf;
+    return v;
+}
+
+const CPUInfo *shm_viewer_info(const ShmViewer *v) { return v ? &v->hdr->info : NULL; }
+int  shm_viewer_cores(const ShmViewer *v)       { return v ? v->hdr->cores : 0; }
+int  shm_viewer_interval_ms(const ShmViewer *v) { return v ? v->hdr->interval_ms : 0; }
+int  shm_viewer_slots(const ShmViewer *v)       { return v ? v->hdr->slots : 0; }
+long shm_viewer_pid(const ShmViewer *v)         { return v ? (long)v->hdr->pid : 0; }
+
+int shm_viewer_alive(const ShmViewer *v) {
+    return v && pid_alive((pid_t)v->hdr->pid);
+}
+
+// Lado lector del seqlock: espera a un valor par y lo devuelve
+static uint32_t read_begin(const ShmHeader *h, int *tries) {
+    uint32_t s;
+    while ((s = atomic_load_explicit(&h->seq, memory_order_acquire)) & 1u) {
+        if (++*tries >= SHM_READ_TRIES) break;
+        sched_yield();
+    }
+    return s;
+}
+
+static int read_retry(const ShmHeader *h, uint32_t s) {
+    atomic_thread_fence(memory_order_acquire);
+    return atomic_load_explicit(&h->seq, memory_order_relaxed) != s;
+}
+
+unsigned long long shm_viewer_count(const ShmViewer *v) {
+    if (!v) return 0;
+    uint64_t n = 0;
+    int tries = 0;
+    uint32_t s;
+    do {
+        s = read_begin(v->hdr, &tries);
+        n = *(const volatile uint64_t *)&v->hdr->count;
+    } while (read_retry(v->hdr, s) && ++tries < SHM_READ_TRIES);
+    return (unsigned long long)n;
+}
+
+int shm_viewer_read(ShmViewer *v, unsigned long long idx, Snapshot *snap) {
+    if (!v || !snap) return 1;
+    const ShmHeader *h = v->hdr;
+    size_t bytes = h->nfields * sizeof(int64_t);
+    const int64_t *slot = v->ring + (size_t)(idx % (unsigned long long)h->slots) * h->nfields;
+
+    // Se copia primero y solo se decodifica una copia validada: una ranura a
+    // medio escribir nunca llega a record_unpack()
+    int tries = 0;
+    for (;;) {
+        uint32_t s = read_begin(h, &tries);
+        if (s & 1u) return 1;
+        uint64_t n = *(const volatile uint64_t *)&h->count;
+        if (idx >= n || n - idx > (uint64_t)h->slots) return 1;
+        memcpy(v->buf, slot, bytes);
+        if (!read_retry(h, s)) break;
+        if (++tries >= SHM_READ_TRIES) return 1;
+    }
+    return record_unpack(v->buf, h->cores, snap) == 0 ? 0 : 3;
+}
+
+void shm_viewer_close(ShmViewer *v) {
+    if (!v) return;
+    munmap((void *)v->hdr, v->map_len);
+    free(v->buf);
+    free(v);
+}
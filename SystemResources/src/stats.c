@@ -0,0 +1,164 @@
+#include "stats.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const double k_ewma_tau_s[STATS_EWMA_COUNT] = { 1.0, 5.0, 15.0 };
+
+int stats_window_for(int interval_ms) {
+    if (interval_ms <= 0) interval_ms = 1000;
+    long w = (STATS_WINDOW_S * 1000L + interval_ms - 1) / interval_ms;
+    if (w < STATS_WINDOW_MIN) w = STATS_WINDOW_MIN;
+    if (w > STATS_WINDOW_MAX) w = STATS_WINDOW_MAX;
+    return (int)w;
+}
+
+size_t stats_bytes(int window, int cores) {
+    if (window <= 0 || cores < 0) return 0;
+    size_t n = (size_t)(STATS_SERIES_COUNT + cores);
+    return n * sizeof(StatsMetric) + n * (size_t)window;
+}
+
+int stats_init(Stats *st, int window, int cores) {
+    if (!st || window < STATS_WINDOW_MIN || window > STATS_WINDOW_MAX || cores < 0) return 1;
+    memset(st, 0, sizeof(*st));
+    size_t n = (size_t)(STATS_SERIES_COUNT + cores);
+    // StatsMetric primero: el anillo de bytes va detrás sin problemas de alineación
+    unsigned char *block = calloc(1, stats_bytes(window, cores));
+    if (!block) return 3;
+
+    st->window    = window;
+    st->block_len = (window + STATS_BLOCKS - 1) / STATS_BLOCKS;
+    st->cores     = cores;
+    st->metric    = (StatsMetric *)(void *)block;
+    st->ring      = block + n * sizeof(StatsMetric);
+    pthread_mutex_init(&st->lock, NULL);
+    return 0;
+}
+
+void stats_free(Stats *st) {
+    if (!st || !st->metric) return;
+    pthread_mutex_destroy(&st->lock);
+    free(st->metric);   // un solo bloque: 'ring' apunta dentro de él
+    memset(st, 0, sizeof(*st));
+}
+
+void stats_clear(Stats *st) {
+    if (!st || !st->metric) return;
+    memset(st->metric, 0, (size_t)(STATS_SERIES_COUNT + st->cores) * sizeof(StatsMetric));
+    st->last_seq = 0;
+}
+
+// Una muestra de la métrica 'idx' en el instante 't' (s). O(1): una cubeta
+// entra y, con la ventana llena, la más vieja sale.
+static void metric_push(Stats *st, int idx, double t, double v) {
+    StatsMetric *m = &st->metric[idx];
+    uint8_t *ring = st->ring + (size_t)idx * (size_t)st->window;
+    if (!(v >= 0.0)) v = 0.0;   // también NAN
+    if (v > 1.0) v = 1.0;
+
+    // Medias: el peso de la muestra depende del tiempo transcurrido, así una
+    // muestra perdida (UI atrasada, core apagado un rato) no las distorsiona
+    double dt = t - m->last_t;
+    for (int k = 0; k < STATS_EWMA_COUNT; ++k) {
+        if (m->count == 0 || dt < 0.0) m->ewma[k] = v;
+        else m->ewma[k] += (1.0 - exp(-dt / k_ewma_tau_s[k])) * (v - m->ewma[k]);
+    }
+    m->last_t = t;
+
+    // Histograma de la ventana
+    int b = (int)(v * STATS_BUCKETS);
+    if (b >= STATS_BUCKETS) b = STATS_BUCKETS - 1;
+    if (m->count == st->window) m->hist[ring[m->head]]--;
+    else m->count++;
+    ring[m->head] = (uint8_t)b;
+    m->hist[b]++;
+    m->head = (m->head + 1 == st->window) ? 0 : m->head + 1;
+
+    // Min/max por sub-bloque: al empezar uno se pisa el más viejo
+    if (m->block_n == st->block_len) {
+        m->block = (m->block + 1) % STATS_BLOCKS;
+        m->block_n = 0;
+    }
+    float f = (float)v;
+    if (m->block_n == 0) {
+        m->bmin[m->block] = m->bmax[m->block] = f;
+        if (m->nblocks < STATS_BLOCKS) m->nblocks++;
+    } else {
+        if (f < m->bmin[m->block]) m->bmin[m->block] = f;
+        if (f > m->bmax[m->block]) m->bmax[m->block] = f;
+    }
+    m->block_n++;
+}
+
+int stats_push(Stats *st, const Snapshot *snap) {
+    if (!st || !st->metric || !snap || snap->seq == st->last_seq) return 0;
+    st->last_seq = snap->seq;
+    double t = (double)snap->ts.tv_sec + (double)snap->ts.tv_nsec / 1e9;
+
+    if (snap->mem_rc == 0) {
+        metric_push(st, STATS_MEM_USED, t, snap->mem.used_ratio);
+        metric_push(st, STATS_SWAP_USED, t, snap->mem.swap_total_kib > 0 ? snap->mem.swap_used_ratio : 0.0);
+    }
+    const CPUUsage *u = &snap->cpu;
+    if (snap->cpu_rc != 0 || !u->ready) return 1;
+    metric_push(st, STATS_CPU_AVG, t, u->avg);
+    int n = u->cores < st->cores ? u->cores : st->cores;
+    for (int c = 0; c < n; ++c)
+        if (u->state[c] == CPU_CORE_ONLINE) metric_push(st, STATS_SERIES_COUNT + c, t, u->per_core[c]);
+    return 1;
+}
+
+// Valor del cuantil 'q' interpolando dentro de la cubeta donde cae
+static double hist_quantile(const StatsMetric *m, double q) {
+    double target = q * (double)m->count;
+    double cum = 0.0;
+    for (int b = 0; b < STATS_BUCKETS; ++b) {
+        double h = m->hist[b];
+        if (h > 0.0 && cum + h >= target) return ((double)b + (target - cum) / h) / STATS_BUCKETS;
+        cum += h;
+    }
+    return 1.0;
+}
+
+static int summarize(const Stats *st, int idx, StatsSummary *out) {
+    const StatsMetric *m = &st->metric[idx];
+    memset(out, 0, sizeof(*out));
+    out->count = m->count;
+    if (m->count == 0) return 0;
+    memcpy(out->ewma, m->ewma, sizeof(out->ewma));
+    out->min = m->bmin[0];
+    out->max = m->bmax[0];
+    for (int k = 1; k < m->nblocks; ++k) {
+        if (m->bmin[k] < out->min) out->min = m->bmin[k];
+        if (m->bmax[k] > out->max) out->max = m->bmax[k];
+    }
+    // Las cubetas son de 1 %: se acotan con los extremos exactos
+    const double q[3] = { 0.50, 0.95, 0.99 };
+    double *p[3] = { &out->p50, &out->p95, &out->p99 };
+    for (int k = 0; k < 3; ++k) {
+        double v = hist_quantile(m, q[k]);
+        *p[k] = v < out->min ? out->min : (v > out->max ? out->max : v);
+    }
+    return 0;
+}
+
+void stats_hook(const Snapshot *snap, void *arg) {
+    Stats *st = arg;
+    pthread_mutex_lock(&st->lock);
+    stats_push(st, snap);
+    pthread_mutex_unlock(&st->lock);
+}
+
+void stats_lock(Stats *st)   { pthread_mutex_lock(&st->lock); }
+void stats_unlock(Stats *st) { pthread_mutex_unlock(&st->lock); }
+
+int stats_summary(const Stats *st, StatsSeries s, StatsSummary *out) {
+    if (!st || !st->metric || !out || (int)s < 0 || s >= STATS_SERIES_COUNT) return 1;
+    return summarize(st, (int)s, out);
+}
+
+int stats_core_summary(const Stats *st, int core, StatsSummary *out) {
+    if (!st || !st->metric || !out || core < 0 || core >= st->cores) return 1;
+    return summarize(st, STATS_SERIES_COUNT + core, out);
+}
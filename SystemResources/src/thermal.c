@@ -0,0 +1,282 @@
+#include "thermal.h"
+#include "procfile.h"
+#include <dirent.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define CPUFREQ_DIR  "/sys/devices/system/cpu/cpufreq"
+#define THERMAL_DIR  "/sys/class/thermal"
+#define THROTTLED_PATH "/sys/devices/platform/soc/soc:firmware/get_throttled"
+#define TRIP_POINT_MAX 16
+
+typedef struct {
+    ProcFile cur, min, max;   // fd = -1 si ese archivo no existe
+} PolicyFiles;
+
+struct ThermalSampler {
+    PolicyFiles *pol;         // [npol]: una por policy que cabe en la muestra
+    int          npol;
+    ProcFile     temp[THERMAL_ZONE_MAX];
+    ProcFile     throttled;
+    ThermalStats fixed;       // lo que no cambia: topología, tipos, disparos, hw_max
+};
+
+const FreqPolicy *thermal_core_policy(const ThermalStats *t, int core) {
+    if (!t || core < 0 || core >= FREQ_CORE_MAX) return NULL;
+    unsigned idx = t->core_policy[core];
+    return ((int)idx < t->npolicies) ? &t->policy[idx] : NULL;
+}
+
+double thermal_max_temp(const ThermalStats *t) {
+    if (!t || t->nzones <= 0) return 0.0;
+    double m = t->zone[0].temp_c;
+    for (int i = 1; i < t->nzones; ++i)
+        if (t->zone[i].temp_c > m) m = t->zone[i].temp_c;
+    return m;
+}
+
+// ---------- Lectura ----------
+// Entero con signo en base 10 (las temperaturas pueden ser negativas).
+static const char *parse_ll(const char *p, long long *out) {
+    const char *s = pf_skip_spaces(p);
+    int neg = (*s == '-');
+    unsigned long long v = 0;
+    const char *e = pf_parse_ull(s + neg, &v);
+    if (e == s + neg) return p;
+    *out = neg ? -(long long)v : (long long)v;
+    return e;
+}
+
+// Relee un archivo de sysfs con un solo número. 0 si OK.
+static int read_ll(ProcFile *pf, long long *out) {
+    if (pf->fd < 0 || procfile_read(pf) != 0) return 2;
+    return parse_ll(pf->buf, out) == pf->buf ? 2 : 0;
+}
+
+// Lectura única (valores fijos): abre, lee y cierra. Devuelve los bytes leídos o -1.
+static int read_once(const char *rel, char *buf, size_t len) {
+    char path[512];
+    const char *p = procfs_path(rel, path, sizeof(path));
+    int fd = p ? open(p, O_RDONLY | O_CLOEXEC) : -1;
+    if (fd < 0) return -1;
+    ssize_t n = read(fd, buf, len - 1);
+    close(fd);
+    if (n < 0) return -1;
+    buf[n] = '\0';
+    return (int)n;
+}
+
+static int read_once_ll(const char *rel, long long *out) {
+    char buf[64];
+    if (read_once(rel, buf, sizeof(buf)) <= 0) return 2;
+    return parse_ll(buf, out) == buf ? 2 : 0;
+}
+
+// "0x50005" → 0x50005. -1 si no es hexadecimal.
+static long parse_hex(const char *p) {
+    p = pf_skip_spaces(p);
+    if (p[0] == '0' && (p[1] == 'x' || p[1] == 'X')) p += 2;
+    long v = 0;
+    int digits = 0;
+    for (;; ++p, ++digits) {
+        int d;
+        if (*p >= '0' && *p <= '9') d = *p - '0';
+        else if (*p >= 'a' && *p <= 'f') d = *p - 'a' + 10;
+        else if (*p >= 'A' && *p <= 'F') d = *p - 'A' + 10;
+        else break;
+        if (v > 0x7FFFFFF) return -1;
+        v = v * 16 + d;
+    }
+    return digits ? v : -1;
+}
+
+// ---------- Descubrimiento ----------
+static int cmp_int(const void *a, const void *b) {
+    int x = *(const int *)a, y = *(const int *)b;
+    return (x > y) - (x < y);
+}
+
+// Números N de las entradas "<prefix>N" de 'dir', ordenados, en *out
+// (reservado aquí; lo libera el llamador). Devuelve cuántas (sin memoria,
+// las que se llegaron a guardar).
+static int list_numbered(const char *dir, const char *prefix, int **out) {
+    *out = NULL;
+    char path[512];
+    const char *p = procfs_path(dir, path, sizeof(path));
+    DIR *d = p ? opendir(p) : NULL;
+    if (!d) return 0;
+    size_t plen = strlen(prefix);
+    int *ids = NULL;
+    int n = 0, cap = 0;
+    struct dirent *de;
+    while ((de = readdir(d)) != NULL) {
+        if (strncmp(de->d_name, prefix, plen) != 0) continue;
+        unsigned long long v;
+        const char *s = de->d_name + plen;
+        const char *e = pf_parse_ull(s, &v);
+        if (e == s || *e != '\0' || v > 0xFFFF) continue;
+        if (n == cap) {
+            int nc = cap ? cap * 2 : 64;
+            int *ni = realloc(ids, (size_t)nc * sizeof(*ni));
+            if (!ni) break;
+            ids = ni;
+            cap = nc;
+        }
+        ids[n++] = (int)v;
+    }
+    closedir(d);
+    if (n > 0) qsort(ids, (size_t)n, sizeof(int), cmp_int);
+    *out = ids;
+    return n;
+}
+
+// related_cpus: "0 1 2 3" (separados por espacios). Marca core_policy[] y
+// deja en la policy el primer núcleo y la cantidad.
+static void map_policy_cpus(ThermalStats *t, int idx, const char *p) {
+    FreqPolicy *fp = &t->policy[idx];
+    fp->first_cpu = -1;
+    fp->ncpus = 0;
+    for (;;) {
+        unsigned long long cpu;
+        const char *e = pf_parse_ull(p, &cpu);
+        if (e == p) break;
+        p = e;
+        if (fp->first_cpu < 0 || (int)cpu < fp->first_cpu) fp->first_cpu = (int)cpu;
+        fp->ncpus++;
+        if (cpu < FREQ_CORE_MAX) t->core_policy[cpu] = (unsigned short)idx;
+    }
+}
+
+static void open_policies(ThermalSampler *s) {
+    ThermalStats *t = &s->fixed;
+    int *ids;
+    int n = list_numbered(CPUFREQ_DIR, "policy", &ids);
+    // Archivos solo para las que caben en la muestra; el resto se cuenta
+    int want = n < FREQ_POLICY_MAX ? n : FREQ_POLICY_MAX;
+    s->pol = want > 0 ? malloc((size_t)want * sizeof(*s->pol)) : NULL;
+    if (s->pol) s->npol = want;
+    for (int i = 0; i < s->npol; ++i)
+        s->pol[i].cur = s->pol[i].min = s->pol[i].max = (ProcFile)PROCFILE_INIT;
+    for (int i = 0; i < n; ++i) {
+        if (t->npolicies >= s->npol) { t->omitted_policies++; continue; }
+        char rel[128], buf[1024];
+        PolicyFiles *pf = &s->pol[t->npolicies];
+        FreqPolicy *fp = &t->policy[t->npolicies];
+
+        snprintf(rel, sizeof(rel), CPUFREQ_DIR "/policy%d/scaling_cur_freq", ids[i]);
+        if (procfile_open(&pf->cur, rel, 64) != 0) continue;   // sin driver activo
+        snprintf(rel, sizeof(rel), CPUFREQ_DIR "/policy%d/scaling_min_freq", ids[i]);
+        (void)procfile_open(&pf->min, rel, 64);
+        snprintf(rel, sizeof(rel), CPUFREQ_DIR "/policy%d/scaling_max_freq", ids[i]);
+        (void)procfile_open(&pf->max, rel, 64);
+
+        long long v = 0;
+        snprintf(rel, sizeof(rel), CPUFREQ_DIR "/policy%d/cpuinfo_max_freq", ids[i]);
+        if (read_once_ll(rel, &v) == 0) fp->hw_max_khz = (long)v;
+
+        snprintf(rel, sizeof(rel), CPUFREQ_DIR "/policy%d/related_cpus", ids[i]);
+        if (read_once(rel, buf, sizeof(buf)) > 0) map_policy_cpus(t, t->npolicies, buf);
+        if (fp->ncpus == 0) {
+            // Sin related_cpus: la policy N es la del núcleo N
+            fp->first_cpu = ids[i];
+            fp->ncpus = 1;
+            if (ids[i] < FREQ_CORE_MAX) t->core_policy[ids[i]] = (unsigned short)t->npolicies;
+        }
+        t->npolicies++;
+    }
+    free(ids);
+}
+
+static void read_trip_points(ThermalZone *z, int id) {
+    for (int k = 0; k < TRIP_POINT_MAX; ++k) {
+        char rel[128], type[32];
+        snprintf(rel, sizeof(rel), THERMAL_DIR "/thermal_zone%d/trip_point_%d_type", id, k);
+        if (read_once(rel, type, sizeof(type)) <= 0) break;
+        long long mc;
+        snprintf(rel, sizeof(rel), THERMAL_DIR "/thermal_zone%d/trip_point_%d_temp", id, k);
+        if (read_once_ll(rel, &mc) != 0 || mc <= 0) continue;
+        if (strncmp(type, "critical", 8) == 0 && z->crit_c == 0.0) z->crit_c = (double)mc / 1000.0;
+        else if (strncmp(type, "passive", 7) == 0 && z->passive_c == 0.0) z->passive_c = (double)mc / 1000.0;
+    }
+}
+
+static void open_zones(ThermalSampler *s) {
+    ThermalStats *t = &s->fixed;
+    int *ids;
+    int n = list_numbered(THERMAL_DIR, "thermal_zone", &ids);
+    for (int i = 0; i < n; ++i) {
+        if (t->nzones >= THERMAL_ZONE_MAX) { t->omitted_zones++; continue; }
+        char rel[128];
+        snprintf(rel, sizeof(rel), THERMAL_DIR "/thermal_zone%d/temp", ids[i]);
+        if (procfile_open(&s->temp[t->nzones], rel, 64) != 0) continue;
+
+        ThermalZone *z = &t->zone[t->nzones];
+        snprintf(rel, sizeof(rel), THERMAL_DIR "/thermal_zone%d/type", ids[i]);
+        int len = read_once(rel, z->type, sizeof(z->type));
+        while (len > 0 && (z->type[len - 1] == '\n' || z->type[len - 1] == ' ')) z->type[--len] = '\0';
+        if (len <= 0) snprintf(z->type, sizeof(z->type), "zone%d", ids[i]);
+        read_trip_points(z, ids[i]);
+        t->nzones++;
+    }
+    free(ids);
+}
+
+// ---------- API ----------
+ThermalSampler *thermal_sampler_create(void) {
+    ThermalSampler *s = calloc(1, sizeof(*s));
+    if (!s) return NULL;
+    for (int i = 0; i < THERMAL_ZONE_MAX; ++i) s->temp[i] = (ProcFile)PROCFILE_INIT;
+    s->throttled = (ProcFile)PROCFILE_INIT;
+    for (int i = 0; i < FREQ_CORE_MAX; ++i) s->fixed.core_policy[i] = FREQ_NO_POLICY;
+    s->fixed.throttled = -1;
+
+    open_policies(s);
+    open_zones(s);
+    (void)procfile_open(&s->throttled, THROTTLED_PATH, 64);
+
+    if (s->fixed.npolicies == 0 && s->fixed.nzones == 0 && s->throttled.fd < 0) {
+        thermal_sampler_destroy(s);
+        return NULL;
+    }
+    return s;
+}
+
+void thermal_sampler_destroy(ThermalSampler *s) {
+    if (!s) return;
+    for (int i = 0; i < s->npol; ++i) {
+        procfile_close(&s->pol[i].cur);
+        procfile_close(&s->pol[i].min);
+        procfile_close(&s->pol[i].max);
+    }
+    free(s->pol);
+    for (int i = 0; i < THERMAL_ZONE_MAX; ++i) procfile_close(&s->temp[i]);
+    procfile_close(&s->throttled);
+    free(s);
+}
+
+int thermal_sampler_sample(ThermalSampler *s, ThermalStats *out) {
+    if (!s || !out) return 1;
+    memcpy(out, &s->fixed, sizeof(*out));
+
+    int ok = 0;
+    long long v;
+    for (int i = 0; i < out->npolicies; ++i) {
+        FreqPolicy *fp = &out->policy[i];
+        // Con todos sus núcleos desconectados la policy deja de responder: 0 = sin dato
+        if (read_ll(&s->pol[i].cur, &v) == 0) { fp->cur_khz = (long)v; ok++; }
+        if (read_ll(&s->pol[i].min, &v) == 0) fp->min_khz = (long)v;
+        if (read_ll(&s->pol[i].max, &v) == 0) fp->max_khz = (long)v;
+    }
+    for (int i = 0; i < out->nzones; ++i) {
+        // Algunos sensores (p. ej. en suspensión) devuelven EAGAIN/ENODATA
+        if (read_ll(&s->temp[i], &v) == 0) { out->zone[i].temp_c = (double)v / 1000.0; ok++; }
+    }
+    if (s->throttled.fd >= 0 && procfile_read(&s->throttled) == 0) {
+        long bits = parse_hex(s->throttled.buf);
+        if (bits >= 0) { out->throttled = (int)bits; ok++; }
+    }
+    return ok ? 0 : 2;
+}
@@ -1,33 +1,164 @@
 #include "tui.h"
+#include "canvas.h"
 #include <ncursesw/ncurses.h>
+#include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
 #include <locale.h>
 #include <time.h>
+#include <math.h>
+
+// --- Paneles: ventana con borde + canvas con seguimiento de daños ---
+// El borde y el título se dibujan una sola vez al crear el panel; cada frame
+// solo se compone el interior y canvas_flush() emite lo que cambió.
+typedef struct {
+    WINDOW *win;
+    Canvas  cv;
+} Panel;
 
 // --- Estado de layout persistente ---
-static WINDOW *g_win_mem = NULL;
-static WINDOW *g_win_cpu = NULL;
+static Panel g_mem;
+static Panel g_cpu;
+static Panel g_sched;      // opcional: solo si hay altura suficiente
+static Panel g_disk;       // opcional: E/S por disco
+static Panel g_net;        // opcional: tráfico por interfaz
+static Panel g_psi;        // opcional: presión (PSI)
+static Panel g_proc;       // opcional: top de procesos
+static Panel g_cg;         // opcional: modo cgroup
+static Panel g_irq;        // opcional: interrupciones por núcleo
+static Canvas g_screen;    // stdscr completo: cabecera, pie y modo fallback
 
 static int g_rows = 0, g_cols = 0;
 static int g_mem_h = 0, g_cpu_h = 0;
 static int g_panel_w = 0, g_panel_x = 0;
 static int g_mem_y = 0, g_cpu_y = 0;
+static int g_sched_h = 0, g_sched_y = 0;
+static int g_disk_h = 0, g_disk_y = 0, g_disk_x = 0, g_disk_w = 0;
+static int g_net_h = 0, g_net_y = 0, g_net_x = 0, g_net_w = 0;
+static int g_psi_h = 0, g_psi_y = 0;
+static int g_proc_h = 0, g_proc_y = 0;
+static int g_cg_h = 0, g_cg_y = 0;
+static int g_irq_h = 0, g_irq_y = 0;
+static int g_need_full = 1;   // recrear layout y repintar todo en el próximo frame
+
+// Texto del pie con el periodo de muestreo real (--interval-ms)
+static char g_period[24] = "2 s";
+
+// Modo de barras por core ('b' alterna)
+static TuiCpuBarMode g_cpu_bar_mode = TUI_CPU_BARS_TOTAL;
+
+// Vista del panel de CPU ('h' alterna) y criterio del top-N del mapa ('s' rota)
+static TuiCpuView g_cpu_view = TUI_CPU_VIEW_BARS;
+static TuiHeatSort g_heat_sort = TUI_HEAT_SORT_TOTAL;
+
+// Pie alternativo (--replay) y hora fija de la cabecera (0 = ahora)
+static char   g_footer[160];
+static int    g_has_footer = 0;
+static time_t g_clock = 0;
+// Motor de alertas: reglas cargadas, instancias disparadas y la última
+static int    g_alert_rules = 0;
+static int    g_alert_firing = 0;
+static char   g_alert_last[64];
+
+// Historial para sparklines (propiedad del llamador)
+static const History *g_hist = NULL;
+// Estadísticas en ventana (propiedad del llamador) y si se muestran por core ('e')
+static const Stats *g_stats = NULL;
+static int g_core_stats = 0;
+// Resúmenes copiados por tui_take_stats(): el dibujo no vuelve a leer g_stats
+static StatsSummary  g_sum[STATS_SERIES_COUNT];
+static StatsSummary *g_core_sum = NULL;   // [g_core_sum_n]
+static int           g_core_sum_n = 0;
+
+// Discos de la muestra en curso (propiedad del llamador; NULL = sin panel) y
+// filas de dispositivos que pide el panel: si cambia, se rehace el layout.
+#define DISK_PANEL_ROWS 4
+static const DiskStats *g_disks = NULL;
+static int g_disk_want = 0;
+// Lo mismo para las interfaces de red
+#define NET_PANEL_ROWS 4
+static const NetStats *g_nets = NULL;
+static int g_net_want = 0;
+// Desde este ancho, Discos y Red van lado a lado en una sola franja
+#define IO_SIDE_BY_SIDE_W 150
+// PSI: una fila por recurso legible (0 = kernel sin PSI, sin panel)
+static const PsiStats *g_psi_stats = NULL;
+static int g_psi_want = 0;
+// Procesos: hasta PROC_TOP filas, las que quepan (mínimo 3)
+#define PROC_PANEL_MIN 3
+static const ProcStats *g_procs = NULL;
+static int g_proc_want = 0;
+static TuiProcSort g_proc_sort = TUI_PROC_SORT_CPU;
+// Térmica: sin panel propio, va en la cabecera y en cada fila del de CPU.
+// Un núcleo con al menos esta carga y el reloj por debajo de FREQ_SLOW_RATIO
+// de su máximo de hardware se marca como frenado.
+static const ThermalStats *g_thermal = NULL;
+#define FREQ_LOAD_MIN   0.50
+#define FREQ_SLOW_RATIO 0.95
+// Cgroup: memoria, CPU y desglose, más un hijo por fila (los de más consumo)
+#define CGROUP_PANEL_CHILDREN 5
+static const CgroupStats *g_cgroup = NULL;
+static int g_cg_want = 0;
+// Interrupciones: cabecera + un núcleo caliente por fila. La parte del núcleo
+// que se va en irq + softirq se colorea con umbrales propios: un 20 % ya es
+// mucho para un solo núcleo.
+#define IRQ_SHARE_WARN 0.20
+#define IRQ_SHARE_HOT  0.50
+static const IrqStats *g_irq_stats = NULL;
+static int g_irq_want = 0;
+
+// Estilos (par de color + negrita) usados por el dashboard
+#define ST_TITLE    CV_STYLE(1, 1)
+#define ST_SUBTITLE CV_STYLE(2, 0)
+
+static int panel_create(Panel *p, int h, int w, int y, int x, const char *title) {
+    memset(p, 0, sizeof(*p));
+    p->win = newwin(h, w, y, x);
+    if (!p->win) return 1;
+    box(p->win, 0, 0);
+    if (has_colors()) wattron(p->win, COLOR_PAIR(5) | A_BOLD);
+    mvwprintw(p->win, 0, 2, "[ %s ]", title);
+    if (has_colors()) wattroff(p->win, COLOR_PAIR(5) | A_BOLD);
+    if (canvas_init(&p->cv, p->win, 1, 1, h - 2, w - 2) != 0) {
+        delwin(p->win);
+        p->win = NULL;
+        return 1;
+    }
+    return 0;
+}
+
+static void panel_destroy(Panel *p) {
+    canvas_free(&p->cv);
+    if (p->win) delwin(p->win);
+    memset(p, 0, sizeof(*p));
+}
 
 static void destroy_windows(void) {
-    if (g_win_mem) { delwin(g_win_mem); g_win_mem = NULL; }
-    if (g_win_cpu) { delwin(g_win_cpu); g_win_cpu = NULL; }
+    panel_destroy(&g_mem);
+    panel_destroy(&g_cpu);
+    panel_destroy(&g_sched);
+    panel_destroy(&g_disk);
+    panel_destroy(&g_net);
+    panel_destroy(&g_psi);
+    panel_destroy(&g_proc);
+    panel_destroy(&g_cg);
+    panel_destroy(&g_irq);
+    canvas_free(&g_screen);
 }
 
 // Calcula/recrea el layout si cambió el tamaño de terminal
 static void ensure_layout(void) {
     int rows, cols;
     getmaxyx(stdscr, rows, cols);
-    if (rows == g_rows && cols == g_cols && g_win_mem && g_win_cpu) return;
+    if (!g_need_full && rows == g_rows && cols == g_cols) return;
 
     // Guarda y recrea
     g_rows = rows; g_cols = cols;
+    g_need_full = 0;
     destroy_windows();
+    erase();
+    wnoutrefresh(stdscr);
+    canvas_init(&g_screen, stdscr, 0, 0, rows, cols);
 
     const int header_lines = 5;
     const int footer_lines = 2;
@@ -39,30 +170,121 @@ static void ensure_layout(void) {
         return;
     }
 
+    g_panel_w = g_cols - 4;
+    g_panel_x = 2;
+
+    // Paneles opcionales, en orden de prioridad, solo si memoria y CPU
+    // conservan sus 8 filas mínimas. El cgroup primero porque se pidió
+    // explícitamente (--cgroup); luego PSI: es el aviso más temprano de que
+    // la máquina se está ahogando.
+    g_cg_h = (g_cg_want > 0 && available - (g_cg_want + 2) - gap_between >= 16) ? g_cg_want + 2 : 0;
+    if (g_cg_h) available -= g_cg_h + gap_between;
+    g_psi_h = (g_psi_want > 0 && available - (g_psi_want + 3) - gap_between >= 16) ? g_psi_want + 3 : 0;
+    if (g_psi_h) available -= g_psi_h + gap_between;
+
+    // Discos y Red: cabecera + un renglón por dispositivo; en terminales
+    // anchas comparten franja (la altura del mayor).
+    int disk_h = g_disk_want > 0 ? g_disk_want + 3 : 0;
+    int net_h  = g_net_want > 0 ? g_net_want + 3 : 0;
+    int side   = disk_h && net_h && g_panel_w >= IO_SIDE_BY_SIDE_W;
+    g_disk_h = g_net_h = 0;
+    g_disk_x = g_net_x = g_panel_x;
+    g_disk_w = g_net_w = g_panel_w;
+    if (side) {
+        int h = disk_h > net_h ? disk_h : net_h;
+        if (available - h - gap_between >= 16) {
+            g_disk_h = g_net_h = h;
+            g_disk_w = (g_panel_w - 1) / 2;
+            g_net_x  = g_panel_x + g_disk_w + 1;
+            g_net_w  = g_panel_w - g_disk_w - 1;
+            available -= h + gap_between;
+        }
+    } else {
+        if (disk_h && available - disk_h - gap_between >= 16) { g_disk_h = disk_h; available -= disk_h + gap_between; }
+        if (net_h && available - net_h - gap_between >= 16)   { g_net_h = net_h;   available -= net_h + gap_between; }
+    }
+    // Interrupciones: tras la E/S, que es quien suele generarlas
+    g_irq_h = (g_irq_want > 0 && available - (g_irq_want + 2) - gap_between >= 16) ? g_irq_want + 2 : 0;
+    if (g_irq_h) available -= g_irq_h + gap_between;
+    // Planificador (3 filas); sin él, su línea va dentro del panel de CPU.
+    g_sched_h = (available - 3 - gap_between >= 16) ? 3 : 0;
+    if (g_sched_h) available -= g_sched_h + gap_between;
+    // Procesos: las filas que sobren, hasta las que pide
+    g_proc_h = 0;
+    if (g_proc_want > 0) {
+        int fit = available - gap_between - 16 - 3;
+        int n = fit < g_proc_want ? fit : g_proc_want;
+        if (n >= PROC_PANEL_MIN) { g_proc_h = n + 3; available -= g_proc_h + gap_between; }
+    }
+
     // 40% memoria, 60% CPU con mínimos
     g_mem_h = (available * 2) / 5; if (g_mem_h < 8) g_mem_h = 8;
     g_cpu_h = available - g_mem_h; if (g_cpu_h < 8) g_cpu_h = 8;
 
-    g_panel_w = g_cols - 4;
-    g_panel_x = 2;
     g_mem_y   = header_lines;
-    g_cpu_y   = g_mem_y + g_mem_h + gap_between;
+    g_cg_y    = g_mem_y + g_mem_h + gap_between;
+    g_psi_y   = g_cg_h ? g_cg_y + g_cg_h + gap_between : g_cg_y;
+    g_disk_y  = g_psi_h ? g_psi_y + g_psi_h + gap_between : g_psi_y;
+    g_net_y   = (g_disk_h && !side) ? g_disk_y + g_disk_h + gap_between : g_disk_y;
+    g_irq_y   = g_net_h ? g_net_y + g_net_h + gap_between
+              : g_disk_h ? g_disk_y + g_disk_h + gap_between : g_disk_y;
+    g_sched_y = g_irq_h ? g_irq_y + g_irq_h + gap_between : g_irq_y;
+    g_proc_y  = g_sched_h ? g_sched_y + g_sched_h + gap_between : g_sched_y;
+    g_cpu_y   = g_proc_h ? g_proc_y + g_proc_h + gap_between : g_proc_y;
 
     // Último ajuste si no cabe exacto
     int overflow = (g_cpu_y + g_cpu_h + footer_lines) - g_rows;
     if (overflow > 0) { g_cpu_h -= overflow; if (g_cpu_h < 6) g_cpu_h = 6; }
 
-    // Crea ventanas (si no caben, quedarán NULL y usaremos fallback)
+    // Crea paneles (si no caben, quedarán sin ventana y usaremos fallback)
     if (g_panel_w >= 20 && g_mem_h >= 6)
-        g_win_mem = newwin(g_mem_h, g_panel_w, g_mem_y, g_panel_x);
+        panel_create(&g_mem, g_mem_h, g_panel_w, g_mem_y, g_panel_x, g_cgroup ? "Memoria (del cgroup)" : "Memoria");
     if (g_panel_w >= 20 && g_cpu_h >= 6)
-        g_win_cpu = newwin(g_cpu_h, g_panel_w, g_cpu_y, g_panel_x);
+        panel_create(&g_cpu, g_cpu_h, g_panel_w, g_cpu_y, g_panel_x, "CPU");
+    if (g_panel_w >= 20 && g_sched_h > 0)
+        panel_create(&g_sched, g_sched_h, g_panel_w, g_sched_y, g_panel_x, "Planificador");
+    if (g_panel_w >= 20 && g_psi_h > 0)
+        panel_create(&g_psi, g_psi_h, g_panel_w, g_psi_y, g_panel_x, "Presión (PSI, % del tiempo con tareas detenidas)");
+    if (g_panel_w >= 20 && g_cg_h > 0) {
+        char title[CGROUP_PATH_MAX + 16];
+        snprintf(title, sizeof(title), "Cgroup %s", g_cgroup ? g_cgroup->path : "");
+        panel_create(&g_cg, g_cg_h, g_panel_w, g_cg_y, g_panel_x, title);
+    }
+    if (g_panel_w >= 20 && g_proc_h > 0)
+        panel_create(&g_proc, g_proc_h, g_panel_w, g_proc_y, g_panel_x, "Procesos");
+    if (g_disk_w >= 20 && g_disk_h > 0)
+        panel_create(&g_disk, g_disk_h, g_disk_w, g_disk_y, g_disk_x, "Discos (tiempos en ms)");
+    if (g_net_w >= 20 && g_net_h > 0)
+        panel_create(&g_net, g_net_h, g_net_w, g_net_y, g_net_x, "Red (bits/s)");
+    if (g_panel_w >= 20 && g_irq_h > 0)
+        panel_create(&g_irq, g_irq_h, g_panel_w, g_irq_y, g_panel_x, "Interrupciones (núcleos más cargados)");
 }
 
 
 // Prototipos helpers (deben ir antes de cualquier uso)
 static void draw_bar(int y, int x, int width, double ratio);
-static void draw_bar_win(WINDOW *w, int y, int x, int width, double ratio);
+static void cv_bar(Canvas *cv, int y, int x, int width, double ratio);
+static void cv_bar_styled(Canvas *cv, int y, int x, int width, double ratio, unsigned short style);
+static void cv_stacked_bar(Canvas *cv, int y, int x, int width, const CPUTimes *t);
+static void cv_mem_breakdown(Canvas *cv, int y, int x, int width, const MemStats *m);
+static void cv_mem_legend(Canvas *cv, int y, int x, const MemStats *m);
+static void cv_mem_details(Canvas *cv, int y, int x, const MemStats *m);
+static void cv_times_legend(Canvas *cv, int y, int x, const CPUTimes *t);
+static void cv_core_bar(Canvas *cv, int y, int x, int width, const CPUUsage *usage, int i);
+static int  cv_sched_line(Canvas *cv, int y, int x, const CPUUsage *usage);
+static int  cv_right(const Canvas *cv);
+static void cv_sparkline(Canvas *cv, int y, int x, int width, const float *ring, double max, int by_ratio);
+static int  spark_width(int avail, int max_w);
+static void draw_disk_panel(Canvas *cv, const DiskStats *d);
+static void draw_net_panel(Canvas *cv, const NetStats *n);
+static void draw_psi_panel(Canvas *cv, const PsiStats *p);
+static void draw_proc_panel(Canvas *cv, const ProcStats *p, const MemStats *mem);
+static int  cv_thermal_summary(Canvas *cv, int y, int x, const ThermalStats *t);
+static int  cv_core_freq(Canvas *cv, int y, int x, const CPUUsage *usage, int i);
+static int  cv_stats_brief(Canvas *cv, int y, int x, StatsSeries s);
+static int  cv_core_stats(Canvas *cv, int y, int x, int i);
+static void draw_cgroup_panel(Canvas *cv, const CgroupStats *cg, int online);
+static void draw_irq_panel(Canvas *cv, const IrqStats *iq, const CPUUsage *usage);
 
 // ==================== Inicialización / cierre ====================
 
@@ -80,31 +302,44 @@ int tui_init(void) {
         init_pair(3, COLOR_GREEN,  COLOR_BLACK);
         init_pair(4, COLOR_RED,    COLOR_BLACK);
         init_pair(5, COLOR_BLUE,   COLOR_BLACK);
+        // 6: irq (magenta), 7: steal (blanco) — usados por las barras apiladas
+        init_pair(6, COLOR_MAGENTA, COLOR_BLACK);
+        init_pair(7, COLOR_WHITE,   COLOR_BLACK);
     }
 
     cbreak();
     noecho();
     keypad(stdscr, TRUE);
     curs_set(0);
-    timeout(2000); // auto-refresh cada 2 s
+    timeout(0);    // getch no bloquea: main() espera con poll() (timerfd + stdin)
     return 0;
 }
 
 void tui_end(void) {
     destroy_windows();
     endwin();
+    free(g_core_sum);
+    g_core_sum = NULL;
+    g_core_sum_n = 0;
+}
+
+void tui_force_full_redraw(void) {
+    g_need_full = 1;
+    clearok(curscr, TRUE);   // la próxima doupdate() reenvía la pantalla entera
 }
 
 // ==================== Vistas antiguas (por compatibilidad) ====================
 
 void tui_draw_memory(const char *installed_str) {
     erase();
+    g_need_full = 1;   // pisa paneles y canvas: el dashboard debe repintar todo
     int rows, cols;
     getmaxyx(stdscr, rows, cols);
 
     const char *title = "Raspberry Pi — System Info (TUI)";
     const char *subtitle = "[Actividad 1] Memoria instalada";
-    const char *hint = "Auto-refresh 2 s — 'r' refrescar ahora, 'q' salir";
+    char hint[96];
+    snprintf(hint, sizeof(hint), "Auto-refresh %s — 'r' refrescar ahora, 'q' salir", g_period);
 
     int title_x = (cols - (int)strlen(title)) / 2;
     int sub_x   = (cols - (int)strlen(subtitle)) / 2;
@@ -128,12 +363,14 @@ void tui_draw_memory(const char *installed_str) {
 
 void tui_draw_memory_usage(const MemStats *st) {
     erase();
+    g_need_full = 1;   // pisa paneles y canvas: el dashboard debe repintar todo
     int rows, cols;
     getmaxyx(stdscr, rows, cols);
 
     const char *title = "Raspberry Pi — System Info (TUI)";
     const char *subtitle = "[Actividad 2] Uso de memoria física y virtual";
-    const char *hint = "Auto-refresh 2 s — 'r' refrescar ahora, 'q' salir";
+    char hint[96];
+    snprintf(hint, sizeof(hint), "Auto-refresh %s — 'r' refrescar ahora, 'q' salir", g_period);
 
     int title_x = (cols - (int)strlen(title)) / 2;
     int sub_x   = (cols - (int)strlen(subtitle)) / 2;
@@ -174,156 +411,379 @@ void tui_draw_memory_usage(const MemStats *st) {
     refresh();
 }
 
-// ==================== Dashboard mejorado (ventanas y cajas) ====================
+// ==================== Dashboard mejorado (paneles con seguimiento de daños) ====================
+
+// Líneas de memoria desde 'y' hasta antes de 'y_end'. Con 5 filas solo van
+// RAM y SWAP; cada fila extra suma, en orden: la barra de RAM pasa a ser el
+// desglose (+ leyenda), la línea de detalle y un respiro antes de SWAP.
+static void draw_memory_lines(Canvas *cv, int y, int x, int y_end, int bar_w, const MemStats *mem) {
+    char installed[64], t_total[64], t_used[64], t_avail[64], s_total[64], s_used[64], s_free[64];
+    format_bytes_from_kib(mem->total_kib,      installed, sizeof(installed));
+    format_bytes_from_kib(mem->total_kib,      t_total,   sizeof(t_total));
+    format_bytes_from_kib(mem->used_kib,       t_used,    sizeof(t_used));
+    format_bytes_from_kib(mem->avail_kib,      t_avail,   sizeof(t_avail));
+    format_bytes_from_kib(mem->swap_total_kib, s_total,   sizeof(s_total));
+    format_bytes_from_kib(mem->swap_used_kib,  s_used,    sizeof(s_used));
+    format_bytes_from_kib(mem->swap_free_kib,  s_free,    sizeof(s_free));
+
+    // Sin MemFree no hay desglose (p. ej. una grabación anterior a él)
+    int known     = mem->total_kib > 0 && mem->free_kib > 0;
+    int extra     = (y_end - y) - 5;
+    int breakdown = known && extra >= 1;  if (breakdown) extra--;
+    int details   = known && extra >= 1;  if (details) extra--;
+    int gap       = extra >= 1;
+
+    canvas_printf(cv, y++, x, CV_PLAIN, "Instalada: %-10s", installed);
+    // Sparkline a la derecha de cada barra, con ancho fijo para que no baile
+    int sw = spark_width(bar_w / 4, 40);
+    int bw = sw ? bar_w - sw - 1 : bar_w;
+
+    int ex = canvas_printf(cv, y, x, CV_PLAIN, "RAM:   total %10s | usada %10s | disp. %10s | uso %5.1f%%",
+                           t_total, t_used, t_avail, mem->used_ratio * 100.0);
+    cv_stats_brief(cv, y++, ex, STATS_MEM_USED);
+    if (breakdown) cv_mem_breakdown(cv, y, x, bw, mem);
+    else cv_bar(cv, y, x, bw, mem->used_ratio);
+    if (sw) cv_sparkline(cv, y, x + bw + 1, sw, history_series(g_hist, HIST_MEM_USED), 1.0, 1);
+    y++;
+    if (breakdown) cv_mem_legend(cv, y++, x, mem);
+    if (gap) y++;
+    ex = canvas_printf(cv, y, x, CV_PLAIN, "SWAP:  total %10s | usada %10s | libre %10s | uso %5.1f%%",
+                       s_total, s_used, s_free,
+                       (mem->swap_total_kib > 0 ? mem->swap_used_ratio * 100.0 : 0.0));
+    if (mem->swap_total_kib > 0) cv_stats_brief(cv, y, ex, STATS_SWAP_USED);
+    y++;
+    cv_bar(cv, y, x, bw, (mem->swap_total_kib > 0) ? mem->swap_used_ratio : 0.0);
+    if (sw) cv_sparkline(cv, y, x + bw + 1, sw, history_series(g_hist, HIST_SWAP_USED), 1.0, 1);
+    y++;
+    if (details) cv_mem_details(cv, y, x, mem);
+}
+
+static void draw_cpu_heatmap(Canvas *cv, int y, int x, int y_end, const CPUUsage *usage);
+
+// Cabecera + cargas por core desde 'y'; se detiene antes de 'y_end'.
+static int draw_cpu_lines(Canvas *cv, int y, int x, int y_end, int with_sched,
+                          const CPUInfo *info, const CPUUsage *usage) {
+    int right = cv_right(cv);
+    int online = usage->ready ? usage->online_count : info->cores_online;
+
+    if (g_cpu_view == TUI_CPU_VIEW_HEATMAP) {
+        // Cabecera compacta: todo el alto restante es para la grilla
+        int hx = canvas_printf(cv, y, x, CV_PLAIN, "CPU %s (%s) | en línea %d/%d | promedio %5.1f%%",
+                               info->arch, info->hardware, online, info->cores_config,
+                               usage->ready ? usage->avg * 100.0 : 0.0);
+        if (g_thermal) cv_thermal_summary(cv, y, hx + 3, g_thermal);
+        y++;
+        // Con pocas filas la línea del planificador cede su lugar a la grilla
+        if (with_sched && y_end - y >= 8) cv_sched_line(cv, y++, x, usage);
+        if (!usage->ready) {
+            canvas_text(cv, y++, x, CV_PLAIN, "Mapa de calor: calculando… (espera un ciclo)");
+            return y;
+        }
+        draw_cpu_heatmap(cv, y, x, y_end, usage);
+        return y_end;
+    }
+
+    canvas_printf(cv, y++, x, CV_PLAIN, "CPU: %s  (SoC: %s, Arch: %s)", info->model, info->hardware, info->arch);
+    int nx = canvas_printf(cv, y, x, CV_PLAIN, "Núcleos: en línea %d / configurados %d", online, info->cores_config);
+    if (g_thermal) cv_thermal_summary(cv, y, nx + 3, g_thermal);
+    y++;
+    if (with_sched) cv_sched_line(cv, y++, x, usage);
+
+    if (!usage->ready) {
+        canvas_text(cv, y++, x, CV_PLAIN, "Cargas por núcleo: calculando… (espera un ciclo)");
+        return y;
+    }
+    int ax = canvas_printf(cv, y, x, CV_PLAIN, "Cargas por núcleo (promedio: %.1f%%):", usage->avg * 100.0) + 1;
+    ax = cv_stats_brief(cv, y, ax - 1, STATS_CPU_AVG) + 1;
+    int asw = spark_width((right - ax) / 2, 40);
+    if (asw) cv_sparkline(cv, y, ax, asw, history_series(g_hist, HIST_CPU_AVG), 1.0, 1);
+    y++;
+    if (g_cpu_bar_mode == TUI_CPU_BARS_STACKED) cv_times_legend(cv, y++, x + 2, &usage->total);
+    int with_freq = g_thermal && g_thermal->npolicies > 0;
+    int i = 0;
+    for (; i < usage->cores && y < y_end; ++i) {
+        // Si no caben todos, la última fila avisa cuántos faltan
+        if (y == y_end - 1 && i < usage->cores - 1) {
+            canvas_printf(cv, y++, x, ST_SUBTITLE, "… %d cores más sin espacio: 'h' mapa de calor",
+                          usage->cores - i);
+            break;
+        }
+        if (usage->state[i] != CPU_CORE_ONLINE) {
+            canvas_printf(cv, y++, x, CV_PLAIN, "core %d: %s", i,
+                          usage->state[i] == CPU_CORE_OFFLINE ? "offline" : "en línea (calculando…)");
+            continue;
+        }
+        int bx = canvas_printf(cv, y, x, CV_PLAIN, "core %d: %5.1f%%", i, usage->per_core[i] * 100.0) + 1;
+        if (with_freq) bx = cv_core_freq(cv, y, bx, usage, i) + 1;
+        if (g_core_stats) bx = cv_core_stats(cv, y, bx, i) + 1;
+        // Sparkline entre la etiqueta y la barra (columna fija para todos los cores)
+        const float *ring = g_hist ? history_core(g_hist, i) : NULL;
+        int csw = ring ? spark_width((right - bx) / 3, 24) : 0;
+        if (csw) { cv_sparkline(cv, y, bx, csw, ring, 1.0, 1); bx += csw; }
+        bx++;
+        int bw = right - bx; if (bw < 10) bw = 10;
+        cv_core_bar(cv, y, bx, bw, usage, i);
+        y++;
+    }
+    return y;
+}
 
 void tui_draw_system_dashboard(const MemStats *mem, const CPUInfo *info, const CPUUsage *usage) {
     // Recalcular layout si cambió tamaño
     ensure_layout();
 
-    // -------- Encabezado en stdscr (no borramos todo) --------
-    int rows, cols; getmaxyx(stdscr, rows, cols);
+    // -------- Encabezado en stdscr --------
+    int rows = g_rows, cols = g_cols;
     const char *title = "Raspberry Pi — System Info (TUI)";
     const char *subtitle = "[Dashboard] Memoria instalada + uso RAM/SWAP + CPU (modelo, núcleos y carga por núcleo)";
-    const char *hint = "Auto-refresh 2 s — 'r' refrescar, 'q' salir";
-
-    // Limpiamos solo cabecera previa
-    mvhline(1, 0, ' ', cols);
-    mvhline(3, 0, ' ', cols);
+    char hint[160];
+    if (g_has_footer) snprintf(hint, sizeof(hint), "%s", g_footer);
+    else snprintf(hint, sizeof(hint), "Auto-refresh %s — 'r' refrescar, 'b' barras, 'h' mapa de calor, 's' orden top, 'm' orden procesos, 'e' estadísticas, 'q' salir", g_period);
 
+    canvas_clear(&g_screen);
     int title_x = (cols - (int)strlen(title)) / 2;
     int sub_x   = (cols - (int)strlen(subtitle)) / 2;
-
-    if (has_colors()) attron(COLOR_PAIR(1) | A_BOLD);
-    mvprintw(1, title_x > 0 ? title_x : 0, "%s", title);
-    if (has_colors()) attroff(COLOR_PAIR(1) | A_BOLD);
-
-    if (has_colors()) attron(COLOR_PAIR(2));
-    mvprintw(3, sub_x > 0 ? sub_x : 0, "%s", subtitle);
-    if (has_colors()) attroff(COLOR_PAIR(2));
+    canvas_text(&g_screen, 1, title_x > 0 ? title_x : 0, ST_TITLE, title);
+    canvas_text(&g_screen, 3, sub_x > 0 ? sub_x : 0, ST_SUBTITLE, subtitle);
 
     // Timestamp
-    time_t now = time(NULL); struct tm *tm = localtime(&now);
+    time_t now = g_clock ? g_clock : time(NULL); struct tm *tm = localtime(&now);
     char ts[32]; strftime(ts, sizeof(ts), "%Y-%m-%d %H:%M:%S", tm);
-    mvprintw(1, cols - (int)strlen(ts) - 2, "%s", ts);
+    canvas_text(&g_screen, 1, cols - (int)strlen(ts) - 2, CV_PLAIN, ts);
+
+    // Alertas a la izquierda del título (se recortan antes de pisarlo)
+    if (g_alert_rules > 0 && title_x > 4) {
+        char al[96];
+        if (g_alert_firing > 0)
+            snprintf(al, sizeof(al), "ALERTA (%d): %s", g_alert_firing, g_alert_last);
+        else
+            snprintf(al, sizeof(al), "alertas: OK (%d reglas)", g_alert_rules);
+        int room = title_x - 4;
+        if ((int)strlen(al) > room) al[room] = '\0';
+        canvas_text(&g_screen, 1, 2, g_alert_firing > 0 ? CV_STYLE(4, 1) : ST_SUBTITLE, al);
+    }
 
     // -------- Si no hay ventanas (terminal pequeña) → fallback en stdscr --------
-    if (!g_win_mem || !g_win_cpu) {
-        int y = 5;
-        // Limpia zona de contenido hasta el pie
-        for (int r = y; r < rows - 2; ++r) mvhline(r, 0, ' ', cols);
-
-        char installed[64], t_total[64], t_used[64], t_avail[64], s_total[64], s_used[64], s_free[64];
-        format_bytes_from_kib(mem->total_kib,      installed, sizeof(installed));
-        format_bytes_from_kib(mem->total_kib,      t_total,   sizeof(t_total));
-        format_bytes_from_kib(mem->used_kib,       t_used,    sizeof(t_used));
-        format_bytes_from_kib(mem->avail_kib,      t_avail,   sizeof(t_avail));
-        format_bytes_from_kib(mem->swap_total_kib, s_total,   sizeof(s_total));
-        format_bytes_from_kib(mem->swap_used_kib,  s_used,    sizeof(s_used));
-        format_bytes_from_kib(mem->swap_free_kib,  s_free,    sizeof(s_free));
-
-        mvprintw(y++, 2, "Instalada: %s", installed);
-        mvprintw(y++, 2, "RAM:  total %s | usada %s | disp. %s | uso %.1f%%",
-                 t_total, t_used, t_avail, mem->used_ratio * 100.0);
-        draw_bar(y++, 2, cols - 4, mem->used_ratio);
-        mvprintw(y++, 2, "SWAP: total %s | usada %s | libre %s | uso %.1f%%",
-                 s_total, s_used, s_free,
-                 (mem->swap_total_kib > 0 ? mem->swap_used_ratio * 100.0 : 0.0));
-        draw_bar(y++, 2, cols - 4, (mem->swap_total_kib > 0) ? mem->swap_used_ratio : 0.0);
-
-        mvprintw(y++, 2, "CPU: %s  (SoC: %s, Arch: %s)", info->model, info->hardware, info->arch);
-        mvprintw(y++, 2, "Núcleos: en línea %d / configurados %d", info->cores_online, info->cores_config);
-        if (!usage->ready) {
-            mvprintw(y++, 2, "Cargas por núcleo: calculando…");
-        } else {
-            mvprintw(y++, 2, "Cargas por núcleo (promedio: %.1f%%):", usage->avg * 100.0);
-            for (int i = 0; i < usage->cores && y < rows - 3; ++i) {
-                char label[32];
-                snprintf(label, sizeof(label), "core %d: %5.1f%%", i, usage->per_core[i] * 100.0);
-                mvprintw(y, 2, "%s", label);
-                int bx = 2 + (int)strlen(label) + 2;
-                draw_bar(y, bx, cols - bx - 2, usage->per_core[i]);
-                y++;
-            }
+    if (!g_mem.win || !g_cpu.win) {
+        draw_memory_lines(&g_screen, 5, 2, 12, cols - 4, mem);
+        draw_cpu_lines(&g_screen, 12, 2, rows - 3, 1, info, usage);
+        canvas_fill(&g_screen, rows - 2, 0, cols, L' ', CV_PLAIN);   // el pie gana
+        canvas_text(&g_screen, rows - 2, 2, CV_PLAIN, hint);
+        return;
+    }
+
+    // -------- Con paneles persistentes: solo se emiten las celdas que cambiaron --------
+    canvas_text(&g_screen, rows - 2, 2, CV_PLAIN, hint);
+    canvas_clear(&g_mem.cv);
+    int inner_bar_w = g_mem.cv.cols - 4; if (inner_bar_w < 10) inner_bar_w = 10;
+    draw_memory_lines(&g_mem.cv, 1, 2, g_mem.cv.y0 + g_mem.cv.rows, inner_bar_w, mem);
+
+    canvas_clear(&g_cpu.cv);
+    draw_cpu_lines(&g_cpu.cv, 1, 2, g_cpu.cv.y0 + g_cpu.cv.rows, !g_sched.win, info, usage);
+
+    if (g_sched.win) {
+        canvas_clear(&g_sched.cv);
+        int sx = cv_sched_line(&g_sched.cv, 1, 2, usage) + 2;
+        // Con ancho de sobra: tendencia de ctxt/s (escala = máximo de la ventana)
+        int ssw = spark_width(cv_right(&g_sched.cv) - sx - 7, 40);
+        if (ssw) {
+            sx = canvas_text(&g_sched.cv, 1, sx, ST_SUBTITLE, "ctxt/s ");
+            cv_sparkline(&g_sched.cv, 1, sx, ssw, history_series(g_hist, HIST_CTXT_PER_S), 0.0, 0);
         }
+    }
+
+    if (g_cg.win) {
+        canvas_clear(&g_cg.cv);
+        if (g_cgroup) draw_cgroup_panel(&g_cg.cv, g_cgroup, usage->ready ? usage->online_count : info->cores_online);
+    }
+    if (g_psi.win) {
+        canvas_clear(&g_psi.cv);
+        if (g_psi_stats) draw_psi_panel(&g_psi.cv, g_psi_stats);
+    }
+    if (g_proc.win) {
+        canvas_clear(&g_proc.cv);
+        if (g_procs) draw_proc_panel(&g_proc.cv, g_procs, mem);
+    }
+    if (g_disk.win) {
+        canvas_clear(&g_disk.cv);
+        if (g_disks) draw_disk_panel(&g_disk.cv, g_disks);
+    }
+    if (g_net.win) {
+        canvas_clear(&g_net.cv);
+        if (g_nets) draw_net_panel(&g_net.cv, g_nets);
+    }
+    if (g_irq.win) {
+        canvas_clear(&g_irq.cv);
+        if (g_irq_stats) draw_irq_panel(&g_irq.cv, g_irq_stats, usage);
+    }
+}
 
-        mvprintw(rows - 2, 2, "%s", hint);
+void tui_present(void) {
+    canvas_flush(&g_screen);
+    if (!g_mem.win || !g_cpu.win) {
         // Un solo “blit”
         wnoutrefresh(stdscr); doupdate();
         return;
     }
 
-    // -------- Con ventanas persistentes (sin flicker) --------
-    // Limpia solo el interior de cada panel
-    werase(g_win_mem); werase(g_win_cpu);
-    box(g_win_mem, 0, 0); box(g_win_cpu, 0, 0);
-    if (has_colors()) wattron(g_win_mem, COLOR_PAIR(5) | A_BOLD);
-    mvwprintw(g_win_mem, 0, 2, "[ Memoria ]");
-    if (has_colors()) wattroff(g_win_mem, COLOR_PAIR(5) | A_BOLD);
-    if (has_colors()) wattron(g_win_cpu, COLOR_PAIR(5) | A_BOLD);
-    mvwprintw(g_win_cpu, 0, 2, "[ CPU ]");
-    if (has_colors()) wattroff(g_win_cpu, COLOR_PAIR(5) | A_BOLD);
+    canvas_flush(&g_mem.cv);
+    canvas_flush(&g_cpu.cv);
+    if (g_sched.win) canvas_flush(&g_sched.cv);
+    if (g_cg.win) canvas_flush(&g_cg.cv);
+    if (g_psi.win) canvas_flush(&g_psi.cv);
+    if (g_proc.win) canvas_flush(&g_proc.cv);
+    if (g_disk.win) canvas_flush(&g_disk.cv);
+    if (g_net.win) canvas_flush(&g_net.cv);
+    if (g_irq.win) canvas_flush(&g_irq.cv);
+
+    // Composición: stdscr primero (los paneles van encima) y un solo “blit”
+    wnoutrefresh(stdscr);
+    wnoutrefresh(g_mem.win);
+    wnoutrefresh(g_cpu.win);
+    if (g_sched.win) wnoutrefresh(g_sched.win);
+    if (g_cg.win) wnoutrefresh(g_cg.win);
+    if (g_psi.win) wnoutrefresh(g_psi.win);
+    if (g_proc.win) wnoutrefresh(g_proc.win);
+    if (g_disk.win) wnoutrefresh(g_disk.win);
+    if (g_net.win) wnoutrefresh(g_net.win);
+    if (g_irq.win) wnoutrefresh(g_irq.win);
+    doupdate();
+}
 
-    // Dimensiones útiles
-    int wrows, wcols; getmaxyx(g_win_mem, wrows, wcols);
-    int wy = 1;
-    int inner_bar_w = wcols - 4 - 2; if (inner_bar_w < 10) inner_bar_w = 10;
 
-    // --- Memoria ---
-    char installed[64], t_total[64], t_used[64], t_avail[64], s_total[64], s_used[64], s_free[64];
-    format_bytes_from_kib(mem->total_kib,      installed, sizeof(installed));
-    format_bytes_from_kib(mem->total_kib,      t_total,   sizeof(t_total));
-    format_bytes_from_kib(mem->used_kib,       t_used,    sizeof(t_used));
-    format_bytes_from_kib(mem->avail_kib,      t_avail,   sizeof(t_avail));
-    format_bytes_from_kib(mem->swap_total_kib, s_total,   sizeof(s_total));
-    format_bytes_from_kib(mem->swap_used_kib,  s_used,    sizeof(s_used));
-    format_bytes_from_kib(mem->swap_free_kib,  s_free,    sizeof(s_free));
+// ==================== Periodo / modo de barras ====================
 
-    mvwprintw(g_win_mem, wy++, 2, "Instalada: %-10s", installed);
-    mvwprintw(g_win_mem, wy++, 2, "RAM:   total %10s | usada %10s | disp. %10s | uso %5.1f%%",
-              t_total, t_used, t_avail, mem->used_ratio * 100.0);
-    draw_bar_win(g_win_mem, wy++, 2, inner_bar_w, mem->used_ratio);
-    wy++;
-    mvwprintw(g_win_mem, wy++, 2, "SWAP:  total %10s | usada %10s | libre %10s | uso %5.1f%%",
-              s_total, s_used, s_free,
-              (mem->swap_total_kib > 0 ? mem->swap_used_ratio * 100.0 : 0.0));
-    draw_bar_win(g_win_mem, wy++, 2, inner_bar_w, (mem->swap_total_kib > 0) ? mem->swap_used_ratio : 0.0);
-
-    // --- CPU ---
-    getmaxyx(g_win_cpu, wrows, wcols);
-    wy = 1;
-    mvwprintw(g_win_cpu, wy++, 2, "CPU: %s  (SoC: %s, Arch: %s)", info->model, info->hardware, info->arch);
-    mvwprintw(g_win_cpu, wy++, 2, "Núcleos: en línea %d / configurados %d", info->cores_online, info->cores_config);
+void tui_set_refresh_interval_ms(int ms) {
+    if (ms % 1000 == 0) snprintf(g_period, sizeof(g_period), "%d s", ms / 1000);
+    else                snprintf(g_period, sizeof(g_period), "%d ms", ms);
+}
 
-    if (!usage->ready) {
-        mvwprintw(g_win_cpu, wy++, 2, "Cargas por núcleo: calculando… (espera un ciclo)");
-    } else {
-        mvwprintw(g_win_cpu, wy++, 2, "Cargas por núcleo (promedio: %.1f%%):", usage->avg * 100.0);
-        for (int i = 0; i < usage->cores && wy < wrows - 1; ++i) {
-            char label[32];
-            snprintf(label, sizeof(label), "core %d: %5.1f%%", i, usage->per_core[i] * 100.0);
-            mvwprintw(g_win_cpu, wy, 2, "%s", label);
-            int bx = 2 + (int)strlen(label) + 2;
-            int bw = wcols - bx - 2; if (bw < 10) bw = 10;
-            draw_bar_win(g_win_cpu, wy, bx, bw, usage->per_core[i]);
-            wy++;
-        }
+void tui_set_history(const History *h) { g_hist = h; }
+
+void tui_set_stats(const Stats *st) {
+    g_stats = st;
+    memset(g_sum, 0, sizeof(g_sum));
+    free(g_core_sum);
+    g_core_sum_n = 0;
+    // Sin memoria: los cores quedan "sin estadísticas aún"
+    g_core_sum = (st && st->cores > 0) ? calloc((size_t)st->cores, sizeof(*g_core_sum)) : NULL;
+    if (g_core_sum) g_core_sum_n = st->cores;
+}
+
+void tui_take_stats(void) {
+    for (int s = 0; s < STATS_SERIES_COUNT; ++s)
+        if (!g_stats || stats_summary(g_stats, (StatsSeries)s, &g_sum[s]) != 0) g_sum[s].count = 0;
+    // Los de cada core solo se dibujan con 'e': el resto del tiempo no se calculan
+    for (int i = 0; i < g_core_sum_n; ++i)
+        if (!g_core_stats || stats_core_summary(g_stats, i, &g_core_sum[i]) != 0) g_core_sum[i].count = 0;
+}
+void tui_set_core_stats(int on) { g_core_stats = on; }
+int  tui_get_core_stats(void) { return g_core_stats; }
+
+void tui_set_disk_stats(const DiskStats *d) {
+    g_disks = d;
+    int want = 0;
+    if (d) want = d->count < 1 ? 1 : (d->count > DISK_PANEL_ROWS ? DISK_PANEL_ROWS : d->count);
+    if (want != g_disk_want) {
+        g_disk_want = want;
+        g_need_full = 1;
     }
+}
 
-    // Pie de página
-    mvhline(rows - 2, 0, ' ', cols);
-    mvprintw(rows - 2, 2, "%s", hint);
+void tui_set_net_stats(const NetStats *n) {
+    g_nets = n;
+    int want = 0;
+    if (n) want = n->count < 1 ? 1 : (n->count > NET_PANEL_ROWS ? NET_PANEL_ROWS : n->count);
+    if (want != g_net_want) {
+        g_net_want = want;
+        g_need_full = 1;
+    }
+}
 
-    // Composición: todas las ventanas al “off-screen buffer”… y un solo “blit”
-    wnoutrefresh(g_win_mem);
-    wnoutrefresh(g_win_cpu);
-    wnoutrefresh(stdscr);
-    doupdate();
+void tui_set_psi_stats(const PsiStats *p) {
+    g_psi_stats = p;
+    int want = 0;
+    if (p) for (int r = 0; r < PSI_COUNT; ++r) want += p->res[r].available ? 1 : 0;
+    if (want != g_psi_want) {
+        g_psi_want = want;
+        g_need_full = 1;
+    }
+}
+
+void tui_set_proc_stats(const ProcStats *p) {
+    g_procs = p;
+    int want = 0;
+    if (p) want = p->total < PROC_PANEL_MIN ? PROC_PANEL_MIN : (p->total > PROC_TOP ? PROC_TOP : p->total);
+    if (want != g_proc_want) {
+        g_proc_want = want;
+        g_need_full = 1;
+    }
+}
+
+void tui_set_thermal_stats(const ThermalStats *t) { g_thermal = t; }
+
+void tui_set_cgroup_stats(const CgroupStats *c) {
+    // El título de Memoria cambia con el modo: también rehace el layout
+    int want = 0;
+    if (c) want = 3 + (c->nchildren > CGROUP_PANEL_CHILDREN ? CGROUP_PANEL_CHILDREN : c->nchildren);
+    if (want != g_cg_want || (c != NULL) != (g_cgroup != NULL)) {
+        g_cg_want = want;
+        g_need_full = 1;
+    }
+    g_cgroup = c;
+}
+
+void tui_set_irq_stats(const IrqStats *s) {
+    g_irq_stats = s;
+    // Filas fijas por máquina (no por muestra) para no rehacer el layout
+    int want = 0;
+    if (s) want = 1 + (s->ncpus < 1 ? 1 : (s->ncpus > IRQ_HOT_MAX ? IRQ_HOT_MAX : s->ncpus));
+    if (want != g_irq_want) {
+        g_irq_want = want;
+        g_need_full = 1;
+    }
+}
+
+void tui_set_proc_sort(TuiProcSort sort) { g_proc_sort = sort; }
+TuiProcSort tui_get_proc_sort(void) { return g_proc_sort; }
+
+void tui_set_footer(const char *text) {
+    g_has_footer = (text != NULL);
+    if (text) snprintf(g_footer, sizeof(g_footer), "%s", text);
 }
 
+void tui_set_clock(time_t t) { g_clock = t; }
+
+void tui_set_alerts(int rules, int firing, const char *last) {
+    g_alert_rules = rules;
+    g_alert_firing = firing;
+    snprintf(g_alert_last, sizeof(g_alert_last), "%s", last ? last : "");
+}
+
+void tui_set_cpu_bar_mode(TuiCpuBarMode mode) { g_cpu_bar_mode = mode; }
+TuiCpuBarMode tui_get_cpu_bar_mode(void) { return g_cpu_bar_mode; }
+
+void tui_set_cpu_view(TuiCpuView view) { g_cpu_view = view; }
+TuiCpuView tui_get_cpu_view(void) { return g_cpu_view; }
+
+void tui_cycle_heatmap_sort(void) {
+    g_heat_sort = (TuiHeatSort)((g_heat_sort + 1) % TUI_HEAT_SORT_COUNT);
+}
 
 // ==================== Entrada con timeout ====================
 
-int tui_getch(void) { return getch(); }
+int tui_getch(void) {
+    int ch = getch();
+    switch (ch) {
+    case KEY_LEFT:  return TUI_KEY_LEFT;
+    case KEY_RIGHT: return TUI_KEY_RIGHT;
+    case KEY_PPAGE: return TUI_KEY_PGUP;
+    case KEY_NPAGE: return TUI_KEY_PGDN;
+    case KEY_HOME:  return TUI_KEY_HOME;
+    case KEY_END:   return TUI_KEY_END;
+    default:        return ch;
+    }
+}
 int tui_was_timeout(int ch) { return (ch == ERR); }
 void tui_set_timeout_ms(int ms) { timeout(ms); }
 
@@ -353,9 +813,26 @@ static void draw_bar(int y, int x, int width, double ratio) {
     for (int i = fill; i < width - 2; ++i) mvprintw(y, x + 1 + i, " ");
 }
 
-// Versión que escribe en una ventana (panel)
-static void draw_bar_win(WINDOW *w, int y, int x, int width, double ratio) {
-    if (!w || width <= 4) return;
+// Columna siguiente a la última dibujable del canvas (sin pisar el borde)
+static int cv_right(const Canvas *cv) {
+    return cv->x0 + cv->cols - 1;
+}
+
+static unsigned short ratio_style(double ratio) {
+    short pair = 3; // verde
+    if (ratio >= 0.90) pair = 4;        // rojo
+    else if (ratio >= 0.70) pair = 2;   // amarillo
+    return CV_STYLE(pair, 1);
+}
+
+// Versión sobre canvas (paneles y fallback del dashboard)
+static void cv_bar(Canvas *cv, int y, int x, int width, double ratio) {
+    cv_bar_styled(cv, y, x, width, ratio, ratio_style(ratio));
+}
+
+// Igual, con el color decidido por el llamador (umbrales propios de la métrica)
+static void cv_bar_styled(Canvas *cv, int y, int x, int width, double ratio, unsigned short style) {
+    if (width <= 4) return;
     if (ratio < 0.0) ratio = 0.0;
     if (ratio > 1.0) ratio = 1.0;
 
@@ -363,16 +840,827 @@ static void draw_bar_win(WINDOW *w, int y, int x, int width, double ratio) {
     if (fill < 0) fill = 0;
     if (fill > width - 2) fill = width - 2;
 
-    mvwprintw(w, y, x, "[");
-    mvwprintw(w, y, x + width - 1, "]");
+    canvas_put(cv, y, x, L'[', CV_PLAIN);
+    canvas_put(cv, y, x + width - 1, L']', CV_PLAIN);
+    canvas_fill(cv, y, x + 1, fill, L'#', style);
+    // el resto ya está en blanco tras canvas_clear()
+}
 
-    short pair = 3; // verde
-    if (ratio >= 0.90) pair = 4;        // rojo
-    else if (ratio >= 0.70) pair = 2;   // amarillo
+// ==================== Barras apiladas (desglose por estado) ====================
+
+// Segmentos en orden de dibujo: carácter, par de color y etiqueta.
+// El carácter distinto por estado mantiene el desglose legible sin colores.
+typedef struct { wchar_t ch; short pair; const char *label; } TimeSeg;
+static const TimeSeg k_time_segs[] = {
+    { L'u', 3, "usr"   },
+    { L'n', 5, "nice"  },
+    { L's', 4, "sys"   },
+    { L'i', 6, "irq"   },
+    { L'q', 1, "sirq"  },
+    { L't', 7, "steal" },
+    { L'w', 2, "iow"   },
+};
+#define N_TIME_SEGS ((int)(sizeof(k_time_segs) / sizeof(k_time_segs[0])))
+
+static void times_to_array(const CPUTimes *t, double v[N_TIME_SEGS]) {
+    v[0] = t->user; v[1] = t->nice; v[2] = t->system; v[3] = t->irq;
+    v[4] = t->softirq; v[5] = t->steal; v[6] = t->iowait;
+}
+
+// Barra apilada genérica: 'v[k]' es la fracción [0..1] del segmento k.
+static void cv_seg_bar(Canvas *cv, int y, int x, int width, const TimeSeg *segs, const double *v, int n) {
+    if (width <= 4) return;
+    int inner = width - 2;
+
+    canvas_put(cv, y, x, L'[', CV_PLAIN);
+    canvas_put(cv, y, x + width - 1, L']', CV_PLAIN);
+
+    // Redondeo acumulado: los segmentos nunca suman más que el ancho interior.
+    double acc = 0.0;
+    int col = 0;
+    for (int k = 0; k < n; ++k) {
+        acc += v[k];
+        int end = (int)(acc * (double)inner + 0.5);
+        if (end > inner) end = inner;
+        if (end <= col) continue;
+        canvas_fill(cv, y, x + 1 + col, end - col, segs[k].ch, CV_STYLE(segs[k].pair, 1));
+        col = end;
+    }
+}
+
+static void cv_stacked_bar(Canvas *cv, int y, int x, int width, const CPUTimes *t) {
+    double v[N_TIME_SEGS];
+    times_to_array(t, v);
+    cv_seg_bar(cv, y, x, width, k_time_segs, v, N_TIME_SEGS);
+}
+
+// Línea "u usr 12.3%  s sys 4.0% …" con el desglose agregado; sirve de leyenda.
+static void cv_times_legend(Canvas *cv, int y, int x, const CPUTimes *t) {
+    double v[N_TIME_SEGS];
+    times_to_array(t, v);
+    int max_x = cv_right(cv);
+    for (int k = 0; k < N_TIME_SEGS; ++k) {
+        char item[32];
+        int n = snprintf(item, sizeof(item), " %s %.1f%%", k_time_segs[k].label, v[k] * 100.0);
+        if (x + 1 + n > max_x) break;
+        canvas_put(cv, y, x, k_time_segs[k].ch, CV_STYLE(k_time_segs[k].pair, 1));
+        canvas_text(cv, y, x + 1, CV_PLAIN, item);
+        x += 1 + n + 2;
+    }
+}
+
+// Desglose de la RAM: a qué se va la memoria (fracciones de MemTotal).
+// "otros" es lo usado que meminfo no atribuye (drivers, vmalloc, etc.);
+// el hueco final de la barra es la memoria libre.
+static const TimeSeg k_mem_segs[] = {
+    { L'a', 4, "apps"   },   // AnonPages
+    { L's', 6, "shmem"  },   // Shmem (tmpfs, memoria compartida)
+    { L'k', 2, "kernel" },   // Slab + KernelStack + PageTables
+    { L'c', 1, "caché"  },   // Cached - Shmem + Buffers
+    { L'o', 7, "otros"  },
+};
+#define N_MEM_SEGS ((int)(sizeof(k_mem_segs) / sizeof(k_mem_segs[0])))
+
+static void mem_to_kib(const MemStats *m, long kib[N_MEM_SEGS]) {
+    long cache = m->cached_kib - m->shmem_kib + m->buffers_kib;
+    kib[0] = m->anon_kib;
+    kib[1] = m->shmem_kib;
+    kib[2] = m->slab_kib + m->kernel_stack_kib + m->page_tables_kib;
+    kib[3] = cache > 0 ? cache : 0;
+    long other = m->total_kib - m->free_kib - kib[0] - kib[1] - kib[2] - kib[3];
+    kib[4] = other > 0 ? other : 0;
+}
+
+static void cv_mem_breakdown(Canvas *cv, int y, int x, int width, const MemStats *m) {
+    long kib[N_MEM_SEGS];
+    double v[N_MEM_SEGS];
+    mem_to_kib(m, kib);
+    for (int k = 0; k < N_MEM_SEGS; ++k)
+        v[k] = m->total_kib > 0 ? (double)kib[k] / (double)m->total_kib : 0.0;
+    cv_seg_bar(cv, y, x, width, k_mem_segs, v, N_MEM_SEGS);
+}
+
+static void cv_mem_legend(Canvas *cv, int y, int x, const MemStats *m) {
+    long kib[N_MEM_SEGS];
+    mem_to_kib(m, kib);
+    int max_x = cv_right(cv);
+    for (int k = 0; k < N_MEM_SEGS; ++k) {
+        char size[32];
+        format_bytes_from_kib(kib[k], size, sizeof(size));
+        // etiqueta + tamaño: a lo sumo 7 + 1 + 11 columnas
+        if (x + 2 + 7 + 1 + (int)strlen(size) > max_x) break;
+        canvas_put(cv, y, x, k_mem_segs[k].ch, CV_STYLE(k_mem_segs[k].pair, 1));
+        int cx = canvas_text(cv, y, x + 2, CV_PLAIN, k_mem_segs[k].label);
+        cx = canvas_text(cv, y, cx + 1, CV_PLAIN, size);
+        x = cx + 3;
+    }
+}
+
+// Escritura pendiente, compromiso de memoria y hugepages (si hay reservadas).
+static void cv_mem_details(Canvas *cv, int y, int x, const MemStats *m) {
+    char dirty[32], wb[32], cas[32], lim[32], line[96];
+    format_bytes_from_kib(m->dirty_kib,        dirty, sizeof(dirty));
+    format_bytes_from_kib(m->writeback_kib,    wb,    sizeof(wb));
+    format_bytes_from_kib(m->committed_kib,    cas,   sizeof(cas));
+    format_bytes_from_kib(m->commit_limit_kib, lim,   sizeof(lim));
+
+    snprintf(line, sizeof(line), "Sucias %s | writeback %s | ", dirty, wb);
+    int cx = canvas_text(cv, y, x, CV_PLAIN, line);
+    snprintf(line, sizeof(line), "commit %s / %s", cas, lim);
+    cx = canvas_text(cv, y, cx, CV_PLAIN, line);
+    if (m->commit_limit_kib > 0) {
+        // Committed_AS puede pasar el límite: el kernel sobrecompromete
+        double r = (double)m->committed_kib / (double)m->commit_limit_kib;
+        char pct[16];
+        snprintf(pct, sizeof(pct), " (%.0f%%)", r * 100.0);
+        cx = canvas_text(cv, y, cx, ratio_style(r), pct);
+    }
+    if (m->huge_total > 0) {
+        char hsz[32];
+        format_bytes_from_kib(m->huge_page_kib, hsz, sizeof(hsz));
+        snprintf(line, sizeof(line), " | hugepages %ld/%ld libres de %s",
+                 m->huge_free, m->huge_total, hsz);
+        canvas_text(cv, y, cx, CV_PLAIN, line);
+    }
+}
+
+// Barra de un core según el modo activo.
+static void cv_core_bar(Canvas *cv, int y, int x, int width, const CPUUsage *usage, int i) {
+    if (g_cpu_bar_mode == TUI_CPU_BARS_STACKED)
+        cv_stacked_bar(cv, y, x, width, &usage->times[i]);
+    else
+        cv_bar(cv, y, x, width, usage->per_core[i]);
+}
+
+// ==================== Discos ====================
+
+// Bytes/s en 7 columnas: "  812 B", "512.0 K", " 12.3 M", "  1.2 G"
+static void fmt_bps(double bps, char *buf, size_t n) {
+    static const char unit[] = { 'B', 'K', 'M', 'G', 'T' };
+    int u = 0;
+    while (bps >= 1000.0 && u < 4) { bps /= 1024.0; u++; }
+    if (u == 0) snprintf(buf, n, "%5.0f %c", bps, unit[u]);
+    else        snprintf(buf, n, "%5.1f %c", bps, unit[u]);
+}
+
+// Operaciones/s: con decimal solo si es chico
+static void fmt_iops(double v, char *buf, size_t n) {
+    if (v < 1000.0) snprintf(buf, n, "%7.1f", v);
+    else            snprintf(buf, n, "%7.0f", v);
+}
+
+// Espera media: amarilla desde 50 ms, roja desde 200 ms (la tarjeta SD se atasca)
+static unsigned short await_style(double ms) {
+    if (ms >= 200.0) return CV_STYLE(4, 1);
+    if (ms >= 50.0)  return CV_STYLE(2, 1);
+    return CV_PLAIN;
+}
+
+#define DISK_COL_UTIL 63   // columna (relativa a x) donde empieza "util"
+
+static void draw_disk_panel(Canvas *cv, const DiskStats *d) {
+    const int x = 2;
+    int y = 1;
+    const int y_end = cv->y0 + cv->rows;
+    const int right = cv_right(cv);
+    int rows = y_end - y - 1;
+    if (rows <= 0) return;
+
+    canvas_text(cv, y, x, ST_SUBTITLE,
+                "disco     lect/s  escr/s   leído escrito espera  serv.  cola   util");
+
+    // Con más discos que filas se muestran los más ocupados, en su orden original
+    int idx[DISK_MAX], n = d->count;
+    for (int i = 0; i < n; ++i) idx[i] = i;
+    if (n > rows) {
+        for (int k = 0; k < rows; ++k) {
+            int best = k;
+            for (int i = k + 1; i < n; ++i) {
+                const DiskDev *a = &d->dev[idx[i]], *b = &d->dev[idx[best]];
+                if (a->util > b->util || (a->util == b->util && a->r_bps + a->w_bps > b->r_bps + b->w_bps)) best = i;
+            }
+            int t = idx[k]; idx[k] = idx[best]; idx[best] = t;
+        }
+        n = rows;
+        for (int i = 1; i < n; ++i)
+            for (int j = i; j > 0 && idx[j - 1] > idx[j]; --j) { int t = idx[j]; idx[j] = idx[j - 1]; idx[j - 1] = t; }
+    }
+    int hidden = d->count - n + d->omitted;
+    if (d->untracked > 0)
+        canvas_printf(cv, y, right - 22, CV_STYLE(4, 1), "+%d más, %d sin seguir", hidden + d->untracked, d->untracked);
+    else if (hidden > 0) canvas_printf(cv, y, right - 8, CV_PLAIN, "+%d más", hidden);
+    if (d->count == 0) canvas_text(cv, y + 1, x, CV_PLAIN, "Sin discos en /proc/diskstats");
+
+    for (int k = 0; k < n; ++k) {
+        const DiskDev *v = &d->dev[idx[k]];
+        int ry = y + 1 + k;
+        canvas_printf(cv, ry, x, CV_PLAIN, "%-8.8s", v->name);
+        if (!d->ready || !v->ready) {
+            canvas_text(cv, ry, x + 10, CV_PLAIN, "calculando…");
+            continue;
+        }
+        char r_iops[16], w_iops[16], r_bps[16], w_bps[16];
+        fmt_iops(v->r_iops, r_iops, sizeof(r_iops));
+        fmt_iops(v->w_iops, w_iops, sizeof(w_iops));
+        fmt_bps(v->r_bps, r_bps, sizeof(r_bps));
+        fmt_bps(v->w_bps, w_bps, sizeof(w_bps));
+        canvas_printf(cv, ry, x + 8, CV_PLAIN, " %7s %7s %7s %7s", r_iops, w_iops, r_bps, w_bps);
+
+        // Espera ponderada por operaciones (await de iostat, lecturas + escrituras)
+        double ops = v->r_iops + v->w_iops;
+        double await = ops > 0 ? (v->r_await_ms * v->r_iops + v->w_await_ms * v->w_iops) / ops : 0.0;
+        canvas_printf(cv, ry, x + 40, await_style(await), "%7.1f", await);
+        canvas_printf(cv, ry, x + 47, CV_PLAIN, " %6.2f %5.2f", v->svc_ms, v->queue);
+
+        int ux = x + DISK_COL_UTIL;
+        int rem = right - ux + 1;
+        if (rem >= 14) {
+            cv_bar(cv, ry, ux, rem - 7, v->util);
+            canvas_printf(cv, ry, right - 5, ratio_style(v->util), "%5.1f%%", v->util * 100.0);
+        } else {
+            canvas_printf(cv, ry, ux, ratio_style(v->util), "%5.1f%%", v->util * 100.0);
+        }
+    }
+}
+
+// ==================== Red ====================
+
+// Bits/s (decimal, como se miden los enlaces) en 7 columnas: "123.4 M"
+static void fmt_bits(double bytes_ps, char *buf, size_t n) {
+    static const char unit[] = { ' ', 'k', 'M', 'G', 'T' };
+    double v = bytes_ps * 8.0;
+    int u = 0;
+    while (v >= 1000.0 && u < 4) { v /= 1000.0; u++; }
+    if (u == 0) snprintf(buf, n, "%5.0f  ", v);
+    else        snprintf(buf, n, "%5.1f %c", v, unit[u]);
+}
+
+// Velocidad de enlace compacta: "100M", "1G", "2.5G"
+static void fmt_link(int mbps, char *buf, size_t n) {
+    if (mbps >= 1000 && mbps % 1000 == 0) snprintf(buf, n, "%dG", mbps / 1000);
+    else if (mbps >= 1000)                snprintf(buf, n, "%.1fG", (double)mbps / 1000.0);
+    else                                  snprintf(buf, n, "%dM", mbps);
+}
+
+#define NET_COL_LINK 58   // columna (relativa a x) donde empieza "enlace"
+
+static void draw_net_panel(Canvas *cv, const NetStats *n) {
+    const int x = 2;
+    int y = 1;
+    const int y_end = cv->y0 + cv->rows;
+    const int right = cv_right(cv);
+    int rows = y_end - y - 1;
+    if (rows <= 0) return;
+
+    canvas_text(cv, y, x, ST_SUBTITLE,
+                "interfaz     rx/s    tx/s  rx pkt/s tx pkt/s  err/s drop/s  enlace");
+
+    // Con más interfaces que filas, las de más tráfico, en su orden original
+    int idx[NET_MAX], cnt = n->count;
+    for (int i = 0; i < cnt; ++i) idx[i] = i;
+    if (cnt > rows) {
+        for (int k = 0; k < rows; ++k) {
+            int best = k;
+            for (int i = k + 1; i < cnt; ++i) {
+                const NetIf *a = &n->ifs[idx[i]], *b = &n->ifs[idx[best]];
+                if (a->rx_bps + a->tx_bps > b->rx_bps + b->tx_bps) best = i;
+            }
+            int t = idx[k]; idx[k] = idx[best]; idx[best] = t;
+        }
+        cnt = rows;
+        for (int i = 1; i < cnt; ++i)
+            for (int j = i; j > 0 && idx[j - 1] > idx[j]; --j) { int t = idx[j]; idx[j] = idx[j - 1]; idx[j - 1] = t; }
+    }
+    int hidden = n->count - cnt + n->omitted;
+    if (n->untracked > 0)
+        canvas_printf(cv, y, right - 22, CV_STYLE(4, 1), "+%d más, %d sin seguir", hidden + n->untracked, n->untracked);
+    else if (hidden > 0) canvas_printf(cv, y, right - 8, CV_PLAIN, "+%d más", hidden);
+    if (n->count == 0) canvas_text(cv, y + 1, x, CV_PLAIN, "Sin interfaces (aparte de lo)");
+
+    for (int k = 0; k < cnt; ++k) {
+        const NetIf *v = &n->ifs[idx[k]];
+        int ry = y + 1 + k;
+        canvas_printf(cv, ry, x, CV_PLAIN, "%-10.10s", v->name);
+        if (!n->ready || !v->ready) {
+            canvas_text(cv, ry, x + 12, CV_PLAIN, "calculando…");
+            continue;
+        }
+        char rx[16], tx[16];
+        fmt_bits(v->rx_bps, rx, sizeof(rx));
+        fmt_bits(v->tx_bps, tx, sizeof(tx));
+        canvas_printf(cv, ry, x + 10, CV_PLAIN, " %7s %7s %8.1f %8.1f", rx, tx, v->rx_pps, v->tx_pps);
+
+        // Errores y descartes: cualquiera distinto de 0 es noticia
+        double errs = v->rx_errs_ps + v->tx_errs_ps, drops = v->rx_drop_ps + v->tx_drop_ps;
+        canvas_printf(cv, ry, x + 44, errs > 0 ? CV_STYLE(4, 1) : CV_PLAIN, " %6.1f", errs);
+        canvas_printf(cv, ry, x + 51, drops > 0 ? CV_STYLE(2, 1) : CV_PLAIN, " %6.1f", drops);
+
+        // Ocupación del enlace: el sentido más cargado sobre la velocidad
+        int lx = x + NET_COL_LINK;
+        if (v->speed_mbps <= 0) { canvas_text(cv, ry, lx, CV_PLAIN, "  —"); continue; }
+        double peak = v->rx_bps > v->tx_bps ? v->rx_bps : v->tx_bps;
+        double util = peak * 8.0 / ((double)v->speed_mbps * 1e6);
+        if (util > 1.0) util = 1.0;
+        char link[16];
+        fmt_link(v->speed_mbps, link, sizeof(link));
+        int cx = canvas_printf(cv, ry, lx, CV_PLAIN, "%5s ", link);
+        int rem = right - cx + 1;
+        if (rem >= 14) {
+            cv_bar(cv, ry, cx, rem - 8, util);
+            canvas_printf(cv, ry, right - 6, ratio_style(util), "%5.1f%%", util * 100.0);
+        } else {
+            canvas_printf(cv, ry, cx, ratio_style(util), "%5.1f%%", util * 100.0);
+        }
+    }
+}
+
+// ==================== Interrupciones ====================
+
+// Eventos/s compactos en 6 columnas: "  812", "12.3k", " 1.2M"
+static void fmt_events(double v, char *buf, size_t n) {
+    if (v >= 1e6)      snprintf(buf, n, "%4.1fM", v / 1e6);
+    else if (v >= 1e4) snprintf(buf, n, "%4.0fk", v / 1e3);
+    else if (v >= 1e3) snprintf(buf, n, "%4.1fk", v / 1e3);
+    else               snprintf(buf, n, "%5.0f", v);
+}
+
+// Sin el relleno de fmt_events, para cifras dentro de una frase
+static const char *trim_left(const char *s) {
+    while (*s == ' ') s++;
+    return s;
+}
+
+static unsigned short irq_share_style(double share) {
+    if (share >= IRQ_SHARE_HOT)  return CV_STYLE(4, 1);
+    if (share >= IRQ_SHARE_WARN) return CV_STYLE(2, 1);
+    return CV_PLAIN;
+}
+
+static void draw_irq_panel(Canvas *cv, const IrqStats *iq, const CPUUsage *usage) {
+    const int x = 2;
+    int y = 1;
+    const int y_end = cv->y0 + cv->rows;
+    const int right = cv_right(cv);
+    if (y >= y_end) return;
+
+    canvas_text(cv, y, x, ST_SUBTITLE, "núcleo   irq/s  sirq/s  %irq+si  fuentes");
+    if (iq->ready) {
+        char a[16], b[16];
+        fmt_events(iq->irq_ps, a, sizeof(a));
+        fmt_events(iq->softirq_ps, b, sizeof(b));
+        canvas_printf(cv, y, x + 44, CV_PLAIN, "  total %s irq/s, %s softirq/s en %d núcleos",
+                      trim_left(a), trim_left(b), iq->ncpus);
+    }
+    if (!iq->ready) { if (y + 1 < y_end) canvas_text(cv, y + 1, x, CV_PLAIN, "calculando…"); return; }
+    if (iq->nhot == 0 && y + 1 < y_end) canvas_text(cv, y + 1, x, CV_PLAIN, "Sin interrupciones en el intervalo");
+
+    for (int i = 0; i < iq->nhot && y + 1 + i < y_end; ++i) {
+        const IrqHotCore *h = &iq->hot[i];
+        int ry = y + 1 + i;
+        char a[16], b[16];
+        fmt_events(h->irq_ps, a, sizeof(a));
+        fmt_events(h->softirq_ps, b, sizeof(b));
+        canvas_printf(cv, ry, x, CV_PLAIN, "cpu%-4d %6s  %6s", h->cpu, a, b);
+
+        // Tiempo del núcleo atendiendo interrupciones (de /proc/stat)
+        int sx = x + 24;
+        if (usage->ready && h->cpu < usage->cores && usage->state[h->cpu] == CPU_CORE_ONLINE) {
+            double share = usage->times[h->cpu].irq + usage->times[h->cpu].softirq;
+            canvas_printf(cv, ry, sx, irq_share_style(share), "%6.1f%%", share * 100.0);
+        } else {
+            canvas_text(cv, ry, sx + 6, CV_PLAIN, "—");
+        }
+
+        int tx = x + 33;
+        for (int k = 0; k < h->nsrc && tx < right; ++k) {
+            const IrqSource *src = &h->src[k];
+            fmt_events(src->rate, a, sizeof(a));
+            if (k) tx = canvas_text(cv, ry, tx, ST_SUBTITLE, " · ");
+            tx = canvas_printf(cv, ry, tx, src->softirq ? ST_SUBTITLE : CV_PLAIN, "%s", src->name);
+            tx = canvas_printf(cv, ry, tx + 1, CV_PLAIN, "%s", trim_left(a));
+        }
+    }
+}
 
-    if (has_colors()) wattron(w, COLOR_PAIR(pair) | A_BOLD);
-    for (int i = 0; i < fill; ++i) mvwprintw(w, y, x + 1 + i, "#");
-    if (has_colors()) wattroff(w, COLOR_PAIR(pair) | A_BOLD);
+// ==================== Presión (PSI) ====================
 
-    for (int i = fill; i < width - 2; ++i) mvwprintw(w, y, x + 1 + i, " ");
+// Umbrales en % de tiempo detenido: con "some" sostenido por encima del 10% la
+// carga ya se nota; por encima del 30% la máquina está al límite.
+static unsigned short psi_style(double pct) {
+    if (pct >= 30.0) return CV_STYLE(4, 1);
+    if (pct >= 10.0) return CV_STYLE(2, 1);
+    return CV_PLAIN;
+}
+
+// ---------- Térmica ----------
+// Cerca del punto "passive" el kernel ya empieza a bajar el reloj; sin puntos
+// de disparo se usan los umbrales del firmware de la Pi (80/85 °C).
+static unsigned short temp_style(const ThermalZone *z) {
+    double hot = z->passive_c > 0.0 ? z->passive_c : (z->crit_c > 0.0 ? z->crit_c - 15.0 : 80.0);
+    if (z->temp_c >= hot) return CV_STYLE(4, 1);
+    if (z->temp_c >= hot - 10.0) return CV_STYLE(2, 1);
+    return CV_PLAIN;
+}
+
+// "Temp: cpu-thermal 54.3°C  gpu 50.1°C | firmware: throttling" desde x;
+// devuelve la columna siguiente
+static int cv_thermal_summary(Canvas *cv, int y, int x, const ThermalStats *t) {
+    if (t->nzones > 0) x = canvas_text(cv, y, x, ST_SUBTITLE, "Temp:");
+    for (int i = 0; i < t->nzones; ++i) {
+        const ThermalZone *z = &t->zone[i];
+        x = canvas_printf(cv, y, x + (i ? 2 : 1), CV_PLAIN, "%s", z->type);
+        x = canvas_printf(cv, y, x + 1, temp_style(z), "%.1f°C", z->temp_c);
+    }
+    if (t->throttled <= 0) return x;
+    // Bits del firmware: los de "ahora" en rojo; si solo quedan los
+    // históricos, un aviso en amarillo
+    static const struct { int bit; const char *label; } k_now[] = {
+        { THROTTLE_UNDERVOLT, "subtensión" }, { THROTTLE_THROTTLED, "throttling" },
+        { THROTTLE_FREQ_CAPPED, "frec. limitada" }, { THROTTLE_SOFT_TEMP, "límite térmico" },
+    };
+    x = canvas_text(cv, y, x + 1, ST_SUBTITLE, "| firmware:");
+    int any = 0;
+    for (size_t k = 0; k < sizeof(k_now) / sizeof(k_now[0]); ++k) {
+        if (!(t->throttled & k_now[k].bit)) continue;
+        x = canvas_text(cv, y, x + 1, CV_STYLE(4, 1), k_now[k].label);
+        any = 1;
+    }
+    if (!any) x = canvas_text(cv, y, x + 1, CV_STYLE(2, 1), "hubo throttling desde el arranque");
+    return x;
+}
+
+// " 1.80GHz" / " 600MHz" (7 columnas) del reloj del núcleo i: rojo si está
+// frenado bajo carga, amarillo si el governor o el kernel le bajaron el tope.
+static int cv_core_freq(Canvas *cv, int y, int x, const CPUUsage *usage, int i) {
+    const FreqPolicy *fp = thermal_core_policy(g_thermal, i);
+    if (!fp || fp->cur_khz <= 0) return canvas_printf(cv, y, x, CV_PLAIN, "%7s", "");
+    long top = fp->hw_max_khz > 0 ? fp->hw_max_khz : fp->max_khz;
+    unsigned short st = CV_PLAIN;
+    if (top > 0 && usage->per_core[i] >= FREQ_LOAD_MIN && (double)fp->cur_khz < FREQ_SLOW_RATIO * (double)top)
+        st = CV_STYLE(4, 1);
+    else if (fp->hw_max_khz > 0 && fp->max_khz > 0 && fp->max_khz < fp->hw_max_khz)
+        st = CV_STYLE(2, 1);
+    if (fp->cur_khz >= 1000000)
+        return canvas_printf(cv, y, x, st, "%4.2fGHz", (double)fp->cur_khz / 1e6);
+    return canvas_printf(cv, y, x, st, "%4ldMHz", fp->cur_khz / 1000);
+}
+
+// ---------- Cgroup ----------
+// Barra + porcentaje al final de la fila desde 'x'; sin límite no hay barra.
+static void cv_limit_bar(Canvas *cv, int y, int x, double ratio) {
+    int bw = cv_right(cv) - x - 7;
+    if (bw < 6) return;
+    unsigned short st = ratio_style(ratio);
+    cv_bar_styled(cv, y, x, bw, ratio, st);
+    canvas_printf(cv, y, x + bw, st, " %5.1f%%", ratio * 100.0);
+}
+
+static void draw_cgroup_panel(Canvas *cv, const CgroupStats *cg, int online) {
+    const int x = 2;
+    int y = 1;
+    const int y_end = cv->y0 + cv->rows;
+    const int bar_x = x + 48;
+    char a[32], b[32], c[32], d[32];
+
+    // Memoria: el límite efectivo es memory.high si es menor que memory.max
+    long limit = cg->mem_max_kib;
+    if (cg->mem_high_kib > 0 && (limit == 0 || cg->mem_high_kib < limit)) limit = cg->mem_high_kib;
+    format_bytes_from_kib(cg->mem_current_kib, a, sizeof(a));
+    if (limit > 0) format_bytes_from_kib(limit, b, sizeof(b));
+    else snprintf(b, sizeof(b), "sin límite");
+    canvas_printf(cv, y, x, CV_PLAIN, "memoria %10s / %-10s%s", a, b,
+                  limit > 0 && limit == cg->mem_high_kib ? " (high)" : "");
+    if (limit > 0) cv_limit_bar(cv, y, bar_x, (double)cg->mem_current_kib / (double)limit);
+    y++;
+
+    // CPU: contra la cuota de cpu.max o, sin ella, contra los núcleos en línea
+    if (y < y_end) {
+        if (cg->cpu_quota > 0.0) snprintf(b, sizeof(b), "%.2f núcl.", cg->cpu_quota);
+        else snprintf(b, sizeof(b), "sin límite");
+        if (!cg->ready) {
+            canvas_printf(cv, y, x, CV_PLAIN, "CPU     %10s / %-10s  calculando…", "", b);
+        } else {
+            int tx = canvas_printf(cv, y, x, CV_PLAIN, "CPU     %5.2f núcl. / %-10s", cg->cpu, b);
+            double cap = cg->cpu_quota > 0.0 ? cg->cpu_quota : (online > 0 ? online : 1);
+            double ratio = cg->cpu / cap;
+            if (ratio > 1.0) ratio = 1.0;
+            if (cg->throttled_ratio > 0.0) {
+                // El frenado por cuota es justo lo que el uso medio no muestra
+                unsigned short st = cg->throttled_ratio >= 0.25 ? CV_STYLE(4, 1) : CV_STYLE(2, 1);
+                canvas_printf(cv, y, tx + 1, st, "frenado %3.0f%%", cg->throttled_ratio * 100.0);
+            }
+            cv_limit_bar(cv, y, bar_x, ratio);
+        }
+        y++;
+    }
+
+    // Desglose de memory.stat y swap
+    if (y < y_end) {
+        format_bytes_from_kib(cg->anon_kib, a, sizeof(a));
+        format_bytes_from_kib(cg->file_kib, b, sizeof(b));
+        format_bytes_from_kib(cg->kernel_kib, c, sizeof(c));
+        format_bytes_from_kib(cg->swap_current_kib, d, sizeof(d));
+        int tx = canvas_printf(cv, y, x, ST_SUBTITLE, "apps %s | caché %s | kernel %s | swap %s", a, b, c, d);
+        if (cg->ready && cg->throttled_ms_ps > 0.0)
+            canvas_printf(cv, y, tx + 3, ST_SUBTITLE, "frenado %.0f ms/s", cg->throttled_ms_ps);
+        y++;
+    }
+
+    // Hijos, más consumo primero; el último avisa cuántos quedaron fuera
+    int shown = cg->nchildren < y_end - y ? cg->nchildren : y_end - y;
+    for (int i = 0; i < shown; ++i, ++y) {
+        const CgroupChild *ch = &cg->child[i];
+        int more = (i == shown - 1) ? cg->nchildren - shown + cg->omitted_children : 0;
+        format_bytes_from_kib(ch->mem_kib, a, sizeof(a));
+        int tx = canvas_printf(cv, y, x, CV_PLAIN, "%s %-32.32s", i == shown - 1 ? "└─" : "├─", ch->name);
+        if (ch->ready) tx = canvas_printf(cv, y, tx + 1, ratio_style(ch->cpu / (cg->cpu > 0.0 ? cg->cpu : 1.0)),
+                                          "cpu %5.2f", ch->cpu);
+        else tx = canvas_printf(cv, y, tx + 1, CV_PLAIN, "cpu %5s", "…");
+        tx = canvas_printf(cv, y, tx + 2, CV_PLAIN, "mem %10s", a);
+        if (more > 0) canvas_printf(cv, y, tx + 2, ST_SUBTITLE, "(+%d hijos más)", more);
+    }
+}
+
+// "some  4.14   5.24 [###      ]   6.5%" desde x con 'w' columnas
+static void cv_psi_line(Canvas *cv, int y, int x, int w, const char *tag,
+                        const PsiLine *l, int ready) {
+    canvas_text(cv, y, x, CV_PLAIN, tag);
+    canvas_printf(cv, y, x + 5, psi_style(l->avg10), "%6.2f", l->avg10);
+    canvas_printf(cv, y, x + 12, psi_style(l->avg60), "%6.2f", l->avg60);
+    if (!ready) { canvas_text(cv, y, x + 20, CV_PLAIN, "…"); return; }
+    double pct = l->stall * 100.0;
+    int bw = w - 20 - 8;
+    if (bw >= 6) {
+        cv_bar_styled(cv, y, x + 20, bw, l->stall, psi_style(pct));
+        canvas_printf(cv, y, x + 20 + bw, psi_style(pct), " %5.1f%%", pct);
+    } else {
+        canvas_printf(cv, y, x + 19, psi_style(pct), " %5.1f%%", pct);
+    }
+}
+
+static void draw_psi_panel(Canvas *cv, const PsiStats *p) {
+    static const char *const label[PSI_COUNT] = { "CPU", "memoria", "E/S" };
+    const int x = 2;
+    int y = 1;
+    const int y_end = cv->y0 + cv->rows;
+    const int name_w = 9;
+    int hw = (cv_right(cv) - x - name_w) / 2;   // mitad "some" y mitad "full"
+    if (hw < 20 || y >= y_end) return;
+
+    for (int k = 0; k < 2; ++k) {
+        int hx = x + name_w + k * hw;
+        canvas_text(cv, y, hx + 5, ST_SUBTITLE, " avg10  avg60  último intervalo");
+    }
+    y++;
+    for (int r = 0; r < PSI_COUNT && y < y_end; ++r) {
+        const PsiResource *pr = &p->res[r];
+        if (!pr->available) continue;
+        canvas_text(cv, y, x, CV_PLAIN, label[r]);
+        cv_psi_line(cv, y, x + name_w, hw - 2, "some", &pr->some, p->ready);
+        if (pr->has_full) cv_psi_line(cv, y, x + name_w + hw, hw - 2, "full", &pr->full, p->ready);
+        else              canvas_text(cv, y, x + name_w + hw, CV_PLAIN, "full    —");
+        y++;
+    }
+}
+
+// ==================== Procesos ====================
+
+// RSS compacto: "  1.25 GiB", "812.0 MiB". Cada unidad cubre menos de 1024
+// de la siguiente y TiB se recorta a 9999: como mucho "1024.00 GiB".
+#define RSS_BUF 16
+static void fmt_rss(long kib, char buf[RSS_BUF]) {
+    const double k = (double)kib;
+    if (kib < 1024L)                 snprintf(buf, RSS_BUF, "%5d KiB", kib > 0 ? (int)kib : 0);
+    else if (kib < 1024L * 1024L)    snprintf(buf, RSS_BUF, "%5.1f MiB", k / 1024.0);
+    else if (k < 1024.0 * 1048576.0) snprintf(buf, RSS_BUF, "%5.2f GiB", k / 1048576.0);
+    else                             snprintf(buf, RSS_BUF, "%5.0f TiB", fmin(k / 1073741824.0, 9999.0));
+}
+
+static void draw_proc_panel(Canvas *cv, const ProcStats *p, const MemStats *mem) {
+    const int x = 2;
+    int y = 1;
+    const int y_end = cv->y0 + cv->rows;
+    const int right = cv_right(cv);
+    if (y >= y_end) return;
+
+    int by_cpu = (g_proc_sort == TUI_PROC_SORT_CPU);
+    canvas_text(cv, y, x, ST_SUBTITLE, "    pid  proceso          E hilos    cpu%        rss");
+    int sx = canvas_printf(cv, y, x + 52, CV_PLAIN, "  %d procesos, %d hilos, %d en ejecución",
+                           p->total, p->threads, p->running);
+    canvas_printf(cv, y, sx, ST_SUBTITLE, " — orden %s ('m')", by_cpu ? "CPU" : "RSS");
+
+    const ProcInfo *list = by_cpu ? p->by_cpu : p->by_rss;
+    int n = by_cpu ? p->n_cpu : p->n_rss;
+    for (int i = 0; i < n && y + 1 + i < y_end; ++i) {
+        const ProcInfo *v = &list[i];
+        int ry = y + 1 + i;
+        char rss[RSS_BUF];
+        fmt_rss(v->rss_kib, rss);
+        canvas_printf(cv, ry, x, CV_PLAIN, "%7d  %-15.15s  %c %5d", v->pid, v->comm, v->state, v->threads);
+        if (p->ready)
+            canvas_printf(cv, ry, x + 34, v->cpu >= 0.9 ? CV_STYLE(4, 1) : v->cpu >= 0.5 ? CV_STYLE(2, 1) : CV_PLAIN,
+                          " %6.1f", v->cpu * 100.0);
+        else
+            canvas_text(cv, ry, x + 35, CV_PLAIN, "     …");
+        canvas_printf(cv, ry, x + 41, CV_PLAIN, " %10s", rss);
+
+        // Barra del criterio de orden: cpu sobre un core, rss sobre la RAM
+        int bx = x + 54, bw = right - bx - 1;
+        if (bw < 8) continue;
+        double r = by_cpu ? v->cpu : (mem && mem->total_kib > 0 ? (double)v->rss_kib / (double)mem->total_kib : 0.0);
+        if (by_cpu && !p->ready) continue;
+        cv_bar(cv, ry, bx, bw, r);
+    }
+}
+
+// ==================== Estadísticas en ventana ====================
+
+// " | 1/5/15 s  44.9  45.0  44.2 | p95  47.1 máx  52.0 %" tras el valor de una
+// métrica global, si cabe entero. Devuelve la columna siguiente.
+static int cv_stats_brief(Canvas *cv, int y, int x, StatsSeries s) {
+    const StatsSummary sum = g_sum[s];
+    if (sum.count == 0) return x;
+    if (cv_right(cv) - x < 52) return x;
+    x = canvas_text(cv, y, x, CV_PLAIN, " | ");
+    x = canvas_text(cv, y, x, ST_SUBTITLE, "1/5/15 s");
+    x = canvas_printf(cv, y, x, CV_PLAIN, " %5.1f %5.1f ", sum.ewma[0] * 100.0, sum.ewma[1] * 100.0);
+    // La de 15 s es la carga sostenida: es la que lleva color
+    x = canvas_printf(cv, y, x, ratio_style(sum.ewma[2]), "%5.1f", sum.ewma[2] * 100.0);
+    x = canvas_text(cv, y, x, CV_PLAIN, " | ");
+    x = canvas_text(cv, y, x, ST_SUBTITLE, "p95");
+    x = canvas_printf(cv, y, x, CV_PLAIN, " %5.1f ", sum.p95 * 100.0);
+    x = canvas_text(cv, y, x, ST_SUBTITLE, "máx");
+    return canvas_printf(cv, y, x, CV_PLAIN, " %5.1f %%", sum.max * 100.0);
+}
+
+// Columnas fijas por core: "~ 15 s 12.3 p50 10 p95 41 p99 77 máx 98" (en %)
+static int cv_core_stats(Canvas *cv, int y, int x, int i) {
+    if (i < 0 || i >= g_core_sum_n || g_core_sum[i].count == 0)
+        return canvas_text(cv, y, x, ST_SUBTITLE, "   (sin estadísticas aún)              ");
+    const StatsSummary sum = g_core_sum[i];
+    x = canvas_printf(cv, y, x, ratio_style(sum.ewma[2]), "~%5.1f", sum.ewma[2] * 100.0);
+    return canvas_printf(cv, y, x, ST_SUBTITLE, " p50 %3.0f p95 %3.0f p99 %3.0f máx %3.0f",
+                         sum.p50 * 100.0, sum.p95 * 100.0, sum.p99 * 100.0, sum.max * 100.0);
+}
+
+// ==================== Sparklines ====================
+
+// Ancho de sparkline para un hueco de 'avail' columnas, a lo sumo 'max_w'
+// (y el largo del historial); 0 si no hay historial o quedan menos de 8.
+static int spark_width(int avail, int max_w) {
+    if (!g_hist || g_hist->cap <= 0) return 0;
+    int w = avail;
+    if (w > max_w) w = max_w;
+    if (w > g_hist->cap) w = g_hist->cap;
+    return (w >= 8) ? w : 0;
+}
+
+// Últimas 'width' muestras de un anillo del historial, la más reciente a la
+// derecha. Escala fija [0, max] (max > 0) o, con max <= 0, el máximo de la
+// ventana visible. Muestras faltantes (NAN) quedan en blanco.
+static void cv_sparkline(Canvas *cv, int y, int x, int width, const float *ring, double max, int by_ratio) {
+    static const wchar_t levels[8] = { L'▁', L'▂', L'▃', L'▄', L'▅', L'▆', L'▇', L'█' };
+    if (!g_hist || !ring || width <= 0) return;
+    int n = g_hist->count < width ? g_hist->count : width;
+
+    if (max <= 0.0) {
+        for (int a = 0; a < n; ++a) {
+            float v = history_at(g_hist, ring, a);
+            if (!isnan(v) && v > max) max = v;
+        }
+        if (max <= 0.0) max = 1.0;
+    }
+    for (int a = 0; a < n; ++a) {
+        float v = history_at(g_hist, ring, a);
+        if (isnan(v)) continue;
+        double r = (double)v / max;
+        if (r < 0.0) r = 0.0;
+        if (r > 1.0) r = 1.0;
+        int lvl = (int)(r * 7.0 + 0.5);
+        canvas_put(cv, y, x + width - 1 - a, levels[lvl],
+                   by_ratio ? ratio_style((double)v) : CV_STYLE(1, 0));
+    }
+}
+
+// ==================== Planificador ====================
+
+// "Ejecutables 3 (0.75/core) | bloq. E/S 0 | ctxt/s 1234 | intr/s 567 | forks/s 2.0"
+// La cola por core en amarillo/rojo cuando hay más tareas ejecutables que cores.
+static int cv_sched_line(Canvas *cv, int y, int x, const CPUUsage *usage) {
+    const CPUKernelStats *k = &usage->kstat;
+    int ncores = usage->online_count > 0 ? usage->online_count : 1;
+    double rq = (double)k->procs_running / (double)ncores;
+
+    short pair = rq >= 2.0 ? 4 : (rq > 1.0 ? 2 : 3);
+    x = canvas_printf(cv, y, x, CV_STYLE(pair, 1), "Ejecutables %d (%.2f/core)", k->procs_running, rq);
+    if (usage->ready) {
+        return canvas_printf(cv, y, x, CV_PLAIN, " | bloq. E/S %d | ctxt/s %.0f | intr/s %.0f | forks/s %.1f",
+                             k->procs_blocked, k->ctxt_per_s, k->intr_per_s, k->forks_per_s);
+    }
+    return canvas_printf(cv, y, x, CV_PLAIN, " | bloq. E/S %d | tasas: calculando…", k->procs_blocked);
+}
+
+// ==================== Mapa de calor ====================
+
+// Métrica por la que se ordena el top-N (y su etiqueta en la cabecera)
+static double heat_metric(const CPUUsage *u, int i, TuiHeatSort sort) {
+    const CPUTimes *t = &u->times[i];
+    switch (sort) {
+    case TUI_HEAT_SORT_KERNEL:  return t->system + t->irq + t->softirq;
+    case TUI_HEAT_SORT_SOFTIRQ: return t->softirq;
+    case TUI_HEAT_SORT_STEAL:   return t->steal;
+    case TUI_HEAT_SORT_IOWAIT:  return t->iowait;
+    default:                    return u->per_core[i];
+    }
+}
+
+static const char *heat_sort_label(TuiHeatSort sort) {
+    switch (sort) {
+    case TUI_HEAT_SORT_KERNEL:  return "sys+irq";
+    case TUI_HEAT_SORT_SOFTIRQ: return "softirq";
+    case TUI_HEAT_SORT_STEAL:   return "steal";
+    case TUI_HEAT_SORT_IOWAIT:  return "iowait";
+    default:                    return "uso";
+    }
+}
+
+// Celda de un core: intensidad por glifo (legible sin color) y color por umbral.
+static void heat_cell(const CPUUsage *u, int i, wchar_t *ch, unsigned short *style) {
+    if (u->state[i] == CPU_CORE_OFFLINE) { *ch = L'x'; *style = CV_STYLE(5, 0); return; }
+    if (u->state[i] != CPU_CORE_ONLINE)  { *ch = L'?'; *style = CV_PLAIN; return; }
+    static const wchar_t glyphs[4] = { L'░', L'▒', L'▓', L'█' };
+    double r = u->per_core[i];
+    int g = (int)(r * 4.0);
+    if (g > 3) g = 3;
+    if (g < 0) g = 0;
+    *ch = glyphs[g];
+    *style = ratio_style(r);
+}
+
+#define HEAT_TOPN_W   15   // "191  100.0%" + separador
+#define HEAT_TOPN_MAX 64
+
+// Grilla de cores (1 o 2 columnas por core) + top-N a la derecha.
+// El coste está acotado por el área del panel, no por el nº de cores.
+static void draw_cpu_heatmap(Canvas *cv, int y, int x, int y_end, const CPUUsage *usage) {
+    int right = cv_right(cv);
+    int rows = y_end - y;
+    int ncores = usage->cores;
+    if (rows <= 0 || ncores <= 0) return;
+
+    // Etiquetas de fila ("192 ") si sobra espacio; celdas de 2 columnas si
+    // caben. Se prueba de más holgado a más compacto y, como último recurso,
+    // se renuncia al top-N para dar todo el ancho a la grilla.
+    int label_w = 2;
+    for (int v = ncores - 1; v >= 10; v /= 10) label_w++;
+    int list_w = 0, cell_w = 1, per_row = 0, use_labels = 0;
+    for (int attempt = 0; attempt < 8; ++attempt) {
+        list_w     = (attempt < 4 && right - x - HEAT_TOPN_W >= 16) ? HEAT_TOPN_W : 0;
+        cell_w     = (attempt % 4 < 2) ? 2 : 1;
+        use_labels = (attempt % 2 == 0);
+        int avail = right - x - list_w - (use_labels ? label_w : 0);
+        per_row = avail / cell_w;
+        if (per_row <= 0 || (long)per_row * rows < ncores) continue;
+        // filas alineadas a múltiplos de 8 si no cuesta cores visibles
+        int aligned = per_row - per_row % 8;
+        if (aligned > 0 && (long)aligned * rows >= ncores) per_row = aligned;
+        break;
+    }
+    if (per_row <= 0) return;
+
+    int shown = per_row * rows < ncores ? per_row * rows : ncores;
+    int gx = x + (use_labels ? label_w : 0);
+    for (int i = 0; i < shown; ++i) {
+        int r = i / per_row, c = i % per_row;
+        if (c == 0 && use_labels) canvas_printf(cv, y + r, x, CV_STYLE(5, 0), "%*d", label_w - 1, i);
+        wchar_t ch; unsigned short st;
+        heat_cell(usage, i, &ch, &st);
+        canvas_fill(cv, y + r, gx + c * cell_w, cell_w, ch, st);
+    }
+    if (shown < ncores) {
+        canvas_printf(cv, y_end - 1, x, ST_SUBTITLE, "… %d cores sin espacio", ncores - shown);
+    }
+
+    // Top-N por la métrica elegida: inserción en un arreglo de N (N ≤ filas),
+    // O(cores·N) sin ordenar todos los cores.
+    if (!list_w) return;
+    int lx = right - list_w + 2;
+    int topn = rows - 1;
+    if (topn <= 0) return;   // una sola fila: no cabe ni una entrada bajo el título
+    if (topn > HEAT_TOPN_MAX) topn = HEAT_TOPN_MAX;
+    int    top_id[HEAT_TOPN_MAX];
+    double top_v [HEAT_TOPN_MAX];
+    int    n = 0;
+    for (int i = 0; i < ncores; ++i) {
+        if (usage->state[i] != CPU_CORE_ONLINE) continue;
+        double v = heat_metric(usage, i, g_heat_sort);
+        if (n == topn && v <= top_v[n - 1]) continue;
+        int k = (n < topn) ? n++ : n - 1;
+        while (k > 0 && top_v[k - 1] < v) { top_v[k] = top_v[k - 1]; top_id[k] = top_id[k - 1]; k--; }
+        top_v[k] = v; top_id[k] = i;
+    }
+    canvas_printf(cv, y, lx, ST_TITLE, "Top %s", heat_sort_label(g_heat_sort));
+    for (int k = 0; k < n; ++k) {
+        canvas_printf(cv, y + 1 + k, lx, ratio_style(top_v[k]), "%4d %6.1f%%", top_id[k], top_v[k] * 100.0);
+    }
 }